@@ -0,0 +1,145 @@
+#include "bench.h"
+
+/// @file bench.c
+/// @brief Implementation of the micro-benchmark harness
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "../common/time_utils.h"
+
+int compare_doubles(const void *first, const void *second);
+double get_percentile(const double *sorted, const int count,
+                      const double percent);
+
+/// @brief time the case
+/// @param bench_case the case
+/// @param samples number of the timed batches
+/// @param result where to save the ns/op percentiles
+/// @return true on malloc error
+bool bench_run_case(const bench_case_t *bench_case, const int samples,
+                    bench_result_t *result) {
+  if (!bench_case || !bench_case->run || samples < 1 || !result) return true;
+  double *ns_per_op = malloc(sizeof(double) * samples);
+  if (!ns_per_op) return true;
+  // the first batch warms the caches up and is not counted
+  for (int s = -1; s != samples; ++s) {
+    if (bench_case->prepare) {
+      for (int i = 0; i != BENCH_BATCH; ++i) {
+        bench_case->prepare(bench_case->data, i);
+      }
+    }
+    const unsigned long long start_ns = get_monotonic_ns();
+    for (int i = 0; i != BENCH_BATCH; ++i) {
+      bench_case->run(bench_case->data, i);
+    }
+    const unsigned long long end_ns = get_monotonic_ns();
+    if (s >= 0) ns_per_op[s] = (double)(end_ns - start_ns) / BENCH_BATCH;
+  }
+  qsort(ns_per_op, samples, sizeof(double), compare_doubles);
+  snprintf(result->name, BENCH_NAME_MAX, "%s", bench_case->name);
+  result->min = ns_per_op[0];
+  result->p50 = get_percentile(ns_per_op, samples, 50);
+  result->p90 = get_percentile(ns_per_op, samples, 90);
+  result->p99 = get_percentile(ns_per_op, samples, 99);
+  free(ns_per_op);
+  return false;
+}
+
+/// @brief write the results as the baseline
+/// @param path the baseline file
+/// @param results the results
+/// @param count number of the results
+/// @return true if the file could not be written
+bool bench_save_baseline(const char *path, const bench_result_t *results,
+                         const int count) {
+  FILE *file = fopen(path, "w");
+  if (!file) return true;
+  fprintf(file, "# name p50 p90 p99 min, ns/op\n");
+  for (int i = 0; i != count; ++i) {
+    fprintf(file, "%s %.2f %.2f %.2f %.2f\n", results[i].name, results[i].p50,
+            results[i].p90, results[i].p99, results[i].min);
+  }
+  return fclose(file) != 0;
+}
+
+/// @brief read the baseline, the lines starting with # are skipped
+/// @param path the baseline file
+/// @param baseline where to save the results
+/// @param max_count size of the baseline array
+/// @return number of the results read, -1 if the file could not be read
+int bench_load_baseline(const char *path, bench_result_t *baseline,
+                        const int max_count) {
+  FILE *file = fopen(path, "r");
+  if (!file) return -1;
+  int count = 0;
+  char line[256];
+  while (count != max_count && fgets(line, sizeof(line), file)) {
+    bench_result_t *result = &baseline[count];
+    if (line[0] != '#' &&
+        sscanf(line, "%47s %lf %lf %lf %lf", result->name, &result->p50,
+               &result->p90, &result->p99, &result->min) == 5) {
+      ++count;
+    }
+  }
+  fclose(file);
+  return count;
+}
+
+/// @brief find the result of a case by its name
+/// @param results the results
+/// @param count number of the results
+/// @param name name of the case
+/// @return the result, NULL if there is none
+const bench_result_t *bench_find_result(const bench_result_t *results,
+                                        const int count, const char *name) {
+  const bench_result_t *found = NULL;
+  for (int i = 0; !found && i != count; ++i) {
+    if (!strcmp(results[i].name, name)) found = &results[i];
+  }
+  return found;
+}
+
+/// @brief print the result and its change against the baseline. The medians
+/// are compared, the other percentiles are too noisy for that
+/// @param out where to print
+/// @param result the result
+/// @param baseline the baseline result of the case, may be NULL
+/// @param threshold_percent the slowdown of the median that is a regression
+/// @return true if the case has regressed
+bool bench_print_result(FILE *out, const bench_result_t *result,
+                        const bench_result_t *baseline,
+                        const double threshold_percent) {
+  fprintf(out, "%-28s %10.1f %10.1f %10.1f %10.1f", result->name, result->p50,
+          result->p90, result->p99, result->min);
+  bool regressed = false;
+  if (baseline && baseline->p50 > 0) {
+    const double change = (result->p50 / baseline->p50 - 1) * 100;
+    regressed = change > threshold_percent;
+    fprintf(out, " %+8.1f%%%s", change, regressed ? "  REGRESSION" : "");
+  }
+  fputc('\n', out);
+  return regressed;
+}
+
+/// @brief qsort comparator of doubles in ascending order
+/// @param first the first double
+/// @param second the second double
+/// @return negative, zero or positive as first is less, equal or greater
+int compare_doubles(const void *first, const void *second) {
+  const double a = *(const double *)first;
+  const double b = *(const double *)second;
+  return (a > b) - (a < b);
+}
+
+/// @brief get the nearest rank percentile
+/// @param sorted the values in ascending order
+/// @param count number of the values
+/// @param percent the percent, 0 to 100
+/// @return the percentile
+double get_percentile(const double *sorted, const int count,
+                      const double percent) {
+  int rank = (int)(count * percent / 100.0);
+  if (rank >= count) rank = count - 1;
+  return sorted[rank];
+}
@@ -0,0 +1,52 @@
+#ifndef TETRIS_BENCH
+#define TETRIS_BENCH
+
+/// @file bench.h
+/// @brief Declaration of the micro-benchmark harness. A case is timed in
+/// samples of BENCH_BATCH operations, every sample gives the ns/op of its
+/// batch and the case is reported by the percentiles of the samples. The
+/// state an operation changes is prepared for every operation of a batch
+/// before the batch is timed. Results are saved to and compared with a
+/// baseline file, a text file with a line per case
+
+#include <stdbool.h>
+#include <stdio.h>
+
+#define BENCH_BATCH 64
+#define BENCH_DEFAULT_SAMPLES 1000
+#define BENCH_NAME_MAX 48
+#define BENCH_CASES_MAX 64
+
+/// @brief An operation of a case, i is its index in the batch
+typedef void (*bench_op_t)(void *data, int i);
+
+/// @brief prepare is not timed and may be NULL
+typedef struct {
+  const char *name;
+  bench_op_t prepare;
+  bench_op_t run;
+  void *data;
+} bench_case_t;
+
+/// @brief ns/op of a case: the fastest sample and the percentiles
+typedef struct {
+  char name[BENCH_NAME_MAX];
+  double min;
+  double p50;
+  double p90;
+  double p99;
+} bench_result_t;
+
+bool bench_run_case(const bench_case_t *, const int samples,
+                    bench_result_t *);
+bool bench_save_baseline(const char *path, const bench_result_t *results,
+                         const int count);
+int bench_load_baseline(const char *path, bench_result_t *baseline,
+                        const int max_count);
+const bench_result_t *bench_find_result(const bench_result_t *results,
+                                        const int count, const char *name);
+bool bench_print_result(FILE *out, const bench_result_t *result,
+                        const bench_result_t *baseline,
+                        const double threshold_percent);
+
+#endif
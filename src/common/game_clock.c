@@ -0,0 +1,73 @@
+#include "game_clock.h"
+
+/// @file game_clock.c
+/// @brief Implementation of the pluggable time source of a game
+
+#include "time_utils.h"
+
+/// @brief get the monotonic time
+/// @return milliseconds since an unspecified point
+unsigned long get_monotonic_ms(void) {
+  struct timespec current_time = {0};
+  clock_gettime(CLOCK_MONOTONIC, &current_time);
+  return current_time.tv_sec * 1000 + current_time.tv_nsec / 1000000;
+}
+
+/// @brief prepare the clock
+/// @param clock the clock
+/// @param kind the time source
+/// @param scale speed of the scaled clock, ignored by the other ones
+void game_clock_init(game_clock_t *clock, game_clock_kind_t kind,
+                     double scale) {
+  clock->kind = kind;
+  clock->manual_ms = 0;
+  clock->scale = scale > 0 ? scale : 1;
+  clock->origin_ms = kind == GAME_CLOCK_SCALED ? get_monotonic_ms() : 0;
+}
+
+/// @brief get the current time of the clock
+/// @param clock the clock
+/// @return milliseconds
+unsigned long game_clock_get_ms(const game_clock_t *clock) {
+  unsigned long now = 0;
+  switch (clock->kind) {
+    case GAME_CLOCK_MANUAL:
+      now = clock->manual_ms;
+      break;
+    case GAME_CLOCK_SCALED:
+      now = (unsigned long)((get_monotonic_ms() - clock->origin_ms) *
+                            clock->scale);
+      break;
+    default:
+      now = get_monotonic_ms();
+      break;
+  }
+  return now;
+}
+
+/// @brief move the manual clock forward, the other clocks ignore it
+/// @param clock the clock
+/// @param ms milliseconds to move by
+void game_clock_advance_ms(game_clock_t *clock, unsigned long ms) {
+  if (clock->kind == GAME_CLOCK_MANUAL) {
+    clock->manual_ms += ms;
+  }
+}
+
+/// @brief check if ms_diff_threshold has passed since the previous operation,
+/// save the current time as the time of the operation if it has
+/// @param clock the clock
+/// @param prev_op_ms time of the previous operation
+/// @param ms_diff_threshold milliseconds between the operations
+/// @return true if it is time to operate
+bool game_clock_get_is_time_to_operate(const game_clock_t *clock,
+                                       unsigned long *prev_op_ms,
+                                       const unsigned long ms_diff_threshold) {
+  const unsigned long now = game_clock_get_ms(clock);
+  bool should_operate = false;
+  if (now - *prev_op_ms >= ms_diff_threshold) {
+    should_operate = true;
+    *prev_op_ms = now;
+  }
+  return should_operate;
+}
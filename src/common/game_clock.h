@@ -0,0 +1,36 @@
+#ifndef GAME_CLOCK
+#define GAME_CLOCK
+
+/// @file game_clock.h
+/// @brief Declaration of the pluggable time source of a game. The game timers
+/// read the time in milliseconds from the clock only, so a game may run on the
+/// real monotonic time, on manually advanced virtual time or on a scaled time
+
+#include <stdbool.h>
+
+typedef enum {
+  GAME_CLOCK_MONOTONIC = 0,
+  GAME_CLOCK_MANUAL,
+  GAME_CLOCK_SCALED
+} game_clock_kind_t;
+
+/// @brief A zeroed clock is the monotonic one. The manual clock starts at 0
+/// and only moves by game_clock_advance_ms(), the scaled one starts at 0 and
+/// runs scale times as fast as the monotonic time
+typedef struct {
+  game_clock_kind_t kind;
+  unsigned long manual_ms;
+  double scale;
+  unsigned long origin_ms;
+} game_clock_t;
+
+void game_clock_init(game_clock_t *, game_clock_kind_t kind, double scale);
+unsigned long game_clock_get_ms(const game_clock_t *);
+void game_clock_advance_ms(game_clock_t *, unsigned long ms);
+bool game_clock_get_is_time_to_operate(const game_clock_t *,
+                                       unsigned long *prev_op_ms,
+                                       const unsigned long ms_diff_threshold);
+
+unsigned long get_monotonic_ms(void);
+
+#endif
@@ -22,3 +22,15 @@ bool get_is_time_to_operate_ms_diff(struct timespec *prev_op,
   }
   return should_operate;
 }
+
+unsigned long get_monotonic_us(void) {
+  struct timespec current_time = {0};
+  clock_gettime(CLOCK_MONOTONIC, &current_time);
+  return current_time.tv_sec * 1000000 + current_time.tv_nsec / 1000;
+}
+
+unsigned long long get_monotonic_ns(void) {
+  struct timespec current_time = {0};
+  clock_gettime(CLOCK_MONOTONIC, &current_time);
+  return current_time.tv_sec * 1000000000ull + current_time.tv_nsec;
+}
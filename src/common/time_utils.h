@@ -12,5 +12,7 @@ unsigned long get_timespec_diff_ms(const struct timespec *later,
                                    const struct timespec *earlier);
 bool get_is_time_to_operate_ms_diff(struct timespec *prev_op,
                                     const unsigned long ms_diff_threshold);
+unsigned long get_monotonic_us(void);
+unsigned long long get_monotonic_ns(void);
 
 #endif
\ No newline at end of file
@@ -0,0 +1,214 @@
+#include "autoplay.h"
+
+/// @file autoplay.c
+/// @brief Implementation of the autoplay and its heuristic evaluator
+
+#include <float.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "search.h"
+
+// the weights of a known genetic search for the standard field with the holes
+// weight doubled and a light wells weight, picked with tetris_sim -A
+const autoplay_weights_t autoplay_default_weights = {-0.51, -0.76, -0.18, -0.1,
+                                                     0.76};
+
+bool get_figures_equal(const figure_t *first, const figure_t *second);
+
+/// @brief set up the autoplay with an evaluator
+/// @param autoplay the autoplay
+/// @param evaluate the evaluator, NULL for the heuristic one
+/// @param data evaluator data, NULL for the default weights of the heuristic
+/// evaluator
+void autoplay_init(autoplay_t *autoplay, autoplay_evaluate_t evaluate,
+                   const void *data) {
+  if (!autoplay) return;
+  autoplay->evaluate = evaluate ? evaluate : autoplay_evaluate_heuristic;
+  autoplay->data = data;
+  autoplay->search = NULL;
+  autoplay_reset(autoplay);
+}
+
+/// @brief choose the placements by the beam search, NULL to go back to the
+/// evaluation of the current figure only. The search is not owned by the
+/// autoplay
+/// @param autoplay the autoplay
+/// @param search the search object
+void autoplay_set_search(autoplay_t *autoplay, struct search *search) {
+  if (!autoplay) return;
+  autoplay->search = search;
+  autoplay_reset(autoplay);
+}
+
+/// @brief drop the plan, the next figure is planned for from scratch
+/// @param autoplay the autoplay
+void autoplay_reset(autoplay_t *autoplay) {
+  if (!autoplay) return;
+  autoplay->planned = false;
+  autoplay->length = 0;
+  autoplay->position = 0;
+}
+
+/// @brief get the next signal for the current figure of the game, planning
+/// for the figure if it is new or has left the path. After the path is over
+/// the lock by the autoshift is all that is left, so AUTOSHIFT_SIG is
+/// returned until the next figure
+/// @param autoplay the autoplay
+/// @param game the game in the IDLE state
+/// @return the signal, NO_INPUT if the figure has no placements
+fsm_input_t autoplay_get_signal(autoplay_t *autoplay,
+                                const tetris_game_t *game) {
+  const figure_t *expected = NULL;
+  if (autoplay->planned && autoplay->piece == game->randomizer.dealt) {
+    expected = autoplay->position ? &autoplay->positions[autoplay->position - 1]
+                                  : &autoplay->start;
+  }
+  if (!expected || !get_figures_equal(expected, &game->current_figure)) {
+    if (autoplay_plan(autoplay, game)) return NO_INPUT;
+  }
+  fsm_input_t signal = AUTOSHIFT_SIG;
+  if (autoplay->position < autoplay->length) {
+    signal = autoplay->path[autoplay->position++];
+  }
+  return signal;
+}
+
+/// @brief choose the placement of the current figure and find the path to it
+/// @param autoplay the autoplay
+/// @param game the game
+/// @return true if the figure has no placements
+bool autoplay_plan(autoplay_t *autoplay, const tetris_game_t *game) {
+  autoplay_reset(autoplay);
+  figure_t choice;
+  if (!autoplay_choose(autoplay, game, &choice)) {
+    autoplay->length =
+        placement_find_path(game->occupancy, &game->current_figure, &choice,
+                            autoplay->path, autoplay->positions);
+  }
+  if (autoplay->length > 0) {
+    autoplay->planned = true;
+    autoplay->piece = game->randomizer.dealt;
+    autoplay->start = game->current_figure;
+  } else {
+    autoplay->length = 0;
+  }
+  return !autoplay->planned;
+}
+
+/// @brief choose the best placement of the current figure, by the search over
+/// it and the preview figure if the autoplay has a search. Placements that end
+/// the game are chosen only if there are no others
+/// @param autoplay the autoplay
+/// @param game the game
+/// @param choice where to save the placement
+/// @return true if the figure has no placements
+bool autoplay_choose(const autoplay_t *autoplay, const tetris_game_t *game,
+                     figure_t *choice) {
+  figure_t placements[PLACEMENTS_MAX];
+  const int count =
+      placement_generate(game->occupancy, &game->current_figure, placements);
+  if (autoplay->search && count) {
+    const int preview_count = game->next_figure_id != NO_FIGURE ? 1 : 0;
+    if (!search_choose(autoplay->search, game->occupancy,
+                       &game->current_figure, &game->next_figure_id,
+                       preview_count, autoplay->evaluate, autoplay->data,
+                       choice)) {
+      return false;
+    }
+  }
+  int best = count ? 0 : -1;
+  double best_score = -DBL_MAX;
+  for (int i = 0; !autoplay->search && i != count; ++i) {
+    row_mask_t board[FIELD_TOTAL_HEIGHT];
+    memcpy(board, game->occupancy, sizeof(board));
+    int cut_rows = 0;
+    if (placement_lock(board, &placements[i], &cut_rows)) continue;
+    const double score = autoplay->evaluate(board, cut_rows, autoplay->data);
+    if (score > best_score) {
+      best_score = score;
+      best = i;
+    }
+  }
+  if (best >= 0) *choice = placements[best];
+  return best < 0;
+}
+
+/// @brief measure the board features the heuristic evaluator weighs
+/// @param board the occupancy bitboard, FIELD_TOTAL_HEIGHT rows
+/// @param cut_rows number of the rows cut by the placement
+/// @param features where to save the features
+void autoplay_get_features(const row_mask_t *board, const int cut_rows,
+                           autoplay_features_t *features) {
+  memset(features, 0, sizeof(autoplay_features_t));
+  features->lines = cut_rows;
+  int heights[FIELD_WIDTH] = {0};
+  row_mask_t covered = 0;
+  for (int r = 0; r != FIELD_TOTAL_HEIGHT; ++r) {
+    const row_mask_t row = board[r] & FULL_ROW_MASK;
+    for (unsigned m = row & ~covered; m; m &= m - 1) {
+      heights[__builtin_ctz(m)] = FIELD_TOTAL_HEIGHT - r;
+    }
+    features->holes += __builtin_popcount(covered & ~row & FULL_ROW_MASK);
+    covered |= row;
+  }
+  for (int c = 0; c != FIELD_WIDTH; ++c) {
+    features->height += heights[c];
+    if (c + 1 != FIELD_WIDTH) {
+      features->bumpiness += abs(heights[c] - heights[c + 1]);
+    }
+    const int left = c ? heights[c - 1] : FIELD_TOTAL_HEIGHT;
+    const int right =
+        c + 1 != FIELD_WIDTH ? heights[c + 1] : FIELD_TOTAL_HEIGHT;
+    const int depth = (left < right ? left : right) - heights[c];
+    if (depth > 0) features->wells += depth;
+  }
+}
+
+/// @brief score the board by the weighted sum of its features
+/// @param board the occupancy bitboard, FIELD_TOTAL_HEIGHT rows
+/// @param cut_rows number of the rows cut by the placement
+/// @param weights autoplay_weights_t of the features, NULL for the defaults
+/// @return the score
+double autoplay_evaluate_heuristic(const row_mask_t *board, const int cut_rows,
+                                   const void *weights) {
+  const autoplay_weights_t *w = weights ? weights : &autoplay_default_weights;
+  autoplay_features_t features;
+  autoplay_get_features(board, cut_rows, &features);
+  return w->height * features.height + w->holes * features.holes +
+         w->bumpiness * features.bumpiness + w->wells * features.wells +
+         w->lines * features.lines;
+}
+
+/// @brief read the weights from the text
+/// @param text height,holes,bumpiness,wells,lines
+/// @param weights where to save the weights
+/// @return true if the text is not 5 comma separated numbers
+bool autoplay_parse_weights(const char *text, autoplay_weights_t *weights) {
+  double values[5];
+  bool error = !text;
+  for (int i = 0; !error && i != 5; ++i) {
+    char *end = NULL;
+    values[i] = strtod(text, &end);
+    error = end == text || *end != (i != 4 ? ',' : '\0');
+    text = end + 1;
+  }
+  if (!error) {
+    weights->height = values[0];
+    weights->holes = values[1];
+    weights->bumpiness = values[2];
+    weights->wells = values[3];
+    weights->lines = values[4];
+  }
+  return error;
+}
+
+/// @brief compare the figure positions
+/// @param first the first figure
+/// @param second the second figure
+/// @return true if the figures are the same and at the same position
+bool get_figures_equal(const figure_t *first, const figure_t *second) {
+  return first->id == second->id && first->rotation == second->rotation &&
+         first->position.r == second->position.r &&
+         first->position.c == second->position.c;
+}
@@ -0,0 +1,82 @@
+#ifndef TETRIS_AUTOPLAY
+#define TETRIS_AUTOPLAY
+
+/// @file autoplay.h
+/// @brief Declaration of the autoplay. For every figure the autoplay locks each
+/// of its placements on a copy of the board, scores the boards with an
+/// evaluator and leads the figure to the best placement by the path of the
+/// FSM signals. The path is followed while the figure is where the path
+/// expects it, otherwise the figure is planned for again from where it is.
+/// With a search set the placement is chosen by the beam search over the
+/// figure and the preview one instead
+
+#include <stdbool.h>
+
+#include "backend.h"
+#include "bitboard.h"
+#include "fsm.h"
+#include "placement.h"
+
+/// @brief Scores the board a placement leaves, the higher the better
+/// @param board the occupancy bitboard after the lock and the cut
+/// @param cut_rows number of the rows cut by the placement
+/// @param data evaluator data, the weights for the heuristic evaluator
+typedef double (*autoplay_evaluate_t)(const row_mask_t *board,
+                                      const int cut_rows, const void *data);
+
+/// @brief The board features the heuristic evaluator weighs. height is the sum
+/// of the column heights, holes are the empty cells under the column tops,
+/// bumpiness is the sum of the height differences of the adjacent columns,
+/// wells is the sum of the depths of the columns lower than both neighbours,
+/// the walls are higher than any column
+typedef struct {
+  int height;
+  int holes;
+  int bumpiness;
+  int wells;
+  int lines;
+} autoplay_features_t;
+
+typedef struct {
+  double height;
+  double holes;
+  double bumpiness;
+  double wells;
+  double lines;
+} autoplay_weights_t;
+
+struct search;
+
+/// @brief The evaluator and the plan for the current figure. piece is the
+/// number of the figure in the game, positions[i] is the figure after path[i]
+typedef struct {
+  autoplay_evaluate_t evaluate;
+  const void *data;
+  struct search *search;
+  bool planned;
+  int piece;
+  figure_t start;
+  int length;
+  int position;
+  fsm_input_t path[PLACEMENT_PATH_MAX];
+  figure_t positions[PLACEMENT_PATH_MAX];
+} autoplay_t;
+
+extern const autoplay_weights_t autoplay_default_weights;
+
+void autoplay_init(autoplay_t *, autoplay_evaluate_t evaluate,
+                   const void *data);
+void autoplay_set_search(autoplay_t *, struct search *search);
+void autoplay_reset(autoplay_t *);
+fsm_input_t autoplay_get_signal(autoplay_t *, const tetris_game_t *game);
+bool autoplay_plan(autoplay_t *, const tetris_game_t *game);
+bool autoplay_choose(const autoplay_t *, const tetris_game_t *game,
+                     figure_t *choice);
+
+void autoplay_get_features(const row_mask_t *board, const int cut_rows,
+                           autoplay_features_t *features);
+double autoplay_evaluate_heuristic(const row_mask_t *board, const int cut_rows,
+                                   const void *weights);
+bool autoplay_parse_weights(const char *text, autoplay_weights_t *weights);
+
+#endif
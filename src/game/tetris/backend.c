@@ -4,103 +4,103 @@
 /// @brief Implementation of functions to move figures
 
 #include <math.h>
-#include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <time.h>
 
+#include "bitboard.h"
 #include "defines.h"
 #include "figures.h"
-#include "matrix.h"
-
-#define SAVE_FILE_PATH "/tmp/.tetris_high_score"
+#include "high_score.h"
 
 int generate_next_figure(tetris_game_t *game);
-void load_high_score(tetris_game_t *game);
-void save_high_score(tetris_game_t *game);
+void mark_dirty_rows(tetris_game_t *game, int first_row, int rows_count);
 
-/// @brief Clear game field and score, prepare 'next figure' for the game start
+/// @brief Clear game field and score, seed the figures randomizer, prepare
+/// 'next figure' for the game start
 /// @param game ptr to a intialized current game
 void backend_setup_new_game(tetris_game_t *game) {
   if (!game) return;
-  fill_matrix(game->game.field, FIELD_TOTAL_HEIGHT, FIELD_WIDTH, 0);
-  fill_matrix(game->game.next, MAX_FIGURE_SIZE, MAX_FIGURE_SIZE, 0);
-  fill_matrix(game->current_figure.mask, MAX_FIGURE_SIZE, MAX_FIGURE_SIZE, 0);
+  memset(game->game.field, 0, sizeof(game->game.field));
+  memset(game->game.next, 0, sizeof(game->game.next));
+  game->current_figure.id = NO_FIGURE;
+  memset(game->occupancy, 0, sizeof(game->occupancy));
   game->game.score = 0;
   game->game.level = 0;
-  load_high_score(game);
+  game->game.lines = 0;
+  game->game.high_score = high_score_get();
+  game->game_seed = game->setup.seed;
+  game->board = (unsigned)game->setup.board < BOARD_KINDS_COUNT
+                    ? game->setup.board
+                    : BOARD_STANDARD;
+  randomizer_init(&game->randomizer, game->setup.randomizer, game->game_seed);
+  splitmix_next(&game->setup.seed);
   generate_next_figure(game);
+  mark_dirty_rows(game, 0, FIELD_TOTAL_HEIGHT);
 }
 
-/// @brief Acquire resources for game field and figures
+/// @brief Prepare an empty game. The game holds no resources, the field and
+/// the figures are stored inline
 /// @param game ptr where to save the game
-/// @return true on malloc error
+/// @return true if there is no game
 bool backend_init_game(tetris_game_t *game) {
   if (!game) return true;
-  bool error = false;
-  game->game.field = calloc_matrix(FIELD_TOTAL_HEIGHT, FIELD_WIDTH);
-  error = game->game.field == NULL;
-  if (!error) {
-    game->game.next = calloc_matrix(MAX_FIGURE_SIZE, MAX_FIGURE_SIZE);
-    error = game->game.next == NULL;
-  }
-  if (!error) {
-    game->current_figure.mask = calloc_matrix(MAX_FIGURE_SIZE, MAX_FIGURE_SIZE);
-    error = game->current_figure.mask == NULL;
-  }
-  if (!error) {
-    load_high_score(game);
-  }
-  if (error) {
-    backend_destroy_game(game);
-  }
-  return error;
+  memset(game->game.field, 0, sizeof(game->game.field));
+  memset(game->game.next, 0, sizeof(game->game.next));
+  game->current_figure.id = NO_FIGURE;
+  game->next_figure_id = NO_FIGURE;
+  game->board = BOARD_STANDARD;
+  memset(game->occupancy, 0, sizeof(game->occupancy));
+  game->game.high_score = high_score_get();
+  mark_dirty_rows(game, 0, FIELD_TOTAL_HEIGHT);
+  return false;
 }
 
 #define spawn_position_r FIELD_UPPER_MARGIN - 1
 #define spawn_position_c FIELD_WIDTH / 2 - MAX_FIGURE_SIZE / 2
-/// @brief Locks the current figure, places the next figure on the field
+void paint_figure(tetris_game_t *const game, const figure_t *figure,
+                  const int value);
+bool check_figure_collision(const tetris_game_t *const game,
+                            const figure_t *figure);
+
+/// @brief Get the figure as it appears on the standard field
+/// @param id figure id
+/// @param figure where to save the figure
+void backend_get_spawned_figure(const int id, figure_t *figure) {
+  figure->id = id;
+  figure->rotation = 0;
+  figure->position.r = spawn_position_r;
+  figure->position.c = spawn_position_c;
+}
+
+/// @brief Locks the current figure, places the next figure on the board of
+/// the game
 /// @param game ptr to current game
 /// @return true if there was a collision of the new figure with anything
 bool swap_current_to_next_figure(tetris_game_t *game) {
   if (!game) return false;
-  bool collision = false;
-  for (int i = 0; i != MAX_FIGURE_SIZE; ++i) {
-    for (int j = 0; j != MAX_FIGURE_SIZE; ++j) {
-      const int field_value =
-          game->game.field[spawn_position_r + i][spawn_position_c + j];
-      const int mask_value = game->game.next[i][j];
-      if (field_value && mask_value) {
-        collision = true;
-      }
-      if (mask_value) {
-        game->game.field[spawn_position_r + i][spawn_position_c + j] =
-            mask_value;
-      }
-      game->current_figure.mask[i][j] = mask_value;
-    }
-  }
-  game->current_figure.position.r = spawn_position_r;
-  game->current_figure.position.c = spawn_position_c;
+  backend_lock_current_figure(game);
+  const board_variant_t *board = board_get_variant(game->board);
+  backend_get_spawned_figure(game->next_figure_id, &game->current_figure);
+  game->current_figure.position.r += board->top;
+  game->current_figure.position.c = board->spawn_c;
+  const bool collision = check_figure_collision(game, &game->current_figure);
+  paint_figure(game, &game->current_figure,
+               get_figure_colour(game->current_figure.id));
   return collision;
 }
 
-/// @brief Free game resources
+/// @brief Release the game. Nothing is allocated by the game, the function is
+/// kept as the pair of backend_init_game()
 /// @param game ptr to the game
-void backend_destroy_game(tetris_game_t *game) {
-  if (!game) return;
-  if (game->game.field) {
-    free_matrix(game->game.field);
-    game->game.field = NULL;
-  }
-  if (game->game.next) {
-    free_matrix(game->game.next);
-    game->game.next = NULL;
-  }
-  if (game->current_figure.mask) {
-    free_matrix(game->current_figure.mask);
-    game->current_figure.mask = NULL;
-  }
+void backend_destroy_game(tetris_game_t *game) { (void)game; }
+
+/// @brief Set the parameters the next game is set up with
+/// @param game the game
+/// @param setup the parameters
+void backend_configure_game(tetris_game_t *game, const tetris_setup_t *setup) {
+  if (!game || !setup) return;
+  game->setup = *setup;
 }
 
 /// @brief Place a random figure in the 'next figure' matrix
@@ -108,39 +108,51 @@ void backend_destroy_game(tetris_game_t *game) {
 /// @return new figure id
 int generate_next_figure(tetris_game_t *game) {
   if (!game) return 0;
-  const int next_figure_id = rand() % (ALLOWED_FIGURES_COUNT);
+  const int next_figure_id = randomizer_next(&game->randomizer);
   fill_figure_by_id(game->game.next, next_figure_id);
+  game->next_figure_id = next_figure_id;
+  ++game->generation;
   return next_figure_id;
 }
 
 void plus_score(tetris_game_t *game, const int cutted_rows_count);
+void shift_down_field_rows(tetris_game_t *game, const int last_shift_row,
+                           const int shift_steps);
 
 /// @brief Remove rows that are full, shifting down the upper rows. Updates user
 /// score
 /// @param game current game
 void backend_cut_filled_rows(tetris_game_t *game) {
   if (!game) return;
-  int pivot = FIELD_UPPER_MARGIN;
-  while (pivot != FIELD_TOTAL_HEIGHT) {
-    while (pivot < FIELD_TOTAL_HEIGHT &&
-           !get_is_a_filled_row((const int **)(game->game.field), pivot,
-                                FIELD_WIDTH)) {
-      ++pivot;
-    }
-    int filled_rows_count = 0;
-    while (pivot + filled_rows_count < FIELD_TOTAL_HEIGHT &&
-           get_is_a_filled_row((const int **)(game->game.field),
-                               pivot + filled_rows_count, FIELD_WIDTH)) {
-      ++filled_rows_count;
-    }
-    if (filled_rows_count) {
-      shift_down_rows(game->game.field, pivot + filled_rows_count - 1,
-                      filled_rows_count, FIELD_WIDTH);
-      plus_score(game, filled_rows_count);
-    }
+  uint32_t filled =
+      board_get_variant(game->board)->get_filled_rows(game->occupancy);
+  // the rows below a cut keep their places, so the mask holds for them
+  while (filled) {
+    const int pivot = __builtin_ctz(filled);
+    const int filled_rows_count = __builtin_ctz(~(filled >> pivot));
+    shift_down_field_rows(game, pivot + filled_rows_count - 1,
+                          filled_rows_count);
+    bitboard_shift_down_rows(game->occupancy, pivot + filled_rows_count - 1,
+                             filled_rows_count);
+    // every row above the cut ones is shifted
+    mark_dirty_rows(game, 0, pivot + filled_rows_count);
+    plus_score(game, filled_rows_count);
+    filled &= ~(((1u << filled_rows_count) - 1) << pivot);
   }
 }
 
+/// @brief Shift the field rows above last_shift_row down, the top rows are
+/// cleared. The rows are contiguous, so that is a single move
+/// @param game current game
+/// @param last_shift_row the lowest row to be overwritten
+/// @param shift_steps number of rows to shift by
+void shift_down_field_rows(tetris_game_t *game, const int last_shift_row,
+                           const int shift_steps) {
+  memmove(game->game.field[shift_steps], game->game.field[0],
+          sizeof(game->game.field[0]) * (last_shift_row + 1 - shift_steps));
+  memset(game->game.field[0], 0, sizeof(game->game.field[0]) * shift_steps);
+}
+
 /// @brief Updates user score depending on the ammount of full rows that were
 /// delete
 /// @param game current game
@@ -165,9 +177,10 @@ void plus_score(tetris_game_t *game, const int cutted_rows_count) {
       break;
   }
   game->game.score += score_delta;
+  game->game.lines += cutted_rows_count;
   game->game.level = game->game.score / 600;
   if (score_delta && game->game.score > game->game.high_score) {
-    save_high_score(game);
+    high_score_offer(game->game.score);
   }
   if (game->game.level > 10) {
     game->game.level = 10;
@@ -175,48 +188,42 @@ void plus_score(tetris_game_t *game, const int cutted_rows_count) {
 }
 
 void edit_current_figure(tetris_game_t *game, const figure_t *new_figure);
-bool check_new_old_figure_exclusive_collision(const tetris_game_t *const game,
-                                              const figure_t *edited_figure);
-bool check_walls_collision(const figure_t *);
 
 /// @brief Shift down one step the current figure with collision
 /// @param game current game
 /// @return false if the shift was successful, meaning there was no collision
 bool backend_drop_current_figure(tetris_game_t *game) {
   if (!game) return true;
-  figure_t edited = {0};
-  edited.mask = calloc_matrix(MAX_FIGURE_SIZE, MAX_FIGURE_SIZE);
-  memcpy(edited.mask[0], game->current_figure.mask[0],
-         sizeof(int) * MAX_FIGURE_SIZE * MAX_FIGURE_SIZE);
-  edited.position.r = game->current_figure.position.r + 1;
-  edited.position.c = game->current_figure.position.c;
-  const bool collision =
-      check_new_old_figure_exclusive_collision(game, &edited) ||
-      check_walls_collision(&edited);
+  figure_t edited = game->current_figure;
+  edited.position.r += 1;
+  const bool collision = check_figure_collision(game, &edited);
   if (!collision) {
     edit_current_figure(game, &edited);
   }
-  free_matrix(edited.mask);
   return collision;
 }
 
-/// @brief Check if the full cells of the figure mask are out of bounds
-/// @param fig figure to check
-/// @return false if the figure is inside the field bounds
-bool check_walls_collision(const figure_t *fig) {
-  bool collision = false;
-  for (int r = 0; !collision && r != MAX_FIGURE_SIZE; ++r) {
-    for (int c = 0; !collision && c != MAX_FIGURE_SIZE; ++c) {
-      const int mask_value = fig->mask[r][c];
-      if (mask_value) {
-        const int absolute_r = r + fig->position.r;
-        const int absolute_c = c + fig->position.c;
-        collision = absolute_r < 0 || absolute_r >= FIELD_TOTAL_HEIGHT ||
-                    absolute_c < 0 || absolute_c >= FIELD_WIDTH;
+/// @brief Set the field cells covered by the figure to the value. The cells
+/// out of the field bounds are ignored
+/// @param game current game
+/// @param figure the figure
+/// @param value value to set
+void paint_figure(tetris_game_t *const game, const figure_t *figure,
+                  const int value) {
+  const figure_shape_t *shape = get_figure_shape(figure->id, figure->rotation);
+  if (!shape) return;
+  mark_dirty_rows(game, figure->position.r + shape->top, shape->height);
+  for (int i = shape->top; i != shape->top + shape->height; ++i) {
+    const int absolute_r = i + figure->position.r;
+    if (absolute_r < 0 || absolute_r >= FIELD_TOTAL_HEIGHT) continue;
+    for (int j = shape->left; j != shape->left + shape->width; ++j) {
+      const int absolute_c = j + figure->position.c;
+      if ((shape->rows[i] >> j) & 1u && absolute_c >= 0 &&
+          absolute_c < FIELD_WIDTH) {
+        game->game.field[absolute_r][absolute_c] = value;
       }
     }
   }
-  return collision;
 }
 
 /// @brief Remove from the field the old figure, replace it with the new one. No
@@ -226,82 +233,24 @@ bool check_walls_collision(const figure_t *fig) {
 void edit_current_figure(tetris_game_t *const game,
                          const figure_t *edited_figure) {
   if (!game) return;
-  // remove old figure from the field
-  for (int r = 0; r != MAX_FIGURE_SIZE; ++r) {
-    for (int c = 0; c != MAX_FIGURE_SIZE; ++c) {
-      const int absolute_r = r + game->current_figure.position.r;
-      const int absolute_c = c + game->current_figure.position.c;
-      const int mask_value = game->current_figure.mask[r][c];
-      if (absolute_c >= 0 && absolute_c < FIELD_WIDTH && absolute_r >= 0 &&
-          absolute_r < FIELD_TOTAL_HEIGHT && mask_value) {
-        game->game.field[absolute_r][absolute_c] = 0;
-      }
-    }
-  }
-  // place new figure
-  for (int r = 0; r != MAX_FIGURE_SIZE; ++r) {
-    for (int c = 0; c != MAX_FIGURE_SIZE; ++c) {
-      const int absolute_r = r + edited_figure->position.r;
-      const int absolute_c = c + edited_figure->position.c;
-      const int mask_value = edited_figure->mask[r][c];
-      if (absolute_c >= 0 && absolute_c < FIELD_WIDTH && absolute_r >= 0 &&
-          absolute_r < FIELD_TOTAL_HEIGHT && mask_value) {
-        game->game.field[absolute_r][absolute_c] = mask_value;
-      }
-      game->current_figure.mask[r][c] = edited_figure->mask[r][c];
-    }
-  }
-  game->current_figure.position.r = edited_figure->position.r;
-  game->current_figure.position.c = edited_figure->position.c;
+  paint_figure(game, &game->current_figure, 0);
+  paint_figure(game, edited_figure, get_figure_colour(edited_figure->id));
+  game->current_figure = *edited_figure;
 }
 
-int get_field_value_no_current_figure(const tetris_game_t *const game,
-                                      const int r, const int c);
-
-/// @brief Check if the new figure collides with any full cells of the field
-/// without the current figure
+/// @brief Check if the figure collides with the locked cells or the board
+/// bounds. The current figure is not a part of the occupancy bitboard, so it
+/// never collides with its own new position
 /// @param game curernt game
-/// @param new_figure new figure
+/// @param figure the figure to check
 /// @return false if no collision
-bool check_new_old_figure_exclusive_collision(const tetris_game_t *const game,
-                                              const figure_t *new_figure) {
-  bool collision = false;
-  for (int new_r = 0; !collision && new_r != MAX_FIGURE_SIZE; ++new_r) {
-    for (int new_c = 0; !collision && new_c != MAX_FIGURE_SIZE; ++new_c) {
-      const int absolute_new_r = new_r + new_figure->position.r;
-      const int absolute_new_c = new_c + new_figure->position.c;
-      const int new_field_value = new_figure->mask[new_r][new_c];
-      const int field_value_no_old = get_field_value_no_current_figure(
-          game, absolute_new_r, absolute_new_c);
-      if (new_field_value &&
-          (absolute_new_c < 0 || absolute_new_c >= FIELD_WIDTH ||
-           absolute_new_r < 0 || absolute_new_r >= FIELD_TOTAL_HEIGHT)) {
-        collision = true;
-      } else if (new_field_value && field_value_no_old) {
-        collision = true;
-      }
-    }
-  }
-  return collision;
-}
-
-/// @brief Get value of a cell in the field without the current figure
-/// @param game current game
-/// @param r cell row
-/// @param c cell column
-/// @return cell value
-int get_field_value_no_current_figure(const tetris_game_t *const game,
-                                      const int r, const int c) {
-  if (!game || r < 0 || r >= FIELD_TOTAL_HEIGHT || c < 0 || c >= FIELD_WIDTH)
-    return 0;
-  int field_value = game->game.field[r][c];
-  const int inside_mask_r = r - game->current_figure.position.r;
-  const int inside_mask_c = c - game->current_figure.position.c;
-  if (inside_mask_r >= 0 && inside_mask_r < MAX_FIGURE_SIZE &&
-      inside_mask_c >= 0 && inside_mask_c < MAX_FIGURE_SIZE) {
-    field_value -= game->current_figure.mask[inside_mask_r][inside_mask_c];
-  }
-  return field_value;
+bool check_figure_collision(const tetris_game_t *const game,
+                            const figure_t *figure) {
+  const figure_shape_t *shape = get_figure_shape(figure->id, figure->rotation);
+  if (!shape) return true;
+  return board_get_variant(game->board)
+      ->get_collision(game->occupancy, shape->rows, figure->position.r,
+                      figure->position.c);
 }
 
 /// @brief Lock the current figure, place the next figure on the field making it
@@ -318,29 +267,26 @@ bool backend_spawn_new_figure(tetris_game_t *const game) {
   return collision;
 }
 
-/// @brief Replace the current figure with its rotated version, if the operation
-/// is possible = there will be no collision
+/// @brief Replace the current figure with its clockwise rotated version. The
+/// kick offsets of the figure are tried in order, the first one without a
+/// collision is taken. Nothing is changed if all of them collide
 /// @param game current game
 void backend_rotate_current_figure(tetris_game_t *const game) {
   if (!game) return;
-  figure_t edited = {0};
-  edited.mask = calloc_matrix(MAX_FIGURE_SIZE, MAX_FIGURE_SIZE);
-  for (int old_r = 0; old_r != MAX_FIGURE_SIZE; ++old_r) {
-    for (int old_c = 0; old_c != MAX_FIGURE_SIZE; ++old_c) {
-      const int new_r = old_c;
-      const int new_c = MAX_FIGURE_SIZE - old_r - 1;
-      edited.mask[new_r][new_c] = game->current_figure.mask[old_r][old_c];
+  int kicks_count = 0;
+  const figure_kick_t *kicks = get_figure_kicks(
+      game->current_figure.id, game->current_figure.rotation, &kicks_count);
+  bool rotated = false;
+  for (int i = 0; !rotated && i < kicks_count; ++i) {
+    figure_t edited = game->current_figure;
+    edited.rotation = (edited.rotation + 1) % FIGURE_ROTATIONS_COUNT;
+    edited.position.r += kicks[i].r;
+    edited.position.c += kicks[i].c;
+    if (!check_figure_collision(game, &edited)) {
+      edit_current_figure(game, &edited);
+      rotated = true;
     }
   }
-  edited.position.r = game->current_figure.position.r;
-  edited.position.c = game->current_figure.position.c;
-  const bool collision =
-      check_new_old_figure_exclusive_collision(game, &edited);
-  if (!collision) {
-    edit_current_figure(game, &edited);
-  }
-  free_matrix(edited.mask);
-  return;
 }
 
 /// @brief Replace the current figure with its moved left version, if the
@@ -348,19 +294,11 @@ void backend_rotate_current_figure(tetris_game_t *const game) {
 /// @param game current game
 void backend_move_left_current_figure(tetris_game_t *const game) {
   if (!game) return;
-  figure_t edited = {0};
-  edited.mask = calloc_matrix(MAX_FIGURE_SIZE, MAX_FIGURE_SIZE);
-  memcpy(edited.mask[0], game->current_figure.mask[0],
-         sizeof(int) * MAX_FIGURE_SIZE * MAX_FIGURE_SIZE);
-  edited.position.r = game->current_figure.position.r;
-  edited.position.c = game->current_figure.position.c - 1;
-  const bool collision =
-      check_new_old_figure_exclusive_collision(game, &edited);
-  if (!collision) {
+  figure_t edited = game->current_figure;
+  edited.position.c -= 1;
+  if (!check_figure_collision(game, &edited)) {
     edit_current_figure(game, &edited);
   }
-  free_matrix(edited.mask);
-  return;
 }
 
 /// @brief Replace the current figure with its moved right version, if the
@@ -368,56 +306,120 @@ void backend_move_left_current_figure(tetris_game_t *const game) {
 /// @param game current game
 void backend_move_right_current_figure(tetris_game_t *const game) {
   if (!game) return;
-  figure_t edited = {0};
-  edited.mask = calloc_matrix(MAX_FIGURE_SIZE, MAX_FIGURE_SIZE);
-  memcpy(edited.mask[0], game->current_figure.mask[0],
-         sizeof(int) * MAX_FIGURE_SIZE * MAX_FIGURE_SIZE);
-  edited.position.r = game->current_figure.position.r;
-  edited.position.c = game->current_figure.position.c + 1;
-  const bool collision =
-      check_new_old_figure_exclusive_collision(game, &edited);
-  if (!collision) {
+  figure_t edited = game->current_figure;
+  edited.position.c += 1;
+  if (!check_figure_collision(game, &edited)) {
     edit_current_figure(game, &edited);
   }
-  free_matrix(edited.mask);
-  return;
 }
 
-/// @brief check if any of the filled cells are outside of the visible field
+/// @brief check if any of the filled cells are outside of the visible board
 /// @param game current game
 /// @return false if no cells are outside
 bool backend_get_overflow(const tetris_game_t *const game) {
   if (!game) return false;
-  bool overflow = false;
-  for (int r = 0; !overflow && r < FIELD_UPPER_MARGIN; ++r) {
-    for (int c = 0; !overflow && c < FIELD_WIDTH; ++c) {
-      if (game->game.field[r][c]) {
-        overflow = true;
-      }
-    }
+  return board_get_variant(game->board)->get_overflow(game->occupancy);
+}
+
+/// @brief Mark the cells of the current figure as occupied. The figure stays
+/// on the field, but is no longer the current one
+/// @param game current game
+void backend_lock_current_figure(tetris_game_t *const game) {
+  if (!game) return;
+  const figure_t *figure = &game->current_figure;
+  const figure_shape_t *shape = get_figure_shape(figure->id, figure->rotation);
+  if (!shape) return;
+  board_get_variant(game->board)
+      ->place_rows(game->occupancy, shape->rows, figure->position.r,
+                   figure->position.c);
+  game->current_figure.id = NO_FIGURE;
+}
+
+/// @brief Rebuild the occupancy bitboard from the field. Every nonzero cell
+/// that is not covered by the current figure is occupied. Required after the
+/// field was edited directly
+/// @param game current game
+void backend_sync_occupancy(tetris_game_t *const game) {
+  if (!game) return;
+  bitboard_from_matrix(game->occupancy, game->game.field[0],
+                       FIELD_TOTAL_HEIGHT, FIELD_WIDTH);
+  mark_dirty_rows(game, 0, FIELD_TOTAL_HEIGHT);
+  const figure_t *figure = &game->current_figure;
+  const figure_shape_t *shape = get_figure_shape(figure->id, figure->rotation);
+  if (!shape) return;
+  row_mask_t figure_board[FIELD_TOTAL_HEIGHT] = {0};
+  bitboard_place_rows(figure_board, FIELD_TOTAL_HEIGHT, shape->rows,
+                      MAX_FIGURE_SIZE, figure->position.r, figure->position.c);
+  for (int r = 0; r != FIELD_TOTAL_HEIGHT; ++r) {
+    game->occupancy[r] &= (row_mask_t)~figure_board[r];
   }
-  return overflow;
 }
 
-/// @brief load high score from the SAVE_FILE_PATH file
+/// @brief Mark the field rows as changed and count the change. The rows out
+/// of the field bounds are ignored
 /// @param game current game
-void load_high_score(tetris_game_t *game) {
-  FILE *high_score_f = fopen(SAVE_FILE_PATH, "r");
-  if (high_score_f) {
-    int high_score = 0;
-    if (fscanf(high_score_f, "%d", &high_score)) {
-      game->game.high_score = high_score;
-    }
-    fclose(high_score_f);
+/// @param first_row first changed row
+/// @param rows_count number of changed rows
+void mark_dirty_rows(tetris_game_t *game, int first_row, int rows_count) {
+  if (first_row < 0) {
+    rows_count += first_row;
+    first_row = 0;
+  }
+  if (first_row + rows_count > FIELD_TOTAL_HEIGHT) {
+    rows_count = FIELD_TOTAL_HEIGHT - first_row;
+  }
+  if (rows_count > 0) {
+    const dirty_rows_t rows =
+        (dirty_rows_t)((1ull << rows_count) - 1) << first_row;
+    game->dirty_rows |= rows;
+  }
+  ++game->generation;
+}
+
+/// @brief Get the field rows changed since the previous call, for the
+/// renderer to redraw only them
+/// @param game current game
+/// @return mask with the bit r set if the row r changed
+dirty_rows_t backend_take_dirty_rows(tetris_game_t *const game) {
+  if (!game) return 0;
+  const dirty_rows_t rows = game->dirty_rows;
+  game->dirty_rows = 0;
+  return rows;
+}
+
+/// @brief Build the GameInfo_t view of the game for the gui. The view points
+/// into the game, it is valid while the game and the view rows live
+/// @param game current game
+/// @param view where to save the row pointers
+/// @return the view
+GameInfo_t backend_get_game_info(tetris_game_t *const game,
+                                 tetris_game_view_t *view) {
+  for (int r = 0; r != FIELD_TOTAL_HEIGHT; ++r) {
+    view->field[r] = game->game.field[r];
+  }
+  for (int r = 0; r != MAX_FIGURE_SIZE; ++r) {
+    view->next[r] = game->game.next[r];
   }
+  GameInfo_t info;
+  info.field = view->field;
+  info.next = view->next;
+  info.score = game->game.score;
+  info.high_score = game->game.high_score;
+  info.level = game->game.level;
+  info.speed = game->game.speed;
+  info.pause = game->game.pause;
+  return info;
 }
 
-/// @brief save the high score to the SAVE_FILE_PATH file
+/// @brief Hash the locked cells of the field, for the replays to check that
+/// they end on the recorded board
 /// @param game current game
-void save_high_score(tetris_game_t *game) {
-  FILE *high_score_f = fopen(SAVE_FILE_PATH, "w");
-  if (high_score_f) {
-    fprintf(high_score_f, "%d", game->game.score);
-    fclose(high_score_f);
+/// @return FNV-1a hash of the occupancy bitboard
+uint64_t backend_get_board_hash(const tetris_game_t *const game) {
+  uint64_t hash = 0xcbf29ce484222325ull;
+  for (int r = 0; r != FIELD_TOTAL_HEIGHT; ++r) {
+    hash = (hash ^ (game->occupancy[r] & 0xFFu)) * 0x100000001b3ull;
+    hash = (hash ^ (game->occupancy[r] >> 8)) * 0x100000001b3ull;
   }
+  return hash;
 }
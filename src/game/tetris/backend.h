@@ -5,25 +5,79 @@
 /// @brief Declaration of functions to move figures
 
 #include <stdbool.h>
+#include <stdint.h>
 
+#include "bitboard.h"
+#include "board.h"
+#include "defines.h"
 #include "lib.h"
+#include "randomizer.h"
 
 typedef struct {
   int r;
   int c;
 } coords_t;
 
+/// @brief Figure on the field. id and rotation index the figure tables,
+/// position is the field cell of the figure box top left corner
 typedef struct {
-  int **mask;
+  int id;
+  int rotation;
   coords_t position;
 } figure_t;
 
+/// @brief Parameters of the next game set up. The seed is advanced on every
+/// set up, so consecutive games of a session differ, yet are reproducible
 typedef struct {
-  GameInfo_t game;
+  uint64_t seed;
+  randomizer_kind_t randomizer;
+  board_kind_t board;
+} tetris_setup_t;
+
+typedef uint32_t dirty_rows_t;
+_Static_assert(FIELD_TOTAL_HEIGHT <= 32, "a field row has no dirty bit");
+
+/// @brief The data of GameInfo_t stored inline and the number of the cut
+/// rows. field is the colour plane used for rendering, it contains the current
+/// figure
+typedef struct {
+  int field[FIELD_TOTAL_HEIGHT][FIELD_WIDTH];
+  int next[MAX_FIGURE_SIZE][MAX_FIGURE_SIZE];
+  int score;
+  int high_score;
+  int level;
+  int lines;
+  int speed;
+  int pause;
+} tetris_game_info_t;
+
+/// @brief Row pointers of a GameInfo_t view of a game
+typedef struct {
+  int *field[FIELD_TOTAL_HEIGHT];
+  int *next[MAX_FIGURE_SIZE];
+} tetris_game_view_t;
+
+/// @brief The game is a POD of a fixed size without pointers, it is copied by
+/// assignment or memcpy. occupancy contains the locked cells only and is used
+/// for the collision and filled rows control. dirty_rows has a bit set for
+/// every game.field row changed since the renderer took the mask, generation
+/// counts the changes of anything drawn: the field, the next figure and the
+/// stats. board is the board kind of the game being played
+typedef struct {
+  tetris_game_info_t game;
   figure_t current_figure;
+  int next_figure_id;
+  board_kind_t board;
+  tetris_setup_t setup;
+  uint64_t game_seed;
+  randomizer_t randomizer;
+  row_mask_t occupancy[FIELD_TOTAL_HEIGHT];
+  dirty_rows_t dirty_rows;
+  unsigned long generation;
 } tetris_game_t;
 
 bool backend_init_game(tetris_game_t *);
+void backend_configure_game(tetris_game_t *, const tetris_setup_t *);
 void backend_destroy_game(tetris_game_t *);
 
 void backend_setup_new_game(tetris_game_t *);
@@ -34,5 +88,11 @@ void backend_rotate_current_figure(tetris_game_t *);
 void backend_move_left_current_figure(tetris_game_t *);
 void backend_move_right_current_figure(tetris_game_t *);
 bool backend_get_overflow(const tetris_game_t *);
+void backend_lock_current_figure(tetris_game_t *);
+void backend_sync_occupancy(tetris_game_t *);
+dirty_rows_t backend_take_dirty_rows(tetris_game_t *);
+void backend_get_spawned_figure(const int id, figure_t *);
+GameInfo_t backend_get_game_info(tetris_game_t *, tetris_game_view_t *);
+uint64_t backend_get_board_hash(const tetris_game_t *);
 
 #endif
@@ -0,0 +1,88 @@
+#include "bitboard.h"
+
+/// @file bitboard.c
+/// @brief Implementation of methods to operate with occupancy bitboards
+
+#include <string.h>
+
+/// @brief shift a figure row mask to the column c of the board
+/// @param row the row mask, bit 0 is the leftmost column of the figure
+/// @param c column of the figure on the board, may be negative
+/// @param shifted where to save the shifted mask
+/// @return true if any of the filled cells is out of the board bounds
+bool shift_row_to_column(const row_mask_t row, const int c,
+                         uint32_t *shifted) {
+  bool out_of_bounds = false;
+  uint32_t mask = row;
+  if (c < 0) {
+    out_of_bounds = (mask & ((1u << -c) - 1)) != 0;
+    mask >>= -c;
+  } else {
+    mask <<= c;
+  }
+  *shifted = mask;
+  return out_of_bounds || (mask & ~(uint32_t)FULL_ROW_MASK) != 0;
+}
+
+/// @brief tells if all the cells of a row are occupied
+/// @param board the bitboard
+/// @param row the row to check
+/// @return true if the row is full
+bool bitboard_get_is_a_filled_row(const row_mask_t *board, const int row) {
+  return board[row] == FULL_ROW_MASK;
+}
+
+/// @brief mark the cells of the figure rows placed at (r, c) as occupied. The
+/// cells out of the board bounds are ignored
+/// @param board the bitboard
+/// @param board_height number of rows in the board
+/// @param rows figure row masks
+/// @param rows_count number of figure rows
+/// @param r board row of the first figure row
+/// @param c board column of the figure bit 0
+void bitboard_place_rows(row_mask_t *board, const int board_height,
+                         const row_mask_t *rows, const int rows_count,
+                         const int r, const int c) {
+  for (int i = 0; i != rows_count; ++i) {
+    const int absolute_r = r + i;
+    if (rows[i] && absolute_r >= 0 && absolute_r < board_height) {
+      uint32_t shifted = 0;
+      shift_row_to_column(rows[i], c, &shifted);
+      board[absolute_r] |= (row_mask_t)(shifted & FULL_ROW_MASK);
+    }
+  }
+}
+
+/// @brief shift down all the first to last_shift_row rows. (last_shift_row -
+/// shift_steps) rows are deleted. new rows are empty
+/// @param board the bitboard
+/// @param last_shift_row last row in the shift pool
+/// @param shift_steps how far the rows are shifted
+void bitboard_shift_down_rows(row_mask_t *board, const int last_shift_row,
+                              const int shift_steps) {
+  if (!board || last_shift_row < 0 || shift_steps < 0) return;
+  if (shift_steps > last_shift_row) {
+    memset(board, 0, sizeof(row_mask_t) * (last_shift_row + 1));
+    return;
+  }
+  memmove(board + shift_steps, board,
+          sizeof(row_mask_t) * (last_shift_row + 1 - shift_steps));
+  memset(board, 0, sizeof(row_mask_t) * shift_steps);
+}
+
+/// @brief build the bitboard of the nonzero cells of a matrix
+/// @param board where to save the bitboard, r rows
+/// @param matrix the matrix cells, row by row
+/// @param r matrix rows count
+/// @param c matrix columns count
+void bitboard_from_matrix(row_mask_t *board, const int *matrix, const int r,
+                          const int c) {
+  if (!board || !matrix) return;
+  for (int i = 0; i != r; ++i) {
+    row_mask_t row = 0;
+    for (int j = 0; j != c; ++j) {
+      if (matrix[i * c + j]) row |= (row_mask_t)(1u << j);
+    }
+    board[i] = row;
+  }
+}
@@ -0,0 +1,28 @@
+#ifndef TETRIS_BITBOARD
+#define TETRIS_BITBOARD
+
+/// @file bitboard.h
+/// @brief Declaration of methods to operate with occupancy bitboards. A
+/// bitboard is an array of row masks, bit c of a row is set if the cell in
+/// column c is occupied. The collisions are checked by the kernels of the
+/// board variants, see board.h
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "defines.h"
+
+typedef uint16_t row_mask_t;
+
+#define FULL_ROW_MASK ((row_mask_t)((1u << FIELD_WIDTH) - 1))
+
+bool bitboard_get_is_a_filled_row(const row_mask_t *board, const int row);
+void bitboard_place_rows(row_mask_t *board, const int board_height,
+                         const row_mask_t *rows, const int rows_count,
+                         const int r, const int c);
+void bitboard_shift_down_rows(row_mask_t *board, const int last_shift_row,
+                              const int shift_steps);
+void bitboard_from_matrix(row_mask_t *board, const int *matrix, const int r,
+                          const int c);
+
+#endif
@@ -0,0 +1,47 @@
+#include "board.h"
+
+/// @file board.c
+/// @brief Implementation of the board variants and their selector
+
+#include <string.h>
+
+#define BOARD_VARIANT standard
+#define BOARD_WIDTH FIELD_WIDTH
+#define BOARD_VISIBLE_HEIGHT FIELD_VISIBLE_HEIGHT
+#include "board_variant.h"
+
+#define BOARD_VARIANT mini
+#define BOARD_WIDTH BOARD_MINI_WIDTH
+#define BOARD_VISIBLE_HEIGHT BOARD_MINI_VISIBLE_HEIGHT
+#include "board_variant.h"
+
+#define BOARD_VARIANT training
+#define BOARD_WIDTH BOARD_TRAINING_WIDTH
+#define BOARD_VISIBLE_HEIGHT BOARD_TRAINING_VISIBLE_HEIGHT
+#include "board_variant.h"
+
+static const board_variant_t *const board_variants[BOARD_KINDS_COUNT] = {
+    &board_variant_standard, &board_variant_mini, &board_variant_training};
+
+/// @brief get the variant of the board kind
+/// @param kind the board kind
+/// @return the variant, the standard one for an unknown kind
+const board_variant_t *board_get_variant(const board_kind_t kind) {
+  return (unsigned)kind < BOARD_KINDS_COUNT ? board_variants[kind]
+                                            : &board_variant_standard;
+}
+
+/// @brief translate a board name
+/// @param name standard, mini or training
+/// @param kind where to save the board kind
+/// @return true if the name is unknown
+bool board_parse_kind(const char *name, board_kind_t *kind) {
+  bool error = true;
+  for (int i = 0; error && i != BOARD_KINDS_COUNT; ++i) {
+    if (!strcmp(name, board_variants[i]->name)) {
+      *kind = (board_kind_t)i;
+      error = false;
+    }
+  }
+  return error;
+}
@@ -0,0 +1,53 @@
+#ifndef TETRIS_BOARD
+#define TETRIS_BOARD
+
+/// @file board.h
+/// @brief Declaration of the board variants. Every variant has its own
+/// kernels for the collision, the lock, the filled rows and the overflow,
+/// instantiated from board_variant.h with the board dimensions as constants,
+/// so their loops have constant bounds. A game picks its variant with the
+/// board kind of its setup, so games of different boards run in one process.
+/// The storage of a game is the one of the standard board, a smaller board
+/// takes its bottom left corner and the rest of the field stays empty, so the
+/// field is drawn and sent the same way for every board
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "bitboard.h"
+#include "defines.h"
+
+#define BOARD_MINI_WIDTH 6
+#define BOARD_MINI_VISIBLE_HEIGHT 12
+#define BOARD_TRAINING_WIDTH 4
+#define BOARD_TRAINING_VISIBLE_HEIGHT 16
+
+typedef enum {
+  BOARD_STANDARD = 0,
+  BOARD_MINI,
+  BOARD_TRAINING,
+  BOARD_KINDS_COUNT
+} board_kind_t;
+
+/// @brief A board variant. top is the first field row of the board with its
+/// upper margin, the board ends at the bottom of the field. The kernels take
+/// the MAX_FIGURE_SIZE rows of a figure shape placed at (r, c), the filled
+/// rows are a mask with the bit r set for the field row r
+typedef struct {
+  const char *name;
+  int width;
+  int visible_height;
+  int top;
+  int spawn_c;
+  bool (*get_collision)(const row_mask_t *board, const row_mask_t *rows,
+                        const int r, const int c);
+  void (*place_rows)(row_mask_t *board, const row_mask_t *rows, const int r,
+                     const int c);
+  uint32_t (*get_filled_rows)(const row_mask_t *board);
+  bool (*get_overflow)(const row_mask_t *board);
+} board_variant_t;
+
+const board_variant_t *board_get_variant(const board_kind_t kind);
+bool board_parse_kind(const char *name, board_kind_t *kind);
+
+#endif
@@ -0,0 +1,109 @@
+/// @file board_variant.h
+/// @brief The kernels of a board variant. Included by board.c once per
+/// variant, with BOARD_VARIANT, BOARD_WIDTH and BOARD_VISIBLE_HEIGHT defined,
+/// it defines board_<kernel>_<BOARD_VARIANT>() and
+/// board_variant_<BOARD_VARIANT> and undefines the parameters. No include
+/// guard on purpose
+
+#define BOARD_JOIN_(name, variant) name##_##variant
+#define BOARD_JOIN(name, variant) BOARD_JOIN_(name, variant)
+#define BOARD_NAME(name) BOARD_JOIN(name, BOARD_VARIANT)
+#define BOARD_STRING_(variant) #variant
+#define BOARD_STRING(variant) BOARD_STRING_(variant)
+#define BOARD_TOP \
+  (FIELD_TOTAL_HEIGHT - BOARD_VISIBLE_HEIGHT - FIELD_UPPER_MARGIN)
+#define BOARD_FULL_ROW ((uint32_t)((1u << BOARD_WIDTH) - 1))
+
+_Static_assert(BOARD_WIDTH >= MAX_FIGURE_SIZE && BOARD_WIDTH <= FIELD_WIDTH,
+               "the board is narrower than a figure or wider than the field");
+_Static_assert(BOARD_VISIBLE_HEIGHT >= MAX_FIGURE_SIZE &&
+                   BOARD_VISIBLE_HEIGHT <= FIELD_VISIBLE_HEIGHT,
+               "the board is lower than a figure or higher than the field");
+
+/// @brief check if the figure rows placed at (r, c) intersect the occupied
+/// cells or the board bounds
+/// @param board the occupancy bitboard, FIELD_TOTAL_HEIGHT rows
+/// @param rows the MAX_FIGURE_SIZE rows of the figure shape
+/// @param r board row of the first figure row
+/// @param c board column of the figure bit 0
+/// @return false if no collision
+bool BOARD_NAME(board_get_collision)(const row_mask_t *board,
+                                     const row_mask_t *rows, const int r,
+                                     const int c) {
+  bool collision = false;
+  for (int i = 0; i != MAX_FIGURE_SIZE; ++i) {
+    const uint32_t row = rows[i];
+    if (!row) continue;
+    const int absolute_r = r + i;
+    const uint32_t shifted = c < 0 ? row >> -c : row << c;
+    collision = collision || absolute_r < BOARD_TOP ||
+                absolute_r >= FIELD_TOTAL_HEIGHT ||
+                (c < 0 && (row & ((1u << -c) - 1))) ||
+                (shifted & ~BOARD_FULL_ROW) || (shifted & board[absolute_r]);
+  }
+  return collision;
+}
+
+/// @brief mark the cells of the figure rows placed at (r, c) as occupied, the
+/// cells out of the board bounds are ignored
+/// @param board the occupancy bitboard, FIELD_TOTAL_HEIGHT rows
+/// @param rows the MAX_FIGURE_SIZE rows of the figure shape
+/// @param r board row of the first figure row
+/// @param c board column of the figure bit 0
+void BOARD_NAME(board_place_rows)(row_mask_t *board, const row_mask_t *rows,
+                                  const int r, const int c) {
+  for (int i = 0; i != MAX_FIGURE_SIZE; ++i) {
+    const int absolute_r = r + i;
+    if (!rows[i] || absolute_r < BOARD_TOP ||
+        absolute_r >= FIELD_TOTAL_HEIGHT) {
+      continue;
+    }
+    const uint32_t shifted = c < 0 ? (uint32_t)rows[i] >> -c
+                                   : (uint32_t)rows[i] << c;
+    board[absolute_r] |= (row_mask_t)(shifted & BOARD_FULL_ROW);
+  }
+}
+
+/// @brief find the visible rows with all the cells occupied
+/// @param board the occupancy bitboard, FIELD_TOTAL_HEIGHT rows
+/// @return mask with the bit r set if the row r is full
+uint32_t BOARD_NAME(board_get_filled_rows)(const row_mask_t *board) {
+  uint32_t filled = 0;
+  for (int r = BOARD_TOP + FIELD_UPPER_MARGIN; r != FIELD_TOTAL_HEIGHT; ++r) {
+    filled |= (uint32_t)(board[r] == BOARD_FULL_ROW) << r;
+  }
+  return filled;
+}
+
+/// @brief check if any of the occupied cells are above the visible board
+/// @param board the occupancy bitboard, FIELD_TOTAL_HEIGHT rows
+/// @return false if no cells are above
+bool BOARD_NAME(board_get_overflow)(const row_mask_t *board) {
+  uint32_t occupied = 0;
+  for (int r = BOARD_TOP; r != BOARD_TOP + FIELD_UPPER_MARGIN; ++r) {
+    occupied |= board[r];
+  }
+  return occupied != 0;
+}
+
+const board_variant_t BOARD_NAME(board_variant) = {
+    BOARD_STRING(BOARD_VARIANT),
+    BOARD_WIDTH,
+    BOARD_VISIBLE_HEIGHT,
+    BOARD_TOP,
+    BOARD_WIDTH / 2 - MAX_FIGURE_SIZE / 2,
+    BOARD_NAME(board_get_collision),
+    BOARD_NAME(board_place_rows),
+    BOARD_NAME(board_get_filled_rows),
+    BOARD_NAME(board_get_overflow)};
+
+#undef BOARD_JOIN_
+#undef BOARD_JOIN
+#undef BOARD_NAME
+#undef BOARD_STRING_
+#undef BOARD_STRING
+#undef BOARD_TOP
+#undef BOARD_FULL_ROW
+#undef BOARD_VARIANT
+#undef BOARD_WIDTH
+#undef BOARD_VISIBLE_HEIGHT
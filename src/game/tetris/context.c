@@ -0,0 +1,370 @@
+#include "context.h"
+
+/// @file context.c
+/// @brief Implementation of methods to operate with the game context
+
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "backend.h"
+#include "defines.h"
+#include "fsm.h"
+
+bool get_is_autoplay_active(const tetris_context_t *context);
+bool handle_autoplay(tetris_context_t *context);
+
+/// @brief allocate a context and initialize its FSM
+/// @return the new context, NULL on malloc error
+tetris_context_t *tetris_context_create(void) {
+  tetris_context_t *context = calloc(1, sizeof(tetris_context_t));
+  if (context) {
+    tetris_context_init(context);
+    if (context->core.state == EXIT) {
+      free(context);
+      context = NULL;
+    }
+  }
+  return context;
+}
+
+/// @brief free the context and all the game resources it holds
+/// @param context context created with tetris_context_create()
+void tetris_context_destroy(tetris_context_t *context) {
+  if (!context) return;
+  backend_destroy_game(&context->core.game);
+  free(context);
+}
+
+/// @brief initialize the FSM of a zeroed context
+/// @param context the context
+void tetris_context_init(tetris_context_t *context) {
+  if (!context) return;
+  fsm_stats_t *previous = NULL;
+  if (context->stats) previous = fsm_stats_bind(context->stats);
+  fsm_apply_input(NO_INPUT, &context->core.state, &context->core.game);
+  if (context->stats) fsm_stats_bind(previous);
+}
+
+/// @brief set the seed and the randomizer the next game is set up with
+/// @param context the context
+/// @param setup the parameters
+void tetris_context_configure(tetris_context_t *context,
+                              const tetris_setup_t *setup) {
+  if (!context) return;
+  backend_configure_game(&context->core.game, setup);
+}
+
+/// @brief replace the time source of the autoshift timer, the timer restarts
+/// @param context the context
+/// @param clock the clock, copied into the context
+void tetris_context_set_clock(tetris_context_t *context,
+                              const game_clock_t *clock) {
+  if (!context || !clock) return;
+  context->core.clock = *clock;
+  context->core.previous_autoshift_ms = 0;
+  context->previous_autoplay_ms = 0;
+}
+
+/// @brief move the manual clock of the context forward
+/// @param context the context
+/// @param ms milliseconds to move by
+void tetris_context_advance_clock_ms(tetris_context_t *context,
+                                     unsigned long ms) {
+  if (!context) return;
+  game_clock_advance_ms(&context->core.clock, ms);
+}
+
+/// @brief record the game to the replay writer, NULL to stop recording. The
+/// writer is not owned by the context
+/// @param context the context
+/// @param recorder the writer
+void tetris_context_set_recorder(tetris_context_t *context,
+                                 replay_writer_t *recorder) {
+  if (!context) return;
+  context->recorder = recorder;
+}
+
+/// @brief play the games with the autoplay, NULL to stop. The autoplay is not
+/// owned by the context
+/// @param context the context
+/// @param autoplay the autoplay
+/// @param move_ms milliseconds between the autoplay moves
+void tetris_context_set_autoplay(tetris_context_t *context,
+                                 autoplay_t *autoplay, unsigned long move_ms) {
+  if (!context) return;
+  autoplay_reset(autoplay);
+  context->autoplay = autoplay;
+  context->autoplay_move_ms = move_ms;
+  context->previous_autoplay_ms = game_clock_get_ms(&context->core.clock);
+}
+
+/// @brief account the FSM transitions and backend calls of the context to the
+/// statistics, NULL to stop. The statistics are not owned by the context and
+/// must not be shared by the contexts of different threads
+/// @param context the context
+/// @param stats the statistics
+void tetris_context_set_stats(tetris_context_t *context, fsm_stats_t *stats) {
+  if (!context) return;
+  context->stats = stats;
+}
+
+/// @brief submit the finished games to the leaderboard, NULL to stop. The
+/// leaderboard is not owned by the context
+/// @param context the context
+/// @param leaderboard the leaderboard
+void tetris_context_set_leaderboard(tetris_context_t *context,
+                                    leaderboard_t *leaderboard) {
+  if (!context) return;
+  context->leaderboard = leaderboard;
+}
+
+/// @brief submit the score of the game to the leaderboard, the game seed is
+/// the replay id
+/// @param context the context
+/// @return true if the score is on the leaderboard
+bool tetris_context_submit_score(tetris_context_t *context) {
+  if (!context || !context->leaderboard) return false;
+  const tetris_game_t *game = &context->core.game;
+  const leaderboard_entry_t entry = {game->game.score, game->game.level,
+                                     game->game.lines, 0,
+                                     (int64_t)time(NULL), game->game_seed};
+  return leaderboard_submit(context->leaderboard, &entry);
+}
+
+/// @brief publish the frames of the game to the spectators, NULL to stop. The
+/// hub is not owned by the context
+/// @param context the context
+/// @param spectators the hub
+void tetris_context_set_spectators(tetris_context_t *context,
+                                   spectator_hub_t *spectators) {
+  if (!context) return;
+  context->spectators = spectators;
+}
+
+/// @brief send what changed in the game to the spectators if there are any
+/// @param context the context
+void tetris_context_publish(tetris_context_t *context) {
+  if (!context || !context->spectators) return;
+  spectator_hub_publish(context->spectators, &context->core.game,
+                        context->core.state);
+}
+
+/// @brief apply a signal to the FSM, recording it if there is a recorder.
+/// A game that is over is submitted to the leaderboard
+/// @param context the context
+/// @param signal the signal
+void tetris_context_apply_signal(tetris_context_t *context,
+                                 fsm_input_t signal) {
+  fsm_stats_t *previous = NULL;
+  if (context->stats) previous = fsm_stats_bind(context->stats);
+  const tetris_state_t state = context->core.state;
+  if (context->recorder) {
+    const unsigned long now_ms = game_clock_get_ms(&context->core.clock);
+    replay_writer_record_signal(context->recorder, now_ms, signal,
+                                context->core.state, &context->core.game);
+    fsm_apply_input(signal, &context->core.state, &context->core.game);
+    replay_writer_record_state(context->recorder, now_ms, context->core.state,
+                               &context->core.game);
+  } else {
+    fsm_apply_input(signal, &context->core.state, &context->core.game);
+  }
+  if (context->stats) fsm_stats_bind(previous);
+  if (state != GAMEOVER && context->core.state == GAMEOVER) {
+    tetris_context_submit_score(context);
+  }
+}
+
+/// @brief save the game play state of the context
+/// @param context the context
+/// @param snapshot where to save the state
+void tetris_context_snapshot(const tetris_context_t *context,
+                             tetris_snapshot_t *snapshot) {
+  memcpy(snapshot, &context->core, sizeof(tetris_snapshot_t));
+}
+
+/// @brief return the context to a saved game play state. The queued input and
+/// the recorder are kept, the whole field is marked to be redrawn. A recorded
+/// game does not replay after a restore, so recording is to be stopped first
+/// @param context the context
+/// @param snapshot the saved state
+void tetris_context_restore(tetris_context_t *context,
+                            const tetris_snapshot_t *snapshot) {
+  const unsigned long generation = context->core.game.generation;
+  memcpy(&context->core, snapshot, sizeof(tetris_snapshot_t));
+  context->core.game.dirty_rows = (dirty_rows_t)~(dirty_rows_t)0;
+  context->core.game.generation = generation + 1;
+}
+
+/// @brief allocate a context that continues the game of another one, with an
+/// empty input queue and no recorder
+/// @param context the context to copy
+/// @return the new context, NULL on malloc error
+tetris_context_t *tetris_context_clone(const tetris_context_t *context) {
+  tetris_context_t *clone = calloc(1, sizeof(tetris_context_t));
+  if (clone) {
+    memcpy(&clone->core, &context->core, sizeof(tetris_snapshot_t));
+  }
+  return clone;
+}
+
+/// @brief queue user input stamped with the context clock. Releases are not
+/// queued, the game reacts to presses only
+/// @param context the context
+/// @param action user input id
+/// @param hold user input value
+void tetris_context_user_input(tetris_context_t *context, UserAction_t action,
+                               bool hold) {
+  if (!context || (int)action < 0 || action >= USERACTIONS_COUNT) return;
+  if (!hold) return;
+  const input_event_t event = {action, hold,
+                               game_clock_get_ms(&context->core.clock)};
+  input_queue_push(&context->input, &event);
+}
+
+/// @brief queue a user input event stamped by the caller
+/// @param context the context
+/// @param event the event
+void tetris_context_push_input_event(tetris_context_t *context,
+                                     const input_event_t *event) {
+  if (!context || !event || (int)event->action < 0 ||
+      event->action >= USERACTIONS_COUNT || !event->hold) {
+    return;
+  }
+  input_queue_push(&context->input, event);
+}
+
+bool tetris_context_get_game_has_finished(const tetris_context_t *context) {
+  return context->core.state == EXIT;
+}
+
+bool tetris_context_get_game_over(const tetris_context_t *context) {
+  return context->core.state == GAMEOVER;
+}
+
+bool tetris_context_get_pause(const tetris_context_t *context) {
+  return context->core.state == PAUSE;
+}
+
+/// @brief get the counter of the game changes, an unchanged value means the
+/// previous frame may be shown again
+/// @param context the context
+/// @return the counter
+unsigned long tetris_context_get_generation(const tetris_context_t *context) {
+  return context->core.game.generation;
+}
+
+/// @brief get the field rows changed since the previous call
+/// @param context the context
+/// @return mask with the bit r set if the field row r changed
+dirty_rows_t tetris_context_take_dirty_rows(tetris_context_t *context) {
+  return backend_take_dirty_rows(&context->core.game);
+}
+
+/// @brief check on the context clock if the autoshift is due, restart the
+/// autoshift timer if it is
+/// @param context the context
+/// @return true if it is time to autoshift
+bool tetris_context_get_is_time_to_autoshift(tetris_context_t *context) {
+  return fsm_is_autoshift_available(context->core.state) &&
+         game_clock_get_is_time_to_operate(
+             &context->core.clock, &context->core.previous_autoshift_ms,
+             get_autoshift_interval_ms(context->core.game.game.level));
+}
+
+/// @brief get how long the context may be left without updates, for a loop
+/// that sleeps until the next input or the next autoshift
+/// @param context the context
+/// @return milliseconds to the autoshift, 0 if the FSM is in an intermediate
+/// state, -1 if only an input changes the state
+long tetris_context_get_ms_to_next_update(const tetris_context_t *context) {
+  long ms = -1;
+  const unsigned long now_ms = game_clock_get_ms(&context->core.clock);
+  if (!fsm_is_waiting_for_input(context->core.state)) {
+    ms = 0;
+  } else if (fsm_is_autoshift_available(context->core.state)) {
+    const unsigned long passed = now_ms - context->core.previous_autoshift_ms;
+    const unsigned long interval =
+        get_autoshift_interval_ms(context->core.game.game.level);
+    ms = passed < interval ? (long)(interval - passed) : 0;
+  }
+  if (ms && get_is_autoplay_active(context)) {
+    const unsigned long passed = now_ms - context->previous_autoplay_ms;
+    const unsigned long interval = context->autoplay_move_ms;
+    const long autoplay_ms = passed < interval ? (long)(interval - passed) : 0;
+    if (ms < 0 || autoplay_ms < ms) ms = autoplay_ms;
+  }
+  return ms;
+}
+
+/// @brief check if the autoplay makes moves in the current state: it moves
+/// the figures and starts the games, a paused game is left to the user
+/// @param context the context
+/// @return true if the autoplay is set and has a move to make
+bool get_is_autoplay_active(const tetris_context_t *context) {
+  const tetris_state_t state = context->core.state;
+  return context->autoplay &&
+         (state == IDLE || state == START || state == GAMEOVER);
+}
+
+/// @brief apply the next autoplay move if it is time to, as a user signal.
+/// The lock is left to the autoshift timer
+/// @param context the context
+/// @return true if a move was applied
+bool handle_autoplay(tetris_context_t *context) {
+  if (!get_is_autoplay_active(context) ||
+      !game_clock_get_is_time_to_operate(&context->core.clock,
+                                         &context->previous_autoplay_ms,
+                                         context->autoplay_move_ms)) {
+    return false;
+  }
+  fsm_input_t signal = START_BTN;
+  if (context->core.state == IDLE) {
+    signal = autoplay_get_signal(context->autoplay, &context->core.game);
+  }
+  UserAction_t action = Start;
+  const bool user_signal = !fsm_get_user_action(signal, &action);
+  if (user_signal) tetris_context_apply_signal(context, signal);
+  return user_signal;
+}
+
+/// @brief update game state. autoshift if it is time to, apply all the user
+/// input from the queue in the order it was pushed, then the autoplay move
+/// @param context the context
+void handle_game_update(tetris_context_t *context) {
+  bool any_signal = false;
+  if (tetris_context_get_is_time_to_autoshift(context)) {
+    tetris_context_apply_signal(context, AUTOSHIFT_SIG);
+    any_signal = true;
+  }
+  input_event_t event = {0};
+  while (input_queue_pop(&context->input, &event)) {
+    tetris_context_apply_signal(context, fsm_get_signal(event.action));
+    any_signal = true;
+  }
+  if (handle_autoplay(context)) any_signal = true;
+  if (!any_signal) {
+    tetris_context_apply_signal(context, NO_INPUT);
+  }
+}
+
+/// @brief get ammount of mseconds that should pass between the autoshifts
+/// @param level game level
+/// @return interval between autoshifts
+unsigned long get_autoshift_interval_ms(const int level) {
+  unsigned long interval = 1000;
+  if (level > 0 && level <= 10) {
+    interval -= 90 * level;
+  }
+  return interval;
+}
+
+/// @brief handle game update, publish it to the spectators and return the
+/// updated state of the game
+/// @param context the context
+/// @return updated game state
+GameInfo_t tetris_context_update_current_state(tetris_context_t *context) {
+  handle_game_update(context);
+  tetris_context_publish(context);
+  return backend_get_game_info(&context->core.game, &context->view);
+}
@@ -0,0 +1,93 @@
+#ifndef TETRIS_CONTEXT
+#define TETRIS_CONTEXT
+
+/// @file context.h
+/// @brief Declaration of the game context - a self-contained game instance.
+/// Every context owns its game, FSM state, input queue and autoshift timer, so
+/// any number of them may be operated independently, one thread per context.
+/// The autoshift timer runs on the context clock, the monotonic one by default.
+/// User input may be pushed from one other thread, the only producer of the
+/// input queue, which is drained by the thread that updates the context. With a
+/// recorder set every applied signal is recorded to the replay. The game play
+/// state of a context is a POD, it may be saved to a snapshot and restored any
+/// number of times. With an autoplay set the updating thread applies the
+/// autoplay moves after the queued input, one per autoplay_move_ms, and starts
+/// the games itself. With FSM statistics set the signals the context applies
+/// are accounted to them. With a leaderboard set every finished game is
+/// submitted to it. With spectators set every updated frame is published to
+/// them
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "../../common/game_clock.h"
+#include "autoplay.h"
+#include "backend.h"
+#include "fsm.h"
+#include "input_queue.h"
+#include "leaderboard.h"
+#include "lib.h"
+#include "replay.h"
+#include "spectator.h"
+
+/// @brief Everything the game play depends on: the game with its randomizer,
+/// the FSM state, the clock and the autoshift timer. Fixed size, no pointers
+typedef struct {
+  tetris_game_t game;
+  tetris_state_t state;
+  game_clock_t clock;
+  unsigned long previous_autoshift_ms;
+} tetris_snapshot_t;
+
+/// @brief core is the game play state, the input queue, the recorder, the
+/// autoplay, the statistics, the leaderboard and the spectators are attached
+/// to the context, view holds the rows of the GameInfo_t returned to the gui
+typedef struct {
+  tetris_snapshot_t core;
+  input_queue_t input;
+  replay_writer_t *recorder;
+  autoplay_t *autoplay;
+  unsigned long autoplay_move_ms;
+  unsigned long previous_autoplay_ms;
+  fsm_stats_t *stats;
+  leaderboard_t *leaderboard;
+  spectator_hub_t *spectators;
+  tetris_game_view_t view;
+} tetris_context_t;
+
+tetris_context_t *tetris_context_create(void);
+void tetris_context_destroy(tetris_context_t *);
+void tetris_context_init(tetris_context_t *);
+void tetris_context_configure(tetris_context_t *, const tetris_setup_t *);
+void tetris_context_set_clock(tetris_context_t *, const game_clock_t *);
+void tetris_context_advance_clock_ms(tetris_context_t *, unsigned long ms);
+void tetris_context_set_recorder(tetris_context_t *, replay_writer_t *);
+void tetris_context_set_autoplay(tetris_context_t *, autoplay_t *,
+                                 unsigned long move_ms);
+void tetris_context_set_stats(tetris_context_t *, fsm_stats_t *);
+void tetris_context_set_leaderboard(tetris_context_t *, leaderboard_t *);
+bool tetris_context_submit_score(tetris_context_t *);
+void tetris_context_set_spectators(tetris_context_t *, spectator_hub_t *);
+void tetris_context_publish(tetris_context_t *);
+void tetris_context_apply_signal(tetris_context_t *, fsm_input_t signal);
+void tetris_context_snapshot(const tetris_context_t *, tetris_snapshot_t *);
+void tetris_context_restore(tetris_context_t *, const tetris_snapshot_t *);
+tetris_context_t *tetris_context_clone(const tetris_context_t *);
+
+void tetris_context_user_input(tetris_context_t *, UserAction_t action,
+                               bool hold);
+void tetris_context_push_input_event(tetris_context_t *,
+                                     const input_event_t *);
+GameInfo_t tetris_context_update_current_state(tetris_context_t *);
+
+bool tetris_context_get_game_has_finished(const tetris_context_t *);
+bool tetris_context_get_game_over(const tetris_context_t *);
+bool tetris_context_get_pause(const tetris_context_t *);
+unsigned long tetris_context_get_generation(const tetris_context_t *);
+dirty_rows_t tetris_context_take_dirty_rows(tetris_context_t *);
+
+bool tetris_context_get_is_time_to_autoshift(tetris_context_t *);
+long tetris_context_get_ms_to_next_update(const tetris_context_t *);
+unsigned long get_autoshift_interval_ms(const int level);
+
+#endif
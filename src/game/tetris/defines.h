@@ -4,12 +4,16 @@
 /// @file defines.h
 /// @brief Game global setting
 
+// bumped on every change of the game rules, replays of other versions may
+// play differently
+#define TETRIS_ENGINE_VERSION 1
+
 #define MAX_FIGURE_SIZE 4
 #define ALLOWED_FIGURES_COUNT 7
 
 #define FIELD_VISIBLE_HEIGHT 20
 #define FIELD_UPPER_MARGIN 4
-#define FIELD_TOTAL_HEIGHT FIELD_VISIBLE_HEIGHT + FIELD_UPPER_MARGIN
+#define FIELD_TOTAL_HEIGHT (FIELD_VISIBLE_HEIGHT + FIELD_UPPER_MARGIN)
 #define FIELD_WIDTH 10
 
 #endif
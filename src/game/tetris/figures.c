@@ -1,95 +1,119 @@
 #include "figures.h"
 
 /// @file figures.c
-/// @brief Implementation of functions to create figures
+/// @brief Implementation of the figure tables and functions to create figures.
+/// J, L, S, T and Z rotate inside the 3x3 box in the rows 1-3 of the figure
+/// box, I rotates inside the whole figure box, O does not rotate. The rotation
+/// 0 is the spawn one: every figure lies on the row 2 of the figure box.
+/// Rotations are clockwise, the kicks follow the Super Rotation System
 
-#include <string.h>
+#include <stddef.h>
 
-#include "defines.h"
-#include "matrix.h"
+const figure_shape_t
+    figure_shapes[ALLOWED_FIGURES_COUNT][FIGURE_ROTATIONS_COUNT] = {
+        // I
+        {{{0x0, 0x0, 0xf, 0x0}, 2, 0, 1, 4},
+         {{0x2, 0x2, 0x2, 0x2}, 0, 1, 4, 1},
+         {{0x0, 0xf, 0x0, 0x0}, 1, 0, 1, 4},
+         {{0x4, 0x4, 0x4, 0x4}, 0, 2, 4, 1}},
+        // J
+        {{{0x0, 0x1, 0x7, 0x0}, 1, 0, 2, 3},
+         {{0x0, 0x6, 0x2, 0x2}, 1, 1, 3, 2},
+         {{0x0, 0x0, 0x7, 0x4}, 2, 0, 2, 3},
+         {{0x0, 0x2, 0x2, 0x3}, 1, 0, 3, 2}},
+        // L
+        {{{0x0, 0x4, 0x7, 0x0}, 1, 0, 2, 3},
+         {{0x0, 0x2, 0x2, 0x6}, 1, 1, 3, 2},
+         {{0x0, 0x0, 0x7, 0x1}, 2, 0, 2, 3},
+         {{0x0, 0x3, 0x2, 0x2}, 1, 0, 3, 2}},
+        // O
+        {{{0x0, 0x6, 0x6, 0x0}, 1, 1, 2, 2},
+         {{0x0, 0x6, 0x6, 0x0}, 1, 1, 2, 2},
+         {{0x0, 0x6, 0x6, 0x0}, 1, 1, 2, 2},
+         {{0x0, 0x6, 0x6, 0x0}, 1, 1, 2, 2}},
+        // S
+        {{{0x0, 0x6, 0x3, 0x0}, 1, 0, 2, 3},
+         {{0x0, 0x2, 0x6, 0x4}, 1, 1, 3, 2},
+         {{0x0, 0x0, 0x6, 0x3}, 2, 0, 2, 3},
+         {{0x0, 0x1, 0x3, 0x2}, 1, 0, 3, 2}},
+        // T
+        {{{0x0, 0x2, 0x7, 0x0}, 1, 0, 2, 3},
+         {{0x0, 0x2, 0x6, 0x2}, 1, 1, 3, 2},
+         {{0x0, 0x0, 0x7, 0x2}, 2, 0, 2, 3},
+         {{0x0, 0x2, 0x3, 0x2}, 1, 0, 3, 2}},
+        // Z
+        {{{0x0, 0x3, 0x6, 0x0}, 1, 0, 2, 3},
+         {{0x0, 0x4, 0x6, 0x2}, 1, 1, 3, 2},
+         {{0x0, 0x0, 0x3, 0x6}, 2, 0, 2, 3},
+         {{0x0, 0x2, 0x3, 0x1}, 1, 0, 3, 2}}};
 
-typedef void (*figure_filler_t)(int **);
+// kicks for the rotation from the indexed one to the next one clockwise.
+// the figure box rows grow downwards, so the SRS y offsets are negated
+const figure_kick_t jlstz_kicks[FIGURE_ROTATIONS_COUNT][FIGURE_KICKS_COUNT] = {
+    {{0, 0}, {0, -1}, {-1, -1}, {2, 0}, {2, -1}},
+    {{0, 0}, {0, 1}, {1, 1}, {-2, 0}, {-2, 1}},
+    {{0, 0}, {0, 1}, {-1, 1}, {2, 0}, {2, 1}},
+    {{0, 0}, {0, -1}, {1, -1}, {-2, 0}, {-2, -1}}};
 
-#define def_fillers                                                         \
-  figure_filler_t fillers[] = {fill_figure_0, fill_figure_1, fill_figure_2, \
-                               fill_figure_3, fill_figure_4, fill_figure_5, \
-                               fill_figure_6};
+// the I spawn rotation is the SRS state 2, so the table starts with 2->L
+const figure_kick_t i_kicks[FIGURE_ROTATIONS_COUNT][FIGURE_KICKS_COUNT] = {
+    {{0, 0}, {0, 2}, {0, -1}, {-1, 2}, {2, -1}},
+    {{0, 0}, {0, 1}, {0, -2}, {2, 1}, {-1, -2}},
+    {{0, 0}, {0, -2}, {0, 1}, {1, -2}, {-2, 1}},
+    {{0, 0}, {0, -1}, {0, 2}, {-2, -1}, {1, 2}}};
 
-#define colour 1
-void fill_figure_0(int **buff) {
-  fill_matrix(buff, MAX_FIGURE_SIZE, MAX_FIGURE_SIZE, 0);
-  for (int i = 0; i != 4; ++i) {
-    buff[2][i] = colour;
-  }
-}
-#undef colour
+#define I_FIGURE_ID 0
+#define O_FIGURE_ID 3
 
-#define colour 2
-void fill_figure_1(int **buff) {
-  fill_matrix(buff, MAX_FIGURE_SIZE, MAX_FIGURE_SIZE, 0);
-  for (int i = 0; i != 3; ++i) {
-    buff[2][i] = colour;
-  }
-  buff[1][0] = colour;
+/// @brief Get the figure shape from the table
+/// @param id figure id
+/// @param rotation figure rotation, any value is taken modulo 4
+/// @return the shape, NULL if the id is not valid
+const figure_shape_t *get_figure_shape(const int id, const int rotation) {
+  if (id < 0 || id >= ALLOWED_FIGURES_COUNT) return NULL;
+  return &figure_shapes[id][rotation & (FIGURE_ROTATIONS_COUNT - 1)];
 }
-#undef colour
 
-#define colour 3
-void fill_figure_2(int **buff) {
-  fill_matrix(buff, MAX_FIGURE_SIZE, MAX_FIGURE_SIZE, 0);
-  for (int i = 0; i != 3; ++i) {
-    buff[2][i] = colour;
-  }
-  buff[1][2] = colour;
-}
-#undef colour
-
-#define colour 4
-void fill_figure_3(int **buff) {
-  fill_matrix(buff, MAX_FIGURE_SIZE, MAX_FIGURE_SIZE, 0);
-  buff[1][1] = colour;
-  buff[1][2] = colour;
-  buff[2][1] = colour;
-  buff[2][2] = colour;
-}
-#undef colour
-
-#define colour 5
-void fill_figure_4(int **buff) {
-  fill_matrix(buff, MAX_FIGURE_SIZE, MAX_FIGURE_SIZE, 0);
-  buff[1][1] = colour;
-  buff[1][2] = colour;
-  buff[2][0] = colour;
-  buff[2][1] = colour;
-}
-#undef colour
-
-#define colour 6
-void fill_figure_5(int **buff) {
-  fill_matrix(buff, MAX_FIGURE_SIZE, MAX_FIGURE_SIZE, 0);
-  for (int i = 0; i != 3; ++i) {
-    buff[2][i] = colour;
+/// @brief Get the offsets to test in order while rotating the figure
+/// clockwise from the given rotation
+/// @param id figure id
+/// @param rotation the rotation before the turn
+/// @param kicks_count where to save the number of the offsets
+/// @return the offsets, NULL if the id is not valid
+const figure_kick_t *get_figure_kicks(const int id, const int rotation,
+                                      int *kicks_count) {
+  const figure_kick_t *kicks = NULL;
+  int count = 0;
+  if (id >= 0 && id < ALLOWED_FIGURES_COUNT) {
+    const int from = rotation & (FIGURE_ROTATIONS_COUNT - 1);
+    if (id == I_FIGURE_ID) {
+      kicks = i_kicks[from];
+      count = FIGURE_KICKS_COUNT;
+    } else {
+      kicks = jlstz_kicks[from];
+      count = id == O_FIGURE_ID ? 1 : FIGURE_KICKS_COUNT;
+    }
   }
-  buff[1][1] = colour;
+  if (kicks_count) *kicks_count = count;
+  return kicks;
 }
-#undef colour
 
-#define colour 7
-void fill_figure_6(int **buff) {
-  fill_matrix(buff, MAX_FIGURE_SIZE, MAX_FIGURE_SIZE, 0);
-  buff[1][0] = colour;
-  buff[1][1] = colour;
-  buff[2][1] = colour;
-  buff[2][2] = colour;
-}
-#undef colour
+/// @brief Get the value the figure cells have on the field
+/// @param id figure id
+/// @return colour of the figure
+int get_figure_colour(const int id) { return id + 1; }
 
 /// @brief Fills the buffer with a figure pattern. The pattern is chosen by id
-/// @param buff matrix large enough to contain the pattern
+/// @param buff the figure matrix
 /// @param id pattern id
-void fill_figure_by_id(int **const buff, const int id) {
-  def_fillers;
-  if (id >= 0 && id < ALLOWED_FIGURES_COUNT) {
-    fillers[id](buff);
+void fill_figure_by_id(int buff[MAX_FIGURE_SIZE][MAX_FIGURE_SIZE],
+                       const int id) {
+  const figure_shape_t *shape = get_figure_shape(id, 0);
+  if (!shape) return;
+  const int colour = get_figure_colour(id);
+  for (int r = 0; r != MAX_FIGURE_SIZE; ++r) {
+    for (int c = 0; c != MAX_FIGURE_SIZE; ++c) {
+      buff[r][c] = (shape->rows[r] >> c) & 1u ? colour : 0;
+    }
   }
 }
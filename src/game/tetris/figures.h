@@ -2,8 +2,37 @@
 #define FIGURES_MANAGER
 
 /// @file figures.h
-/// @brief Declaration of functions to create figures
+/// @brief Declaration of the figure tables and functions to create figures
 
-void fill_figure_by_id(int **const buff, const int id);
+#include "bitboard.h"
+#include "defines.h"
+
+#define FIGURE_ROTATIONS_COUNT 4
+#define FIGURE_KICKS_COUNT 5
+#define NO_FIGURE -1
+
+/// @brief Figure in a given rotation. rows are the row masks of the
+/// MAX_FIGURE_SIZE x MAX_FIGURE_SIZE figure box, top, left, height and width
+/// describe the bounding box of the filled cells inside the figure box
+typedef struct {
+  row_mask_t rows[MAX_FIGURE_SIZE];
+  int top;
+  int left;
+  int height;
+  int width;
+} figure_shape_t;
+
+/// @brief Offset of the figure box to test during a rotation
+typedef struct {
+  int r;
+  int c;
+} figure_kick_t;
+
+const figure_shape_t *get_figure_shape(const int id, const int rotation);
+const figure_kick_t *get_figure_kicks(const int id, const int rotation,
+                                      int *kicks_count);
+int get_figure_colour(const int id);
+void fill_figure_by_id(int buff[MAX_FIGURE_SIZE][MAX_FIGURE_SIZE],
+                       const int id);
 
 #endif
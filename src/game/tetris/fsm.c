@@ -6,13 +6,24 @@
 #include "backend.h"
 #include "lib.h"
 
+/// @brief set up a new game, timing the backend call
+/// @param game current game ptr
+void fsm_setup_new_game(tetris_game_t *const game) {
+  const uint64_t start_ns = STATS_BEGIN_CALL();
+  backend_setup_new_game(game);
+  STATS_END_CALL(STATS_SETUP_NEW_GAME, start_ns);
+}
+
 /// @brief transitions from the PRESTART state
 /// @param state current state ptr
 /// @param game current game ptr
 void fsm_prestart_transition(tetris_state_t *const state,
                              tetris_game_t *const game) {
   if (!state || !game) return;
-  if (backend_init_game(game)) {
+  const uint64_t start_ns = STATS_BEGIN_CALL();
+  const bool error = backend_init_game(game);
+  STATS_END_CALL(STATS_INIT_GAME, start_ns);
+  if (error) {
     *state = EXIT;
   } else {
     *state = START;
@@ -29,7 +40,7 @@ void fsm_start_transition(fsm_input_t *const input, tetris_state_t *const state,
   switch (*input) {
     case START_BTN:
       *state = SPAWNING;
-      backend_setup_new_game(game);
+      fsm_setup_new_game(game);
       break;
     case EXIT_BTN:
       *state = PREEXIT;
@@ -47,7 +58,10 @@ void fsm_start_transition(fsm_input_t *const input, tetris_state_t *const state,
 void fsm_spawning_transition(tetris_state_t *const state,
                              tetris_game_t *const game) {
   if (!state) return;
-  if (backend_spawn_new_figure(game)) {
+  const uint64_t start_ns = STATS_BEGIN_CALL();
+  const bool game_over = backend_spawn_new_figure(game);
+  STATS_END_CALL(STATS_SPAWN, start_ns);
+  if (game_over) {
     *state = GAMEOVER;
   } else {
     *state = IDLE;
@@ -92,9 +106,15 @@ void fsm_idle_transition(fsm_input_t *const input,
 void fsm_autoshifting_transition(tetris_state_t *const state,
                                  tetris_game_t *const game) {
   if (!state) return;
-  if (!backend_drop_current_figure(game)) {
+  uint64_t start_ns = STATS_BEGIN_CALL();
+  const bool landed = backend_drop_current_figure(game);
+  STATS_END_CALL(STATS_DROP, start_ns);
+  if (!landed) {
     *state = IDLE;
   } else {
+    start_ns = STATS_BEGIN_CALL();
+    backend_lock_current_figure(game);
+    STATS_END_CALL(STATS_LOCK, start_ns);
     *state = OVERFLOWCONTROL;
   }
 }
@@ -107,18 +127,23 @@ void fsm_moving_transition(fsm_input_t *const input,
                            tetris_state_t *const state,
                            tetris_game_t *const game) {
   if (!state || !input) return;
+  const uint64_t start_ns = STATS_BEGIN_CALL();
   switch (*input) {
     case MOVE_LEFT:
       backend_move_left_current_figure(game);
+      STATS_END_CALL(STATS_MOVE_LEFT, start_ns);
       break;
     case MOVE_RIGHT:
       backend_move_right_current_figure(game);
+      STATS_END_CALL(STATS_MOVE_RIGHT, start_ns);
       break;
     case ROTATE_BTN:
       backend_rotate_current_figure(game);
+      STATS_END_CALL(STATS_ROTATE, start_ns);
       break;
     case MOVE_DOWN:
       backend_drop_current_figure(game);
+      STATS_END_CALL(STATS_DROP, start_ns);
       break;
     default:
       break;
@@ -153,7 +178,10 @@ void fsm_pause_transition(fsm_input_t *const input,
 void fsm_overflowcontrol_transition(tetris_state_t *const state,
                                     tetris_game_t *const game) {
   if (!state) return;
-  if (backend_get_overflow(game)) {
+  const uint64_t start_ns = STATS_BEGIN_CALL();
+  const bool overflow = backend_get_overflow(game);
+  STATS_END_CALL(STATS_OVERFLOW, start_ns);
+  if (overflow) {
     *state = GAMEOVER;
   } else {
     *state = ROWCUTTING;
@@ -166,7 +194,9 @@ void fsm_overflowcontrol_transition(tetris_state_t *const state,
 void fsm_rowcutting_transition(tetris_state_t *const state,
                                tetris_game_t *const game) {
   if (!state) return;
+  const uint64_t start_ns = STATS_BEGIN_CALL();
   backend_cut_filled_rows(game);
+  STATS_END_CALL(STATS_CUT, start_ns);
   *state = SPAWNING;
 }
 
@@ -184,7 +214,7 @@ void fsm_gameover_transition(fsm_input_t *const input,
       break;
     case START_BTN:
       *state = SPAWNING;
-      backend_setup_new_game(game);
+      fsm_setup_new_game(game);
       break;
     default:
       *state = GAMEOVER;
@@ -199,37 +229,40 @@ void fsm_gameover_transition(fsm_input_t *const input,
 void fsm_preexit_transition(tetris_state_t *const state,
                             tetris_game_t *const game) {
   if (!state) return;
+  const uint64_t start_ns = STATS_BEGIN_CALL();
   backend_destroy_game(game);
+  STATS_END_CALL(STATS_DESTROY_GAME, start_ns);
   *state = EXIT;
 }
 
-/// @brief get ptr to the state object
-/// @return ptr to the state object
-tetris_state_t *get_current_state(void) {
-  static tetris_state_t state;
-  return &state;
-}
-
-/// @brief get the value of the state object
-/// @return value of the state object
-tetris_state_t fsm_get_state(void) { return *get_current_state(); }
-
-/// @brief get if the autoshift is available in the current state
+/// @brief get if the autoshift is available in the state
+/// @param state the state to check
 /// @return true if autoshift is available
-bool fsm_is_autoshift_available(void) {
-  const tetris_state_t state = fsm_get_state();
+bool fsm_is_autoshift_available(const tetris_state_t state) {
   bool available = false;
   if (state == IDLE) available = true;
   return available;
 }
 
+/// @brief get if the state is a stable one. The other states are passed on
+/// the next update without any input
+/// @param state the state to check
+/// @return true if only an input or the autoshift changes the state
+bool fsm_is_waiting_for_input(const tetris_state_t state) {
+  return state == START || state == IDLE || state == PAUSE ||
+         state == GAMEOVER || state == EXIT;
+}
+
 /// @brief Apply user input at the current state of the FSM
 /// @param inp user input value
+/// @param state ptr to the FSM state of the game
 /// @param game current game
-void fsm_apply_input(fsm_input_t inp, tetris_game_t *const game) {
-  tetris_state_t *state = get_current_state();
+void fsm_apply_input(fsm_input_t inp, tetris_state_t *const state,
+                     tetris_game_t *const game) {
+  if (!state) return;
   bool at_least_once = false;
   while (inp != NO_INPUT || !at_least_once) {
+    STATS_COUNT_TRANSITION(*state);
     switch (*state) {
       case START:
         fsm_start_transition(&inp, state, game);
@@ -303,3 +336,38 @@ fsm_input_t fsm_get_signal(UserAction_t user_input) {
   }
   return input;
 }
+
+/// @brief translate the fsm signal of a move to the user input that causes it
+/// @param signal fsm signal value
+/// @param user_input where to save the user input
+/// @return true if no user input causes the signal
+bool fsm_get_user_action(const fsm_input_t signal, UserAction_t *user_input) {
+  bool error = false;
+  switch (signal) {
+    case START_BTN:
+      *user_input = Start;
+      break;
+    case PAUSE_BTN:
+      *user_input = Pause;
+      break;
+    case EXIT_BTN:
+      *user_input = Terminate;
+      break;
+    case MOVE_LEFT:
+      *user_input = Left;
+      break;
+    case MOVE_RIGHT:
+      *user_input = Right;
+      break;
+    case MOVE_DOWN:
+      *user_input = Down;
+      break;
+    case ROTATE_BTN:
+      *user_input = Action;
+      break;
+    default:
+      error = true;
+      break;
+  }
+  return error;
+}
@@ -6,6 +6,7 @@
 
 #include "backend.h"
 #include "lib.h"
+#include "stats.h"
 
 typedef enum {
   PRESTART = 0,
@@ -22,6 +23,8 @@ typedef enum {
   EXIT
 } tetris_state_t;
 
+_Static_assert(EXIT + 1 == STATS_STATES_COUNT, "a state has no counter");
+
 typedef enum {
   NO_INPUT = 0,
   START_BTN,
@@ -35,8 +38,9 @@ typedef enum {
 } fsm_input_t;
 
 fsm_input_t fsm_get_signal(UserAction_t user_input);
-void fsm_apply_input(fsm_input_t, tetris_game_t *);
-tetris_state_t fsm_get_state(void);
-bool fsm_is_autoshift_available(void);
+bool fsm_get_user_action(const fsm_input_t signal, UserAction_t *user_input);
+void fsm_apply_input(fsm_input_t, tetris_state_t *, tetris_game_t *);
+bool fsm_is_autoshift_available(tetris_state_t);
+bool fsm_is_waiting_for_input(tetris_state_t);
 
 #endif
@@ -0,0 +1,182 @@
+#define _POSIX_C_SOURCE 200809L
+// relying on the POSIX threads, fsync() and fileno()
+#include "high_score.h"
+
+/// @file high_score.c
+/// @brief Implementation of the high score store
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+/// @brief best is the authoritative record, written is the one in the file.
+/// The writer thread writes while best differs from written
+typedef struct {
+  pthread_mutex_t lock;
+  pthread_cond_t changed;
+  pthread_once_t loaded;
+  atomic_int best;
+  int written;
+  bool started;
+  bool writing;
+  bool error;
+  char path[HIGH_SCORE_PATH_MAX];
+} high_score_store_t;
+
+static high_score_store_t store = {PTHREAD_MUTEX_INITIALIZER,
+                                   PTHREAD_COND_INITIALIZER,
+                                   PTHREAD_ONCE_INIT,
+                                   0,
+                                   0,
+                                   false,
+                                   false,
+                                   false,
+                                   HIGH_SCORE_DEFAULT_PATH};
+
+void high_score_load(void);
+int high_score_read_file(const char *path);
+bool high_score_write_file(const char *path, const int score);
+void *high_score_writer_routine(void *arg);
+void high_score_flush_at_exit(void);
+
+/// @brief get the high score, read from the file on the first call
+/// @return the high score
+int high_score_get(void) {
+  pthread_once(&store.loaded, high_score_load);
+  return atomic_load_explicit(&store.best, memory_order_relaxed);
+}
+
+/// @brief take the score as the high score if it beats the record and wake
+/// the writer thread up, starting it on the first record
+/// @param score the score
+void high_score_offer(const int score) {
+  pthread_once(&store.loaded, high_score_load);
+  int best = atomic_load_explicit(&store.best, memory_order_relaxed);
+  while (score > best &&
+         !atomic_compare_exchange_weak(&store.best, &best, score)) {
+  }
+  if (score <= best) return;
+  pthread_mutex_lock(&store.lock);
+  if (!store.started) {
+    pthread_t thread;
+    store.started =
+        !pthread_create(&thread, NULL, high_score_writer_routine, NULL);
+    if (store.started) {
+      pthread_detach(thread);
+      atexit(high_score_flush_at_exit);
+    }
+  }
+  pthread_cond_broadcast(&store.changed);
+  pthread_mutex_unlock(&store.lock);
+}
+
+/// @brief wait until the high score is in the file. Without the writer
+/// thread the record is written right away
+/// @return true if the last write has failed
+bool high_score_flush(void) {
+  pthread_once(&store.loaded, high_score_load);
+  pthread_mutex_lock(&store.lock);
+  const int best = atomic_load(&store.best);
+  if (!store.started && best != store.written) {
+    store.error = high_score_write_file(store.path, best);
+    store.written = best;
+  }
+  while (store.started &&
+         (store.writing || atomic_load(&store.best) != store.written)) {
+    pthread_cond_wait(&store.changed, &store.lock);
+  }
+  const bool error = store.error;
+  pthread_mutex_unlock(&store.lock);
+  return error;
+}
+
+/// @brief keep the high score in another file. The pending record is written
+/// to the old file, then the high score is read from the new one
+/// @param path the file
+/// @return true if the path is too long or the old file could not be written
+bool high_score_set_path(const char *path) {
+  if (!path || strlen(path) >= HIGH_SCORE_PATH_MAX) return true;
+  const bool error = high_score_flush();
+  pthread_mutex_lock(&store.lock);
+  strcpy(store.path, path);
+  store.written = high_score_read_file(store.path);
+  atomic_store(&store.best, store.written);
+  store.error = false;
+  pthread_mutex_unlock(&store.lock);
+  return error;
+}
+
+/// @brief read the high score from the file, once
+void high_score_load(void) {
+  pthread_mutex_lock(&store.lock);
+  store.written = high_score_read_file(store.path);
+  atomic_store(&store.best, store.written);
+  pthread_mutex_unlock(&store.lock);
+}
+
+/// @brief read the high score
+/// @param path the file
+/// @return the high score, 0 if there is no file
+int high_score_read_file(const char *path) {
+  int high_score = 0;
+  FILE *high_score_f = fopen(path, "r");
+  if (high_score_f) {
+    if (fscanf(high_score_f, "%d", &high_score) != 1) high_score = 0;
+    fclose(high_score_f);
+  }
+  return high_score;
+}
+
+/// @brief write the high score to a temporary file and rename it over the
+/// file, so the file has either the old or the new record
+/// @param path the file
+/// @param score the high score
+/// @return true on error, the file is not changed then
+bool high_score_write_file(const char *path, const int score) {
+  char temporary_path[HIGH_SCORE_PATH_MAX + 32];
+  snprintf(temporary_path, sizeof(temporary_path), "%s.%ld.tmp", path,
+           (long)getpid());
+  FILE *high_score_f = fopen(temporary_path, "w");
+  bool error = !high_score_f;
+  if (!error) {
+    error = fprintf(high_score_f, "%d", score) < 0 ||
+            fflush(high_score_f) != 0 || fsync(fileno(high_score_f)) != 0;
+    error = fclose(high_score_f) != 0 || error;
+    error = error || rename(temporary_path, path) != 0;
+    if (error) remove(temporary_path);
+  }
+  return error;
+}
+
+/// @brief write the latest record whenever it differs from the written one
+/// @param arg unused
+/// @return never returns, the thread is detached
+void *high_score_writer_routine(void *arg) {
+  (void)arg;
+  pthread_mutex_lock(&store.lock);
+  while (true) {
+    const int best = atomic_load(&store.best);
+    if (best == store.written) {
+      pthread_cond_wait(&store.changed, &store.lock);
+    } else {
+      char path[HIGH_SCORE_PATH_MAX];
+      strcpy(path, store.path);
+      store.writing = true;
+      pthread_mutex_unlock(&store.lock);
+      const bool error = high_score_write_file(path, best);
+      pthread_mutex_lock(&store.lock);
+      store.writing = false;
+      store.error = error;
+      // a set_path() in between has read the record of the new file
+      if (!strcmp(path, store.path)) store.written = best;
+      pthread_cond_broadcast(&store.changed);
+    }
+  }
+  return NULL;
+}
+
+/// @brief write the pending record before the process exits
+void high_score_flush_at_exit(void) { high_score_flush(); }
@@ -0,0 +1,24 @@
+#ifndef TETRIS_HIGH_SCORE
+#define TETRIS_HIGH_SCORE
+
+/// @file high_score.h
+/// @brief Declaration of the high score store. The high score in memory is
+/// the authoritative one, it is shared by all the games of the process and
+/// read from the file once, on the first use. A new record is taken by an
+/// atomic update, the file is written by a writer thread started on the first
+/// record: the thread writes the latest record only, however many came
+/// during the previous write, to a temporary file renamed over the old one.
+/// The game thread never waits for the disk, the pending record is written at
+/// the exit or on a flush
+
+#include <stdbool.h>
+
+#define HIGH_SCORE_DEFAULT_PATH "/tmp/.tetris_high_score"
+#define HIGH_SCORE_PATH_MAX 4096
+
+int high_score_get(void);
+void high_score_offer(const int score);
+bool high_score_flush(void);
+bool high_score_set_path(const char *path);
+
+#endif
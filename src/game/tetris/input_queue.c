@@ -0,0 +1,43 @@
+#include "input_queue.h"
+
+/// @file input_queue.c
+/// @brief Implementation of the bounded lock-free queue of user input events
+
+/// @brief push an event, producer side
+/// @param queue the queue
+/// @param event the event
+/// @return true if the queue is full and the event is dropped
+bool input_queue_push(input_queue_t *queue, const input_event_t *event) {
+  const size_t tail = atomic_load_explicit(&queue->tail, memory_order_relaxed);
+  const size_t head = atomic_load_explicit(&queue->head, memory_order_acquire);
+  const bool full = tail - head == INPUT_QUEUE_CAPACITY;
+  if (full) {
+    atomic_fetch_add_explicit(&queue->dropped, 1, memory_order_relaxed);
+  } else {
+    queue->events[tail & (INPUT_QUEUE_CAPACITY - 1)] = *event;
+    atomic_store_explicit(&queue->tail, tail + 1, memory_order_release);
+  }
+  return full;
+}
+
+/// @brief pop the oldest event, consumer side
+/// @param queue the queue
+/// @param event where to save the event
+/// @return true if an event is popped, false if the queue is empty
+bool input_queue_pop(input_queue_t *queue, input_event_t *event) {
+  const size_t head = atomic_load_explicit(&queue->head, memory_order_relaxed);
+  const size_t tail = atomic_load_explicit(&queue->tail, memory_order_acquire);
+  const bool popped = head != tail;
+  if (popped) {
+    *event = queue->events[head & (INPUT_QUEUE_CAPACITY - 1)];
+    atomic_store_explicit(&queue->head, head + 1, memory_order_release);
+  }
+  return popped;
+}
+
+/// @brief get the number of events dropped because the queue was full
+/// @param queue the queue
+/// @return number of dropped events
+unsigned long input_queue_get_dropped(input_queue_t *queue) {
+  return atomic_load_explicit(&queue->dropped, memory_order_relaxed);
+}
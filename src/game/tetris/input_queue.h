@@ -0,0 +1,39 @@
+#ifndef TETRIS_INPUT_QUEUE
+#define TETRIS_INPUT_QUEUE
+
+/// @file input_queue.h
+/// @brief Declaration of the bounded lock-free queue of user input events.
+/// One producer thread pushes the events, one consumer thread pops them
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "lib.h"
+
+// power of two
+#define INPUT_QUEUE_CAPACITY 64
+#define INPUT_QUEUE_PADDING 64
+
+typedef struct {
+  UserAction_t action;
+  bool hold;
+  unsigned long timestamp_ms;
+} input_event_t;
+
+/// @brief head is written by the consumer only, tail by the producer only, they
+/// are padded apart to not share a cache line. A zeroed queue is empty
+typedef struct {
+  atomic_size_t head;
+  char head_padding[INPUT_QUEUE_PADDING];
+  atomic_size_t tail;
+  char tail_padding[INPUT_QUEUE_PADDING];
+  atomic_ulong dropped;
+  input_event_t events[INPUT_QUEUE_CAPACITY];
+} input_queue_t;
+
+bool input_queue_push(input_queue_t *, const input_event_t *);
+bool input_queue_pop(input_queue_t *, input_event_t *);
+unsigned long input_queue_get_dropped(input_queue_t *);
+
+#endif
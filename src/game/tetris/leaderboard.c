@@ -0,0 +1,341 @@
+#define _POSIX_C_SOURCE 200809L
+// relying on the POSIX mmap(), fcntl() locks, kill() and sched_yield()
+#include "leaderboard.h"
+
+/// @file leaderboard.c
+/// @brief Implementation of the leaderboard shared by the processes
+
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <sched.h>
+#include <signal.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#define LEADERBOARD_SPINS_BEFORE_YIELD 64
+
+bool leaderboard_map(leaderboard_t *board, const int capacity);
+bool get_entry_ranks_lower(const leaderboard_entry_t *entry,
+                           const leaderboard_entry_t *other);
+int compare_entries(const void *first, const void *second);
+void leaderboard_sift_up(leaderboard_entry_t *entries, int i);
+void leaderboard_sift_down(leaderboard_entry_t *entries, const int count,
+                           int i);
+void leaderboard_lock(leaderboard_file_t *file);
+void leaderboard_unlock(leaderboard_file_t *file);
+void leaderboard_repair(leaderboard_file_t *file);
+bool get_owner_is_gone(const unsigned owner);
+
+/// @brief map the leaderboard file, create it if there is none
+/// @param path the file
+/// @param capacity number of the records of a new file, an existing file
+/// keeps its own
+/// @return the leaderboard, NULL if the file could not be mapped or is not a
+/// leaderboard
+leaderboard_t *leaderboard_open(const char *path, const int capacity) {
+  if (!path || capacity < 1 || capacity > LEADERBOARD_MAX_CAPACITY) {
+    return NULL;
+  }
+  leaderboard_t *board = calloc(1, sizeof(leaderboard_t));
+  if (!board) return NULL;
+  board->fd = open(path, O_RDWR | O_CREAT, 0644);
+  // the file lock makes the creation atomic for the processes opening it at
+  // once, the records are never locked with it
+  struct flock file_lock;
+  memset(&file_lock, 0, sizeof(file_lock));
+  file_lock.l_type = F_WRLCK;
+  file_lock.l_whence = SEEK_SET;
+  bool error = board->fd < 0 || fcntl(board->fd, F_SETLKW, &file_lock) != 0;
+  error = error || leaderboard_map(board, capacity);
+  if (board->fd >= 0) {
+    file_lock.l_type = F_UNLCK;
+    fcntl(board->fd, F_SETLK, &file_lock);
+  }
+  if (error) {
+    if (board->fd >= 0) close(board->fd);
+    free(board);
+    board = NULL;
+  }
+  return board;
+}
+
+/// @brief map the file, sizing and initializing an empty one. The file must
+/// be locked
+/// @param board the leaderboard with the open file
+/// @param capacity number of the records of a new file
+/// @return true on error
+bool leaderboard_map(leaderboard_t *board, const int capacity) {
+  struct stat file_stat;
+  if (fstat(board->fd, &file_stat)) return true;
+  const bool created = file_stat.st_size == 0;
+  leaderboard_file_t header;
+  int records = capacity;
+  if (!created) {
+    if (pread(board->fd, &header, sizeof(header), 0) != sizeof(header) ||
+        memcmp(header.magic, LEADERBOARD_MAGIC, LEADERBOARD_MAGIC_SIZE) ||
+        header.version != LEADERBOARD_FORMAT_VERSION ||
+        header.capacity < 1 || header.capacity > LEADERBOARD_MAX_CAPACITY) {
+      return true;
+    }
+    records = (int)header.capacity;
+  }
+  board->size =
+      sizeof(leaderboard_file_t) + sizeof(leaderboard_entry_t) * records;
+  if (created && ftruncate(board->fd, (off_t)board->size)) return true;
+  if ((size_t)file_stat.st_size != board->size && !created) return true;
+  void *mapping = mmap(NULL, board->size, PROT_READ | PROT_WRITE, MAP_SHARED,
+                       board->fd, 0);
+  if (mapping == MAP_FAILED) return true;
+  board->file = mapping;
+  if (created) {
+    // the other fields are zeroed by ftruncate()
+    board->file->version = LEADERBOARD_FORMAT_VERSION;
+    board->file->capacity = (uint32_t)records;
+    atomic_store(&board->file->min_score, INT_MIN);
+    memcpy(board->file->magic, LEADERBOARD_MAGIC, LEADERBOARD_MAGIC_SIZE);
+  }
+  return false;
+}
+
+/// @brief unmap the leaderboard, the file stays
+/// @param board the leaderboard
+void leaderboard_close(leaderboard_t *board) {
+  if (!board) return;
+  munmap(board->file, board->size);
+  close(board->fd);
+  free(board);
+}
+
+/// @brief put the record on the board if it ranks higher than the worst one
+/// or the board is not full
+/// @param board the leaderboard
+/// @param entry the record
+/// @return true if the record is on the board
+bool leaderboard_submit(leaderboard_t *board,
+                        const leaderboard_entry_t *entry) {
+  if (!board || !entry) return false;
+  leaderboard_file_t *file = board->file;
+  const int capacity = (int)file->capacity;
+  // the count and the worst score only grow, so the stale ones do not reject
+  // a record that ranks higher
+  if (atomic_load_explicit(&file->count, memory_order_acquire) == capacity &&
+      entry->score <
+          atomic_load_explicit(&file->min_score, memory_order_relaxed)) {
+    return false;
+  }
+  leaderboard_lock(file);
+  const int count = atomic_load_explicit(&file->count, memory_order_relaxed);
+  const bool entered =
+      count < capacity || get_entry_ranks_lower(&file->entries[0], entry);
+  if (entered) {
+    const unsigned sequence =
+        atomic_load_explicit(&file->sequence, memory_order_relaxed);
+    atomic_store_explicit(&file->sequence, sequence + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    if (count < capacity) {
+      file->entries[count] = *entry;
+      leaderboard_sift_up(file->entries, count);
+      atomic_store_explicit(&file->count, count + 1, memory_order_relaxed);
+    } else {
+      file->entries[0] = *entry;
+      leaderboard_sift_down(file->entries, count, 0);
+    }
+    atomic_store_explicit(
+        &file->min_score,
+        count + 1 >= capacity ? file->entries[0].score : INT_MIN,
+        memory_order_relaxed);
+    atomic_store_explicit(&file->sequence, sequence + 2, memory_order_release);
+  }
+  leaderboard_unlock(file);
+  return entered;
+}
+
+/// @brief copy the best records, the highest ranking first. A change left
+/// unfinished by a process that does not exist any more is repaired under the
+/// lock, so the read never waits on a dead writer
+/// @param board the leaderboard
+/// @param entries where to save the records
+/// @param max_count size of the entries array
+/// @return number of the records copied, -1 on malloc error
+int leaderboard_read(const leaderboard_t *board, leaderboard_entry_t *entries,
+                     const int max_count) {
+  if (!board || !entries || max_count < 0) return -1;
+  leaderboard_file_t *file = board->file;
+  leaderboard_entry_t *heap =
+      malloc(sizeof(leaderboard_entry_t) * file->capacity);
+  if (!heap) return -1;
+  int count = 0;
+  unsigned before = 0;
+  unsigned after = 0;
+  bool done = false;
+  for (long spins = 1; !done; ++spins) {
+    before = atomic_load_explicit(&file->sequence, memory_order_acquire);
+    if (before & 1u) {
+      if (spins % LEADERBOARD_SPINS_BEFORE_YIELD == 0) {
+        sched_yield();
+        // the lock takes over from a dead owner and repairs the heap
+        if (get_owner_is_gone(
+                atomic_load_explicit(&file->lock, memory_order_relaxed))) {
+          leaderboard_lock(file);
+          leaderboard_unlock(file);
+        }
+      }
+    } else {
+      count = atomic_load_explicit(&file->count, memory_order_relaxed);
+      memcpy(heap, file->entries, sizeof(leaderboard_entry_t) * count);
+      atomic_thread_fence(memory_order_acquire);
+      after = atomic_load_explicit(&file->sequence, memory_order_relaxed);
+      done = before == after;
+    }
+  }
+  qsort(heap, count, sizeof(leaderboard_entry_t), compare_entries);
+  if (count > max_count) count = max_count;
+  memcpy(entries, heap, sizeof(leaderboard_entry_t) * count);
+  free(heap);
+  return count;
+}
+
+/// @brief print the best records
+/// @param out where to print
+/// @param board the leaderboard
+/// @param count number of the records to print
+void leaderboard_print(FILE *out, const leaderboard_t *board,
+                       const int count) {
+  leaderboard_entry_t *entries =
+      count > 0 ? malloc(sizeof(leaderboard_entry_t) * count) : NULL;
+  const int read = entries ? leaderboard_read(board, entries, count) : -1;
+  if (read >= 0) {
+    fprintf(out, "%4s %10s %6s %8s %-20s %s\n", "#", "score", "level",
+            "lines", "time", "seed");
+  }
+  for (int i = 0; i < read; ++i) {
+    const time_t timestamp = (time_t)entries[i].timestamp;
+    struct tm local;
+    char date[32] = "";
+    if (localtime_r(&timestamp, &local)) {
+      strftime(date, sizeof(date), "%Y-%m-%d %H:%M:%S", &local);
+    }
+    fprintf(out, "%4d %10d %6d %8d %-20s %llu\n", i + 1, entries[i].score,
+            entries[i].level, entries[i].lines, date,
+            (unsigned long long)entries[i].replay_id);
+  }
+  free(entries);
+}
+
+/// @brief get if the record ranks lower than the other
+/// @param entry the record
+/// @param other the other record
+/// @return true if the record has a lower score, or the same score later
+bool get_entry_ranks_lower(const leaderboard_entry_t *entry,
+                           const leaderboard_entry_t *other) {
+  return entry->score < other->score ||
+         (entry->score == other->score && entry->timestamp > other->timestamp);
+}
+
+/// @brief qsort comparator of the records, the highest ranking first
+/// @param first the first record
+/// @param second the second record
+/// @return negative if the first ranks higher, positive if lower
+int compare_entries(const void *first, const void *second) {
+  const leaderboard_entry_t *a = first;
+  const leaderboard_entry_t *b = second;
+  return get_entry_ranks_lower(a, b) - get_entry_ranks_lower(b, a);
+}
+
+/// @brief move the record up the heap while it ranks lower than its parent
+/// @param entries the heap
+/// @param i index of the record
+void leaderboard_sift_up(leaderboard_entry_t *entries, int i) {
+  while (i > 0 &&
+         get_entry_ranks_lower(&entries[i], &entries[(i - 1) / 2])) {
+    const leaderboard_entry_t swapped = entries[i];
+    entries[i] = entries[(i - 1) / 2];
+    entries[(i - 1) / 2] = swapped;
+    i = (i - 1) / 2;
+  }
+}
+
+/// @brief move the record down the heap while a child ranks lower
+/// @param entries the heap
+/// @param count number of the records in the heap
+/// @param i index of the record
+void leaderboard_sift_down(leaderboard_entry_t *entries, const int count,
+                           int i) {
+  bool moved = true;
+  while (moved) {
+    int lowest = i;
+    const int left = 2 * i + 1;
+    const int right = left + 1;
+    if (left < count &&
+        get_entry_ranks_lower(&entries[left], &entries[lowest])) {
+      lowest = left;
+    }
+    if (right < count &&
+        get_entry_ranks_lower(&entries[right], &entries[lowest])) {
+      lowest = right;
+    }
+    moved = lowest != i;
+    if (moved) {
+      const leaderboard_entry_t swapped = entries[i];
+      entries[i] = entries[lowest];
+      entries[lowest] = swapped;
+      i = lowest;
+    }
+  }
+}
+
+/// @brief take the lock, spinning and then yielding. A lock held by a process
+/// that does not exist any more is taken over and the heap is repaired
+/// @param file the leaderboard file
+void leaderboard_lock(leaderboard_file_t *file) {
+  const unsigned pid = (unsigned)getpid();
+  bool locked = false;
+  for (long spins = 1; !locked; ++spins) {
+    unsigned owner = 0;
+    locked = atomic_compare_exchange_weak_explicit(
+        &file->lock, &owner, pid, memory_order_acquire, memory_order_relaxed);
+    if (!locked && spins % LEADERBOARD_SPINS_BEFORE_YIELD == 0) {
+      sched_yield();
+      if (get_owner_is_gone(owner) &&
+          atomic_compare_exchange_strong_explicit(&file->lock, &owner, pid,
+                                                  memory_order_acquire,
+                                                  memory_order_relaxed)) {
+        leaderboard_repair(file);
+        locked = true;
+      }
+    }
+  }
+}
+
+/// @brief check the owner of the lock
+/// @param owner pid of the owner, 0 if the lock is free
+/// @return true if the lock is held by a process that does not exist any more
+bool get_owner_is_gone(const unsigned owner) {
+  return owner && kill((pid_t)owner, 0) != 0 && errno == ESRCH;
+}
+
+/// @brief release the lock
+/// @param file the leaderboard file
+void leaderboard_unlock(leaderboard_file_t *file) {
+  atomic_store_explicit(&file->lock, 0, memory_order_release);
+}
+
+/// @brief restore the heap order and the sequence after a process has died
+/// in the middle of a change
+/// @param file the leaderboard file, locked
+void leaderboard_repair(leaderboard_file_t *file) {
+  const int count = atomic_load(&file->count);
+  for (int i = count / 2 - 1; i >= 0; --i) {
+    leaderboard_sift_down(file->entries, count, i);
+  }
+  atomic_store(&file->min_score, count == (int)file->capacity
+                                     ? file->entries[0].score
+                                     : INT_MIN);
+  const unsigned sequence = atomic_load(&file->sequence);
+  atomic_store(&file->sequence, (sequence + 1) & ~1u);
+}
@@ -0,0 +1,68 @@
+#ifndef TETRIS_LEADERBOARD
+#define TETRIS_LEADERBOARD
+
+/// @file leaderboard.h
+/// @brief Declaration of the leaderboard shared by the processes. The file is
+/// a header and a fixed array of capacity records, mapped by every process
+/// that submits to it. The records are a min-heap on the rank, the root is the
+/// worst record on the board, so a submission takes O(log capacity) swaps.
+/// The rank of the root is also published apart: a full board rejects the
+/// scores below it without any locking, that is most of the submissions. The
+/// heap changes under a spinlock in the file holding the pid of the owner, a
+/// lock left by a dead process is taken over. Readers take no lock, the
+/// sequence counter is odd while the heap changes and a read racing a change
+/// is retried, a reader finding the change left by a dead process takes the
+/// lock over too. A record ranks higher with a higher score, then with an
+/// earlier timestamp
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#define LEADERBOARD_MAGIC "TTLB"
+#define LEADERBOARD_MAGIC_SIZE 4
+#define LEADERBOARD_FORMAT_VERSION 1
+#define LEADERBOARD_DEFAULT_CAPACITY 100
+#define LEADERBOARD_MAX_CAPACITY 65536
+#define LEADERBOARD_CACHE_LINE 64
+
+_Static_assert(ATOMIC_INT_LOCK_FREE == 2,
+               "the leaderboard lock is shared by the processes");
+
+/// @brief replay_id is the seed of the game, it names the game in a replay
+typedef struct {
+  int32_t score;
+  int32_t level;
+  int32_t lines;
+  int32_t reserved;
+  int64_t timestamp;
+  uint64_t replay_id;
+} leaderboard_entry_t;
+
+typedef struct {
+  char magic[LEADERBOARD_MAGIC_SIZE];
+  uint32_t version;
+  uint32_t capacity;
+  _Alignas(LEADERBOARD_CACHE_LINE) atomic_uint lock;
+  atomic_uint sequence;
+  atomic_int count;
+  atomic_int min_score;
+  _Alignas(LEADERBOARD_CACHE_LINE) leaderboard_entry_t entries[];
+} leaderboard_file_t;
+
+/// @brief The mapping of the file in this process
+typedef struct {
+  int fd;
+  size_t size;
+  leaderboard_file_t *file;
+} leaderboard_t;
+
+leaderboard_t *leaderboard_open(const char *path, const int capacity);
+void leaderboard_close(leaderboard_t *);
+bool leaderboard_submit(leaderboard_t *, const leaderboard_entry_t *);
+int leaderboard_read(const leaderboard_t *, leaderboard_entry_t *entries,
+                     const int max_count);
+void leaderboard_print(FILE *, const leaderboard_t *, const int count);
+
+#endif
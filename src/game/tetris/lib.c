@@ -1,106 +1,193 @@
 #include "lib.h"
 
 /// @file lib.c
-/// @brief Implementation of methods to operate with the tetris game object
+/// @brief Implementation of methods to operate with the tetris game object.
+/// The methods are thin wrappers over the default game context
 
-#include <stdlib.h>
+#include <stdio.h>
+#include <time.h>
 
-#include "../../common/time_utils.h"
-#include "backend.h"
-#include "defines.h"
-#include "fsm.h"
+#include "context.h"
+#include "search.h"
 
-/// @brief get ptr to the current game
-/// @return ptr to the current game
-tetris_game_t *get_current_game(void) {
-  static tetris_game_t game;
-  return &game;
+/// @brief get ptr to the default context
+/// @return ptr to the default context
+tetris_context_t *get_default_context(void) {
+  static tetris_context_t context;
+  return &context;
 }
 
-/// @brief get ptr to the user input QUEUE
-/// @return ptr to the queue
-bool *get_user_input_state_array(void) {
-  static bool user_input_state[USERACTIONS_COUNT];
-  return user_input_state;
+/// @brief save user input in the queue
+/// @param action user input id
+/// @param hold user input value
+void userInput(UserAction_t action, bool hold) {
+  tetris_context_user_input(get_default_context(), action, hold);
 }
 
-/// @brief get the value of an input in the queue
-/// @param input user input id
-/// @return value from the queue
-bool get_user_input_state(const int input) {
-  if (input < 0 || input >= USERACTIONS_COUNT) {
-    return false;
-  }
-  return get_user_input_state_array()[input];
+bool getGameHasFinished(void) {
+  return tetris_context_get_game_has_finished(get_default_context());
 }
+bool getGameOver(void) {
+  return tetris_context_get_game_over(get_default_context());
+}
+bool getPause(void) { return tetris_context_get_pause(get_default_context()); }
 
-/// @brief set the value of an input in the queue
-/// @param input user input id
-/// @param hold new value
-void set_user_input_state(const int input, bool hold) {
-  get_user_input_state_array()[input] = hold;
+/// @brief get the counter of the game changes
+/// @return the counter, unchanged if there is nothing new to draw
+unsigned long getGeneration(void) {
+  return tetris_context_get_generation(get_default_context());
 }
 
-/// @brief save user input in the queue
-/// @param action user input id
-/// @param hold user input value
-void userInput(UserAction_t action, bool hold) {
-  set_user_input_state(action, hold);
+/// @brief get the field rows changed since the previous call
+/// @return mask with the bit r set if the field row r changed
+unsigned long takeDirtyRows(void) {
+  return tetris_context_take_dirty_rows(get_default_context());
 }
 
-bool getGameHasFinished(void) { return fsm_get_state() == EXIT; }
-bool getGameOver(void) { return fsm_get_state() == GAMEOVER; }
-bool getPause(void) { return fsm_get_state() == PAUSE; }
+/// @brief get how long the game may be left without updates
+/// @return milliseconds to the autoshift, 0 to update right away, -1 to wait
+/// for the next input
+long getMsToNextUpdate(void) {
+  return tetris_context_get_ms_to_next_update(get_default_context());
+}
 
-unsigned long get_autoshift_interval_ms(const int level);
-unsigned long get_timespec_diff_ms(const struct timespec *later,
-                                   const struct timespec *earlier);
+/// @brief handle game update and return the updated state of the game
+/// @return updated game state
+GameInfo_t updateCurrentState(void) {
+  return tetris_context_update_current_state(get_default_context());
+}
 
-/// @brief update game state. autoshift if it is time to, otherwise apply user
-/// input from the queue
-/// @param
-void handle_game_update(void) {
-  static struct timespec previous_atoshift_sig;
-
-  fsm_input_t signal = NO_INPUT;
-  if (fsm_is_autoshift_available() &&
-      get_is_time_to_operate_ms_diff(
-          &previous_atoshift_sig,
-          get_autoshift_interval_ms(get_current_game()->game.level))) {
-    signal = AUTOSHIFT_SIG;
+/// @brief play the games of the default context with the heuristic autoplay
+/// @param move_ms milliseconds between the autoplay moves
+/// @param weights height,holes,bumpiness,wells,lines weights of the
+/// evaluator, NULL for the default ones
+/// @param beam_width width of the beam search over the current and the
+/// preview figure, 0 to evaluate the current figure only
+/// @return true if the weights could not be read or on malloc error
+bool startAutoplay(unsigned long move_ms, const char *weights,
+                   int beam_width) {
+  static autoplay_t autoplay;
+  static autoplay_weights_t autoplay_weights;
+  static search_t *search;
+  autoplay_weights = autoplay_default_weights;
+  if (weights && autoplay_parse_weights(weights, &autoplay_weights)) {
+    return true;
+  }
+  autoplay_init(&autoplay, autoplay_evaluate_heuristic, &autoplay_weights);
+  if (beam_width > 0 && !search) {
+    search_config_t config;
+    search_config_init(&config);
+    config.beam_width = beam_width;
+    search = search_create(&config);
+    if (!search) return true;
   }
-  if (!signal) {
-    for (int i = 0; !signal && i < USERACTIONS_COUNT; ++i) {
-      if (get_user_input_state(i)) {
-        signal = fsm_get_signal(i);
-        set_user_input_state(i, false);
-      }
-    }
+  if (beam_width > 0) {
+    search->config.beam_width = beam_width;
+    autoplay_set_search(&autoplay, search);
+  }
+  tetris_context_set_autoplay(get_default_context(), &autoplay, move_ms);
+  return false;
+}
+
+static fsm_stats_t fsm_stats;
+
+/// @brief account the FSM transitions and the backend call latencies of the
+/// default context
+void startFsmStats(void) {
+  fsm_stats_reset(&fsm_stats);
+  tetris_context_set_stats(get_default_context(), &fsm_stats);
+}
+
+/// @brief print the statistics accounted since startFsmStats()
+/// @param out where to print
+void printFsmStats(FILE *out) { fsm_stats_print(out, &fsm_stats); }
+
+static leaderboard_t *leaderboard;
+
+/// @brief submit the finished games of the default context to a leaderboard
+/// shared with the other processes
+/// @param path the leaderboard file, created if there is none
+/// @return true if the file could not be mapped or is not a leaderboard
+bool openLeaderboard(const char *path) {
+  if (leaderboard) return true;
+  leaderboard = leaderboard_open(path, LEADERBOARD_DEFAULT_CAPACITY);
+  tetris_context_set_leaderboard(get_default_context(), leaderboard);
+  return !leaderboard;
+}
+
+/// @brief print the best records of the leaderboard
+/// @param out where to print
+/// @param count number of the records to print
+void printLeaderboard(FILE *out, int count) {
+  if (leaderboard) leaderboard_print(out, leaderboard, count);
+}
+
+/// @brief stop submitting the games and unmap the leaderboard
+void closeLeaderboard(void) {
+  tetris_context_set_leaderboard(get_default_context(), NULL);
+  leaderboard_close(leaderboard);
+  leaderboard = NULL;
+}
+
+static spectator_hub_t *spectators;
+
+/// @brief publish the frames of the default context to the spectators
+/// connecting to a Unix domain socket
+/// @param path the socket file
+/// @return true if the socket could not be listened on or on malloc error
+bool startSpectating(const char *path) {
+  if (spectators) return true;
+  spectators = spectator_hub_create();
+  if (spectator_hub_listen(spectators, path)) {
+    spectator_hub_destroy(spectators);
+    spectators = NULL;
   }
-  fsm_apply_input(signal, get_current_game());
+  tetris_context_set_spectators(get_default_context(), spectators);
+  return !spectators;
+}
+
+/// @brief disconnect the spectators and remove the socket file
+void stopSpectating(void) {
+  tetris_context_set_spectators(get_default_context(), NULL);
+  spectator_hub_destroy(spectators);
+  spectators = NULL;
 }
 
-/// @brief get ammount of mseconds that should pass between the autoshifts
-/// @param level game level
-/// @return interval between autoshifts
-unsigned long get_autoshift_interval_ms(const int level) {
-  unsigned long interval = 1000;
-  if (level > 0 && level <= 10) {
-    interval -= 90 * level;
+static FILE *replay_file;
+static replay_writer_t *replay_writer;
+
+/// @brief record the games of the default context to a replay file
+/// @param path where to save the replay
+/// @return true on error
+bool startRecording(const char *path) {
+  if (replay_writer) return true;
+  replay_file = fopen(path, "wb");
+  replay_writer = replay_writer_create(replay_file);
+  if (!replay_writer && replay_file) {
+    fclose(replay_file);
+    replay_file = NULL;
   }
-  return interval;
+  tetris_context_set_recorder(get_default_context(), replay_writer);
+  return !replay_writer;
 }
 
-/// @brief handle game update and return the updated state of the game
-/// @return updated game state
-GameInfo_t updateCurrentState(void) {
-  handle_game_update();
-  return get_current_game()->game;
+/// @brief flush and close the replay file
+/// @return true if any write has failed
+bool stopRecording(void) {
+  if (!replay_writer) return true;
+  tetris_context_set_recorder(get_default_context(), NULL);
+  bool error = replay_writer_destroy(replay_writer);
+  error = fclose(replay_file) != 0 || error;
+  replay_writer = NULL;
+  replay_file = NULL;
+  return error;
 }
 
 /// @brief initialize the FSM
 /// @param
 void initGame(void) {
-  srand(time(NULL));
-  fsm_apply_input(NO_INPUT, get_current_game());
+  const tetris_setup_t setup = {(uint64_t)time(NULL), RANDOMIZER_UNIFORM,
+                                BOARD_STANDARD};
+  tetris_context_configure(get_default_context(), &setup);
+  tetris_context_init(get_default_context());
 }
@@ -4,11 +4,27 @@
 /// @file lib.h
 /// @brief Declaration of methods to operate with the tetris game object
 
+#include <stdio.h>
+
 #include "../lib.h"
 
 void initGame(void);
 bool getGameHasFinished(void);
 bool getGameOver(void);
 bool getPause(void);
+unsigned long getGeneration(void);
+unsigned long takeDirtyRows(void);
+long getMsToNextUpdate(void);
+bool startRecording(const char *path);
+bool stopRecording(void);
+bool startAutoplay(unsigned long move_ms, const char *weights,
+                   int beam_width);
+void startFsmStats(void);
+void printFsmStats(FILE *out);
+bool openLeaderboard(const char *path);
+void printLeaderboard(FILE *out, int count);
+void closeLeaderboard(void);
+bool startSpectating(const char *path);
+void stopSpectating(void);
 
 #endif
@@ -0,0 +1,408 @@
+#include "placement.h"
+
+/// @file placement.c
+/// @brief Implementation of the placement generator. The positions free of
+/// collisions are computed for all the columns of a row at once, then the
+/// reachable positions are flooded as column masks: a shift of a mask is a
+/// move to the side, the next row is a drop, the kicks move masks between
+/// the rotations. The flood is repeated until nothing changes, so the moves
+/// up by the kicks are followed too
+
+#include <string.h>
+
+#define PLACEMENT_ALL_COLUMNS \
+  ((placement_mask_t)((1u << PLACEMENT_COLUMNS) - 1))
+
+void placement_get_free_map(const row_mask_t *board, const int id,
+                            placement_map_t *free);
+void placement_flood(const placement_map_t *free, const int id,
+                     placement_map_t *reach, int rotation);
+void placement_flood_rotation(const placement_map_t *free, const int rotation,
+                              placement_map_t *reach);
+bool placement_flood_kicks(const placement_map_t *free, const int id,
+                           const int rotation, placement_map_t *reach);
+void placement_remove_duplicates(const int id, placement_map_t *land);
+placement_mask_t shift_columns(const placement_mask_t mask, const int dc);
+placement_mask_t spread_row(const placement_mask_t mask,
+                            const placement_mask_t free);
+
+/// @brief shift a column mask by dc columns to the right, the columns out of
+/// the map are dropped
+/// @param mask the mask
+/// @param dc the shift, may be negative
+/// @return shifted mask
+placement_mask_t shift_columns(const placement_mask_t mask, const int dc) {
+  const placement_mask_t shifted = dc >= 0 ? mask << dc : mask >> -dc;
+  return shifted & PLACEMENT_ALL_COLUMNS;
+}
+
+/// @brief find the positions of the figure box where the figure does not
+/// collide with the occupied cells and the field bounds. A figure cell in the
+/// box column j collides in the box columns of the blocked mask shifted by j.
+/// Above the stack only the walls block
+/// @param board the occupancy bitboard
+/// @param id figure id
+/// @param free where to save the positions
+void placement_get_free_map(const row_mask_t *board, const int id,
+                            placement_map_t *free) {
+  // the cell in the column x is the bit PLACEMENT_COLUMN_OFFSET + x
+  const placement_mask_t walls =
+      ((1u << PLACEMENT_COLUMN_OFFSET) - 1) | ~PLACEMENT_ALL_COLUMNS;
+  int stack_r = 0;
+  while (stack_r != FIELD_TOTAL_HEIGHT && !board[stack_r]) ++stack_r;
+  for (int rotation = 0; rotation != FIGURE_ROTATIONS_COUNT; ++rotation) {
+    const figure_shape_t *shape = get_figure_shape(id, rotation);
+    int cells_r[MAX_FIGURE_SIZE * MAX_FIGURE_SIZE];
+    int cells_c[MAX_FIGURE_SIZE * MAX_FIGURE_SIZE];
+    int cells_count = 0;
+    placement_mask_t wall_collision = 0;
+    for (int i = shape->top; i != shape->top + shape->height; ++i) {
+      for (int j = 0; j != MAX_FIGURE_SIZE; ++j) {
+        if ((shape->rows[i] >> j) & 1u) {
+          cells_r[cells_count] = i;
+          cells_c[cells_count++] = j;
+          wall_collision |= walls >> j;
+        }
+      }
+    }
+    for (int map_r = 0; map_r != PLACEMENT_ROWS; ++map_r) {
+      const int first_r = map_r - PLACEMENT_ROW_OFFSET + shape->top;
+      const int last_r = first_r + shape->height - 1;
+      placement_mask_t collision = PLACEMENT_ALL_COLUMNS;
+      if (first_r >= 0 && last_r < stack_r) {
+        collision = wall_collision;
+      } else if (first_r >= 0 && last_r < FIELD_TOTAL_HEIGHT) {
+        collision = wall_collision;
+        for (int k = 0; k != cells_count; ++k) {
+          const placement_mask_t row =
+              board[map_r - PLACEMENT_ROW_OFFSET + cells_r[k]];
+          collision |= (row << PLACEMENT_COLUMN_OFFSET) >> cells_c[k];
+        }
+      }
+      free->rows[rotation][map_r] = ~collision & PLACEMENT_ALL_COLUMNS;
+    }
+  }
+}
+
+/// @brief spread the positions of a row over the free runs they are in, as
+/// the moves to the sides do. Each step doubles the spread distance
+/// @param mask the positions
+/// @param free the positions without collisions
+/// @return the positions reachable by the moves to the sides
+placement_mask_t spread_row(const placement_mask_t mask,
+                            const placement_mask_t free) {
+  placement_mask_t right = mask;
+  placement_mask_t left = mask;
+  placement_mask_t right_free = free;
+  placement_mask_t left_free = free;
+  for (int step = 1; step < PLACEMENT_COLUMNS; step *= 2) {
+    right |= right_free & (right << step);
+    left |= left_free & (left >> step);
+    right_free &= right_free << step;
+    left_free &= left_free >> step;
+  }
+  return right | left;
+}
+
+/// @brief flood the positions of a rotation reachable by the drops and the
+/// moves to the sides. There are no moves up, so one sweep down is enough
+/// @param free positions without collisions
+/// @param rotation the rotation
+/// @param reach the reachable positions
+void placement_flood_rotation(const placement_map_t *free, const int rotation,
+                              placement_map_t *reach) {
+  const placement_mask_t *free_rows = free->rows[rotation];
+  placement_mask_t *reach_rows = reach->rows[rotation];
+  placement_mask_t above = 0;
+  for (int map_r = 0; map_r != PLACEMENT_ROWS; ++map_r) {
+    placement_mask_t mask = reach_rows[map_r] | (above & free_rows[map_r]);
+    // a row free from wall to wall is reached whole at once
+    if (mask && mask != free_rows[map_r]) {
+      mask = spread_row(mask, free_rows[map_r]);
+    }
+    reach_rows[map_r] = mask;
+    above = mask;
+  }
+}
+
+/// @brief add the positions reachable by a clockwise rotation. A position
+/// takes the first kick without a collision, as the backend does
+/// @param free positions without collisions
+/// @param id figure id
+/// @param rotation the rotation before the turn
+/// @param reach the reachable positions
+/// @return true if any position was added
+bool placement_flood_kicks(const placement_map_t *free, const int id,
+                           const int rotation, placement_map_t *reach) {
+  int kicks_count = 0;
+  const figure_kick_t *kicks = get_figure_kicks(id, rotation, &kicks_count);
+  const int next = (rotation + 1) % FIGURE_ROTATIONS_COUNT;
+  bool changed = false;
+  for (int map_r = 0; map_r != PLACEMENT_ROWS; ++map_r) {
+    placement_mask_t turning = reach->rows[rotation][map_r];
+    for (int k = 0; turning && k != kicks_count; ++k) {
+      const int target_r = map_r + kicks[k].r;
+      if (target_r < 0 || target_r >= PLACEMENT_ROWS) continue;
+      const placement_mask_t fits =
+          turning & shift_columns(free->rows[next][target_r], -kicks[k].c);
+      const placement_mask_t turned = shift_columns(fits, kicks[k].c);
+      if (turned & ~reach->rows[next][target_r]) {
+        reach->rows[next][target_r] |= turned;
+        changed = true;
+      }
+      turning &= ~fits;
+    }
+  }
+  return changed;
+}
+
+/// @brief flood all the positions reachable from the ones in reach
+/// @param free positions without collisions
+/// @param id figure id
+/// @param reach the reachable positions
+/// @param rotation the rotation of the start position
+void placement_flood(const placement_map_t *free, const int id,
+                     placement_map_t *reach, int rotation) {
+  // the kicks lead to the next rotation only, so the rotations are flooded
+  // in a cycle until a turn adds nothing new
+  bool changed = true;
+  while (changed) {
+    placement_flood_rotation(free, rotation, reach);
+    changed = placement_flood_kicks(free, id, rotation, reach);
+    rotation = (rotation + 1) % FIGURE_ROTATIONS_COUNT;
+  }
+}
+
+/// @brief remove the positions that cover the same cells as a position of
+/// a lower rotation. The rotations of O, and the opposite rotations of I, S
+/// and Z have the same shapes
+/// @param id figure id
+/// @param land the positions
+void placement_remove_duplicates(const int id, placement_map_t *land) {
+  for (int rotation = 1; rotation != FIGURE_ROTATIONS_COUNT; ++rotation) {
+    const figure_shape_t *shape = get_figure_shape(id, rotation);
+    bool duplicate = false;
+    for (int lower = 0; !duplicate && lower != rotation; ++lower) {
+      const figure_shape_t *other = get_figure_shape(id, lower);
+      duplicate = shape->height == other->height &&
+                  shape->width == other->width;
+      for (int i = 0; duplicate && i != shape->height; ++i) {
+        duplicate = shape->rows[shape->top + i] >> shape->left ==
+                    other->rows[other->top + i] >> other->left;
+      }
+      if (!duplicate) continue;
+      // the box at (r, c) covers the cells of the lower one at (r + dr, c + dc)
+      const int dr = shape->top - other->top;
+      const int dc = shape->left - other->left;
+      for (int map_r = 0; map_r != PLACEMENT_ROWS; ++map_r) {
+        const int other_r = map_r + dr;
+        if (other_r < 0 || other_r >= PLACEMENT_ROWS) continue;
+        land->rows[rotation][map_r] &=
+            ~shift_columns(land->rows[lower][other_r], -dc);
+      }
+    }
+  }
+}
+
+/// @brief find all the final resting positions reachable by the figure
+/// @param board the occupancy bitboard, FIELD_TOTAL_HEIGHT rows
+/// @param figure the figure at its current position
+/// @param placements where to save the positions, PLACEMENTS_MAX of them
+/// @return number of the positions, 0 if the figure collides already
+int placement_generate(const row_mask_t *board, const figure_t *figure,
+                       figure_t *placements) {
+  const int map_r = figure->position.r + PLACEMENT_ROW_OFFSET;
+  const int map_c = figure->position.c + PLACEMENT_COLUMN_OFFSET;
+  if (!get_figure_shape(figure->id, 0) || map_r < 0 ||
+      map_r >= PLACEMENT_ROWS || map_c < 0 || map_c >= PLACEMENT_COLUMNS) {
+    return 0;
+  }
+  placement_map_t free;
+  placement_get_free_map(board, figure->id, &free);
+  const int rotation = figure->rotation & (FIGURE_ROTATIONS_COUNT - 1);
+  placement_map_t reach;
+  memset(&reach, 0, sizeof(reach));
+  reach.rows[rotation][map_r] = free.rows[rotation][map_r] & (1u << map_c);
+  placement_flood(&free, figure->id, &reach, rotation);
+  // resting positions are the ones the figure can not drop from
+  placement_map_t land;
+  for (int rot = 0; rot != FIGURE_ROTATIONS_COUNT; ++rot) {
+    for (int r = 0; r != PLACEMENT_ROWS; ++r) {
+      const placement_mask_t below =
+          r + 1 < PLACEMENT_ROWS ? free.rows[rot][r + 1] : 0;
+      land.rows[rot][r] = reach.rows[rot][r] & ~below;
+    }
+  }
+  placement_remove_duplicates(figure->id, &land);
+  int count = 0;
+  for (int rot = 0; rot != FIGURE_ROTATIONS_COUNT; ++rot) {
+    for (int r = 0; r != PLACEMENT_ROWS; ++r) {
+      for (placement_mask_t m = land.rows[rot][r]; m; m &= m - 1) {
+        figure_t *placement = &placements[count++];
+        placement->id = figure->id;
+        placement->rotation = rot;
+        placement->position.r = r - PLACEMENT_ROW_OFFSET;
+        placement->position.c = __builtin_ctz(m) - PLACEMENT_COLUMN_OFFSET;
+      }
+    }
+  }
+  return count;
+}
+
+/// @brief find the shortest sequence of the FSM signals that moves the figure
+/// to the placement and locks it there. The autoshift is expected to happen
+/// only as the last signal of the path
+/// @param board the occupancy bitboard, FIELD_TOTAL_HEIGHT rows
+/// @param from the figure at its current position
+/// @param to the placement
+/// @param path where to save the signals, PLACEMENT_PATH_MAX of them
+/// @param positions where to save the figure after every move of the path,
+/// PLACEMENT_PATH_MAX of them, may be NULL
+/// @return number of the signals, -1 if the placement is not reachable
+int placement_find_path(const row_mask_t *board, const figure_t *from,
+                        const figure_t *to, fsm_input_t *path,
+                        figure_t *positions) {
+  if (!get_figure_shape(from->id, 0) || from->id != to->id) return -1;
+  placement_map_t free;
+  placement_get_free_map(board, from->id, &free);
+  // the positions are numbered (rotation, map row, map column)
+  int16_t parents[PLACEMENTS_MAX];
+  int16_t queue[PLACEMENTS_MAX];
+  unsigned char moves[PLACEMENTS_MAX];
+  memset(parents, -1, sizeof(parents));
+  const int start = ((from->rotation & (FIGURE_ROTATIONS_COUNT - 1)) *
+                         PLACEMENT_ROWS +
+                     from->position.r + PLACEMENT_ROW_OFFSET) *
+                        PLACEMENT_COLUMNS +
+                    from->position.c + PLACEMENT_COLUMN_OFFSET;
+  const int goal = ((to->rotation & (FIGURE_ROTATIONS_COUNT - 1)) *
+                        PLACEMENT_ROWS +
+                    to->position.r + PLACEMENT_ROW_OFFSET) *
+                       PLACEMENT_COLUMNS +
+                   to->position.c + PLACEMENT_COLUMN_OFFSET;
+  if (start < 0 || start >= PLACEMENTS_MAX || goal < 0 ||
+      goal >= PLACEMENTS_MAX) {
+    return -1;
+  }
+  int head = 0;
+  int tail = 0;
+  queue[tail++] = (int16_t)start;
+  parents[start] = (int16_t)start;
+  while (head != tail && parents[goal] < 0) {
+    const int node = queue[head++];
+    const int rotation = node / (PLACEMENT_ROWS * PLACEMENT_COLUMNS);
+    const int map_r = node / PLACEMENT_COLUMNS % PLACEMENT_ROWS;
+    const int map_c = node % PLACEMENT_COLUMNS;
+    int targets[4][3] = {{rotation, map_r, map_c - 1},
+                         {rotation, map_r, map_c + 1},
+                         {-1, 0, 0},
+                         {rotation, map_r + 1, map_c}};
+    int kicks_count = 0;
+    const figure_kick_t *kicks =
+        get_figure_kicks(from->id, rotation, &kicks_count);
+    const int next = (rotation + 1) % FIGURE_ROTATIONS_COUNT;
+    for (int k = 0; targets[2][0] < 0 && k != kicks_count; ++k) {
+      const int r = map_r + kicks[k].r;
+      const int c = map_c + kicks[k].c;
+      if (r >= 0 && r < PLACEMENT_ROWS && c >= 0 && c < PLACEMENT_COLUMNS &&
+          (free.rows[next][r] >> c) & 1u) {
+        targets[2][0] = next;
+        targets[2][1] = r;
+        targets[2][2] = c;
+      }
+    }
+    const fsm_input_t signals[4] = {MOVE_LEFT, MOVE_RIGHT, ROTATE_BTN,
+                                    MOVE_DOWN};
+    for (int m = 0; m != 4; ++m) {
+      const int rot = targets[m][0];
+      const int r = targets[m][1];
+      const int c = targets[m][2];
+      if (rot < 0 || r >= PLACEMENT_ROWS || c < 0 || c >= PLACEMENT_COLUMNS ||
+          !((free.rows[rot][r] >> c) & 1u)) {
+        continue;
+      }
+      const int target = (rot * PLACEMENT_ROWS + r) * PLACEMENT_COLUMNS + c;
+      if (parents[target] < 0) {
+        parents[target] = (int16_t)node;
+        moves[target] = (unsigned char)signals[m];
+        queue[tail++] = (int16_t)target;
+      }
+    }
+  }
+  if (parents[goal] < 0) return -1;
+  int length = 0;
+  for (int node = goal; node != start; node = parents[node]) ++length;
+  path[length] = AUTOSHIFT_SIG;
+  if (positions) positions[length] = *to;
+  int i = length;
+  for (int node = goal; node != start; node = parents[node]) {
+    path[--i] = (fsm_input_t)moves[node];
+    if (positions) {
+      positions[i].id = from->id;
+      positions[i].rotation = node / (PLACEMENT_ROWS * PLACEMENT_COLUMNS);
+      positions[i].position.r =
+          node / PLACEMENT_COLUMNS % PLACEMENT_ROWS - PLACEMENT_ROW_OFFSET;
+      positions[i].position.c =
+          node % PLACEMENT_COLUMNS - PLACEMENT_COLUMN_OFFSET;
+    }
+  }
+  return length + 1;
+}
+
+/// @brief lock the figure on the board and cut the filled rows, as the FSM
+/// does: a figure locked above the visible field ends the game, nothing is
+/// cut then
+/// @param board the occupancy bitboard, FIELD_TOTAL_HEIGHT rows
+/// @param figure the figure
+/// @param cut_rows where to save the number of the cut rows, may be NULL
+/// @return true if the game is over
+bool placement_lock(row_mask_t *board, const figure_t *figure,
+                    int *cut_rows) {
+  const figure_shape_t *shape = get_figure_shape(figure->id, figure->rotation);
+  if (cut_rows) *cut_rows = 0;
+  if (!shape) return false;
+  bitboard_place_rows(board, FIELD_TOTAL_HEIGHT, shape->rows + shape->top,
+                      shape->height, figure->position.r + shape->top,
+                      figure->position.c);
+  bool overflow = false;
+  for (int r = 0; !overflow && r != FIELD_UPPER_MARGIN; ++r) {
+    overflow = board[r] != 0;
+  }
+  int cut = 0;
+  for (int i = 0; !overflow && i != shape->height; ++i) {
+    const int r = figure->position.r + shape->top + i;
+    if (r >= 0 && r < FIELD_TOTAL_HEIGHT &&
+        bitboard_get_is_a_filled_row(board, r)) {
+      bitboard_shift_down_rows(board, r, 1);
+      ++cut;
+    }
+  }
+  if (cut_rows) *cut_rows = cut;
+  return overflow;
+}
+
+/// @brief count the sequences of placements of the given figures, as the
+/// perft of the chess engines does. The figures spawn as in the game, a
+/// placement that tops out the field ends the sequence
+/// @param board the occupancy bitboard, FIELD_TOTAL_HEIGHT rows
+/// @param ids figure ids, depth of them
+/// @param depth number of the figures to place
+/// @return number of the sequences of depth placements
+unsigned long placement_perft(const row_mask_t *board, const int *ids,
+                              const int depth) {
+  if (depth <= 0) return 1;
+  figure_t spawned;
+  backend_get_spawned_figure(ids[0], &spawned);
+  figure_t placements[PLACEMENTS_MAX];
+  const int count = placement_generate(board, &spawned, placements);
+  if (depth == 1) return (unsigned long)count;
+  unsigned long sequences = 0;
+  for (int i = 0; i != count; ++i) {
+    row_mask_t next_board[FIELD_TOTAL_HEIGHT];
+    memcpy(next_board, board, sizeof(next_board));
+    if (!placement_lock(next_board, &placements[i], NULL)) {
+      sequences += placement_perft(next_board, ids + 1, depth - 1);
+    }
+  }
+  return sequences;
+}
@@ -0,0 +1,53 @@
+#ifndef TETRIS_PLACEMENT
+#define TETRIS_PLACEMENT
+
+/// @file placement.h
+/// @brief Declaration of the placement generator. A placement is a final
+/// resting position of a figure - a position it may be locked in by the
+/// autoshift - that is reachable from the current position of the figure by
+/// the moves of the backend: left, right, the rotation with its kicks and the
+/// drop, tucks and spins included. Positions with the same cells are reported
+/// once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "backend.h"
+#include "bitboard.h"
+#include "defines.h"
+#include "figures.h"
+#include "fsm.h"
+
+// the figure box may stick out of the field by MAX_FIGURE_SIZE - 1 cells
+// to the left and to the top, its row r is PLACEMENT_ROW_OFFSET + r in the
+// maps, its column c is the bit PLACEMENT_COLUMN_OFFSET + c
+#define PLACEMENT_ROW_OFFSET (MAX_FIGURE_SIZE - 1)
+#define PLACEMENT_COLUMN_OFFSET (MAX_FIGURE_SIZE - 1)
+#define PLACEMENT_ROWS (FIELD_TOTAL_HEIGHT + PLACEMENT_ROW_OFFSET)
+#define PLACEMENT_COLUMNS (FIELD_WIDTH + PLACEMENT_COLUMN_OFFSET)
+#define PLACEMENTS_MAX \
+  (FIGURE_ROTATIONS_COUNT * PLACEMENT_ROWS * PLACEMENT_COLUMNS)
+// a path visits every position at most once and ends with the lock
+#define PLACEMENT_PATH_MAX (PLACEMENTS_MAX + 1)
+
+typedef uint32_t placement_mask_t;
+_Static_assert(PLACEMENT_COLUMNS + MAX_FIGURE_SIZE <= 32,
+               "a placement map row does not fit the mask");
+
+/// @brief Positions of the figure box, a mask of the columns per rotation and
+/// row
+typedef struct {
+  placement_mask_t rows[FIGURE_ROTATIONS_COUNT][PLACEMENT_ROWS];
+} placement_map_t;
+
+int placement_generate(const row_mask_t *board, const figure_t *figure,
+                       figure_t *placements);
+int placement_find_path(const row_mask_t *board, const figure_t *from,
+                        const figure_t *to, fsm_input_t *path,
+                        figure_t *positions);
+bool placement_lock(row_mask_t *board, const figure_t *figure,
+                    int *cut_rows);
+unsigned long placement_perft(const row_mask_t *board, const int *ids,
+                              const int depth);
+
+#endif
@@ -0,0 +1,147 @@
+#include "randomizer.h"
+
+/// @file randomizer.c
+/// @brief Implementation of the figures randomizers
+
+#include <stdbool.h>
+#include <string.h>
+
+// figure ids as in the figures tables
+#define S_FIGURE_ID 4
+#define Z_FIGURE_ID 6
+#define O_FIGURE_ID 3
+
+/// @brief splitmix64 step, used to expand a seed to the generator state and to
+/// derive seeds from seeds
+/// @param state splitmix64 state
+/// @return next value
+uint64_t splitmix_next(uint64_t *state) {
+  uint64_t z = (*state += 0x9e3779b97f4a7c15ull);
+  z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+  z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+  return z ^ (z >> 31);
+}
+
+/// @brief seed the generator
+/// @param generator the generator
+/// @param seed any value, zero included
+void xoshiro_seed(xoshiro256_t *generator, uint64_t seed) {
+  uint64_t state = seed;
+  for (int i = 0; i != 4; ++i) {
+    generator->s[i] = splitmix_next(&state);
+  }
+}
+
+/// @brief rotate left
+/// @param x value to rotate
+/// @param k number of bits, 1 to 63
+/// @return rotated value
+uint64_t rotl(const uint64_t x, const int k) {
+  return (x << k) | (x >> (64 - k));
+}
+
+/// @brief xoshiro256** step
+/// @param generator the generator
+/// @return next pseudo random value
+uint64_t xoshiro_next(xoshiro256_t *generator) {
+  uint64_t *s = generator->s;
+  const uint64_t result = rotl(s[1] * 5, 7) * 9;
+  const uint64_t t = s[1] << 17;
+  s[2] ^= s[0];
+  s[3] ^= s[1];
+  s[1] ^= s[2];
+  s[0] ^= s[3];
+  s[2] ^= t;
+  s[3] = rotl(s[3], 45);
+  return result;
+}
+
+/// @brief get a pseudo random value in [0, bound) by the multiply-shift
+/// reduction of the upper 32 bits, no division involved
+/// @param generator the generator
+/// @param bound upper bound, not included
+/// @return the value
+uint32_t xoshiro_below(xoshiro256_t *generator, uint32_t bound) {
+  const uint64_t value = xoshiro_next(generator) >> 32;
+  return (uint32_t)((value * bound) >> 32);
+}
+
+/// @brief prepare the randomizer for a new game
+/// @param randomizer the randomizer
+/// @param kind randomizer kind
+/// @param seed game seed
+void randomizer_init(randomizer_t *randomizer, randomizer_kind_t kind,
+                     uint64_t seed) {
+  memset(randomizer, 0, sizeof(randomizer_t));
+  randomizer->kind = kind;
+  xoshiro_seed(&randomizer->generator, seed);
+  for (int i = 0; i != RANDOMIZER_HISTORY_SIZE; ++i) {
+    randomizer->history[i] = Z_FIGURE_ID;
+  }
+}
+
+/// @brief deal a figure from the bag, refill and shuffle it when it is empty
+/// @param randomizer the randomizer
+/// @return figure id
+int randomizer_next_from_bag(randomizer_t *randomizer) {
+  if (!randomizer->bag_left) {
+    for (int i = 0; i != ALLOWED_FIGURES_COUNT; ++i) {
+      randomizer->bag[i] = i;
+    }
+    for (int i = ALLOWED_FIGURES_COUNT - 1; i > 0; --i) {
+      const int j = (int)xoshiro_below(&randomizer->generator, i + 1);
+      const int tmp = randomizer->bag[i];
+      randomizer->bag[i] = randomizer->bag[j];
+      randomizer->bag[j] = tmp;
+    }
+    randomizer->bag_left = ALLOWED_FIGURES_COUNT;
+  }
+  return randomizer->bag[--randomizer->bag_left];
+}
+
+/// @brief roll a figure that is not in the history, giving up after
+/// RANDOMIZER_HISTORY_ROLLS rolls. The first figure is never S, Z or O
+/// @param randomizer the randomizer
+/// @return figure id
+int randomizer_next_from_history(randomizer_t *randomizer) {
+  int id = 0;
+  if (!randomizer->dealt) {
+    do {
+      id = (int)xoshiro_below(&randomizer->generator, ALLOWED_FIGURES_COUNT);
+    } while (id == S_FIGURE_ID || id == Z_FIGURE_ID || id == O_FIGURE_ID);
+  } else {
+    bool accepted = false;
+    for (int roll = 0; !accepted && roll != RANDOMIZER_HISTORY_ROLLS;
+         ++roll) {
+      id = (int)xoshiro_below(&randomizer->generator, ALLOWED_FIGURES_COUNT);
+      accepted = true;
+      for (int i = 0; accepted && i != RANDOMIZER_HISTORY_SIZE; ++i) {
+        accepted = randomizer->history[i] != id;
+      }
+    }
+  }
+  memmove(randomizer->history + 1, randomizer->history,
+          sizeof(int) * (RANDOMIZER_HISTORY_SIZE - 1));
+  randomizer->history[0] = id;
+  return id;
+}
+
+/// @brief get the next figure of the game
+/// @param randomizer the randomizer
+/// @return figure id
+int randomizer_next(randomizer_t *randomizer) {
+  int id = 0;
+  switch (randomizer->kind) {
+    case RANDOMIZER_BAG:
+      id = randomizer_next_from_bag(randomizer);
+      break;
+    case RANDOMIZER_HISTORY:
+      id = randomizer_next_from_history(randomizer);
+      break;
+    default:
+      id = (int)xoshiro_below(&randomizer->generator, ALLOWED_FIGURES_COUNT);
+      break;
+  }
+  ++randomizer->dealt;
+  return id;
+}
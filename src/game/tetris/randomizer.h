@@ -0,0 +1,46 @@
+#ifndef TETRIS_RANDOMIZER
+#define TETRIS_RANDOMIZER
+
+/// @file randomizer.h
+/// @brief Declaration of the figures randomizers. All of them are driven by a
+/// per-game xoshiro256** generator, so a seed gives the same figures sequence
+/// on every machine
+
+#include <stdint.h>
+
+#include "defines.h"
+
+#define RANDOMIZER_HISTORY_SIZE 4
+#define RANDOMIZER_HISTORY_ROLLS 4
+
+typedef struct {
+  uint64_t s[4];
+} xoshiro256_t;
+
+/// @brief RANDOMIZER_UNIFORM - every figure is equally likely.
+/// RANDOMIZER_BAG - figures are dealt from shuffled bags of all the 7.
+/// RANDOMIZER_HISTORY - rerolls figures that are among the last 4, TGM-like
+typedef enum {
+  RANDOMIZER_UNIFORM = 0,
+  RANDOMIZER_BAG,
+  RANDOMIZER_HISTORY
+} randomizer_kind_t;
+
+typedef struct {
+  randomizer_kind_t kind;
+  xoshiro256_t generator;
+  int bag[ALLOWED_FIGURES_COUNT];
+  int bag_left;
+  int history[RANDOMIZER_HISTORY_SIZE];
+  int dealt;
+} randomizer_t;
+
+uint64_t splitmix_next(uint64_t *state);
+void xoshiro_seed(xoshiro256_t *, uint64_t seed);
+uint64_t xoshiro_next(xoshiro256_t *);
+uint32_t xoshiro_below(xoshiro256_t *, uint32_t bound);
+
+void randomizer_init(randomizer_t *, randomizer_kind_t kind, uint64_t seed);
+int randomizer_next(randomizer_t *);
+
+#endif
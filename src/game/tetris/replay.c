@@ -0,0 +1,371 @@
+#include "replay.h"
+
+/// @file replay.c
+/// @brief Implementation of the binary replay format, its streaming writer
+/// and its reader
+
+#include <stdlib.h>
+#include <string.h>
+
+#define REPLAY_CODE_BITS 4
+#define REPLAY_CODE_MASK 0xFu
+
+_Static_assert(BOARD_KINDS_COUNT <= 16 && RANDOMIZER_HISTORY < 16,
+               "the setup byte packs the randomizer and the board");
+
+void *replay_writer_routine(void *arg);
+void replay_writer_submit_block(replay_writer_t *writer);
+unsigned char *replay_writer_reserve(replay_writer_t *writer);
+void replay_writer_flush_run(replay_writer_t *writer);
+size_t replay_put_u64(unsigned char *buffer, uint64_t value);
+bool replay_reader_get_setup(replay_reader_t *reader, tetris_setup_t *setup);
+bool replay_reader_get_u64(replay_reader_t *reader, uint64_t *value);
+bool replay_reader_get_varint(replay_reader_t *reader, uint64_t *value);
+
+/// @brief write an unsigned LEB128 varint
+/// @param buffer where to write, at least 10 bytes
+/// @param value the value
+/// @return number of bytes written
+size_t replay_put_varint(unsigned char *buffer, uint64_t value) {
+  size_t size = 0;
+  while (value >= 0x80) {
+    buffer[size++] = (unsigned char)(value | 0x80);
+    value >>= 7;
+  }
+  buffer[size++] = (unsigned char)value;
+  return size;
+}
+
+/// @brief read an unsigned LEB128 varint
+/// @param buffer where to read from
+/// @param size bytes available
+/// @param value where to save the value
+/// @return number of bytes read, 0 if the varint is truncated or too long
+size_t replay_get_varint(const unsigned char *buffer, size_t size,
+                         uint64_t *value) {
+  uint64_t result = 0;
+  size_t read = 0;
+  bool done = false;
+  while (!done && read < size && read < 10) {
+    result |= (uint64_t)(buffer[read] & 0x7F) << (7 * read);
+    done = !(buffer[read] & 0x80);
+    ++read;
+  }
+  *value = result;
+  return done ? read : 0;
+}
+
+/// @brief write a little endian 64 bit number
+/// @param buffer where to write, at least 8 bytes
+/// @param value the value
+/// @return number of bytes written
+size_t replay_put_u64(unsigned char *buffer, uint64_t value) {
+  for (int i = 0; i != 8; ++i) {
+    buffer[i] = (unsigned char)(value >> (8 * i));
+  }
+  return 8;
+}
+
+/// @brief create the writer, write the file header and start the writer
+/// thread
+/// @param file file open for writing, the writer does not close it
+/// @return the writer, NULL on error
+replay_writer_t *replay_writer_create(FILE *file) {
+  if (!file) return NULL;
+  replay_writer_t *writer = calloc(1, sizeof(replay_writer_t));
+  if (!writer) return NULL;
+  writer->file = file;
+  bool error = pthread_mutex_init(&writer->lock, NULL) != 0;
+  if (!error && pthread_cond_init(&writer->changed, NULL)) {
+    pthread_mutex_destroy(&writer->lock);
+    error = true;
+  }
+  if (!error &&
+      pthread_create(&writer->thread, NULL, replay_writer_routine, writer)) {
+    pthread_cond_destroy(&writer->changed);
+    pthread_mutex_destroy(&writer->lock);
+    error = true;
+  }
+  if (error) {
+    free(writer);
+    writer = NULL;
+  } else {
+    replay_block_t *block = &writer->blocks[writer->filling];
+    memcpy(block->data, REPLAY_MAGIC, REPLAY_MAGIC_SIZE);
+    block->size = REPLAY_MAGIC_SIZE;
+    block->data[block->size++] = REPLAY_FORMAT_VERSION;
+    block->size += replay_put_varint(block->data + block->size,
+                                     TETRIS_ENGINE_VERSION);
+  }
+  return writer;
+}
+
+/// @brief flush everything recorded, stop the writer thread and free the
+/// writer. A game still in progress is left without the end record
+/// @param writer the writer
+/// @return true if any write has failed
+bool replay_writer_destroy(replay_writer_t *writer) {
+  if (!writer) return true;
+  replay_writer_flush_run(writer);
+  if (writer->blocks[writer->filling].size) {
+    replay_writer_submit_block(writer);
+  }
+  pthread_mutex_lock(&writer->lock);
+  writer->closing = true;
+  pthread_cond_broadcast(&writer->changed);
+  pthread_mutex_unlock(&writer->lock);
+  pthread_join(writer->thread, NULL);
+  pthread_cond_destroy(&writer->changed);
+  pthread_mutex_destroy(&writer->lock);
+  const bool error = writer->error || fflush(writer->file) != 0;
+  free(writer);
+  return error;
+}
+
+/// @brief write the queued blocks to the file until the writer is closed
+/// @param arg the writer
+/// @return NULL
+void *replay_writer_routine(void *arg) {
+  replay_writer_t *writer = arg;
+  pthread_mutex_lock(&writer->lock);
+  while (!writer->closing || writer->queued_count) {
+    if (!writer->queued_count) {
+      pthread_cond_wait(&writer->changed, &writer->lock);
+    } else {
+      replay_block_t *block = &writer->blocks[writer->queued_first];
+      pthread_mutex_unlock(&writer->lock);
+      const bool error =
+          fwrite(block->data, 1, block->size, writer->file) != block->size;
+      pthread_mutex_lock(&writer->lock);
+      writer->error = writer->error || error;
+      writer->queued_first = (writer->queued_first + 1) % REPLAY_BLOCKS_COUNT;
+      --writer->queued_count;
+      pthread_cond_broadcast(&writer->changed);
+    }
+  }
+  pthread_mutex_unlock(&writer->lock);
+  return NULL;
+}
+
+/// @brief queue the filling block to the writer thread and take the next
+/// one, wait for a free block if all of them are queued
+/// @param writer the writer
+void replay_writer_submit_block(replay_writer_t *writer) {
+  pthread_mutex_lock(&writer->lock);
+  ++writer->queued_count;
+  pthread_cond_broadcast(&writer->changed);
+  while (writer->queued_count == REPLAY_BLOCKS_COUNT) {
+    pthread_cond_wait(&writer->changed, &writer->lock);
+  }
+  writer->filling =
+      (writer->queued_first + writer->queued_count) % REPLAY_BLOCKS_COUNT;
+  pthread_mutex_unlock(&writer->lock);
+  writer->blocks[writer->filling].size = 0;
+}
+
+/// @brief get space for an entry in the filling block
+/// @param writer the writer
+/// @return where to write REPLAY_MAX_ENTRY_SIZE bytes at most
+unsigned char *replay_writer_reserve(replay_writer_t *writer) {
+  if (REPLAY_BLOCK_SIZE - writer->blocks[writer->filling].size <
+      REPLAY_MAX_ENTRY_SIZE) {
+    replay_writer_submit_block(writer);
+  }
+  replay_block_t *block = &writer->blocks[writer->filling];
+  return block->data + block->size;
+}
+
+/// @brief write the pending run of autoshifts as one entry
+/// @param writer the writer
+void replay_writer_flush_run(replay_writer_t *writer) {
+  if (!writer->run_count) return;
+  unsigned char *entry = replay_writer_reserve(writer);
+  size_t size = replay_put_varint(
+      entry, (writer->run_delta_ms << REPLAY_CODE_BITS) | AUTOSHIFT_SIG);
+  size += replay_put_varint(entry + size, writer->run_count - 1);
+  writer->blocks[writer->filling].size += size;
+  writer->run_count = 0;
+}
+
+/// @brief record a signal the game is about to apply. A START_BTN in the START
+/// or GAMEOVER state begins a game, the signals are recorded in a game only
+/// @param writer the writer
+/// @param now_ms current time of the context clock
+/// @param signal the signal
+/// @param before FSM state the signal is applied at
+/// @param game the game the signal is applied to
+void replay_writer_record_signal(replay_writer_t *writer, unsigned long now_ms,
+                                 fsm_input_t signal, tetris_state_t before,
+                                 const tetris_game_t *game) {
+  if (!writer || signal == NO_INPUT) return;
+  if (signal == START_BTN && (before == START || before == GAMEOVER)) {
+    unsigned char *entry = replay_writer_reserve(writer);
+    size_t size = replay_put_varint(entry, 0);
+    entry[size++] = REPLAY_RECORD_GAME_START;
+    size += replay_put_u64(entry + size, game->setup.seed);
+    entry[size++] = (unsigned char)(game->setup.randomizer & 0x0F) |
+                    (unsigned char)(game->setup.board << 4);
+    writer->blocks[writer->filling].size += size;
+    writer->in_game = true;
+    writer->last_ms = now_ms;
+  } else if (writer->in_game) {
+    const unsigned long delta_ms = now_ms - writer->last_ms;
+    writer->last_ms = now_ms;
+    if (signal == AUTOSHIFT_SIG) {
+      if (!writer->run_count) writer->run_delta_ms = delta_ms;
+      ++writer->run_count;
+    } else {
+      replay_writer_flush_run(writer);
+      unsigned char *entry = replay_writer_reserve(writer);
+      writer->blocks[writer->filling].size += replay_put_varint(
+          entry, ((uint64_t)delta_ms << REPLAY_CODE_BITS) | signal);
+    }
+  }
+}
+
+/// @brief record the end of the game when the FSM gets to GAMEOVER or exits
+/// @param writer the writer
+/// @param now_ms current time of the context clock
+/// @param after FSM state after a signal is applied
+/// @param game the game
+void replay_writer_record_state(replay_writer_t *writer, unsigned long now_ms,
+                                tetris_state_t after,
+                                const tetris_game_t *game) {
+  if (!writer || !writer->in_game) return;
+  if (after != GAMEOVER && after != PREEXIT && after != EXIT) return;
+  replay_writer_flush_run(writer);
+  unsigned char *entry = replay_writer_reserve(writer);
+  size_t size = replay_put_varint(
+      entry, (uint64_t)(now_ms - writer->last_ms) << REPLAY_CODE_BITS);
+  entry[size++] = REPLAY_RECORD_GAME_END;
+  size += replay_put_varint(entry + size, (uint64_t)game->game.score);
+  size += replay_put_u64(entry + size, backend_get_board_hash(game));
+  writer->blocks[writer->filling].size += size;
+  writer->in_game = false;
+}
+
+/// @brief check the file header and prepare to read the games
+/// @param reader the reader
+/// @param data the replay
+/// @param size size of the replay
+/// @return true if it is not a replay of a known format version
+bool replay_reader_init(replay_reader_t *reader, const void *data,
+                        size_t size) {
+  memset(reader, 0, sizeof(replay_reader_t));
+  reader->data = data;
+  reader->size = size;
+  bool error = size < REPLAY_MAGIC_SIZE + 1 ||
+               memcmp(data, REPLAY_MAGIC, REPLAY_MAGIC_SIZE);
+  if (!error) {
+    reader->format_version = reader->data[REPLAY_MAGIC_SIZE];
+    error = reader->format_version < REPLAY_FORMAT_VERSION_STANDARD_BOARD ||
+            reader->format_version > REPLAY_FORMAT_VERSION;
+  }
+  if (!error) {
+    uint64_t version = 0;
+    const size_t read =
+        replay_get_varint(reader->data + REPLAY_MAGIC_SIZE + 1,
+                          size - REPLAY_MAGIC_SIZE - 1, &version);
+    error = !read;
+    reader->engine_version = (unsigned long)version;
+    reader->position = REPLAY_MAGIC_SIZE + 1 + read;
+  }
+  reader->error = error;
+  return error;
+}
+
+/// @brief read a little endian 64 bit number
+/// @param reader the reader
+/// @param value where to save the value
+/// @return true if the data is truncated
+bool replay_reader_get_u64(replay_reader_t *reader, uint64_t *value) {
+  bool error = reader->size - reader->position < 8;
+  if (!error) {
+    *value = 0;
+    for (int i = 0; i != 8; ++i) {
+      *value |= (uint64_t)reader->data[reader->position + i] << (8 * i);
+    }
+    reader->position += 8;
+  }
+  return error;
+}
+
+/// @brief read a varint
+/// @param reader the reader
+/// @param value where to save the value
+/// @return true if the data is truncated
+bool replay_reader_get_varint(replay_reader_t *reader, uint64_t *value) {
+  const size_t read =
+      replay_get_varint(reader->data + reader->position,
+                        reader->size - reader->position, value);
+  reader->position += read;
+  return !read;
+}
+
+/// @brief read the setup byte of a start record, the games of format version
+/// 1 are played on the standard board
+/// @param reader the reader
+/// @param setup where to save the randomizer and the board
+/// @return true if the data is truncated or the kinds are unknown
+bool replay_reader_get_setup(replay_reader_t *reader, tetris_setup_t *setup) {
+  bool error = reader->position == reader->size;
+  unsigned randomizer = 0;
+  unsigned board = BOARD_STANDARD;
+  if (!error) {
+    const unsigned char byte = reader->data[reader->position++];
+    randomizer = byte;
+    if (reader->format_version != REPLAY_FORMAT_VERSION_STANDARD_BOARD) {
+      randomizer = byte & 0x0Fu;
+      board = byte >> 4;
+    }
+    error = randomizer > RANDOMIZER_HISTORY || board >= BOARD_KINDS_COUNT;
+  }
+  if (!error) {
+    setup->randomizer = (randomizer_kind_t)randomizer;
+    setup->board = (board_kind_t)board;
+  }
+  return error;
+}
+
+/// @brief read the next entry
+/// @param reader the reader
+/// @param event where to save the entry
+/// @return true if an entry is read, false at the end of the replay or on
+/// corrupted data, reader->error tells which
+bool replay_reader_next(replay_reader_t *reader, replay_event_t *event) {
+  if (reader->error || reader->position == reader->size) return false;
+  memset(event, 0, sizeof(replay_event_t));
+  uint64_t head = 0;
+  bool error = replay_reader_get_varint(reader, &head);
+  const unsigned code = (unsigned)(head & REPLAY_CODE_MASK);
+  event->delta_ms = (unsigned long)(head >> REPLAY_CODE_BITS);
+  if (!error && code) {
+    error = code > AUTOSHIFT_SIG;
+    event->kind = REPLAY_EVENT_SIGNAL;
+    event->signal = (fsm_input_t)code;
+    event->count = 1;
+    uint64_t repeats = 0;
+    if (!error && code == AUTOSHIFT_SIG) {
+      error = replay_reader_get_varint(reader, &repeats);
+      event->count += (unsigned long)repeats;
+    }
+  } else if (!error) {
+    error = reader->position == reader->size;
+    const int record = error ? 0 : reader->data[reader->position++];
+    uint64_t value = 0;
+    if (record == REPLAY_RECORD_GAME_START) {
+      event->kind = REPLAY_EVENT_GAME_START;
+      error = replay_reader_get_u64(reader, &event->setup.seed) ||
+              replay_reader_get_setup(reader, &event->setup);
+    } else if (record == REPLAY_RECORD_GAME_END) {
+      event->kind = REPLAY_EVENT_GAME_END;
+      error = replay_reader_get_varint(reader, &value) ||
+              replay_reader_get_u64(reader, &event->board_hash);
+      event->score = (int)value;
+    } else {
+      error = true;
+    }
+  }
+  reader->error = error;
+  return !error;
+}
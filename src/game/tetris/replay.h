@@ -0,0 +1,114 @@
+#ifndef TETRIS_REPLAY
+#define TETRIS_REPLAY
+
+/// @file replay.h
+/// @brief Declaration of the binary replay format, its streaming writer and
+/// its reader.
+///
+/// A replay is the file header followed by the games. The header is the
+/// "TTRP" magic, the format version byte and the engine version varint. A
+/// game is a start record, the FSM signals applied in the game and an end
+/// record. Every entry starts with the varint (delta_ms << 4 | code), where
+/// delta_ms is the time since the previous entry on the context clock:
+/// - code 1..8 is the applied fsm_input_t signal. An autoshift is followed by
+///   the varint count - 1 of the autoshifts in a row, without any other signal
+///   between them
+/// - code 0 is a record, followed by the record type byte. The start record
+///   has the 8 bytes of the seed and the setup byte: the randomizer in the low
+///   nibble and the board kind in the high one, the end record has the score
+///   varint and the 8 bytes of the board hash
+/// Multi byte numbers are little endian, varints are unsigned LEB128. The
+/// setup byte of format version 1 is the randomizer alone, its games are read
+/// as the games of the standard board
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "backend.h"
+#include "fsm.h"
+
+#define REPLAY_MAGIC "TTRP"
+#define REPLAY_MAGIC_SIZE 4
+#define REPLAY_FORMAT_VERSION 2
+// the oldest version read, before the board kinds
+#define REPLAY_FORMAT_VERSION_STANDARD_BOARD 1
+#define REPLAY_BLOCK_SIZE 65536
+#define REPLAY_BLOCKS_COUNT 4
+// more than any entry takes
+#define REPLAY_MAX_ENTRY_SIZE 32
+
+typedef enum {
+  REPLAY_RECORD_GAME_START = 1,
+  REPLAY_RECORD_GAME_END
+} replay_record_t;
+
+typedef struct {
+  unsigned char data[REPLAY_BLOCK_SIZE];
+  size_t size;
+} replay_block_t;
+
+/// @brief The game thread encodes the entries to the filling block, the full
+/// blocks are queued to the writer thread and written to the file. The game
+/// thread waits only if all the blocks are queued
+typedef struct {
+  FILE *file;
+  pthread_t thread;
+  pthread_mutex_t lock;
+  pthread_cond_t changed;
+  replay_block_t blocks[REPLAY_BLOCKS_COUNT];
+  int filling;
+  int queued_first;
+  int queued_count;
+  bool closing;
+  bool error;
+  bool in_game;
+  unsigned long last_ms;
+  unsigned long run_delta_ms;
+  unsigned long run_count;
+} replay_writer_t;
+
+typedef enum {
+  REPLAY_EVENT_GAME_START = 0,
+  REPLAY_EVENT_SIGNAL,
+  REPLAY_EVENT_GAME_END
+} replay_event_kind_t;
+
+typedef struct {
+  replay_event_kind_t kind;
+  unsigned long delta_ms;
+  fsm_input_t signal;
+  unsigned long count;
+  tetris_setup_t setup;
+  int score;
+  uint64_t board_hash;
+} replay_event_t;
+
+/// @brief Reads a replay from memory, e.g. from a mapped file
+typedef struct {
+  const unsigned char *data;
+  size_t size;
+  size_t position;
+  int format_version;
+  unsigned long engine_version;
+  bool error;
+} replay_reader_t;
+
+replay_writer_t *replay_writer_create(FILE *file);
+bool replay_writer_destroy(replay_writer_t *);
+void replay_writer_record_signal(replay_writer_t *, unsigned long now_ms,
+                                 fsm_input_t signal, tetris_state_t before,
+                                 const tetris_game_t *);
+void replay_writer_record_state(replay_writer_t *, unsigned long now_ms,
+                                tetris_state_t after, const tetris_game_t *);
+
+size_t replay_put_varint(unsigned char *buffer, uint64_t value);
+size_t replay_get_varint(const unsigned char *buffer, size_t size,
+                         uint64_t *value);
+
+bool replay_reader_init(replay_reader_t *, const void *data, size_t size);
+bool replay_reader_next(replay_reader_t *, replay_event_t *);
+
+#endif
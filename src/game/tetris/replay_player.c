@@ -0,0 +1,72 @@
+#include "replay_player.h"
+
+/// @file replay_player.c
+/// @brief Implementation of the replay player
+
+#include <string.h>
+
+/// @brief play the next recorded game. The context must be in the START or
+/// GAMEOVER state, its clock is replaced with a manual one. The context is
+/// left in the GAMEOVER state, as a game recorded stopped before its end is
+/// finished as if it was over
+/// @param reader reader positioned at a game start record
+/// @param context the context to play in
+/// @param result where to save the recorded and the replayed game ends
+/// @return true if the replay is corrupted or ends before the game does
+bool replay_play_game(replay_reader_t *reader, tetris_context_t *context,
+                      replay_game_result_t *result) {
+  if (!reader || !context || !result) return true;
+  if (context->core.state != START && context->core.state != GAMEOVER) {
+    return true;
+  }
+  memset(result, 0, sizeof(replay_game_result_t));
+  replay_event_t event = {0};
+  bool error = !replay_reader_next(reader, &event) ||
+               event.kind != REPLAY_EVENT_GAME_START;
+  if (!error) {
+    game_clock_t clock = {0};
+    game_clock_init(&clock, GAME_CLOCK_MANUAL, 1);
+    tetris_context_set_clock(context, &clock);
+    tetris_context_set_recorder(context, NULL);
+    tetris_context_configure(context, &event.setup);
+    tetris_context_apply_signal(context, START_BTN);
+  }
+  bool finished = false;
+  while (!error && !finished) {
+    error = !replay_reader_next(reader, &event) ||
+            event.kind == REPLAY_EVENT_GAME_START;
+    if (!error) {
+      tetris_context_advance_clock_ms(context, event.delta_ms);
+    }
+    if (!error && event.kind == REPLAY_EVENT_SIGNAL) {
+      for (unsigned long i = 0; i != event.count; ++i) {
+        tetris_context_apply_signal(context, event.signal);
+      }
+      result->signals += (long)event.count;
+    } else if (!error) {
+      finished = true;
+    }
+  }
+  if (!error) {
+    // the live game passes the intermediate states between the signals
+    while (!fsm_is_waiting_for_input(context->core.state)) {
+      tetris_context_apply_signal(context, NO_INPUT);
+    }
+    if (context->core.state != EXIT) context->core.state = GAMEOVER;
+    result->score = context->core.game.game.score;
+    result->board_hash = backend_get_board_hash(&context->core.game);
+    // the figures dealt are the spawned ones and the next one
+    result->pieces = (long)context->core.game.randomizer.dealt - 1;
+    result->recorded_score = event.score;
+    result->recorded_board_hash = event.board_hash;
+  }
+  return error;
+}
+
+/// @brief check if the replayed game ended as the recorded one
+/// @param result the result
+/// @return true if the score and the board match
+bool replay_game_result_get_matches(const replay_game_result_t *result) {
+  return result->score == result->recorded_score &&
+         result->board_hash == result->recorded_board_hash;
+}
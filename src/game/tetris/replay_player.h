@@ -0,0 +1,28 @@
+#ifndef TETRIS_REPLAY_PLAYER
+#define TETRIS_REPLAY_PLAYER
+
+/// @file replay_player.h
+/// @brief Declaration of the replay player. A recorded game is played again
+/// on a manual clock, as fast as the CPU allows, and its end is compared with
+/// the recorded one
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "context.h"
+#include "replay.h"
+
+typedef struct {
+  int score;
+  uint64_t board_hash;
+  int recorded_score;
+  uint64_t recorded_board_hash;
+  long signals;
+  long pieces;
+} replay_game_result_t;
+
+bool replay_play_game(replay_reader_t *, tetris_context_t *,
+                      replay_game_result_t *);
+bool replay_game_result_get_matches(const replay_game_result_t *);
+
+#endif
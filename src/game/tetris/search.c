@@ -0,0 +1,266 @@
+#include "search.h"
+
+/// @file search.c
+/// @brief Implementation of the beam search and its transposition table
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "figures.h"
+#include "randomizer.h"
+
+// every search object has the same keys, so the hashes may be compared
+#define SEARCH_KEYS_SEED 0x7e7215ull
+
+bool expand_search_node(search_t *search, const search_node_t *parent,
+                        const figure_t *figure, const int ply,
+                        autoplay_evaluate_t evaluate, const void *data);
+long select_search_beam(search_t *search, const long begin, const long end);
+bool get_is_known_position(search_t *search, const uint64_t key);
+uint64_t hash_board_rows(const search_t *search, const row_mask_t *board,
+                         const int first, const int last);
+
+/// @brief fill the config with the defaults
+/// @param config the config
+void search_config_init(search_config_t *config) {
+  if (!config) return;
+  config->beam_width = SEARCH_DEFAULT_BEAM_WIDTH;
+  config->node_budget = SEARCH_DEFAULT_NODE_BUDGET;
+  config->table_bits = SEARCH_DEFAULT_TABLE_BITS;
+}
+
+/// @brief allocate a search object with its arena and transposition table
+/// @param config the beam width, the node budget and the table size, NULL for
+/// the defaults
+/// @return the search object, NULL on malloc error or a bad config
+search_t *search_create(const search_config_t *config) {
+  search_config_t defaults;
+  if (!config) {
+    search_config_init(&defaults);
+    config = &defaults;
+  }
+  if (config->beam_width < 1 || config->node_budget < 1 ||
+      config->table_bits < 1 || config->table_bits > 30) {
+    return NULL;
+  }
+  search_t *search = calloc(1, sizeof(search_t));
+  if (search) {
+    search->config = *config;
+    search->arena = malloc(sizeof(search_node_t) * config->node_budget);
+    search->table =
+        calloc((size_t)1 << config->table_bits, sizeof(search_entry_t));
+    if (!search->arena || !search->table) {
+      search_destroy(search);
+      search = NULL;
+    }
+  }
+  if (search) {
+    search->table_mask = ((uint64_t)1 << config->table_bits) - 1;
+    uint64_t state = SEARCH_KEYS_SEED;
+    for (int r = 0; r != FIELD_TOTAL_HEIGHT; ++r) {
+      for (int c = 0; c != FIELD_WIDTH; ++c) {
+        search->keys[r][c] = splitmix_next(&state);
+      }
+    }
+    for (int p = 0; p != SEARCH_MAX_DEPTH; ++p) {
+      search->ply_keys[p] = splitmix_next(&state);
+    }
+  }
+  return search;
+}
+
+/// @brief free the search object
+/// @param search search object created with search_create()
+void search_destroy(search_t *search) {
+  if (!search) return;
+  free(search->arena);
+  free(search->table);
+  free(search);
+}
+
+/// @brief choose the placement of the figure by the beam search over it and
+/// the preview figures
+/// @param search the search object
+/// @param board the occupancy bitboard, FIELD_TOTAL_HEIGHT rows
+/// @param figure the figure at its current position
+/// @param preview_ids ids of the figures that follow, preview_count of them,
+/// up to SEARCH_MAX_DEPTH - 1 are used
+/// @param preview_count number of the preview figures
+/// @param evaluate the evaluator of the boards
+/// @param data the evaluator data
+/// @param choice where to save the chosen placement
+/// @return true if the figure has no placements that do not end the game
+bool search_choose(search_t *search, const row_mask_t *board,
+                   const figure_t *figure, const int *preview_ids,
+                   const int preview_count, autoplay_evaluate_t evaluate,
+                   const void *data, figure_t *choice) {
+  if (!search || !board || !figure || !evaluate || !choice ||
+      (preview_count > 0 && !preview_ids)) {
+    return true;
+  }
+  int depth = 1 + (preview_count > 0 ? preview_count : 0);
+  if (depth > SEARCH_MAX_DEPTH) depth = SEARCH_MAX_DEPTH;
+  ++search->stats.searches;
+  search->arena_used = 0;
+  if (++search->stamp == 0) {
+    memset(search->table, 0,
+           sizeof(search_entry_t) * (size_t)(search->table_mask + 1));
+    search->stamp = 1;
+  }
+  search_node_t root;
+  memcpy(root.board, board, sizeof(root.board));
+  root.hash = search_hash_board(search, board);
+  root.lines = 0;
+  root.score = 0;
+  bool budget_left = expand_search_node(search, &root, figure, 0, evaluate,
+                                        data);
+  long begin = 0;
+  long end = search->arena_used;
+  for (int ply = 1; budget_left && ply != depth; ++ply) {
+    figure_t spawned;
+    backend_get_spawned_figure(preview_ids[ply - 1], &spawned);
+    if (!get_figure_shape(spawned.id, 0)) break;
+    const long kept = select_search_beam(search, begin, end);
+    const long next_begin = search->arena_used;
+    for (long i = begin; budget_left && i != begin + kept; ++i) {
+      budget_left = expand_search_node(search, &search->arena[i], &spawned,
+                                       ply, evaluate, data);
+    }
+    // a ply without boards leaves the choice to the previous one
+    if (search->arena_used == next_begin) break;
+    begin = next_begin;
+    end = search->arena_used;
+  }
+  if (!budget_left) ++search->stats.budget_cuts;
+  long best = -1;
+  for (long i = begin; i != end; ++i) {
+    if (best < 0 || search->arena[i].score > search->arena[best].score) {
+      best = i;
+    }
+  }
+  if (best >= 0) *choice = search->arena[best].root;
+  return best < 0;
+}
+
+/// @brief compute the Zobrist hash of the board from scratch
+/// @param search the search object with the keys
+/// @param board the occupancy bitboard, FIELD_TOTAL_HEIGHT rows
+/// @return the hash, 0 for the empty board
+uint64_t search_hash_board(const search_t *search, const row_mask_t *board) {
+  return hash_board_rows(search, board, 0, FIELD_TOTAL_HEIGHT - 1);
+}
+
+/// @brief update the hash of the board after the figure is locked on it.
+/// Only the rows of the figure change, or all the rows down to the figure if
+/// some are cut
+/// @param search the search object with the keys
+/// @param hash the hash of the board before the lock
+/// @param before the board before the lock
+/// @param after the board after the lock and the cut
+/// @param figure the locked figure
+/// @param cut_rows number of the cut rows
+/// @return the hash of the board after the lock
+uint64_t search_hash_lock(const search_t *search, uint64_t hash,
+                          const row_mask_t *before, const row_mask_t *after,
+                          const figure_t *figure, const int cut_rows) {
+  int first = cut_rows ? 0 : figure->position.r;
+  int last = figure->position.r + MAX_FIGURE_SIZE - 1;
+  if (first < 0) first = 0;
+  if (last > FIELD_TOTAL_HEIGHT - 1) last = FIELD_TOTAL_HEIGHT - 1;
+  return hash ^ hash_board_rows(search, before, first, last) ^
+         hash_board_rows(search, after, first, last);
+}
+
+/// @brief add the boards of all the placements of the figure on the board of
+/// the parent node to the arena. Boards that end the game or are already
+/// known are skipped
+/// @param search the search object
+/// @param parent the parent node
+/// @param figure the figure at its start position
+/// @param ply number of the figure in the search
+/// @param evaluate the evaluator
+/// @param data the evaluator data
+/// @return false if the arena is used up
+bool expand_search_node(search_t *search, const search_node_t *parent,
+                        const figure_t *figure, const int ply,
+                        autoplay_evaluate_t evaluate, const void *data) {
+  const int count =
+      placement_generate(parent->board, figure, search->placements);
+  bool budget_left = true;
+  for (int i = 0; budget_left && i != count; ++i) {
+    if (search->arena_used == search->config.node_budget) {
+      budget_left = false;
+      continue;
+    }
+    const figure_t *placement = &search->placements[i];
+    search_node_t *node = &search->arena[search->arena_used];
+    memcpy(node->board, parent->board, sizeof(node->board));
+    int cut_rows = 0;
+    if (placement_lock(node->board, placement, &cut_rows)) continue;
+    node->hash = search_hash_lock(search, parent->hash, parent->board,
+                                  node->board, placement, cut_rows);
+    if (get_is_known_position(search, node->hash ^ search->ply_keys[ply])) {
+      ++search->stats.duplicates;
+      continue;
+    }
+    node->lines = parent->lines + cut_rows;
+    node->score = evaluate(node->board, node->lines, data);
+    node->root = ply ? parent->root : *placement;
+    ++search->arena_used;
+    ++search->stats.nodes;
+  }
+  return budget_left;
+}
+
+/// @brief move the beam_width best nodes of the range to its start, best
+/// first
+/// @param search the search object
+/// @param begin the first node of the range
+/// @param end the node after the range
+/// @return number of the nodes in the beam
+long select_search_beam(search_t *search, const long begin, const long end) {
+  long kept = end - begin;
+  if (kept > search->config.beam_width) kept = search->config.beam_width;
+  for (long i = begin; i != begin + kept; ++i) {
+    long best = i;
+    for (long j = i + 1; j != end; ++j) {
+      if (search->arena[j].score > search->arena[best].score) best = j;
+    }
+    if (best != i) {
+      const search_node_t node = search->arena[i];
+      search->arena[i] = search->arena[best];
+      search->arena[best] = node;
+    }
+  }
+  return kept;
+}
+
+/// @brief look the position up in the transposition table, adding it if it
+/// is not there
+/// @param search the search object
+/// @param key the board hash mixed with the ply key
+/// @return true if the position was seen in the current search
+bool get_is_known_position(search_t *search, const uint64_t key) {
+  search_entry_t *entry = &search->table[key & search->table_mask];
+  const bool known = entry->stamp == search->stamp && entry->hash == key;
+  entry->hash = key;
+  entry->stamp = search->stamp;
+  return known;
+}
+
+/// @brief xor the keys of the occupied cells of the rows
+/// @param search the search object with the keys
+/// @param board the occupancy bitboard
+/// @param first the first row
+/// @param last the last row, included
+/// @return the xor of the keys
+uint64_t hash_board_rows(const search_t *search, const row_mask_t *board,
+                         const int first, const int last) {
+  uint64_t hash = 0;
+  for (int r = first; r <= last; ++r) {
+    for (unsigned m = board[r] & FULL_ROW_MASK; m; m &= m - 1) {
+      hash ^= search->keys[r][__builtin_ctz(m)];
+    }
+  }
+  return hash;
+}
@@ -0,0 +1,87 @@
+#ifndef TETRIS_SEARCH
+#define TETRIS_SEARCH
+
+/// @file search.h
+/// @brief Declaration of the beam search over the current figure and the
+/// preview ones. Every ply locks each placement of its figure on the boards
+/// of the beam, scores the boards with the autoplay evaluator and keeps the
+/// beam_width best of them for the next ply. The figure placement that leads
+/// to the best board of the last ply is chosen. Boards are identified by
+/// Zobrist hashes updated as the figures lock, a board reached again by
+/// another order of the placements is found in the transposition table and
+/// skipped. The nodes of a search are taken from the arena of node_budget
+/// nodes, the search stops expanding when it is used up
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "autoplay.h"
+#include "backend.h"
+#include "bitboard.h"
+#include "placement.h"
+
+#define SEARCH_MAX_DEPTH 4
+#define SEARCH_DEFAULT_BEAM_WIDTH 8
+#define SEARCH_DEFAULT_NODE_BUDGET 4096
+#define SEARCH_DEFAULT_TABLE_BITS 14
+
+typedef struct {
+  int beam_width;
+  long node_budget;
+  int table_bits;
+} search_config_t;
+
+/// @brief Counters of all the searches made with a search object. nodes are
+/// the boards evaluated, duplicates the boards skipped as already seen
+typedef struct {
+  long searches;
+  long nodes;
+  long duplicates;
+  long budget_cuts;
+} search_stats_t;
+
+/// @brief A board of the search. root is the placement of the current figure
+/// the board descends from, lines the number of the rows cut on the way
+typedef struct {
+  row_mask_t board[FIELD_TOTAL_HEIGHT];
+  uint64_t hash;
+  double score;
+  int lines;
+  figure_t root;
+} search_node_t;
+
+typedef struct {
+  uint64_t hash;
+  uint32_t stamp;
+} search_entry_t;
+
+/// @brief The search object, one per thread. keys are the Zobrist keys of the
+/// cells and of the plies, the table entries of the previous searches have
+/// an older stamp
+typedef struct search {
+  search_config_t config;
+  search_stats_t stats;
+  search_node_t *arena;
+  long arena_used;
+  search_entry_t *table;
+  uint64_t table_mask;
+  uint32_t stamp;
+  uint64_t keys[FIELD_TOTAL_HEIGHT][FIELD_WIDTH];
+  uint64_t ply_keys[SEARCH_MAX_DEPTH];
+  figure_t placements[PLACEMENTS_MAX];
+} search_t;
+
+void search_config_init(search_config_t *);
+search_t *search_create(const search_config_t *);
+void search_destroy(search_t *);
+bool search_choose(search_t *, const row_mask_t *board, const figure_t *figure,
+                   const int *preview_ids, const int preview_count,
+                   autoplay_evaluate_t evaluate, const void *data,
+                   figure_t *choice);
+
+uint64_t search_hash_board(const search_t *, const row_mask_t *board);
+uint64_t search_hash_lock(const search_t *, uint64_t hash,
+                          const row_mask_t *before, const row_mask_t *after,
+                          const figure_t *figure, const int cut_rows);
+
+#endif
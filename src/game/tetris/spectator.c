@@ -0,0 +1,493 @@
+#define _POSIX_C_SOURCE 200809L
+// relying on the POSIX sockets, poll(), strdup() and the signal masks
+#include "spectator.h"
+
+/// @file spectator.c
+/// @brief Implementation of the spectator stream
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "replay.h"
+
+size_t spectator_pack_cells(const uint8_t *cells, const int count,
+                            uint8_t *buffer);
+void spectator_unpack_cells(const uint8_t *buffer, const int count,
+                            uint8_t *cells);
+bool spectator_parse(const uint8_t *body, const size_t size,
+                     const bool keyframe, spectator_frame_t *frame);
+void spectator_hub_accept(spectator_hub_t *hub);
+bool spectator_flush(spectator_t *spectator, spectator_hub_stats_t *stats);
+bool spectator_send(spectator_t *spectator, const uint8_t *frame,
+                    const size_t size, spectator_hub_stats_t *stats);
+ssize_t spectator_write(const spectator_t *spectator, const uint8_t *data,
+                        const size_t size);
+
+/// @brief take what a spectator sees of the game
+/// @param frame where to store the frame
+/// @param game the game
+/// @param state the FSM state
+void spectator_frame_fill(spectator_frame_t *frame, const tetris_game_t *game,
+                          const tetris_state_t state) {
+  for (int r = 0; r != FIELD_TOTAL_HEIGHT; ++r) {
+    for (int c = 0; c != FIELD_WIDTH; ++c) {
+      frame->field[r][c] = (uint8_t)game->game.field[r][c];
+    }
+  }
+  for (int r = 0; r != MAX_FIGURE_SIZE; ++r) {
+    for (int c = 0; c != MAX_FIGURE_SIZE; ++c) {
+      frame->next[r][c] = (uint8_t)game->game.next[r][c];
+    }
+  }
+  frame->score = game->game.score;
+  frame->high_score = game->game.high_score;
+  frame->level = game->game.level;
+  frame->lines = game->game.lines;
+  frame->state = (uint8_t)state;
+  frame->pause = (uint8_t)game->game.pause;
+  frame->reserved[0] = 0;
+  frame->reserved[1] = 0;
+}
+
+/// @brief encode a frame with its size
+/// @param previous the frame the delta applies to, NULL for a keyframe
+/// @param frame the frame
+/// @param number the frame number
+/// @param buffer where to write, at least SPECTATOR_MAX_FRAME_SIZE bytes
+/// @return number of bytes written
+size_t spectator_encode(const spectator_frame_t *previous,
+                        const spectator_frame_t *frame, const uint64_t number,
+                        uint8_t *buffer) {
+  uint8_t body[SPECTATOR_MAX_FRAME_SIZE];
+  size_t size = 0;
+  body[size++] = previous ? SPECTATOR_DELTA : SPECTATOR_KEYFRAME;
+  size += replay_put_varint(body + size, number);
+  dirty_rows_t rows = 0;
+  for (int r = 0; r != FIELD_TOTAL_HEIGHT; ++r) {
+    if (!previous ||
+        memcmp(previous->field[r], frame->field[r], FIELD_WIDTH) != 0) {
+      rows |= (dirty_rows_t)1 << r;
+    }
+  }
+  size += replay_put_varint(body + size, rows);
+  for (int r = 0; r != FIELD_TOTAL_HEIGHT; ++r) {
+    if (rows >> r & 1) {
+      size += spectator_pack_cells(frame->field[r], FIELD_WIDTH, body + size);
+    }
+  }
+  uint8_t flags = SPECTATOR_HAS_ALL;
+  if (previous) {
+    flags = 0;
+    if (memcmp(previous->next, frame->next, sizeof(frame->next)) != 0) {
+      flags |= SPECTATOR_HAS_NEXT;
+    }
+    if (previous->score != frame->score) flags |= SPECTATOR_HAS_SCORE;
+    if (previous->high_score != frame->high_score) {
+      flags |= SPECTATOR_HAS_HIGH_SCORE;
+    }
+    if (previous->level != frame->level) flags |= SPECTATOR_HAS_LEVEL;
+    if (previous->lines != frame->lines) flags |= SPECTATOR_HAS_LINES;
+    if (previous->state != frame->state || previous->pause != frame->pause) {
+      flags |= SPECTATOR_HAS_STATUS;
+    }
+  }
+  body[size++] = flags;
+  if (flags & SPECTATOR_HAS_NEXT) {
+    size += spectator_pack_cells(
+        &frame->next[0][0], MAX_FIGURE_SIZE * MAX_FIGURE_SIZE, body + size);
+  }
+  const int32_t numbers[4] = {frame->score, frame->high_score, frame->level,
+                              frame->lines};
+  for (int i = 0; i != 4; ++i) {
+    if (flags & (SPECTATOR_HAS_SCORE << i)) {
+      size += replay_put_varint(body + size, (uint32_t)numbers[i]);
+    }
+  }
+  if (flags & SPECTATOR_HAS_STATUS) {
+    body[size++] = frame->state;
+    body[size++] = frame->pause;
+  }
+  const size_t prefix = replay_put_varint(buffer, size);
+  memcpy(buffer + prefix, body, size);
+  return prefix + size;
+}
+
+/// @brief pack the cells two per byte, the first one in the low nibble
+/// @param cells the cells, an even number
+/// @param count number of the cells
+/// @param buffer where to write
+/// @return number of bytes written
+size_t spectator_pack_cells(const uint8_t *cells, const int count,
+                            uint8_t *buffer) {
+  for (int i = 0; i < count; i += 2) {
+    buffer[i / 2] = (uint8_t)((cells[i] & 0x0F) | (cells[i + 1] & 0x0F) << 4);
+  }
+  return (size_t)count / 2;
+}
+
+/// @brief unpack the cells packed by spectator_pack_cells()
+/// @param buffer the packed cells
+/// @param count number of the cells
+/// @param cells where to store the cells
+void spectator_unpack_cells(const uint8_t *buffer, const int count,
+                            uint8_t *cells) {
+  for (int i = 0; i < count; i += 2) {
+    cells[i] = buffer[i / 2] & 0x0F;
+    cells[i + 1] = buffer[i / 2] >> 4;
+  }
+}
+
+/// @brief apply the next frame of the stream. A delta that does not follow
+/// the last frame applied is skipped and the decoder waits for a keyframe
+/// @param decoder the decoder
+/// @param buffer the stream
+/// @param size number of the bytes in the buffer
+/// @return number of the bytes of the frame, 0 if the buffer does not hold a
+/// whole frame, -1 if the frame is malformed
+int spectator_decode(spectator_decoder_t *decoder, const uint8_t *buffer,
+                     const size_t size) {
+  uint64_t body_size = 0;
+  const size_t prefix = replay_get_varint(buffer, size, &body_size);
+  if (!prefix) return size < 3 ? 0 : -1;
+  if (body_size < 2 || body_size > SPECTATOR_MAX_FRAME_SIZE) return -1;
+  if (size < prefix + body_size) return 0;
+  const uint8_t *body = buffer + prefix;
+  const int frame_size = (int)(prefix + body_size);
+  uint64_t number = 0;
+  const size_t number_size = replay_get_varint(body + 1, body_size - 1,
+                                               &number);
+  const bool keyframe = body[0] == SPECTATOR_KEYFRAME;
+  if (!number_size || (!keyframe && body[0] != SPECTATOR_DELTA)) return -1;
+  if (!keyframe && (!decoder->synced || number != decoder->number + 1)) {
+    decoder->synced = false;
+    ++decoder->skipped;
+    return frame_size;
+  }
+  spectator_frame_t frame = decoder->frame;
+  if (spectator_parse(body + 1 + number_size,
+                      body_size - 1 - number_size, keyframe, &frame)) {
+    return -1;
+  }
+  decoder->frame = frame;
+  decoder->number = number;
+  decoder->synced = true;
+  ++decoder->frames;
+  decoder->keyframes += keyframe;
+  return frame_size;
+}
+
+/// @brief apply the rows and the parts of a frame
+/// @param body the frame after its number
+/// @param size number of the bytes of the rest of the frame
+/// @param keyframe whether the frame is to hold everything
+/// @param frame the frame to apply to
+/// @return true if the frame is malformed
+bool spectator_parse(const uint8_t *body, const size_t size,
+                     const bool keyframe, spectator_frame_t *frame) {
+  const dirty_rows_t all_rows =
+      (dirty_rows_t)(((uint64_t)1 << FIELD_TOTAL_HEIGHT) - 1);
+  uint64_t rows = 0;
+  size_t read = replay_get_varint(body, size, &rows);
+  if (!read || rows & ~(uint64_t)all_rows || (keyframe && rows != all_rows)) {
+    return true;
+  }
+  for (int r = 0; r != FIELD_TOTAL_HEIGHT; ++r) {
+    if (!(rows >> r & 1)) continue;
+    if (size - read < SPECTATOR_ROW_SIZE) return true;
+    spectator_unpack_cells(body + read, FIELD_WIDTH, frame->field[r]);
+    read += SPECTATOR_ROW_SIZE;
+  }
+  if (read == size) return true;
+  const uint8_t flags = body[read++];
+  if (flags & ~SPECTATOR_HAS_ALL || (keyframe && flags != SPECTATOR_HAS_ALL)) {
+    return true;
+  }
+  if (flags & SPECTATOR_HAS_NEXT) {
+    if (size - read < SPECTATOR_NEXT_SIZE) return true;
+    spectator_unpack_cells(body + read, MAX_FIGURE_SIZE * MAX_FIGURE_SIZE,
+                           &frame->next[0][0]);
+    read += SPECTATOR_NEXT_SIZE;
+  }
+  int32_t *numbers[4] = {&frame->score, &frame->high_score, &frame->level,
+                         &frame->lines};
+  for (int i = 0; i != 4; ++i) {
+    if (!(flags & (SPECTATOR_HAS_SCORE << i))) continue;
+    uint64_t value = 0;
+    const size_t value_size =
+        replay_get_varint(body + read, size - read, &value);
+    if (!value_size || value > INT32_MAX) return true;
+    *numbers[i] = (int32_t)value;
+    read += value_size;
+  }
+  if (flags & SPECTATOR_HAS_STATUS) {
+    if (size - read < 2) return true;
+    frame->state = body[read++];
+    frame->pause = body[read++];
+  }
+  return read != size;
+}
+
+/// @brief allocate a hub without spectators
+/// @return the hub, NULL on malloc error
+spectator_hub_t *spectator_hub_create(void) {
+  spectator_hub_t *hub = calloc(1, sizeof(spectator_hub_t));
+  if (hub) hub->listen_fd = -1;
+  return hub;
+}
+
+/// @brief disconnect the spectators, remove the socket file and free the hub
+/// @param hub the hub
+void spectator_hub_destroy(spectator_hub_t *hub) {
+  if (!hub) return;
+  for (int i = 0; i != hub->count; ++i) {
+    close(hub->spectators[i].fd);
+  }
+  if (hub->listen_fd >= 0) {
+    close(hub->listen_fd);
+    unlink(hub->socket_path);
+  }
+  free(hub->socket_path);
+  free(hub->spectators);
+  free(hub);
+}
+
+/// @brief let the spectators connect to the Unix domain socket, replacing the
+/// file of a previous hub. The connections are accepted when a frame is
+/// published
+/// @param hub the hub
+/// @param path the socket file
+/// @return true if the socket could not be listened on
+bool spectator_hub_listen(spectator_hub_t *hub, const char *path) {
+  if (!hub || !path || hub->listen_fd >= 0) return true;
+  struct sockaddr_un address;
+  memset(&address, 0, sizeof(address));
+  address.sun_family = AF_UNIX;
+  if (strlen(path) >= sizeof(address.sun_path)) return true;
+  strcpy(address.sun_path, path);
+  hub->socket_path = strdup(path);
+  int fd = hub->socket_path ? socket(AF_UNIX, SOCK_STREAM, 0) : -1;
+  if (fd >= 0) {
+    unlink(path);
+    if (bind(fd, (struct sockaddr *)&address, sizeof(address)) != 0 ||
+        listen(fd, SPECTATOR_BACKLOG) != 0 ||
+        fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK) != 0) {
+      close(fd);
+      fd = -1;
+    }
+  }
+  hub->listen_fd = fd;
+  return fd < 0;
+}
+
+/// @brief add a spectator, it gets a keyframe with the next frame published.
+/// The descriptor is owned by the hub and made non-blocking, it is closed on
+/// error too
+/// @param hub the hub
+/// @param fd the write end of a pipe or a socket
+/// @return true on malloc error or if the descriptor is not usable
+bool spectator_hub_add(spectator_hub_t *hub, const int fd) {
+  if (!hub || fd < 0) return true;
+  struct stat status;
+  bool error = fstat(fd, &status) != 0 ||
+               fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK) != 0;
+  if (!error && hub->count == hub->capacity) {
+    const int capacity = hub->capacity ? hub->capacity * 2 : 4;
+    spectator_t *spectators =
+        realloc(hub->spectators, capacity * sizeof(spectator_t));
+    error = !spectators;
+    if (spectators) {
+      hub->spectators = spectators;
+      hub->capacity = capacity;
+    }
+  }
+  if (error) {
+    close(fd);
+    return true;
+  }
+  spectator_t *spectator = &hub->spectators[hub->count++];
+  memset(spectator, 0, offsetof(spectator_t, pending));
+  spectator->fd = fd;
+  spectator->socket = S_ISSOCK(status.st_mode);
+  spectator->resync = true;
+  return false;
+}
+
+/// @brief wait for a spectator to connect to the socket of the hub
+/// @param hub the hub
+/// @param timeout_ms how long to wait, -1 for no limit
+/// @return true if no spectator connected in time or on error
+bool spectator_hub_wait(spectator_hub_t *hub, const int timeout_ms) {
+  if (!hub || hub->listen_fd < 0) return true;
+  struct pollfd listening = {hub->listen_fd, POLLIN, 0};
+  int ready = 0;
+  do {
+    ready = poll(&listening, 1, timeout_ms);
+  } while (ready < 0 && errno == EINTR);
+  if (ready > 0) spectator_hub_accept(hub);
+  return !hub->count;
+}
+
+/// @brief accept the pending connections of the spectators
+/// @param hub the hub
+void spectator_hub_accept(spectator_hub_t *hub) {
+  if (hub->listen_fd < 0) return;
+  int fd = -1;
+  while ((fd = accept(hub->listen_fd, NULL, NULL)) >= 0) {
+    spectator_hub_add(hub, fd);
+  }
+}
+
+/// @brief send the game to the spectators if anything drawn has changed since
+/// the last frame, and a keyframe to the spectators waiting for one. Never
+/// blocks: a spectator busy with a previous frame misses this one and is
+/// dropped when it has been busy for too long
+/// @param hub the hub
+/// @param game the game
+/// @param state the FSM state
+void spectator_hub_publish(spectator_hub_t *hub, const tetris_game_t *game,
+                           const tetris_state_t state) {
+  if (!hub || !game) return;
+  spectator_hub_accept(hub);
+  if (!hub->count) {
+    hub->started = false;
+    return;
+  }
+  spectator_frame_t frame;
+  spectator_frame_fill(&frame, game, state);
+  const bool changed =
+      !hub->started || memcmp(&frame, &hub->last, sizeof(frame)) != 0;
+  bool keyframe_due = false;
+  if (changed) {
+    ++hub->number;
+    ++hub->stats.frames;
+    keyframe_due =
+        !hub->started || ++hub->since_keyframe >= SPECTATOR_KEYFRAME_INTERVAL;
+    if (keyframe_due) hub->since_keyframe = 0;
+  }
+  // a frame is encoded once for all the spectators
+  uint8_t delta[SPECTATOR_MAX_FRAME_SIZE];
+  uint8_t keyframe[SPECTATOR_MAX_FRAME_SIZE];
+  size_t delta_size = 0;
+  size_t keyframe_size = 0;
+  if (changed && !keyframe_due) {
+    delta_size = spectator_encode(&hub->last, &frame, hub->number, delta);
+  }
+  for (int i = 0; i < hub->count;) {
+    spectator_t *spectator = &hub->spectators[i];
+    bool drop = spectator_flush(spectator, &hub->stats);
+    if (!drop && spectator->pending_sent != spectator->pending_size) {
+      if (changed) {
+        const unsigned long now_ms = get_monotonic_ms();
+        if (!spectator->resync) spectator->stalled_ms = now_ms;
+        spectator->resync = true;
+        ++hub->stats.missed;
+        drop = now_ms - spectator->stalled_ms > SPECTATOR_MAX_STALL_MS;
+      }
+    } else if (!drop && (changed || spectator->resync)) {
+      const bool key = spectator->resync || keyframe_due;
+      if (key && !keyframe_size) {
+        keyframe_size = spectator_encode(NULL, &frame, hub->number, keyframe);
+      }
+      drop = key ? spectator_send(spectator, keyframe, keyframe_size,
+                                  &hub->stats)
+                 : spectator_send(spectator, delta, delta_size, &hub->stats);
+      hub->stats.keyframes += key;
+      hub->stats.deltas += !key;
+    }
+    if (drop) {
+      close(spectator->fd);
+      *spectator = hub->spectators[--hub->count];
+      ++hub->stats.dropped;
+    } else {
+      ++i;
+    }
+  }
+  hub->last = frame;
+  hub->started = true;
+}
+
+/// @brief write the rest of the frame the spectator has not taken yet
+/// @param spectator the spectator
+/// @param stats the stats of the hub
+/// @return true if the spectator is gone
+bool spectator_flush(spectator_t *spectator, spectator_hub_stats_t *stats) {
+  if (spectator->pending_sent == spectator->pending_size) return false;
+  const ssize_t sent =
+      spectator_write(spectator, spectator->pending + spectator->pending_sent,
+                      spectator->pending_size - spectator->pending_sent);
+  if (sent < 0) return true;
+  // a spectator that takes anything is slow, not stalled
+  if (sent > 0) spectator->stalled_ms = get_monotonic_ms();
+  spectator->pending_sent += (size_t)sent;
+  stats->bytes += sent;
+  return false;
+}
+
+/// @brief write a frame to the spectator, the part it does not take is kept
+/// to be written before the next frame
+/// @param spectator the spectator, with nothing pending
+/// @param frame the encoded frame
+/// @param size size of the frame
+/// @param stats the stats of the hub
+/// @return true if the spectator is gone
+bool spectator_send(spectator_t *spectator, const uint8_t *frame,
+                    const size_t size, spectator_hub_stats_t *stats) {
+  const ssize_t sent = spectator_write(spectator, frame, size);
+  if (sent < 0) return true;
+  stats->bytes += sent;
+  spectator->resync = false;
+  spectator->pending_size = size - (size_t)sent;
+  spectator->pending_sent = 0;
+  memcpy(spectator->pending, frame + sent, spectator->pending_size);
+  return false;
+}
+
+/// @brief write to the spectator without blocking and without SIGPIPE. A
+/// pipe is written with SIGPIPE blocked in the calling thread, the SIGPIPE of
+/// a pipe without a reader is taken before it is unblocked
+/// @param spectator the spectator
+/// @param data the bytes
+/// @param size number of the bytes
+/// @return number of the bytes written, 0 if the spectator is busy, -1 if it
+/// is gone
+ssize_t spectator_write(const spectator_t *spectator, const uint8_t *data,
+                        const size_t size) {
+  sigset_t pipe_set;
+  sigset_t previous;
+  sigset_t pending;
+  bool was_pending = false;
+  if (!spectator->socket) {
+    sigemptyset(&pipe_set);
+    sigaddset(&pipe_set, SIGPIPE);
+    pthread_sigmask(SIG_BLOCK, &pipe_set, &previous);
+    sigpending(&pending);
+    was_pending = sigismember(&pending, SIGPIPE) == 1;
+  }
+  ssize_t sent = -1;
+  do {
+    sent = spectator->socket ? send(spectator->fd, data, size, MSG_NOSIGNAL)
+                             : write(spectator->fd, data, size);
+  } while (sent < 0 && errno == EINTR);
+  const int write_errno = errno;
+  if (!spectator->socket) {
+    if (sent < 0 && write_errno == EPIPE && !was_pending) {
+      const struct timespec no_wait = {0, 0};
+      while (sigtimedwait(&pipe_set, NULL, &no_wait) < 0 && errno == EINTR) {
+      }
+    }
+    pthread_sigmask(SIG_SETMASK, &previous, NULL);
+  }
+  if (sent < 0 && (write_errno == EAGAIN || write_errno == EWOULDBLOCK)) {
+    sent = 0;
+  }
+  return sent;
+}
@@ -0,0 +1,153 @@
+#ifndef TETRIS_SPECTATOR
+#define TETRIS_SPECTATOR
+
+/// @file spectator.h
+/// @brief Declaration of the spectator stream of a game, its encoder, the hub
+/// that sends it to the spectators and the decoder.
+///
+/// A stream is a sequence of frames, a frame is sent when anything drawn has
+/// changed. Every frame starts with the varint size of the rest of the frame,
+/// the type byte and the varint frame number, then:
+/// - the varint mask of the GameInfo_t.field rows in the frame, bit r for the
+///   row r, and FIELD_WIDTH / 2 bytes per row, two cells per byte with the
+///   first cell in the low nibble
+/// - the flags byte of the other parts in the frame, then the parts in the
+///   order of the flags: next as MAX_FIGURE_SIZE^2 / 2 bytes packed as the
+///   rows, the score, the high score, the level and the lines as varints, the
+///   FSM state byte and the pause byte
+/// A keyframe has all the rows and all the parts, a delta has the changed
+/// ones and applies to the previous frame. The frame numbers of a spectator
+/// are consecutive, a spectator that misses a frame waits for a keyframe.
+/// Multi byte numbers are unsigned LEB128 varints.
+///
+/// The hub sends the frames to any number of spectators: the pipes or sockets
+/// added to it and the connections to its Unix domain socket. A frame is
+/// encoded once for all the spectators. A spectator that cannot take a frame
+/// right away misses it and gets a keyframe once it can, one that has taken
+/// nothing for SPECTATOR_MAX_STALL_MS is dropped, so a slow spectator never
+/// stalls the game. A spectator whose reader is gone is dropped, the writes
+/// to the pipes hold SIGPIPE off
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "../../common/game_clock.h"
+#include "backend.h"
+#include "fsm.h"
+
+#define SPECTATOR_DEFAULT_SOCKET_PATH "/tmp/.tetris_spectate.sock"
+#define SPECTATOR_KEYFRAME_INTERVAL 64
+#define SPECTATOR_MAX_STALL_MS 5000
+#define SPECTATOR_BACKLOG 64
+#define SPECTATOR_ROW_SIZE (FIELD_WIDTH / 2)
+#define SPECTATOR_NEXT_SIZE (MAX_FIGURE_SIZE * MAX_FIGURE_SIZE / 2)
+// the size varint, the type, the number, the mask, the rows, the flags, the
+// next, 4 varints and 2 bytes
+#define SPECTATOR_MAX_FRAME_SIZE                                     \
+  (3 + 1 + 10 + 5 + FIELD_TOTAL_HEIGHT * SPECTATOR_ROW_SIZE + 1 + \
+   SPECTATOR_NEXT_SIZE + 4 * 5 + 2)
+// the size of a GameInfo_t dump of the field, next and the numbers
+#define SPECTATOR_FULL_FRAME_SIZE                                \
+  ((FIELD_TOTAL_HEIGHT * FIELD_WIDTH +                           \
+    MAX_FIGURE_SIZE * MAX_FIGURE_SIZE + 6) *                     \
+   (int)sizeof(int))
+
+_Static_assert(FIELD_WIDTH % 2 == 0, "a row is packed two cells per byte");
+_Static_assert(ALLOWED_FIGURES_COUNT < 16, "a colour is packed in a nibble");
+
+typedef enum {
+  SPECTATOR_KEYFRAME = 1,
+  SPECTATOR_DELTA
+} spectator_frame_type_t;
+
+typedef enum {
+  SPECTATOR_HAS_NEXT = 1 << 0,
+  SPECTATOR_HAS_SCORE = 1 << 1,
+  SPECTATOR_HAS_HIGH_SCORE = 1 << 2,
+  SPECTATOR_HAS_LEVEL = 1 << 3,
+  SPECTATOR_HAS_LINES = 1 << 4,
+  SPECTATOR_HAS_STATUS = 1 << 5,
+  SPECTATOR_HAS_ALL = (1 << 6) - 1
+} spectator_flags_t;
+
+/// @brief What a spectator sees of the game, the colours of GameInfo_t.
+/// Without padding, frames are compared with memcmp
+typedef struct {
+  uint8_t field[FIELD_TOTAL_HEIGHT][FIELD_WIDTH];
+  uint8_t next[MAX_FIGURE_SIZE][MAX_FIGURE_SIZE];
+  int32_t score;
+  int32_t high_score;
+  int32_t level;
+  int32_t lines;
+  uint8_t state;
+  uint8_t pause;
+  uint8_t reserved[2];
+} spectator_frame_t;
+
+/// @brief resync is set for a spectator that is to get a keyframe, pending
+/// holds the part of a frame the spectator has not taken yet, stalled_ms is
+/// the monotonic time of the first frame it missed or of the last bytes it
+/// took since, whichever is later
+typedef struct {
+  int fd;
+  bool socket;
+  bool resync;
+  unsigned long stalled_ms;
+  size_t pending_size;
+  size_t pending_sent;
+  uint8_t pending[SPECTATOR_MAX_FRAME_SIZE];
+} spectator_t;
+
+typedef struct {
+  long frames;
+  long keyframes;
+  long deltas;
+  long bytes;
+  long missed;
+  long dropped;
+} spectator_hub_stats_t;
+
+/// @brief last is the last frame sent, number its number. The spectators
+/// are owned by the hub
+typedef struct {
+  int listen_fd;
+  char *socket_path;
+  spectator_t *spectators;
+  int count;
+  int capacity;
+  bool started;
+  uint64_t number;
+  int since_keyframe;
+  spectator_frame_t last;
+  spectator_hub_stats_t stats;
+} spectator_hub_t;
+
+/// @brief frame is the one of the last frame number applied, it is the
+/// picture of the game while synced
+typedef struct {
+  spectator_frame_t frame;
+  uint64_t number;
+  bool synced;
+  long frames;
+  long keyframes;
+  long skipped;
+} spectator_decoder_t;
+
+void spectator_frame_fill(spectator_frame_t *, const tetris_game_t *,
+                          const tetris_state_t state);
+size_t spectator_encode(const spectator_frame_t *previous,
+                        const spectator_frame_t *frame, const uint64_t number,
+                        uint8_t *buffer);
+int spectator_decode(spectator_decoder_t *, const uint8_t *buffer,
+                     const size_t size);
+
+spectator_hub_t *spectator_hub_create(void);
+void spectator_hub_destroy(spectator_hub_t *);
+bool spectator_hub_listen(spectator_hub_t *, const char *path);
+bool spectator_hub_add(spectator_hub_t *, const int fd);
+bool spectator_hub_wait(spectator_hub_t *, const int timeout_ms);
+void spectator_hub_publish(spectator_hub_t *, const tetris_game_t *,
+                           const tetris_state_t state);
+
+#endif
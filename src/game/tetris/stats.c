@@ -0,0 +1,171 @@
+#include "stats.h"
+
+/// @file stats.c
+/// @brief Implementation of the FSM instrumentation
+
+#include <string.h>
+
+#include "../../common/time_utils.h"
+
+static _Thread_local fsm_stats_t *bound_stats;
+
+/// @brief zero the statistics
+/// @param stats the statistics
+void fsm_stats_reset(fsm_stats_t *stats) {
+  if (stats) memset(stats, 0, sizeof(fsm_stats_t));
+}
+
+/// @brief make the FSM account to the statistics on the calling thread
+/// @param stats the statistics, not owned, NULL to stop accounting
+/// @return the statistics bound before
+fsm_stats_t *fsm_stats_bind(fsm_stats_t *stats) {
+  fsm_stats_t *previous = bound_stats;
+  bound_stats = stats;
+  return previous;
+}
+
+/// @brief add the statistics of another thread or context
+/// @param stats the statistics to add to
+/// @param other the statistics to add
+void fsm_stats_merge(fsm_stats_t *stats, const fsm_stats_t *other) {
+  if (!stats || !other) return;
+  for (int s = 0; s != STATS_STATES_COUNT; ++s) {
+    stats->transitions[s] += other->transitions[s];
+  }
+  for (int c = 0; c != STATS_CALLS_COUNT; ++c) {
+    stats_histogram_merge(&stats->calls[c], &other->calls[c]);
+  }
+}
+
+/// @brief add the samples of another histogram
+/// @param histogram the histogram
+/// @param other the histogram to add
+void stats_histogram_merge(stats_histogram_t *histogram,
+                           const stats_histogram_t *other) {
+  histogram->count += other->count;
+  histogram->total_ns += other->total_ns;
+  if (other->max_ns > histogram->max_ns) histogram->max_ns = other->max_ns;
+  for (int b = 0; b != STATS_HISTOGRAM_BUCKETS; ++b) {
+    histogram->buckets[b] += other->buckets[b];
+  }
+}
+
+/// @brief print the transitions and the calls with a non-zero count
+/// @param out where to print
+/// @param stats the statistics
+void fsm_stats_print(FILE *out, const fsm_stats_t *stats) {
+  const char *states[STATS_STATES_COUNT] = {
+      "PRESTART",   "START",    "SPAWNING", "IDLE",
+      "MOVING",     "PAUSE",    "AUTOSHIFTING", "OVERFLOWCONTROL",
+      "ROWCUTTING", "GAMEOVER", "PREEXIT",  "EXIT"};
+  fprintf(out, "%-20s %12s\n", "state", "transitions");
+  for (int s = 0; s != STATS_STATES_COUNT; ++s) {
+    if (stats->transitions[s]) {
+      fprintf(out, "%-20s %12llu\n", states[s],
+              (unsigned long long)stats->transitions[s]);
+    }
+  }
+  fprintf(out, "%-20s %12s %9s %9s %9s %9s %9s\n", "call, ns", "count", "mean",
+          "p50", "p90", "p99", "max");
+  for (int c = 0; c != STATS_CALLS_COUNT; ++c) {
+    const stats_histogram_t *histogram = &stats->calls[c];
+    if (!histogram->count) continue;
+    fprintf(out, "%-20s %12llu %9.1f %9llu %9llu %9llu %9llu\n",
+            fsm_stats_get_call_name(c), (unsigned long long)histogram->count,
+            (double)histogram->total_ns / histogram->count,
+            (unsigned long long)stats_histogram_get_percentile(histogram, 50),
+            (unsigned long long)stats_histogram_get_percentile(histogram, 90),
+            (unsigned long long)stats_histogram_get_percentile(histogram, 99),
+            (unsigned long long)histogram->max_ns);
+  }
+}
+
+/// @brief get the name of the backend call
+/// @param call the call
+/// @return the name, "unknown" for the values out of range
+const char *fsm_stats_get_call_name(const stats_call_t call) {
+  const char *names[STATS_CALLS_COUNT] = {
+      "init_game",    "setup_new_game",  "spawn_new_figure", "move_left",
+      "move_right",   "rotate",          "drop",             "lock",
+      "get_overflow", "cut_filled_rows", "destroy_game"};
+  const char *name = "unknown";
+  if ((int)call >= 0 && call < STATS_CALLS_COUNT) name = names[call];
+  return name;
+}
+
+/// @brief get the histogram bucket of a value. The values below
+/// STATS_SUB_BUCKETS have a bucket each, then every power of two is split in
+/// STATS_SUB_BUCKETS equal buckets
+/// @param ns the value
+/// @return the bucket, the last one for the values out of range
+int stats_histogram_get_bucket(const uint64_t ns) {
+  if (ns < STATS_SUB_BUCKETS) return (int)ns;
+  const int power = 63 - __builtin_clzll(ns);
+  const int shift = power - STATS_SUB_BUCKETS_BITS;
+  const int sub = (int)(ns >> shift) & (STATS_SUB_BUCKETS - 1);
+  const int bucket = (shift + 1) * STATS_SUB_BUCKETS + sub;
+  return bucket < STATS_HISTOGRAM_BUCKETS ? bucket
+                                          : STATS_HISTOGRAM_BUCKETS - 1;
+}
+
+/// @brief get the largest value of the bucket
+/// @param bucket the bucket
+/// @return the value, the last bucket also takes all the larger ones
+uint64_t stats_histogram_get_bucket_max(const int bucket) {
+  if (bucket < STATS_SUB_BUCKETS) return (uint64_t)bucket;
+  const int shift = bucket / STATS_SUB_BUCKETS - 1;
+  const uint64_t sub = bucket % STATS_SUB_BUCKETS;
+  return ((STATS_SUB_BUCKETS + sub + 1) << shift) - 1;
+}
+
+/// @brief account a value
+/// @param histogram the histogram
+/// @param ns the value
+void stats_histogram_record(stats_histogram_t *histogram, const uint64_t ns) {
+  ++histogram->count;
+  histogram->total_ns += ns;
+  if (ns > histogram->max_ns) histogram->max_ns = ns;
+  ++histogram->buckets[stats_histogram_get_bucket(ns)];
+}
+
+/// @brief get the value below which the given percent of the values are. The
+/// value is rounded up to its bucket maximum, but not above the maximum value
+/// @param histogram the histogram
+/// @param percent the percent, 0 to 100
+/// @return the value, 0 if the histogram is empty
+uint64_t stats_histogram_get_percentile(const stats_histogram_t *histogram,
+                                        const double percent) {
+  if (!histogram->count) return 0;
+  uint64_t rank = (uint64_t)(histogram->count * percent / 100.0);
+  if (rank >= histogram->count) rank = histogram->count - 1;
+  int bucket = 0;
+  uint64_t seen = histogram->buckets[0];
+  while (seen <= rank && bucket < STATS_HISTOGRAM_BUCKETS - 1) {
+    seen += histogram->buckets[++bucket];
+  }
+  const uint64_t value = stats_histogram_get_bucket_max(bucket);
+  return value < histogram->max_ns ? value : histogram->max_ns;
+}
+
+/// @brief start timing a backend call
+/// @return the start time, 0 if no statistics are bound to the thread
+uint64_t stats_begin_call(void) {
+  return bound_stats ? get_monotonic_ns() : 0;
+}
+
+/// @brief account the time of a backend call
+/// @param call the call
+/// @param start_ns the value stats_begin_call() returned
+void stats_end_call(const stats_call_t call, const uint64_t start_ns) {
+  if (!bound_stats || !start_ns) return;
+  stats_histogram_record(&bound_stats->calls[call],
+                         get_monotonic_ns() - start_ns);
+}
+
+/// @brief account a transition
+/// @param state the state the transition is from
+void stats_count_transition(const int state) {
+  if (bound_stats && state >= 0 && state < STATS_STATES_COUNT) {
+    ++bound_stats->transitions[state];
+  }
+}
@@ -0,0 +1,79 @@
+#ifndef TETRIS_STATS
+#define TETRIS_STATS
+
+/// @file stats.h
+/// @brief Declaration of the FSM instrumentation: the transitions count per
+/// state and a latency histogram per backend call. fsm_apply_input() accounts
+/// to the statistics bound to the calling thread and does nothing but a check
+/// of the binding when there are none, so every thread or every context keeps
+/// its own statistics and they are merged on demand. With TETRIS_NO_STATS
+/// defined the hooks are compiled out of the FSM. The histogram buckets are
+/// log-linear: STATS_SUB_BUCKETS linear buckets per power of two of
+/// nanoseconds, so a bucket is at most 1/STATS_SUB_BUCKETS of its value wide
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#define STATS_STATES_COUNT 12
+#define STATS_SUB_BUCKETS_BITS 2
+#define STATS_SUB_BUCKETS (1 << STATS_SUB_BUCKETS_BITS)
+// the last bucket takes everything from 7 * 2^38 ns, about 32 minutes
+#define STATS_HISTOGRAM_BUCKETS (40 * STATS_SUB_BUCKETS)
+
+typedef enum {
+  STATS_INIT_GAME = 0,
+  STATS_SETUP_NEW_GAME,
+  STATS_SPAWN,
+  STATS_MOVE_LEFT,
+  STATS_MOVE_RIGHT,
+  STATS_ROTATE,
+  STATS_DROP,
+  STATS_LOCK,
+  STATS_OVERFLOW,
+  STATS_CUT,
+  STATS_DESTROY_GAME,
+  STATS_CALLS_COUNT
+} stats_call_t;
+
+typedef struct {
+  uint64_t count;
+  uint64_t total_ns;
+  uint64_t max_ns;
+  uint64_t buckets[STATS_HISTOGRAM_BUCKETS];
+} stats_histogram_t;
+
+/// @brief transitions[s] counts the transitions from the state s
+typedef struct {
+  uint64_t transitions[STATS_STATES_COUNT];
+  stats_histogram_t calls[STATS_CALLS_COUNT];
+} fsm_stats_t;
+
+void fsm_stats_reset(fsm_stats_t *);
+fsm_stats_t *fsm_stats_bind(fsm_stats_t *);
+void fsm_stats_merge(fsm_stats_t *, const fsm_stats_t *other);
+void fsm_stats_print(FILE *, const fsm_stats_t *);
+const char *fsm_stats_get_call_name(const stats_call_t call);
+
+int stats_histogram_get_bucket(const uint64_t ns);
+uint64_t stats_histogram_get_bucket_max(const int bucket);
+void stats_histogram_record(stats_histogram_t *, const uint64_t ns);
+void stats_histogram_merge(stats_histogram_t *, const stats_histogram_t *);
+uint64_t stats_histogram_get_percentile(const stats_histogram_t *,
+                                        const double percent);
+
+uint64_t stats_begin_call(void);
+void stats_end_call(const stats_call_t call, const uint64_t start_ns);
+void stats_count_transition(const int state);
+
+#ifdef TETRIS_NO_STATS
+#define STATS_BEGIN_CALL() 0
+#define STATS_END_CALL(call, start_ns) ((void)(start_ns))
+#define STATS_COUNT_TRANSITION(state) ((void)0)
+#else
+#define STATS_BEGIN_CALL() stats_begin_call()
+#define STATS_END_CALL(call, start_ns) stats_end_call(call, start_ns)
+#define STATS_COUNT_TRANSITION(state) stats_count_transition(state)
+#endif
+
+#endif
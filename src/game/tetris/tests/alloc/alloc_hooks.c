@@ -0,0 +1,45 @@
+#include "alloc_hooks.h"
+
+/// @file alloc_hooks.c
+/// @brief Implementation of the heap allocation counter
+
+#include <stdbool.h>
+
+void *__libc_malloc(size_t size);
+void *__libc_calloc(size_t count, size_t size);
+void *__libc_realloc(void *ptr, size_t size);
+void __libc_free(void *ptr);
+
+static bool counting;
+static size_t allocations;
+
+/// @brief start counting the allocations from zero
+/// @param
+void alloc_hooks_start_counting(void) {
+  allocations = 0;
+  counting = true;
+}
+
+/// @brief stop counting the allocations
+/// @return number of allocations since the counting was started
+size_t alloc_hooks_stop_counting(void) {
+  counting = false;
+  return allocations;
+}
+
+void *malloc(size_t size) {
+  if (counting) ++allocations;
+  return __libc_malloc(size);
+}
+
+void *calloc(size_t count, size_t size) {
+  if (counting) ++allocations;
+  return __libc_calloc(count, size);
+}
+
+void *realloc(void *ptr, size_t size) {
+  if (counting) ++allocations;
+  return __libc_realloc(ptr, size);
+}
+
+void free(void *ptr) { __libc_free(ptr); }
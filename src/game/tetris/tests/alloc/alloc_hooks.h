@@ -0,0 +1,13 @@
+#ifndef TETRIS_ALLOC_HOOKS
+#define TETRIS_ALLOC_HOOKS
+
+/// @file alloc_hooks.h
+/// @brief Declaration of the heap allocation counter. The hooks replace the
+/// malloc family of the test binary, relying on the glibc __libc_* entries
+
+#include <stddef.h>
+
+void alloc_hooks_start_counting(void);
+size_t alloc_hooks_stop_counting(void);
+
+#endif
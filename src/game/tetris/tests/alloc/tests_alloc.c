@@ -0,0 +1,97 @@
+#include <limits.h>
+
+#include "../tests.h"
+#include "alloc_hooks.h"
+
+START_TEST(t_alloc_backend_hot_path) {
+  tetris_game_t game = {0};
+  ck_assert_int_eq(backend_init_game(&game), false);
+  backend_setup_new_game(&game);
+  // a new high score is persisted, that is not a part of the hot path
+  game.game.high_score = INT_MAX;
+  alloc_hooks_start_counting();
+  bool game_over = backend_spawn_new_figure(&game);
+  for (int i = 0; !game_over && i != 100000; ++i) {
+    switch (i % 5) {
+      case 0:
+        backend_move_left_current_figure(&game);
+        break;
+      case 1:
+        backend_rotate_current_figure(&game);
+        break;
+      case 2:
+        backend_move_right_current_figure(&game);
+        break;
+      default:
+        if (backend_drop_current_figure(&game)) {
+          backend_lock_current_figure(&game);
+          game_over = backend_get_overflow(&game);
+          backend_cut_filled_rows(&game);
+          game_over = game_over || backend_spawn_new_figure(&game);
+        }
+        break;
+    }
+  }
+  const size_t allocations = alloc_hooks_stop_counting();
+  ck_assert_uint_eq(allocations, 0);
+  backend_destroy_game(&game);
+}
+END_TEST
+
+START_TEST(t_alloc_fsm_hot_path) {
+  tetris_game_t game = {0};
+  tetris_state_t state = PRESTART;
+  fsm_apply_input(NO_INPUT, &state, &game);
+  fsm_apply_input(START_BTN, &state, &game);
+  game.game.high_score = INT_MAX;
+  const fsm_input_t inputs[] = {MOVE_LEFT, ROTATE_BTN, AUTOSHIFT_SIG,
+                                MOVE_RIGHT, MOVE_DOWN, AUTOSHIFT_SIG};
+  alloc_hooks_start_counting();
+  for (int i = 0; state != GAMEOVER && i != 100000; ++i) {
+    fsm_apply_input(inputs[i % 6], &state, &game);
+  }
+  const size_t allocations = alloc_hooks_stop_counting();
+  ck_assert_uint_eq(allocations, 0);
+  fsm_apply_input(EXIT_BTN, &state, &game);
+  fsm_apply_input(NO_INPUT, &state, &game);
+}
+END_TEST
+
+START_TEST(t_alloc_context_update) {
+  tetris_context_t *context = tetris_context_create();
+  ck_assert_ptr_nonnull(context);
+  tetris_context_user_input(context, Start, true);
+  tetris_context_update_current_state(context);
+  context->core.game.game.high_score = INT_MAX;
+  const UserAction_t actions[] = {Left, Action, Down, Right, Down};
+  alloc_hooks_start_counting();
+  for (int i = 0; !tetris_context_get_game_over(context) && i != 100000;
+       ++i) {
+    tetris_context_user_input(context, actions[i % 5], true);
+    tetris_context_update_current_state(context);
+  }
+  const size_t allocations = alloc_hooks_stop_counting();
+  ck_assert_uint_eq(allocations, 0);
+  tetris_context_destroy(context);
+}
+END_TEST
+
+Suite *ts_alloc(void) {
+  Suite *s1 = suite_create("ts_alloc");
+  TCase *t1 = tcase_create("tc_alloc");
+
+  suite_add_tcase(s1, t1);
+  tcase_add_test(t1, t_alloc_backend_hot_path);
+  tcase_add_test(t1, t_alloc_fsm_hot_path);
+  tcase_add_test(t1, t_alloc_context_update);
+
+  return s1;
+}
+
+int main(void) {
+  SRunner *r = srunner_create(ts_alloc());
+  srunner_run_all(r, CK_VERBOSE);
+  const int failed = srunner_ntests_failed(r);
+  srunner_free(r);
+  return failed;
+}
@@ -9,11 +9,39 @@ int main(void) {
   Suite *s2 = ts_lib();
   Suite *s3 = ts_figures();
   Suite *s4 = ts_fsm();
+  Suite *s5 = ts_context();
+  Suite *s6 = ts_bitboard();
+  Suite *s7 = ts_randomizer();
+  Suite *s8 = ts_input_queue();
+  Suite *s9 = ts_replay();
+  Suite *s10 = ts_placement();
+  Suite *s11 = ts_autoplay();
+  Suite *s12 = ts_search();
+  Suite *s13 = ts_stats();
+  Suite *s14 = ts_high_score();
+  Suite *s15 = ts_leaderboard();
+  Suite *s16 = ts_timer_heap();
+  Suite *s17 = ts_spectator();
+  Suite *s18 = ts_board();
 
   ftc += srun_all(s1);
   ftc += srun_all(s2);
   ftc += srun_all(s3);
   ftc += srun_all(s4);
+  ftc += srun_all(s5);
+  ftc += srun_all(s6);
+  ftc += srun_all(s7);
+  ftc += srun_all(s8);
+  ftc += srun_all(s9);
+  ftc += srun_all(s10);
+  ftc += srun_all(s11);
+  ftc += srun_all(s12);
+  ftc += srun_all(s13);
+  ftc += srun_all(s14);
+  ftc += srun_all(s15);
+  ftc += srun_all(s16);
+  ftc += srun_all(s17);
+  ftc += srun_all(s18);
 
   return ftc;
 }
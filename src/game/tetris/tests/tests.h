@@ -4,6 +4,7 @@
 #include <check.h>
 
 #include "../backend.h"
+#include "../context.h"
 #include "../defines.h"
 #include "../figures.h"
 #include "../fsm.h"
@@ -13,5 +14,19 @@ Suite *ts_backend(void);
 Suite *ts_lib(void);
 Suite *ts_figures(void);
 Suite *ts_fsm(void);
+Suite *ts_context(void);
+Suite *ts_bitboard(void);
+Suite *ts_randomizer(void);
+Suite *ts_input_queue(void);
+Suite *ts_replay(void);
+Suite *ts_placement(void);
+Suite *ts_autoplay(void);
+Suite *ts_search(void);
+Suite *ts_stats(void);
+Suite *ts_high_score(void);
+Suite *ts_leaderboard(void);
+Suite *ts_timer_heap(void);
+Suite *ts_spectator(void);
+Suite *ts_board(void);
 
 #endif
@@ -0,0 +1,149 @@
+#include "../autoplay.h"
+#include "tests.h"
+
+/// @brief an evaluator that wants the leftmost column filled
+/// @param board the occupancy bitboard
+/// @param cut_rows number of the cut rows
+/// @param data unused
+/// @return number of the occupied cells in the column 0
+double evaluate_left_column(const row_mask_t *board, const int cut_rows,
+                            const void *data) {
+  (void)cut_rows;
+  (void)data;
+  int cells = 0;
+  for (int r = 0; r != FIELD_TOTAL_HEIGHT; ++r) cells += board[r] & 1u;
+  return cells;
+}
+
+START_TEST(t_autoplay_features) {
+  row_mask_t board[FIELD_TOTAL_HEIGHT] = {0};
+  // the column 0 covers a hole, the others are one cell high
+  board[FIELD_TOTAL_HEIGHT - 1] = 0x3FE;
+  board[FIELD_TOTAL_HEIGHT - 2] = 0x1;
+  board[FIELD_TOTAL_HEIGHT - 3] = 0x1;
+  autoplay_features_t features;
+  autoplay_get_features(board, 1, &features);
+  ck_assert_int_eq(features.height, 12);
+  ck_assert_int_eq(features.holes, 1);
+  ck_assert_int_eq(features.bumpiness, 2);
+  ck_assert_int_eq(features.wells, 0);
+  ck_assert_int_eq(features.lines, 1);
+  // a two cells deep well in the column 5
+  board[FIELD_TOTAL_HEIGHT - 1] = FULL_ROW_MASK & ~(1u << 5);
+  board[FIELD_TOTAL_HEIGHT - 2] = FULL_ROW_MASK & ~(1u << 5);
+  board[FIELD_TOTAL_HEIGHT - 3] = 0;
+  autoplay_get_features(board, 0, &features);
+  ck_assert_int_eq(features.height, 18);
+  ck_assert_int_eq(features.holes, 0);
+  ck_assert_int_eq(features.bumpiness, 4);
+  ck_assert_int_eq(features.wells, 2);
+  const autoplay_weights_t weights = {-1, 0, 0, -10, 0};
+  ck_assert(autoplay_evaluate_heuristic(board, 0, &weights) == -38);
+}
+END_TEST
+
+START_TEST(t_autoplay_weights) {
+  autoplay_weights_t weights = autoplay_default_weights;
+  ck_assert_int_eq(autoplay_parse_weights("-1,-2.5,0,3,4e1", &weights), false);
+  ck_assert(weights.height == -1);
+  ck_assert(weights.holes == -2.5);
+  ck_assert(weights.bumpiness == 0);
+  ck_assert(weights.wells == 3);
+  ck_assert(weights.lines == 40);
+  ck_assert_int_eq(autoplay_parse_weights("1,2,3,4", &weights), true);
+  ck_assert_int_eq(autoplay_parse_weights("1,2,3,4,5,6", &weights), true);
+  ck_assert_int_eq(autoplay_parse_weights("1,2,x,4,5", &weights), true);
+  ck_assert_int_eq(autoplay_parse_weights(NULL, &weights), true);
+  ck_assert(weights.lines == 40);
+}
+END_TEST
+
+START_TEST(t_autoplay_evaluator) {
+  static tetris_game_t game;
+  backend_init_game(&game);
+  backend_get_spawned_figure(0, &game.current_figure);
+  static autoplay_t autoplay;
+  autoplay_init(&autoplay, evaluate_left_column, NULL);
+  fsm_input_t signal = NO_INPUT;
+  int moves = 0;
+  while ((signal = autoplay_get_signal(&autoplay, &game)) != AUTOSHIFT_SIG) {
+    if (signal == MOVE_LEFT) backend_move_left_current_figure(&game);
+    if (signal == MOVE_RIGHT) backend_move_right_current_figure(&game);
+    if (signal == ROTATE_BTN) backend_rotate_current_figure(&game);
+    if (signal == MOVE_DOWN) backend_drop_current_figure(&game);
+    ck_assert_int_lt(++moves, PLACEMENT_PATH_MAX);
+  }
+  // the I figure is put upright into the column 0
+  ck_assert_int_eq(backend_drop_current_figure(&game), true);
+  backend_lock_current_figure(&game);
+  ck_assert_int_eq(evaluate_left_column(game.occupancy, 0, NULL), 4);
+  // a locked figure has no placements
+  ck_assert_int_eq(autoplay_get_signal(&autoplay, &game), NO_INPUT);
+}
+END_TEST
+
+START_TEST(t_autoplay_game) {
+  tetris_context_t *context = tetris_context_create();
+  ck_assert_ptr_nonnull(context);
+  const tetris_setup_t setup = {5, RANDOMIZER_BAG, BOARD_STANDARD};
+  tetris_context_configure(context, &setup);
+  static autoplay_t autoplay;
+  autoplay_init(&autoplay, NULL, NULL);
+  tetris_context_apply_signal(context, START_BTN);
+  int pieces = 0;
+  while (context->core.state != GAMEOVER && pieces != 500) {
+    fsm_input_t signal = NO_INPUT;
+    if (context->core.state == SPAWNING) ++pieces;
+    if (context->core.state == IDLE) {
+      signal = autoplay_get_signal(&autoplay, &context->core.game);
+    }
+    tetris_context_apply_signal(context, signal);
+  }
+  ck_assert_int_eq(pieces, 500);
+  // 500 figures of 4 cells do not fit without cutting 180 rows
+  ck_assert_int_ge(context->core.game.game.score, 180 * 100);
+  tetris_context_destroy(context);
+}
+END_TEST
+
+START_TEST(t_autoplay_context) {
+  tetris_context_t *context = tetris_context_create();
+  ck_assert_ptr_nonnull(context);
+  game_clock_t clock = {0};
+  game_clock_init(&clock, GAME_CLOCK_MANUAL, 1);
+  tetris_context_set_clock(context, &clock);
+  static autoplay_t autoplay;
+  autoplay_init(&autoplay, NULL, NULL);
+  tetris_context_set_autoplay(context, &autoplay, 50);
+  // the autoplay starts the game itself and wakes the loop for its moves
+  ck_assert_int_eq(tetris_context_get_ms_to_next_update(context), 50);
+  for (int i = 0; i != 20000; ++i) {
+    tetris_context_advance_clock_ms(context, 50);
+    tetris_context_update_current_state(context);
+    ck_assert_int_le(tetris_context_get_ms_to_next_update(context), 50);
+    // the moves do not go through the queue of the input thread
+    ck_assert_uint_eq(atomic_load(&context->input.tail), 0);
+  }
+  ck_assert_int_ne(context->core.state, START);
+  ck_assert_int_gt(context->core.game.randomizer.dealt, 20);
+  // without the autoplay only the autoshift is waited for
+  tetris_context_set_autoplay(context, NULL, 0);
+  tetris_context_update_current_state(context);
+  ck_assert_int_gt(tetris_context_get_ms_to_next_update(context), 50);
+  tetris_context_destroy(context);
+}
+END_TEST
+
+Suite *ts_autoplay(void) {
+  Suite *s1 = suite_create("ts_autoplay");
+  TCase *t1 = tcase_create("tc_autoplay");
+
+  suite_add_tcase(s1, t1);
+  tcase_add_test(t1, t_autoplay_features);
+  tcase_add_test(t1, t_autoplay_weights);
+  tcase_add_test(t1, t_autoplay_evaluator);
+  tcase_add_test(t1, t_autoplay_game);
+  tcase_add_test(t1, t_autoplay_context);
+
+  return s1;
+}
@@ -6,6 +6,7 @@ START_TEST(t_backend_init_destroy_overflow) {
   tetris_game_t game = {0};
   ck_assert_int_eq(backend_init_game(&game), false);
   game.game.field[0][3] = 1;
+  backend_sync_occupancy(&game);
   ck_assert_int_eq(backend_get_overflow(&game), true);
   backend_destroy_game(&game);
 }
@@ -42,27 +43,32 @@ bool matrix_assert_pattern(int **m, const int r, const int c, int q) {
 START_TEST(t_backend_cut_filled) {
   tetris_game_t game = {0};
   ck_assert_int_eq(backend_init_game(&game), false);
-  matrix_fill_pattern(game.game.field + 5, 10, FIELD_WIDTH, 3);
-  fill_matrix(game.game.field + 20, FIELD_TOTAL_HEIGHT - 20, FIELD_WIDTH, 1);
-  ck_assert_int_eq(
-      matrix_assert_pattern(game.game.field + 5, 10, FIELD_WIDTH, 3), true);
+  tetris_game_view_t view;
+  int **field = backend_get_game_info(&game, &view).field;
+  matrix_fill_pattern(field + 5, 10, FIELD_WIDTH, 3);
+  fill_matrix(field + 20, FIELD_TOTAL_HEIGHT - 20, FIELD_WIDTH, 1);
+  ck_assert_int_eq(matrix_assert_pattern(field + 5, 10, FIELD_WIDTH, 3), true);
+  backend_sync_occupancy(&game);
   backend_cut_filled_rows(&game);
-  ck_assert_int_eq(
-      matrix_assert_pattern(game.game.field + 9, 10, FIELD_WIDTH, 3), true);
+  ck_assert_int_eq(matrix_assert_pattern(field + 9, 10, FIELD_WIDTH, 3), true);
   ck_assert_int_eq(game.game.score, 1500);
   ck_assert_int_eq(game.game.level, 2);
-  fill_matrix(game.game.field + 21, FIELD_TOTAL_HEIGHT - 21, FIELD_WIDTH, 1);
+  fill_matrix(field + 21, FIELD_TOTAL_HEIGHT - 21, FIELD_WIDTH, 1);
+  backend_sync_occupancy(&game);
   backend_cut_filled_rows(&game);
   ck_assert_int_eq(game.game.score, 2200);
   ck_assert_int_eq(game.game.level, 3);
-  fill_matrix(game.game.field + 22, FIELD_TOTAL_HEIGHT - 22, FIELD_WIDTH, 1);
+  fill_matrix(field + 22, FIELD_TOTAL_HEIGHT - 22, FIELD_WIDTH, 1);
+  backend_sync_occupancy(&game);
   backend_cut_filled_rows(&game);
   ck_assert_int_eq(game.game.score, 2500);
   ck_assert_int_eq(game.game.level, 4);
-  fill_matrix(game.game.field + 23, FIELD_TOTAL_HEIGHT - 23, FIELD_WIDTH, 1);
+  fill_matrix(field + 23, FIELD_TOTAL_HEIGHT - 23, FIELD_WIDTH, 1);
+  backend_sync_occupancy(&game);
   backend_cut_filled_rows(&game);
   ck_assert_int_eq(game.game.score, 2600);
   ck_assert_int_eq(game.game.level, 4);
+  ck_assert_int_eq(game.game.lines, 4 + 3 + 2 + 1);
   backend_destroy_game(&game);
 }
 END_TEST
@@ -70,18 +76,20 @@ END_TEST
 START_TEST(t_backend_cut_filled_multiple_through_not_filled) {
   tetris_game_t game = {0};
   ck_assert_int_eq(backend_init_game(&game), false);
-  matrix_fill_pattern(game.game.field + 5, 10, FIELD_WIDTH, 3);
-  fill_matrix(game.game.field + 20, FIELD_TOTAL_HEIGHT - 20, FIELD_WIDTH, 1);
-  fill_matrix(game.game.field + 21, 1, FIELD_WIDTH, 0);
+  tetris_game_view_t view;
+  int **field = backend_get_game_info(&game, &view).field;
+  matrix_fill_pattern(field + 5, 10, FIELD_WIDTH, 3);
+  fill_matrix(field + 20, FIELD_TOTAL_HEIGHT - 20, FIELD_WIDTH, 1);
+  fill_matrix(field + 21, 1, FIELD_WIDTH, 0);
   game.game.field[21][1] = 9;
   game.game.field[21][8] = 8;
-  print_matrix(game.game.field, FIELD_TOTAL_HEIGHT, FIELD_WIDTH);
+  print_matrix(field, FIELD_TOTAL_HEIGHT, FIELD_WIDTH);
+  backend_sync_occupancy(&game);
   backend_cut_filled_rows(&game);
-  print_matrix(game.game.field, FIELD_TOTAL_HEIGHT, FIELD_WIDTH);
+  print_matrix(field, FIELD_TOTAL_HEIGHT, FIELD_WIDTH);
   ck_assert_int_eq(game.game.score, 400);
   ck_assert_int_eq(game.game.level, 0);
-  ck_assert_int_eq(
-      matrix_assert_pattern(game.game.field + 8, 10, FIELD_WIDTH, 3), true);
+  ck_assert_int_eq(matrix_assert_pattern(field + 8, 10, FIELD_WIDTH, 3), true);
   backend_destroy_game(&game);
 }
 END_TEST
@@ -89,7 +97,9 @@ END_TEST
 START_TEST(t_backend_setup_new) {
   tetris_game_t game = {0};
   ck_assert_int_eq(backend_init_game(&game), false);
-  matrix_fill_pattern(game.game.field + 5, 10, FIELD_WIDTH, 3);
+  tetris_game_view_t view;
+  int **field = backend_get_game_info(&game, &view).field;
+  matrix_fill_pattern(field + 5, 10, FIELD_WIDTH, 3);
   game.game.score = 10000;
   game.game.level = 10000;
 
@@ -132,30 +142,107 @@ START_TEST(t_backend_drop) {
 }
 END_TEST
 
+bool field_has_no_empty_cells(int field[FIELD_TOTAL_HEIGHT][FIELD_WIDTH]) {
+  bool full = true;
+  for (int r = 0; full && r < FIELD_TOTAL_HEIGHT; ++r) {
+    for (int c = 0; full && c < FIELD_WIDTH; ++c) {
+      full = field[r][c] != 0;
+    }
+  }
+  return full;
+}
+
+bool figure_is_at(const figure_t *figure, const int rotation, const int r,
+                  const int c) {
+  return figure->rotation == rotation && figure->position.r == r &&
+         figure->position.c == c;
+}
+
 START_TEST(t_backend_rotate_move) {
   tetris_game_t game = {0};
   ck_assert_int_eq(backend_init_game(&game), false);
   backend_setup_new_game(&game);
   ck_assert_int_eq(backend_spawn_new_figure(&game), false);
   backend_drop_current_figure(&game);
-  fill_matrix(game.game.field, FIELD_TOTAL_HEIGHT, FIELD_WIDTH, 0);
-  matrix_fill_pattern(game.game.field + FIELD_UPPER_MARGIN, 10, FIELD_WIDTH, 3);
-  fill_matrix(game.current_figure.mask, 4, 4, 1);
-  backend_rotate_current_figure(&game);
-  backend_rotate_current_figure(&game);
-  backend_rotate_current_figure(&game);
-  backend_rotate_current_figure(&game);
-  ck_assert_int_eq(matrix_assert_pattern(game.game.field + FIELD_UPPER_MARGIN,
-                                         10, FIELD_WIDTH, 3),
-                   true);
+  // wall the figure in, so that neither a rotation nor a move is possible
+  for (int r = 0; r < FIELD_TOTAL_HEIGHT; ++r) {
+    for (int c = 0; c < FIELD_WIDTH; ++c) {
+      if (!game.game.field[r][c]) game.game.field[r][c] = 9;
+    }
+  }
+  backend_sync_occupancy(&game);
+  const figure_t figure = game.current_figure;
+  for (int i = 0; i != 4; ++i) {
+    backend_rotate_current_figure(&game);
+    ck_assert_int_eq(figure_is_at(&game.current_figure, figure.rotation,
+                                  figure.position.r, figure.position.c),
+                     true);
+  }
   backend_move_left_current_figure(&game);
-  ck_assert_int_eq(matrix_assert_pattern(game.game.field + FIELD_UPPER_MARGIN,
-                                         10, FIELD_WIDTH, 3),
+  ck_assert_int_eq(figure_is_at(&game.current_figure, figure.rotation,
+                                figure.position.r, figure.position.c),
                    true);
   backend_move_right_current_figure(&game);
-  ck_assert_int_eq(matrix_assert_pattern(game.game.field + FIELD_UPPER_MARGIN,
-                                         10, FIELD_WIDTH, 3),
+  ck_assert_int_eq(figure_is_at(&game.current_figure, figure.rotation,
+                                figure.position.r, figure.position.c),
                    true);
+  ck_assert_int_eq(field_has_no_empty_cells(game.game.field), true);
+  backend_destroy_game(&game);
+}
+END_TEST
+
+START_TEST(t_backend_rotate_wall_kick) {
+  tetris_game_t game = {0};
+  ck_assert_int_eq(backend_init_game(&game), false);
+  backend_setup_new_game(&game);
+  // vertical I at the left wall: the plain rotation is out of the field
+  game.current_figure.id = 0;
+  game.current_figure.rotation = 1;
+  game.current_figure.position.r = 10;
+  game.current_figure.position.c = -1;
+  backend_rotate_current_figure(&game);
+  ck_assert_int_eq(figure_is_at(&game.current_figure, 2, 10, 0), true);
+  for (int c = 0; c < 4; ++c) {
+    ck_assert_int_eq(game.game.field[11][c], get_figure_colour(0));
+  }
+  // T in a notch: the rotation is taken by the second kick
+  backend_setup_new_game(&game);
+  game.current_figure.id = 5;
+  game.current_figure.rotation = 0;
+  game.current_figure.position.r = 10;
+  game.current_figure.position.c = 4;
+  game.game.field[13][5] = 9;
+  backend_sync_occupancy(&game);
+  backend_rotate_current_figure(&game);
+  ck_assert_int_eq(figure_is_at(&game.current_figure, 1, 10, 3), true);
+  backend_destroy_game(&game);
+}
+END_TEST
+
+START_TEST(t_backend_dirty_rows) {
+  const dirty_rows_t all_rows = ((dirty_rows_t)1 << FIELD_TOTAL_HEIGHT) - 1;
+  tetris_game_t game = {0};
+  ck_assert_int_eq(backend_init_game(&game), false);
+  tetris_game_view_t view;
+  int **field = backend_get_game_info(&game, &view).field;
+  backend_setup_new_game(&game);
+  ck_assert_uint_eq(backend_take_dirty_rows(&game), all_rows);
+  ck_assert_uint_eq(backend_take_dirty_rows(&game), 0);
+  backend_spawn_new_figure(&game);
+  backend_take_dirty_rows(&game);
+  // the figure box spans rows 3-6 at the spawn
+  const unsigned long generation = game.generation;
+  backend_move_left_current_figure(&game);
+  const dirty_rows_t figure_rows = backend_take_dirty_rows(&game);
+  ck_assert_uint_ne(figure_rows, 0);
+  ck_assert_uint_eq(figure_rows & ~((dirty_rows_t)0xF << 3), 0);
+  ck_assert_uint_gt(game.generation, generation);
+  // a cut shifts every row above the cut one
+  fill_matrix(field + FIELD_TOTAL_HEIGHT - 1, 1, FIELD_WIDTH, 9);
+  backend_sync_occupancy(&game);
+  backend_take_dirty_rows(&game);
+  backend_cut_filled_rows(&game);
+  ck_assert_uint_eq(backend_take_dirty_rows(&game), all_rows);
   backend_destroy_game(&game);
 }
 END_TEST
@@ -170,7 +257,9 @@ Suite *ts_backend(void) {
   tcase_add_test(t1, t_backend_setup_new);
   tcase_add_test(t1, t_backend_drop);
   tcase_add_test(t1, t_backend_rotate_move);
+  tcase_add_test(t1, t_backend_rotate_wall_kick);
   tcase_add_test(t1, t_backend_cut_filled_multiple_through_not_filled);
+  tcase_add_test(t1, t_backend_dirty_rows);
 
   return s1;
 }
@@ -0,0 +1,79 @@
+#include "../bitboard.h"
+#include "../board.h"
+#include "../matrix.h"
+#include "tests.h"
+
+START_TEST(t_bitboard_collision_bounds) {
+  row_mask_t board[FIELD_TOTAL_HEIGHT] = {0};
+  const row_mask_t figure[MAX_FIGURE_SIZE] = {0, 0x2, 0x7, 0};
+  const board_variant_t *standard = board_get_variant(BOARD_STANDARD);
+  ck_assert_int_eq(standard->get_collision(board, figure, 0, 0), false);
+  ck_assert_int_eq(standard->get_collision(board, figure, 0, -1), true);
+  ck_assert_int_eq(standard->get_collision(board, figure, 0, FIELD_WIDTH - 3),
+                   false);
+  ck_assert_int_eq(standard->get_collision(board, figure, 0, FIELD_WIDTH - 2),
+                   true);
+  ck_assert_int_eq(
+      standard->get_collision(board, figure, FIELD_TOTAL_HEIGHT - 3, 0), false);
+  ck_assert_int_eq(
+      standard->get_collision(board, figure, FIELD_TOTAL_HEIGHT - 2, 0), true);
+  ck_assert_int_eq(standard->get_collision(board, figure, -1, 0), false);
+  ck_assert_int_eq(standard->get_collision(board, figure, -2, 0), true);
+}
+END_TEST
+
+START_TEST(t_bitboard_collision_place_shift) {
+  row_mask_t board[FIELD_TOTAL_HEIGHT] = {0};
+  const row_mask_t figure[MAX_FIGURE_SIZE] = {0, 0x2, 0x7, 0};
+  const board_variant_t *standard = board_get_variant(BOARD_STANDARD);
+  bitboard_place_rows(board, FIELD_TOTAL_HEIGHT, figure, MAX_FIGURE_SIZE, 10,
+                      4);
+  ck_assert_uint_eq(board[11], 0x2 << 4);
+  ck_assert_uint_eq(board[12], 0x7 << 4);
+  ck_assert_int_eq(standard->get_collision(board, figure, 9, 4), true);
+  ck_assert_int_eq(standard->get_collision(board, figure, 10, 7), false);
+  board[13] = FULL_ROW_MASK;
+  ck_assert_int_eq(bitboard_get_is_a_filled_row(board, 12), false);
+  ck_assert_int_eq(bitboard_get_is_a_filled_row(board, 13), true);
+  bitboard_shift_down_rows(board, 13, 1);
+  ck_assert_uint_eq(board[11], 0);
+  ck_assert_uint_eq(board[12], 0x2 << 4);
+  ck_assert_uint_eq(board[13], 0x7 << 4);
+}
+END_TEST
+
+START_TEST(t_bitboard_follows_the_field) {
+  tetris_game_t game = {0};
+  tetris_state_t state = PRESTART;
+  fsm_apply_input(NO_INPUT, &state, &game);
+  fsm_apply_input(START_BTN, &state, &game);
+  const fsm_input_t moves[] = {MOVE_LEFT,  ROTATE_BTN, MOVE_RIGHT,
+                               MOVE_RIGHT, ROTATE_BTN, MOVE_LEFT};
+  for (int i = 0; i != 2000; ++i) {
+    fsm_apply_input(moves[i % 6], &state, &game);
+    fsm_apply_input(AUTOSHIFT_SIG, &state, &game);
+    fsm_apply_input(NO_INPUT, &state, &game);
+    // a spawned figure overlaps the locked cells on game over
+    if (state == GAMEOVER) break;
+    tetris_game_t expected = game;
+    backend_sync_occupancy(&expected);
+    for (int r = 0; r != FIELD_TOTAL_HEIGHT; ++r) {
+      ck_assert_uint_eq(game.occupancy[r], expected.occupancy[r]);
+    }
+  }
+  fsm_apply_input(EXIT_BTN, &state, &game);
+  fsm_apply_input(NO_INPUT, &state, &game);
+}
+END_TEST
+
+Suite *ts_bitboard(void) {
+  Suite *s1 = suite_create("ts_bitboard");
+  TCase *t1 = tcase_create("tc_bitboard");
+
+  suite_add_tcase(s1, t1);
+  tcase_add_test(t1, t_bitboard_collision_bounds);
+  tcase_add_test(t1, t_bitboard_collision_place_shift);
+  tcase_add_test(t1, t_bitboard_follows_the_field);
+
+  return s1;
+}
@@ -0,0 +1,182 @@
+#include <stdlib.h>
+
+#include "../replay.h"
+#include "../replay_player.h"
+#include "tests.h"
+
+/// @brief play a game of a board with random presses on a manual clock,
+/// checking that nothing is drawn out of the board
+/// @param context the context, in the START state
+/// @param seed game and presses seed
+/// @param kind the board kind
+void play_random_board_game(tetris_context_t *context, uint64_t seed,
+                            const board_kind_t kind) {
+  const UserAction_t actions[] = {Left, Right, Up, Action, Down};
+  const board_variant_t *board = board_get_variant(kind);
+  xoshiro256_t presses;
+  xoshiro_seed(&presses, seed);
+  const tetris_setup_t setup = {seed, RANDOMIZER_BAG, kind};
+  tetris_context_configure(context, &setup);
+  tetris_context_user_input(context, Start, true);
+  tetris_context_update_current_state(context);
+  for (int i = 0; i != 200000 && context->core.state != GAMEOVER; ++i) {
+    tetris_context_advance_clock_ms(context, 20);
+    const uint32_t press = xoshiro_below(&presses, 16);
+    if (press < 5) tetris_context_user_input(context, actions[press], true);
+    tetris_context_update_current_state(context);
+    const tetris_game_t *game = &context->core.game;
+    for (int r = 0; r != FIELD_TOTAL_HEIGHT; ++r) {
+      for (int c = 0; c != FIELD_WIDTH; ++c) {
+        if (r < board->top || c >= board->width) {
+          ck_assert_int_eq(game->game.field[r][c], 0);
+        }
+      }
+    }
+  }
+  ck_assert_int_eq(context->core.state, GAMEOVER);
+  ck_assert_int_eq(context->core.game.board, kind);
+}
+
+START_TEST(t_board_variants) {
+  const int widths[BOARD_KINDS_COUNT] = {FIELD_WIDTH, BOARD_MINI_WIDTH,
+                                         BOARD_TRAINING_WIDTH};
+  const int heights[BOARD_KINDS_COUNT] = {FIELD_VISIBLE_HEIGHT,
+                                          BOARD_MINI_VISIBLE_HEIGHT,
+                                          BOARD_TRAINING_VISIBLE_HEIGHT};
+  for (int kind = 0; kind != BOARD_KINDS_COUNT; ++kind) {
+    const board_variant_t *board = board_get_variant((board_kind_t)kind);
+    ck_assert_int_eq(board->width, widths[kind]);
+    ck_assert_int_eq(board->visible_height, heights[kind]);
+    ck_assert_int_eq(board->top + FIELD_UPPER_MARGIN + heights[kind],
+                     FIELD_TOTAL_HEIGHT);
+    board_kind_t parsed = BOARD_KINDS_COUNT;
+    ck_assert_int_eq(board_parse_kind(board->name, &parsed), false);
+    ck_assert_int_eq(parsed, kind);
+  }
+  board_kind_t parsed = BOARD_MINI;
+  ck_assert_int_eq(board_parse_kind("huge", &parsed), true);
+  ck_assert_int_eq(parsed, BOARD_MINI);
+  ck_assert_ptr_eq(board_get_variant(BOARD_KINDS_COUNT),
+                   board_get_variant(BOARD_STANDARD));
+}
+END_TEST
+
+START_TEST(t_board_collision_bounds) {
+  // a horizontal I in the second row of its box
+  const row_mask_t rows[MAX_FIGURE_SIZE] = {0, 0xF, 0, 0};
+  row_mask_t occupancy[FIELD_TOTAL_HEIGHT] = {0};
+  for (int kind = 0; kind != BOARD_KINDS_COUNT; ++kind) {
+    const board_variant_t *board = board_get_variant((board_kind_t)kind);
+    const int last_c = board->width - MAX_FIGURE_SIZE;
+    const int last_r = FIELD_TOTAL_HEIGHT - 2;
+    ck_assert_int_eq(board->get_collision(occupancy, rows, last_r, 0), false);
+    ck_assert_int_eq(board->get_collision(occupancy, rows, last_r, last_c),
+                     false);
+    ck_assert_int_eq(board->get_collision(occupancy, rows, board->top - 1, 0),
+                     false);
+    ck_assert_int_eq(board->get_collision(occupancy, rows, last_r, -1), true);
+    ck_assert_int_eq(
+        board->get_collision(occupancy, rows, last_r, last_c + 1), true);
+    ck_assert_int_eq(board->get_collision(occupancy, rows, last_r + 1, 0),
+                     true);
+    ck_assert_int_eq(board->get_collision(occupancy, rows, board->top - 2, 0),
+                     true);
+    board->place_rows(occupancy, rows, last_r, last_c);
+    ck_assert_int_eq(occupancy[last_r + 1], 0xF << last_c);
+    ck_assert_int_eq(board->get_collision(occupancy, rows, last_r, 0),
+                     last_c < MAX_FIGURE_SIZE);
+    ck_assert_int_eq(board->get_filled_rows(occupancy),
+                     last_c ? 0 : 1u << (last_r + 1));
+    ck_assert_int_eq(board->get_overflow(occupancy), false);
+    occupancy[last_r + 1] = 0;
+    occupancy[board->top] = 1;
+    ck_assert_int_eq(board->get_overflow(occupancy), true);
+    occupancy[board->top] = 0;
+  }
+}
+END_TEST
+
+START_TEST(t_board_mini_cut) {
+  tetris_game_t game = {0};
+  ck_assert_int_eq(backend_init_game(&game), false);
+  const tetris_setup_t setup = {1, RANDOMIZER_BAG, BOARD_MINI};
+  backend_configure_game(&game, &setup);
+  backend_setup_new_game(&game);
+  ck_assert_int_eq(game.board, BOARD_MINI);
+  for (int c = 0; c != BOARD_MINI_WIDTH; ++c) {
+    game.game.field[FIELD_TOTAL_HEIGHT - 1][c] = 1;
+    game.game.field[FIELD_TOTAL_HEIGHT - 2][c] = c != 2;
+  }
+  backend_sync_occupancy(&game);
+  backend_cut_filled_rows(&game);
+  ck_assert_int_eq(game.game.lines, 1);
+  ck_assert_int_eq(game.game.score, 100);
+  for (int c = 0; c != BOARD_MINI_WIDTH; ++c) {
+    ck_assert_int_eq(game.game.field[FIELD_TOTAL_HEIGHT - 1][c], c != 2);
+    ck_assert_int_eq(game.game.field[FIELD_TOTAL_HEIGHT - 2][c], 0);
+  }
+  // the same row is not full on the standard board
+  game.board = BOARD_STANDARD;
+  game.game.field[FIELD_TOTAL_HEIGHT - 1][2] = 1;
+  backend_sync_occupancy(&game);
+  backend_cut_filled_rows(&game);
+  ck_assert_int_eq(game.game.lines, 1);
+  backend_destroy_game(&game);
+}
+END_TEST
+
+START_TEST(t_board_mixed_replay) {
+  FILE *file = tmpfile();
+  ck_assert_ptr_nonnull(file);
+  replay_writer_t *writer = replay_writer_create(file);
+  ck_assert_ptr_nonnull(writer);
+  tetris_context_t *live = tetris_context_create();
+  ck_assert_ptr_nonnull(live);
+  game_clock_t clock = {0};
+  game_clock_init(&clock, GAME_CLOCK_MANUAL, 1);
+  tetris_context_set_clock(live, &clock);
+  tetris_context_set_recorder(live, writer);
+  int scores[BOARD_KINDS_COUNT] = {0};
+  for (int kind = BOARD_KINDS_COUNT - 1; kind >= 0; --kind) {
+    play_random_board_game(live, 3 + kind, (board_kind_t)kind);
+    scores[kind] = live->core.game.game.score;
+  }
+  tetris_context_destroy(live);
+  ck_assert_int_eq(replay_writer_destroy(writer), false);
+  fseek(file, 0, SEEK_END);
+  const size_t size = (size_t)ftell(file);
+  rewind(file);
+  unsigned char *data = malloc(size);
+  ck_assert_ptr_nonnull(data);
+  ck_assert_uint_eq(fread(data, 1, size, file), size);
+  fclose(file);
+
+  replay_reader_t reader;
+  ck_assert_int_eq(replay_reader_init(&reader, data, size), false);
+  tetris_context_t *replayed = tetris_context_create();
+  ck_assert_ptr_nonnull(replayed);
+  for (int kind = BOARD_KINDS_COUNT - 1; kind >= 0; --kind) {
+    replay_game_result_t result;
+    ck_assert_int_eq(replay_play_game(&reader, replayed, &result), false);
+    ck_assert_int_eq(replayed->core.game.board, kind);
+    ck_assert_int_eq(result.score, scores[kind]);
+    ck_assert_int_eq(replay_game_result_get_matches(&result), true);
+  }
+  ck_assert_uint_eq(reader.position, size);
+  tetris_context_destroy(replayed);
+  free(data);
+}
+END_TEST
+
+Suite *ts_board(void) {
+  Suite *s1 = suite_create("ts_board");
+  TCase *t1 = tcase_create("tc_board");
+
+  suite_add_tcase(s1, t1);
+  tcase_add_test(t1, t_board_variants);
+  tcase_add_test(t1, t_board_collision_bounds);
+  tcase_add_test(t1, t_board_mini_cut);
+  tcase_add_test(t1, t_board_mixed_replay);
+
+  return s1;
+}
@@ -0,0 +1,182 @@
+#include "../context.h"
+#include "tests.h"
+
+START_TEST(t_context_create_destroy) {
+  tetris_context_t *context = tetris_context_create();
+  ck_assert_ptr_nonnull(context);
+  ck_assert_int_eq(context->core.state, START);
+  ck_assert_int_eq(tetris_context_get_game_has_finished(context), false);
+  ck_assert_int_eq(tetris_context_get_game_over(context), false);
+  ck_assert_int_eq(tetris_context_get_pause(context), false);
+  tetris_context_user_input(context, Terminate, true);
+  tetris_context_update_current_state(context);
+  tetris_context_update_current_state(context);
+  ck_assert_int_eq(tetris_context_get_game_has_finished(context), true);
+  tetris_context_destroy(context);
+}
+END_TEST
+
+START_TEST(t_context_independent_instances) {
+  tetris_context_t *first = tetris_context_create();
+  tetris_context_t *second = tetris_context_create();
+  ck_assert_ptr_nonnull(first);
+  ck_assert_ptr_nonnull(second);
+  tetris_context_user_input(first, Start, true);
+  tetris_context_update_current_state(first);
+  tetris_context_update_current_state(first);
+  ck_assert_int_eq(first->core.state, IDLE);
+  ck_assert_int_eq(second->core.state, START);
+  tetris_context_user_input(first, Pause, true);
+  // the first update is taken by the autoshift
+  tetris_context_update_current_state(first);
+  tetris_context_update_current_state(first);
+  tetris_context_update_current_state(second);
+  ck_assert_int_eq(tetris_context_get_pause(first), true);
+  ck_assert_int_eq(tetris_context_get_pause(second), false);
+  ck_assert_int_eq(second->core.state, START);
+  tetris_context_destroy(first);
+  tetris_context_destroy(second);
+}
+END_TEST
+
+START_TEST(t_context_seeded_figures) {
+  tetris_context_t *first = tetris_context_create();
+  tetris_context_t *second = tetris_context_create();
+  ck_assert_ptr_nonnull(first);
+  ck_assert_ptr_nonnull(second);
+  const tetris_setup_t setup = {42, RANDOMIZER_BAG, BOARD_STANDARD};
+  tetris_context_configure(first, &setup);
+  tetris_context_configure(second, &setup);
+  tetris_context_user_input(first, Start, true);
+  tetris_context_user_input(second, Start, true);
+  tetris_context_update_current_state(first);
+  tetris_context_update_current_state(second);
+  for (int i = 0; i != 100; ++i) {
+    ck_assert_int_eq(first->core.game.next_figure_id,
+                     second->core.game.next_figure_id);
+    backend_spawn_new_figure(&first->core.game);
+    backend_spawn_new_figure(&second->core.game);
+  }
+  tetris_context_destroy(first);
+  tetris_context_destroy(second);
+}
+END_TEST
+
+START_TEST(t_context_manual_clock_autoshift) {
+  tetris_context_t *context = tetris_context_create();
+  ck_assert_ptr_nonnull(context);
+  game_clock_t clock = {0};
+  game_clock_init(&clock, GAME_CLOCK_MANUAL, 1);
+  tetris_context_set_clock(context, &clock);
+  tetris_context_user_input(context, Start, true);
+  tetris_context_update_current_state(context);
+  tetris_context_update_current_state(context);
+  ck_assert_int_eq(context->core.state, IDLE);
+  const int row = context->core.game.current_figure.position.r;
+  const unsigned long interval =
+      get_autoshift_interval_ms(context->core.game.game.level);
+  // no time passes on the manual clock unless it is advanced
+  for (int i = 0; i != 100; ++i) {
+    tetris_context_update_current_state(context);
+  }
+  tetris_context_advance_clock_ms(context, interval - 1);
+  tetris_context_update_current_state(context);
+  tetris_context_update_current_state(context);
+  ck_assert_int_eq(context->core.game.current_figure.position.r, row);
+  // the autoshift signal moves the FSM to AUTOSHIFTING, the next update shifts
+  tetris_context_advance_clock_ms(context, 1);
+  tetris_context_update_current_state(context);
+  tetris_context_update_current_state(context);
+  ck_assert_int_eq(context->core.game.current_figure.position.r, row + 1);
+  tetris_context_advance_clock_ms(context, interval);
+  tetris_context_update_current_state(context);
+  tetris_context_update_current_state(context);
+  ck_assert_int_eq(context->core.game.current_figure.position.r, row + 2);
+  tetris_context_destroy(context);
+}
+END_TEST
+
+START_TEST(t_context_input_burst) {
+  tetris_context_t *context = tetris_context_create();
+  ck_assert_ptr_nonnull(context);
+  game_clock_t clock = {0};
+  game_clock_init(&clock, GAME_CLOCK_MANUAL, 1);
+  tetris_context_set_clock(context, &clock);
+  tetris_context_user_input(context, Start, true);
+  tetris_context_update_current_state(context);
+  tetris_context_update_current_state(context);
+  ck_assert_int_eq(context->core.state, IDLE);
+  const int column = context->core.game.current_figure.position.c;
+  // the repeated presses do not collapse, one update applies all of them
+  tetris_context_user_input(context, Left, true);
+  tetris_context_user_input(context, Left, false);
+  tetris_context_user_input(context, Left, true);
+  tetris_context_user_input(context, Right, true);
+  tetris_context_user_input(context, Left, true);
+  tetris_context_update_current_state(context);
+  ck_assert_int_eq(context->core.game.current_figure.position.c, column - 2);
+  ck_assert_int_eq(context->core.state, IDLE);
+  tetris_context_update_current_state(context);
+  ck_assert_int_eq(context->core.game.current_figure.position.c, column - 2);
+  tetris_context_destroy(context);
+}
+END_TEST
+
+/// @brief apply a fixed sequence of signals to the context
+/// @param context the context
+/// @param count number of signals
+void apply_signal_sequence(tetris_context_t *context, const int count) {
+  const fsm_input_t signals[] = {MOVE_LEFT, ROTATE_BTN, AUTOSHIFT_SIG,
+                                 MOVE_RIGHT, MOVE_DOWN, AUTOSHIFT_SIG};
+  for (int i = 0; context->core.state != GAMEOVER && i != count; ++i) {
+    tetris_context_apply_signal(context, signals[i % 6]);
+  }
+}
+
+START_TEST(t_context_snapshot_restore_clone) {
+  tetris_context_t *context = tetris_context_create();
+  ck_assert_ptr_nonnull(context);
+  const tetris_setup_t setup = {7, RANDOMIZER_BAG, BOARD_STANDARD};
+  tetris_context_configure(context, &setup);
+  tetris_context_apply_signal(context, START_BTN);
+  apply_signal_sequence(context, 50);
+  tetris_snapshot_t snapshot;
+  tetris_context_snapshot(context, &snapshot);
+  tetris_context_t *clone = tetris_context_clone(context);
+  ck_assert_ptr_nonnull(clone);
+  apply_signal_sequence(context, 500);
+  const int score = context->core.game.game.score;
+  const uint64_t hash = backend_get_board_hash(&context->core.game);
+  const int dealt = context->core.game.randomizer.dealt;
+  ck_assert_int_ne(dealt, snapshot.game.randomizer.dealt);
+  // the restored and the cloned games play exactly as the original one
+  tetris_context_take_dirty_rows(context);
+  tetris_context_restore(context, &snapshot);
+  ck_assert_uint_ne(tetris_context_take_dirty_rows(context), 0);
+  ck_assert_int_eq(context->core.state, snapshot.state);
+  apply_signal_sequence(context, 500);
+  apply_signal_sequence(clone, 500);
+  ck_assert_int_eq(context->core.game.game.score, score);
+  ck_assert_int_eq(clone->core.game.game.score, score);
+  ck_assert_uint_eq(backend_get_board_hash(&context->core.game), hash);
+  ck_assert_uint_eq(backend_get_board_hash(&clone->core.game), hash);
+  ck_assert_int_eq(clone->core.game.randomizer.dealt, dealt);
+  tetris_context_destroy(clone);
+  tetris_context_destroy(context);
+}
+END_TEST
+
+Suite *ts_context(void) {
+  Suite *s1 = suite_create("ts_context");
+  TCase *t1 = tcase_create("tc_context");
+
+  suite_add_tcase(s1, t1);
+  tcase_add_test(t1, t_context_create_destroy);
+  tcase_add_test(t1, t_context_independent_instances);
+  tcase_add_test(t1, t_context_seeded_figures);
+  tcase_add_test(t1, t_context_manual_clock_autoshift);
+  tcase_add_test(t1, t_context_input_burst);
+  tcase_add_test(t1, t_context_snapshot_restore_clone);
+
+  return s1;
+}
@@ -1,19 +1,17 @@
 #include <stdlib.h>
 #include <time.h>
 
-#include "../matrix.h"
 #include "tests.h"
 
 START_TEST(t_figures_randomness) {
   srand(time(NULL));
   int hits[ALLOWED_FIGURES_COUNT] = {0};
-  int **m = calloc_matrix(4, 4);
+  int m[MAX_FIGURE_SIZE][MAX_FIGURE_SIZE] = {0};
   for (int i = 0; i < 1000000; ++i) {
     const int next_figure_id = rand() % (ALLOWED_FIGURES_COUNT);
     fill_figure_by_id(m, next_figure_id);
     ++hits[next_figure_id];
   }
-  free_matrix(m);
   int chances[ALLOWED_FIGURES_COUNT] = {0};
   for (int i = 0; i < ALLOWED_FIGURES_COUNT; ++i) {
     chances[i] = hits[i] / 10000;
@@ -24,12 +22,64 @@ START_TEST(t_figures_randomness) {
 }
 END_TEST
 
+int count_shape_cells(const figure_shape_t *shape) {
+  int cells = 0;
+  for (int r = 0; r != MAX_FIGURE_SIZE; ++r) {
+    for (int c = 0; c != MAX_FIGURE_SIZE; ++c) {
+      cells += (shape->rows[r] >> c) & 1u;
+    }
+  }
+  return cells;
+}
+
+START_TEST(t_figures_tables) {
+  for (int id = 0; id != ALLOWED_FIGURES_COUNT; ++id) {
+    for (int rotation = 0; rotation != FIGURE_ROTATIONS_COUNT; ++rotation) {
+      const figure_shape_t *shape = get_figure_shape(id, rotation);
+      ck_assert_ptr_nonnull(shape);
+      ck_assert_int_eq(count_shape_cells(shape), 4);
+      row_mask_t bounds = 0;
+      for (int r = 0; r != MAX_FIGURE_SIZE; ++r) {
+        const bool inside = r >= shape->top && r < shape->top + shape->height;
+        ck_assert_int_eq(shape->rows[r] != 0, inside);
+        bounds |= shape->rows[r];
+      }
+      const row_mask_t expected_bounds =
+          (row_mask_t)(((1u << shape->width) - 1) << shape->left);
+      ck_assert_uint_eq(bounds, expected_bounds);
+    }
+    int kicks_count = 0;
+    ck_assert_ptr_nonnull(get_figure_kicks(id, 0, &kicks_count));
+    ck_assert_int_gt(kicks_count, 0);
+    ck_assert_int_le(kicks_count, FIGURE_KICKS_COUNT);
+  }
+  ck_assert_ptr_null(get_figure_shape(NO_FIGURE, 0));
+  ck_assert_ptr_null(get_figure_shape(ALLOWED_FIGURES_COUNT, 0));
+}
+END_TEST
+
+START_TEST(t_figures_spawn_on_row_2) {
+  int m[MAX_FIGURE_SIZE][MAX_FIGURE_SIZE] = {0};
+  for (int id = 0; id != ALLOWED_FIGURES_COUNT; ++id) {
+    fill_figure_by_id(m, id);
+    const figure_shape_t *shape = get_figure_shape(id, 0);
+    ck_assert_int_eq(shape->top + shape->height - 1, 2);
+    for (int c = 0; c != MAX_FIGURE_SIZE; ++c) {
+      ck_assert_int_eq(m[2][c] != 0, (shape->rows[2] >> c) & 1u);
+      ck_assert_int_eq(m[3][c], 0);
+    }
+  }
+}
+END_TEST
+
 Suite *ts_figures(void) {
   Suite *s1 = suite_create("ts_figures");
   TCase *t1 = tcase_create("tc_figures");
 
   suite_add_tcase(s1, t1);
   tcase_add_test(t1, t_figures_randomness);
+  tcase_add_test(t1, t_figures_tables);
+  tcase_add_test(t1, t_figures_spawn_on_row_2);
 
   return s1;
 }
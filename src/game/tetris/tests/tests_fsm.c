@@ -6,116 +6,126 @@
 
 START_TEST(t_fsm_init_to_exit) {
   tetris_game_t g = {0};
-  fsm_apply_input(NO_INPUT, &g);
-  fsm_apply_input(fsm_get_signal(Terminate), &g);
-  ck_assert_int_eq(fsm_get_state(), PREEXIT);
-  fsm_apply_input(NO_INPUT, &g);
-  ck_assert_int_eq(fsm_get_state(), EXIT);
+  tetris_state_t state = PRESTART;
+  fsm_apply_input(NO_INPUT, &state, &g);
+  fsm_apply_input(fsm_get_signal(Terminate), &state, &g);
+  ck_assert_int_eq(state, PREEXIT);
+  fsm_apply_input(NO_INPUT, &state, &g);
+  ck_assert_int_eq(state, EXIT);
 }
 END_TEST
 
 START_TEST(t_fsm_start_to_spawn_to_idle_to_pause_to_exit) {
   tetris_game_t g = {0};
-  fsm_apply_input(NO_INPUT, &g);
-  fsm_apply_input(fsm_get_signal(Start), &g);
-  ck_assert_int_eq(fsm_get_state(), SPAWNING);
-  fsm_apply_input(fsm_get_signal(Pause), &g);
-  ck_assert_int_eq(fsm_get_state(), PAUSE);
-  fsm_apply_input(fsm_get_signal(Terminate), &g);
-  fsm_apply_input(NO_INPUT, &g);
+  tetris_state_t state = PRESTART;
+  fsm_apply_input(NO_INPUT, &state, &g);
+  fsm_apply_input(fsm_get_signal(Start), &state, &g);
+  ck_assert_int_eq(state, SPAWNING);
+  fsm_apply_input(fsm_get_signal(Pause), &state, &g);
+  ck_assert_int_eq(state, PAUSE);
+  fsm_apply_input(fsm_get_signal(Terminate), &state, &g);
+  fsm_apply_input(NO_INPUT, &state, &g);
 }
 END_TEST
 
 START_TEST(t_fsm_start_to_spawn_to_idle_to_moves) {
   tetris_game_t g = {0};
-  fsm_apply_input(NO_INPUT, &g);
-  fsm_apply_input(fsm_get_signal(Start), &g);
-  ck_assert_int_eq(fsm_get_state(), SPAWNING);
-  fsm_apply_input(fsm_get_signal(Left), &g);
-  ck_assert_int_eq(fsm_get_state(), IDLE);
-  fsm_apply_input(fsm_get_signal(Right), &g);
-  ck_assert_int_eq(fsm_get_state(), IDLE);
-  fsm_apply_input(fsm_get_signal(Down), &g);
-  ck_assert_int_eq(fsm_get_state(), IDLE);
-  fsm_apply_input(fsm_get_signal(Action), &g);
-  ck_assert_int_eq(fsm_get_state(), IDLE);
-  fsm_apply_input(fsm_get_signal(Terminate), &g);
-  fsm_apply_input(NO_INPUT, &g);
+  tetris_state_t state = PRESTART;
+  fsm_apply_input(NO_INPUT, &state, &g);
+  fsm_apply_input(fsm_get_signal(Start), &state, &g);
+  ck_assert_int_eq(state, SPAWNING);
+  fsm_apply_input(fsm_get_signal(Left), &state, &g);
+  ck_assert_int_eq(state, IDLE);
+  fsm_apply_input(fsm_get_signal(Right), &state, &g);
+  ck_assert_int_eq(state, IDLE);
+  fsm_apply_input(fsm_get_signal(Down), &state, &g);
+  ck_assert_int_eq(state, IDLE);
+  fsm_apply_input(fsm_get_signal(Action), &state, &g);
+  ck_assert_int_eq(state, IDLE);
+  fsm_apply_input(fsm_get_signal(Terminate), &state, &g);
+  fsm_apply_input(NO_INPUT, &state, &g);
 }
 END_TEST
 
 START_TEST(t_fsm_start_to_spawn_to_idle_to_autoshift_to_idle) {
   tetris_game_t g = {0};
-  fsm_apply_input(NO_INPUT, &g);
-  fsm_apply_input(fsm_get_signal(Start), &g);
-  ck_assert_int_eq(fsm_get_state(), SPAWNING);
-  fsm_apply_input(AUTOSHIFT_SIG, &g);
-  ck_assert_int_eq(fsm_get_state(), AUTOSHIFTING);
-  fsm_apply_input(NO_INPUT, &g);
-  ck_assert_int_eq(fsm_get_state(), IDLE);
-  fsm_apply_input(fsm_get_signal(Terminate), &g);
-  fsm_apply_input(NO_INPUT, &g);
+  tetris_state_t state = PRESTART;
+  fsm_apply_input(NO_INPUT, &state, &g);
+  fsm_apply_input(fsm_get_signal(Start), &state, &g);
+  ck_assert_int_eq(state, SPAWNING);
+  fsm_apply_input(AUTOSHIFT_SIG, &state, &g);
+  ck_assert_int_eq(state, AUTOSHIFTING);
+  fsm_apply_input(NO_INPUT, &state, &g);
+  ck_assert_int_eq(state, IDLE);
+  fsm_apply_input(fsm_get_signal(Terminate), &state, &g);
+  fsm_apply_input(NO_INPUT, &state, &g);
 }
 END_TEST
 
 START_TEST(t_fsm_start_to_spawn_to_idle_to_bottom_to_autoshift_to_overflow) {
   tetris_game_t g = {0};
-  fsm_apply_input(NO_INPUT, &g);
-  fsm_apply_input(fsm_get_signal(Start), &g);
-  ck_assert_int_eq(fsm_get_state(), SPAWNING);
+  tetris_state_t state = PRESTART;
+  fsm_apply_input(NO_INPUT, &state, &g);
+  fsm_apply_input(fsm_get_signal(Start), &state, &g);
+  ck_assert_int_eq(state, SPAWNING);
   for (int i = 0; i != FIELD_VISIBLE_HEIGHT - 2; ++i) {
-    fsm_apply_input(fsm_get_signal(Down), &g);
+    fsm_apply_input(fsm_get_signal(Down), &state, &g);
   }
-  fsm_apply_input(AUTOSHIFT_SIG, &g);
-  ck_assert_int_eq(fsm_get_state(), AUTOSHIFTING);
-  fsm_apply_input(NO_INPUT, &g);
-  ck_assert_int_eq(fsm_get_state(), OVERFLOWCONTROL);
-  fsm_apply_input(NO_INPUT, &g);
-  ck_assert_int_eq(fsm_get_state(), ROWCUTTING);
-  fsm_apply_input(NO_INPUT, &g);
-  ck_assert_int_eq(fsm_get_state(), SPAWNING);
-  fsm_apply_input(NO_INPUT, &g);
-  ck_assert_int_eq(fsm_get_state(), IDLE);
-  fsm_apply_input(fsm_get_signal(Terminate), &g);
-  fsm_apply_input(NO_INPUT, &g);
+  fsm_apply_input(AUTOSHIFT_SIG, &state, &g);
+  ck_assert_int_eq(state, AUTOSHIFTING);
+  fsm_apply_input(NO_INPUT, &state, &g);
+  ck_assert_int_eq(state, OVERFLOWCONTROL);
+  fsm_apply_input(NO_INPUT, &state, &g);
+  ck_assert_int_eq(state, ROWCUTTING);
+  fsm_apply_input(NO_INPUT, &state, &g);
+  ck_assert_int_eq(state, SPAWNING);
+  fsm_apply_input(NO_INPUT, &state, &g);
+  ck_assert_int_eq(state, IDLE);
+  fsm_apply_input(fsm_get_signal(Terminate), &state, &g);
+  fsm_apply_input(NO_INPUT, &state, &g);
 }
 END_TEST
 
 START_TEST(t_fsm_start_to_spawn_to_idle_to_gameover_to_exit) {
   tetris_game_t g = {0};
-  fsm_apply_input(NO_INPUT, &g);
-  fsm_apply_input(fsm_get_signal(Start), &g);
-  ck_assert_int_eq(fsm_get_state(), SPAWNING);
-  fsm_apply_input(NO_INPUT, &g);
-  ck_assert_int_eq(fsm_get_state(), IDLE);
+  tetris_state_t state = PRESTART;
+  fsm_apply_input(NO_INPUT, &state, &g);
+  fsm_apply_input(fsm_get_signal(Start), &state, &g);
+  ck_assert_int_eq(state, SPAWNING);
+  fsm_apply_input(NO_INPUT, &state, &g);
+  ck_assert_int_eq(state, IDLE);
 
-  fill_matrix(g.game.field, FIELD_TOTAL_HEIGHT, FIELD_WIDTH, 1);
-  fsm_apply_input(AUTOSHIFT_SIG, &g);
-  ck_assert_int_eq(fsm_get_state(), AUTOSHIFTING);
-  fsm_apply_input(NO_INPUT, &g);
-  ck_assert_int_eq(fsm_get_state(), OVERFLOWCONTROL);
-  fsm_apply_input(NO_INPUT, &g);
-  ck_assert_int_eq(fsm_get_state(), GAMEOVER);
-  fsm_apply_input(NO_INPUT, &g);
-  ck_assert_int_eq(fsm_get_state(), GAMEOVER);
-  fsm_apply_input(fsm_get_signal(Terminate), &g);
-  ck_assert_int_eq(fsm_get_state(), PREEXIT);
-  fsm_apply_input(NO_INPUT, &g);
-  ck_assert_int_eq(fsm_get_state(), EXIT);
+  tetris_game_view_t view;
+  fill_matrix(backend_get_game_info(&g, &view).field, FIELD_TOTAL_HEIGHT,
+              FIELD_WIDTH, 1);
+  backend_sync_occupancy(&g);
+  fsm_apply_input(AUTOSHIFT_SIG, &state, &g);
+  ck_assert_int_eq(state, AUTOSHIFTING);
+  fsm_apply_input(NO_INPUT, &state, &g);
+  ck_assert_int_eq(state, OVERFLOWCONTROL);
+  fsm_apply_input(NO_INPUT, &state, &g);
+  ck_assert_int_eq(state, GAMEOVER);
+  fsm_apply_input(NO_INPUT, &state, &g);
+  ck_assert_int_eq(state, GAMEOVER);
+  fsm_apply_input(fsm_get_signal(Terminate), &state, &g);
+  ck_assert_int_eq(state, PREEXIT);
+  fsm_apply_input(NO_INPUT, &state, &g);
+  ck_assert_int_eq(state, EXIT);
 }
 END_TEST
 
 START_TEST(t_fsm_autoshift_availability) {
   tetris_game_t g = {0};
-  fsm_apply_input(NO_INPUT, &g);
-  fsm_apply_input(fsm_get_signal(Start), &g);
-  ck_assert_int_eq(fsm_get_state(), SPAWNING);
-  ck_assert_int_eq(fsm_is_autoshift_available(), false);
-  fsm_apply_input(NO_INPUT, &g);
-  ck_assert_int_eq(fsm_get_state(), IDLE);
-  ck_assert_int_eq(fsm_is_autoshift_available(), true);
-  fsm_apply_input(fsm_get_signal(Terminate), &g);
-  fsm_apply_input(NO_INPUT, &g);
+  tetris_state_t state = PRESTART;
+  fsm_apply_input(NO_INPUT, &state, &g);
+  fsm_apply_input(fsm_get_signal(Start), &state, &g);
+  ck_assert_int_eq(state, SPAWNING);
+  ck_assert_int_eq(fsm_is_autoshift_available(state), false);
+  fsm_apply_input(NO_INPUT, &state, &g);
+  ck_assert_int_eq(state, IDLE);
+  ck_assert_int_eq(fsm_is_autoshift_available(state), true);
+  fsm_apply_input(fsm_get_signal(Terminate), &state, &g);
+  fsm_apply_input(NO_INPUT, &state, &g);
 }
 END_TEST
 
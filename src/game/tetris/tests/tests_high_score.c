@@ -0,0 +1,79 @@
+#define _POSIX_C_SOURCE 200809L
+// relying on the POSIX getpid()
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "../high_score.h"
+#include "tests.h"
+
+/// @brief read the score saved to the file
+/// @param path the file
+/// @return the score, -1 if there is none
+int read_saved_score(const char *path) {
+  int score = -1;
+  FILE *file = fopen(path, "r");
+  if (file) {
+    if (fscanf(file, "%d", &score) != 1) score = -1;
+    fclose(file);
+  }
+  return score;
+}
+
+START_TEST(t_high_score_records) {
+  char path[64];
+  snprintf(path, sizeof(path), "/tmp/.tetris_high_score_test.%ld",
+           (long)getpid());
+  FILE *file = fopen(path, "w");
+  ck_assert_ptr_nonnull(file);
+  fprintf(file, "%d", 500);
+  fclose(file);
+  ck_assert_int_eq(high_score_set_path(path), false);
+  ck_assert_int_eq(high_score_get(), 500);
+  // a lower score is not a record, the records are written once flushed
+  high_score_offer(400);
+  ck_assert_int_eq(high_score_get(), 500);
+  for (int score = 600; score <= 6000; score += 100) {
+    high_score_offer(score);
+  }
+  ck_assert_int_eq(high_score_get(), 6000);
+  ck_assert_int_eq(high_score_flush(), false);
+  ck_assert_int_eq(read_saved_score(path), 6000);
+  // a new game takes the record from memory
+  tetris_game_t game = {0};
+  ck_assert_int_eq(backend_init_game(&game), false);
+  backend_setup_new_game(&game);
+  ck_assert_int_eq(game.game.high_score, 6000);
+  remove(path);
+  ck_assert_int_eq(high_score_set_path(path), false);
+  ck_assert_int_eq(high_score_get(), 0);
+  ck_assert_int_eq(high_score_set_path(HIGH_SCORE_DEFAULT_PATH), false);
+}
+END_TEST
+
+START_TEST(t_high_score_bad_path) {
+  char path[HIGH_SCORE_PATH_MAX + 1];
+  memset(path, 'a', HIGH_SCORE_PATH_MAX);
+  path[HIGH_SCORE_PATH_MAX] = '\0';
+  ck_assert_int_eq(high_score_set_path(path), true);
+  ck_assert_int_eq(high_score_set_path("/nonexistent/dir/high_score"), false);
+  const int best = high_score_get();
+  high_score_offer(best + 1);
+  ck_assert_int_eq(high_score_get(), best + 1);
+  ck_assert_int_eq(high_score_flush(), true);
+  // the failed write is reported once to the path it was made for
+  ck_assert_int_eq(high_score_set_path(HIGH_SCORE_DEFAULT_PATH), true);
+  ck_assert_int_eq(high_score_flush(), false);
+}
+END_TEST
+
+Suite *ts_high_score(void) {
+  Suite *s1 = suite_create("ts_high_score");
+  TCase *t1 = tcase_create("tc_high_score");
+
+  suite_add_tcase(s1, t1);
+  tcase_add_test(t1, t_high_score_records);
+  tcase_add_test(t1, t_high_score_bad_path);
+
+  return s1;
+}
@@ -0,0 +1,76 @@
+#include <pthread.h>
+
+#include "../input_queue.h"
+#include "tests.h"
+
+#define STRESS_EVENTS 200000
+
+START_TEST(t_input_queue_fifo) {
+  input_queue_t queue = {0};
+  input_event_t event = {0};
+  ck_assert_int_eq(input_queue_pop(&queue, &event), false);
+  for (int i = 0; i != 3 * INPUT_QUEUE_CAPACITY; ++i) {
+    const input_event_t pushed = {i % USERACTIONS_COUNT, true, i};
+    ck_assert_int_eq(input_queue_push(&queue, &pushed), false);
+    ck_assert_int_eq(input_queue_pop(&queue, &event), true);
+    ck_assert_int_eq(event.action, i % USERACTIONS_COUNT);
+    ck_assert_uint_eq(event.timestamp_ms, i);
+  }
+  ck_assert_int_eq(input_queue_pop(&queue, &event), false);
+}
+END_TEST
+
+START_TEST(t_input_queue_full) {
+  input_queue_t queue = {0};
+  input_event_t event = {Left, true, 0};
+  for (int i = 0; i != INPUT_QUEUE_CAPACITY; ++i) {
+    event.timestamp_ms = i;
+    ck_assert_int_eq(input_queue_push(&queue, &event), false);
+  }
+  ck_assert_int_eq(input_queue_push(&queue, &event), true);
+  ck_assert_uint_eq(input_queue_get_dropped(&queue), 1);
+  for (int i = 0; i != INPUT_QUEUE_CAPACITY; ++i) {
+    ck_assert_int_eq(input_queue_pop(&queue, &event), true);
+    ck_assert_uint_eq(event.timestamp_ms, i);
+  }
+  ck_assert_int_eq(input_queue_pop(&queue, &event), false);
+}
+END_TEST
+
+void *push_sequence(void *arg) {
+  input_queue_t *queue = arg;
+  for (unsigned long i = 0; i != STRESS_EVENTS; ++i) {
+    const input_event_t event = {Right, true, i};
+    while (input_queue_push(queue, &event)) {
+    }
+  }
+  return NULL;
+}
+
+START_TEST(t_input_queue_threads) {
+  static input_queue_t queue;
+  pthread_t producer;
+  ck_assert_int_eq(pthread_create(&producer, NULL, push_sequence, &queue), 0);
+  unsigned long expected = 0;
+  while (expected != STRESS_EVENTS) {
+    input_event_t event = {0};
+    if (input_queue_pop(&queue, &event)) {
+      ck_assert_uint_eq(event.timestamp_ms, expected);
+      ++expected;
+    }
+  }
+  pthread_join(producer, NULL);
+}
+END_TEST
+
+Suite *ts_input_queue(void) {
+  Suite *s1 = suite_create("ts_input_queue");
+  TCase *t1 = tcase_create("tc_input_queue");
+
+  suite_add_tcase(s1, t1);
+  tcase_add_test(t1, t_input_queue_fifo);
+  tcase_add_test(t1, t_input_queue_full);
+  tcase_add_test(t1, t_input_queue_threads);
+
+  return s1;
+}
@@ -0,0 +1,194 @@
+#define _POSIX_C_SOURCE 200809L
+// relying on the POSIX fork(), waitpid() and getpid()
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "../leaderboard.h"
+#include "tests.h"
+
+#define TEST_CAPACITY 16
+#define TEST_PROCESSES 4
+#define TEST_SUBMISSIONS 500
+
+/// @brief make the name of a leaderboard file of the test process
+/// @param path where to save the name
+/// @param size size of the path
+/// @param name the name of the test
+void get_test_leaderboard_path(char *path, size_t size, const char *name) {
+  snprintf(path, size, "/tmp/.tetris_leaderboard_%s.%ld", name,
+           (long)getpid());
+  remove(path);
+}
+
+/// @brief get the deterministic score of a submission
+/// @param process number of the submitting process
+/// @param i number of the submission
+/// @return the score, unique for every submission
+int get_test_score(const int process, const int i) {
+  return (int)(((unsigned)(i * TEST_PROCESSES + process) * 2654435761u) %
+               1000003u);
+}
+
+/// @brief qsort comparator of the scores, the highest first
+/// @param first the first score
+/// @param second the second score
+/// @return negative if the first is higher, positive if lower
+int compare_scores_descending(const void *first, const void *second) {
+  const int a = *(const int *)first;
+  const int b = *(const int *)second;
+  return (a < b) - (a > b);
+}
+
+START_TEST(t_leaderboard_top) {
+  char path[128];
+  get_test_leaderboard_path(path, sizeof(path), "top");
+  leaderboard_t *board = leaderboard_open(path, 3);
+  ck_assert_ptr_nonnull(board);
+  const int scores[] = {300, 100, 500, 200, 400, 50};
+  for (int i = 0; i < 6; ++i) {
+    const leaderboard_entry_t entry = {scores[i], 1, 2, 0, 1000 + i, i};
+    // the board fills up, then every score but 50 beats the worst one
+    ck_assert_int_eq(leaderboard_submit(board, &entry), scores[i] != 50);
+  }
+  // the same score ranks lower when it came later
+  const leaderboard_entry_t tie = {300, 1, 2, 0, 2000, 6};
+  ck_assert_int_eq(leaderboard_submit(board, &tie), false);
+  leaderboard_entry_t entries[4];
+  ck_assert_int_eq(leaderboard_read(board, entries, 4), 3);
+  ck_assert_int_eq(entries[0].score, 500);
+  ck_assert_int_eq(entries[1].score, 400);
+  ck_assert_int_eq(entries[2].score, 300);
+  ck_assert_int_eq((int)entries[2].replay_id, 0);
+  ck_assert_int_eq(leaderboard_read(board, entries, 1), 1);
+  ck_assert_int_eq(entries[0].score, 500);
+  leaderboard_close(board);
+  // the records stay in the file and the capacity is the one of the file
+  board = leaderboard_open(path, 100);
+  ck_assert_ptr_nonnull(board);
+  ck_assert_int_eq(leaderboard_read(board, entries, 4), 3);
+  ck_assert_int_eq(entries[1].score, 400);
+  ck_assert_int_eq(entries[1].level, 1);
+  ck_assert_int_eq(entries[1].lines, 2);
+  leaderboard_close(board);
+  remove(path);
+}
+END_TEST
+
+START_TEST(t_leaderboard_processes) {
+  char path[128];
+  get_test_leaderboard_path(path, sizeof(path), "processes");
+  leaderboard_t *board = leaderboard_open(path, TEST_CAPACITY);
+  ck_assert_ptr_nonnull(board);
+  pid_t children[TEST_PROCESSES];
+  for (int p = 0; p < TEST_PROCESSES; ++p) {
+    children[p] = fork();
+    ck_assert_int_ge(children[p], 0);
+    if (!children[p]) {
+      leaderboard_t *child = leaderboard_open(path, TEST_CAPACITY);
+      for (int i = 0; child && i < TEST_SUBMISSIONS; ++i) {
+        const leaderboard_entry_t entry = {get_test_score(p, i), 0, 0, 0, 0,
+                                           (uint64_t)p};
+        leaderboard_submit(child, &entry);
+      }
+      _exit(!child);
+    }
+  }
+  for (int p = 0; p < TEST_PROCESSES; ++p) {
+    int status = 0;
+    ck_assert_int_eq(waitpid(children[p], &status, 0), children[p]);
+    ck_assert_int_eq(WIFEXITED(status) && !WEXITSTATUS(status), true);
+  }
+  // the board is exactly the best TEST_CAPACITY of all the submissions
+  int scores[TEST_PROCESSES * TEST_SUBMISSIONS];
+  for (int p = 0; p < TEST_PROCESSES; ++p) {
+    for (int i = 0; i < TEST_SUBMISSIONS; ++i) {
+      scores[p * TEST_SUBMISSIONS + i] = get_test_score(p, i);
+    }
+  }
+  qsort(scores, TEST_PROCESSES * TEST_SUBMISSIONS, sizeof(int),
+        compare_scores_descending);
+  leaderboard_entry_t entries[TEST_CAPACITY + 1];
+  ck_assert_int_eq(leaderboard_read(board, entries, TEST_CAPACITY + 1),
+                   TEST_CAPACITY);
+  for (int i = 0; i < TEST_CAPACITY; ++i) {
+    ck_assert_int_eq(entries[i].score, scores[i]);
+  }
+  ck_assert_int_eq(atomic_load(&board->file->lock), 0);
+  ck_assert_int_eq(atomic_load(&board->file->sequence) % 2, 0);
+  leaderboard_close(board);
+  remove(path);
+}
+END_TEST
+
+START_TEST(t_leaderboard_dead_writer) {
+  char path[128];
+  get_test_leaderboard_path(path, sizeof(path), "dead");
+  leaderboard_t *board = leaderboard_open(path, TEST_CAPACITY);
+  ck_assert_ptr_nonnull(board);
+  for (int i = 0; i < TEST_CAPACITY; ++i) {
+    const leaderboard_entry_t entry = {get_test_score(0, i), 0, 0, 0, 0, 0};
+    ck_assert_int_eq(leaderboard_submit(board, &entry), true);
+  }
+  // a writer dies holding the lock in the middle of a change of the heap
+  const pid_t child = fork();
+  ck_assert_int_ge(child, 0);
+  if (!child) {
+    leaderboard_file_t *file = board->file;
+    atomic_store(&file->lock, (unsigned)getpid());
+    atomic_fetch_add(&file->sequence, 1);
+    const leaderboard_entry_t swapped = file->entries[0];
+    file->entries[0] = file->entries[TEST_CAPACITY - 1];
+    file->entries[TEST_CAPACITY - 1] = swapped;
+    _exit(0);
+  }
+  int status = 0;
+  ck_assert_int_eq(waitpid(child, &status, 0), child);
+  ck_assert_int_eq(atomic_load(&board->file->sequence) % 2, 1);
+  // the reader takes the lock over instead of waiting on the sequence
+  int scores[TEST_CAPACITY];
+  for (int i = 0; i < TEST_CAPACITY; ++i) scores[i] = get_test_score(0, i);
+  qsort(scores, TEST_CAPACITY, sizeof(int), compare_scores_descending);
+  leaderboard_entry_t entries[TEST_CAPACITY];
+  ck_assert_int_eq(leaderboard_read(board, entries, TEST_CAPACITY),
+                   TEST_CAPACITY);
+  for (int i = 0; i < TEST_CAPACITY; ++i) {
+    ck_assert_int_eq(entries[i].score, scores[i]);
+  }
+  ck_assert_int_eq(atomic_load(&board->file->lock), 0);
+  ck_assert_int_eq(atomic_load(&board->file->sequence) % 2, 0);
+  ck_assert_int_eq(atomic_load(&board->file->min_score),
+                   scores[TEST_CAPACITY - 1]);
+  leaderboard_close(board);
+  remove(path);
+}
+END_TEST
+
+START_TEST(t_leaderboard_bad_file) {
+  char path[128];
+  get_test_leaderboard_path(path, sizeof(path), "bad");
+  ck_assert_ptr_null(leaderboard_open(path, 0));
+  ck_assert_ptr_null(leaderboard_open(path, LEADERBOARD_MAX_CAPACITY + 1));
+  ck_assert_ptr_null(leaderboard_open("/nonexistent/dir/board", 10));
+  FILE *file = fopen(path, "w");
+  ck_assert_ptr_nonnull(file);
+  for (int i = 0; i < 64; ++i) fputs("not a leaderboard ", file);
+  fclose(file);
+  ck_assert_ptr_null(leaderboard_open(path, 10));
+  remove(path);
+}
+END_TEST
+
+Suite *ts_leaderboard(void) {
+  Suite *s1 = suite_create("ts_leaderboard");
+  TCase *t1 = tcase_create("tc_leaderboard");
+
+  suite_add_tcase(s1, t1);
+  tcase_add_test(t1, t_leaderboard_top);
+  tcase_add_test(t1, t_leaderboard_processes);
+  tcase_add_test(t1, t_leaderboard_dead_writer);
+  tcase_add_test(t1, t_leaderboard_bad_file);
+
+  return s1;
+}
@@ -0,0 +1,190 @@
+#include <string.h>
+
+#include "../placement.h"
+#include "../randomizer.h"
+#include "tests.h"
+
+/// @brief encode the cells covered by the figure, equal for the positions
+/// that cover the same cells
+/// @param figure the figure
+/// @return the field indexes of the cells in ascending order, 8 bits each
+uint32_t get_cells_key(const figure_t *figure) {
+  const figure_shape_t *shape = get_figure_shape(figure->id, figure->rotation);
+  uint32_t key = 0;
+  for (int i = 0; i != MAX_FIGURE_SIZE; ++i) {
+    for (int j = 0; j != MAX_FIGURE_SIZE; ++j) {
+      if ((shape->rows[i] >> j) & 1u) {
+        const int r = figure->position.r + i;
+        const int c = figure->position.c + j;
+        key = (key << 8) | (uint32_t)(r * FIELD_WIDTH + c);
+      }
+    }
+  }
+  return key;
+}
+
+/// @brief apply a move with the backend
+/// @param game the game with the board
+/// @param figure the figure to move
+/// @param move the move signal
+/// @return the figure after the move
+figure_t apply_backend_move(tetris_game_t *game, const figure_t *figure,
+                            const fsm_input_t move) {
+  game->current_figure = *figure;
+  if (move == MOVE_LEFT) backend_move_left_current_figure(game);
+  if (move == MOVE_RIGHT) backend_move_right_current_figure(game);
+  if (move == ROTATE_BTN) backend_rotate_current_figure(game);
+  if (move == MOVE_DOWN) backend_drop_current_figure(game);
+  return game->current_figure;
+}
+
+/// @brief find the resting positions by a search over the backend moves
+/// @param game the game with the board
+/// @param spawned the figure at its start position
+/// @param keys where to save the cells keys of the positions
+/// @return number of the distinct keys
+int search_backend_placements(tetris_game_t *game, const figure_t *spawned,
+                              uint32_t *keys) {
+  static figure_t queue[4 * PLACEMENTS_MAX + 1];
+  static bool seen[PLACEMENTS_MAX];
+  memset(seen, 0, sizeof(seen));
+  const fsm_input_t moves[] = {MOVE_LEFT, MOVE_RIGHT, ROTATE_BTN, MOVE_DOWN};
+  int head = 0;
+  int tail = 0;
+  int count = 0;
+  queue[tail++] = *spawned;
+  while (head != tail) {
+    const figure_t figure = queue[head++];
+    const int index = (figure.rotation * PLACEMENT_ROWS + figure.position.r +
+                       PLACEMENT_ROW_OFFSET) *
+                          PLACEMENT_COLUMNS +
+                      figure.position.c + PLACEMENT_COLUMN_OFFSET;
+    if (seen[index]) continue;
+    seen[index] = true;
+    for (int m = 0; m != 4; ++m) {
+      queue[tail++] = apply_backend_move(game, &figure, moves[m]);
+    }
+    game->current_figure = figure;
+    if (backend_drop_current_figure(game)) {
+      const uint32_t key = get_cells_key(&figure);
+      bool known = false;
+      for (int i = 0; !known && i != count; ++i) known = keys[i] == key;
+      if (!known) keys[count++] = key;
+    }
+  }
+  return count;
+}
+
+START_TEST(t_placement_empty_board) {
+  const row_mask_t board[FIELD_TOTAL_HEIGHT] = {0};
+  // I, J, L, O, S, T, Z on a 10 columns wide field
+  const int expected[ALLOWED_FIGURES_COUNT] = {17, 34, 34, 9, 17, 34, 17};
+  figure_t placements[PLACEMENTS_MAX];
+  for (int id = 0; id != ALLOWED_FIGURES_COUNT; ++id) {
+    figure_t spawned;
+    backend_get_spawned_figure(id, &spawned);
+    ck_assert_int_eq(placement_generate(board, &spawned, placements),
+                     expected[id]);
+  }
+  const int ids[] = {5, 5};
+  ck_assert_uint_eq(placement_perft(board, ids, 1), 34);
+  ck_assert_uint_eq(placement_perft(board, ids, 0), 1);
+}
+END_TEST
+
+START_TEST(t_placement_matches_backend) {
+  xoshiro256_t random;
+  xoshiro_seed(&random, 11);
+  static tetris_game_t game;
+  static figure_t placements[PLACEMENTS_MAX];
+  static uint32_t keys[PLACEMENTS_MAX];
+  static fsm_input_t path[PLACEMENT_PATH_MAX];
+  static figure_t positions[PLACEMENT_PATH_MAX];
+  for (int b = 0; b != 40; ++b) {
+    backend_init_game(&game);
+    // ragged stacks with holes and overhangs
+    const int stack_height = 1 + b % 12;
+    for (int r = FIELD_TOTAL_HEIGHT - stack_height; r < FIELD_TOTAL_HEIGHT;
+         ++r) {
+      game.occupancy[r] =
+          (row_mask_t)(xoshiro_next(&random) & (FULL_ROW_MASK >> 1));
+    }
+    for (int id = 0; id != ALLOWED_FIGURES_COUNT; ++id) {
+      figure_t spawned;
+      backend_get_spawned_figure(id, &spawned);
+      const int count =
+          placement_generate(game.occupancy, &spawned, placements);
+      const int expected = search_backend_placements(&game, &spawned, keys);
+      ck_assert_int_eq(count, expected);
+      for (int i = 0; i != count; ++i) {
+        const uint32_t key = get_cells_key(&placements[i]);
+        bool known = false;
+        for (int k = 0; !known && k != expected; ++k) known = keys[k] == key;
+        ck_assert_int_eq(known, true);
+        // the path leads the backend to the placement and locks it there
+        const int length = placement_find_path(game.occupancy, &spawned,
+                                               &placements[i], path, positions);
+        ck_assert_int_gt(length, 0);
+        ck_assert_int_eq(path[length - 1], AUTOSHIFT_SIG);
+        figure_t figure = spawned;
+        for (int s = 0; s != length - 1; ++s) {
+          figure = apply_backend_move(&game, &figure, path[s]);
+          ck_assert_int_eq(figure.rotation, positions[s].rotation);
+          ck_assert_int_eq(figure.position.r, positions[s].position.r);
+          ck_assert_int_eq(figure.position.c, positions[s].position.c);
+        }
+        ck_assert_int_eq(figure.rotation, placements[i].rotation);
+        ck_assert_int_eq(figure.position.r, placements[i].position.r);
+        ck_assert_int_eq(figure.position.c, placements[i].position.c);
+        game.current_figure = figure;
+        ck_assert_int_eq(backend_drop_current_figure(&game), true);
+      }
+    }
+  }
+}
+END_TEST
+
+START_TEST(t_placement_spin) {
+  // a T slot under an overhang, reachable by a rotation at the bottom only
+  row_mask_t board[FIELD_TOTAL_HEIGHT] = {0};
+  board[FIELD_TOTAL_HEIGHT - 1] = FULL_ROW_MASK & ~(1u << 4);
+  board[FIELD_TOTAL_HEIGHT - 2] = FULL_ROW_MASK & ~(0x7u << 3);
+  board[FIELD_TOTAL_HEIGHT - 3] = 0xF;
+  figure_t spawned;
+  backend_get_spawned_figure(5, &spawned);
+  figure_t placements[PLACEMENTS_MAX];
+  const int count = placement_generate(board, &spawned, placements);
+  int slot = -1;
+  for (int i = 0; i != count; ++i) {
+    if (placements[i].rotation == 2 &&
+        placements[i].position.r == FIELD_TOTAL_HEIGHT - 4 &&
+        placements[i].position.c == 3) {
+      slot = i;
+    }
+  }
+  ck_assert_int_ge(slot, 0);
+  fsm_input_t path[PLACEMENT_PATH_MAX];
+  const int length =
+      placement_find_path(board, &spawned, &placements[slot], path, NULL);
+  ck_assert_int_gt(length, 1);
+  ck_assert_int_eq(path[length - 2], ROTATE_BTN);
+  // both filled rows are cut
+  int cut_rows = 0;
+  ck_assert_int_eq(placement_lock(board, &placements[slot], &cut_rows),
+                   false);
+  ck_assert_int_eq(cut_rows, 2);
+  ck_assert_uint_eq(board[FIELD_TOTAL_HEIGHT - 1], 0xF);
+}
+END_TEST
+
+Suite *ts_placement(void) {
+  Suite *s1 = suite_create("ts_placement");
+  TCase *t1 = tcase_create("tc_placement");
+
+  suite_add_tcase(s1, t1);
+  tcase_add_test(t1, t_placement_empty_board);
+  tcase_add_test(t1, t_placement_matches_backend);
+  tcase_add_test(t1, t_placement_spin);
+
+  return s1;
+}
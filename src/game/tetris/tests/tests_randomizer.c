@@ -0,0 +1,87 @@
+#include "../randomizer.h"
+#include "tests.h"
+
+START_TEST(t_randomizer_golden_sequences) {
+  // the values are fixed, a game replays identically on every machine
+  xoshiro256_t generator;
+  xoshiro_seed(&generator, 42);
+  ck_assert_uint_eq(xoshiro_next(&generator), 0x15780b2e0c2ec716ull);
+  ck_assert_uint_eq(xoshiro_next(&generator), 0x6104d9866d113a7eull);
+  ck_assert_uint_eq(xoshiro_next(&generator), 0xae17533239e499a1ull);
+
+  const int expected[3][14] = {
+      {0, 2, 4, 6, 6, 5, 5, 5, 5, 4, 4, 2, 5, 2},
+      {0, 2, 3, 4, 5, 1, 6, 5, 6, 3, 2, 4, 0, 1},
+      {0, 2, 4, 5, 4, 2, 6, 4, 0, 1, 3, 2, 5, 4},
+  };
+  const randomizer_kind_t kinds[3] = {RANDOMIZER_UNIFORM, RANDOMIZER_BAG,
+                                      RANDOMIZER_HISTORY};
+  for (int k = 0; k != 3; ++k) {
+    randomizer_t randomizer;
+    randomizer_init(&randomizer, kinds[k], 42);
+    for (int i = 0; i != 14; ++i) {
+      ck_assert_int_eq(randomizer_next(&randomizer), expected[k][i]);
+    }
+  }
+}
+END_TEST
+
+START_TEST(t_randomizer_bag_permutations) {
+  for (uint64_t seed = 0; seed != 50; ++seed) {
+    randomizer_t randomizer;
+    randomizer_init(&randomizer, RANDOMIZER_BAG, seed);
+    for (int bag = 0; bag != 20; ++bag) {
+      int dealt[ALLOWED_FIGURES_COUNT] = {0};
+      for (int i = 0; i != ALLOWED_FIGURES_COUNT; ++i) {
+        const int id = randomizer_next(&randomizer);
+        ck_assert_int_ge(id, 0);
+        ck_assert_int_lt(id, ALLOWED_FIGURES_COUNT);
+        ++dealt[id];
+      }
+      for (int i = 0; i != ALLOWED_FIGURES_COUNT; ++i) {
+        ck_assert_int_eq(dealt[i], 1);
+      }
+    }
+  }
+}
+END_TEST
+
+START_TEST(t_randomizer_history_first_figure) {
+  for (uint64_t seed = 0; seed != 200; ++seed) {
+    randomizer_t randomizer;
+    randomizer_init(&randomizer, RANDOMIZER_HISTORY, seed);
+    const int id = randomizer_next(&randomizer);
+    ck_assert_int_ne(id, 3);
+    ck_assert_int_ne(id, 4);
+    ck_assert_int_ne(id, 6);
+    for (int i = 0; i != 100; ++i) {
+      const int next = randomizer_next(&randomizer);
+      ck_assert_int_ge(next, 0);
+      ck_assert_int_lt(next, ALLOWED_FIGURES_COUNT);
+    }
+  }
+}
+END_TEST
+
+START_TEST(t_randomizer_below_bounds) {
+  xoshiro256_t generator;
+  xoshiro_seed(&generator, 0);
+  for (int i = 0; i != 1000; ++i) {
+    ck_assert_uint_lt(xoshiro_below(&generator, 7), 7);
+    ck_assert_uint_eq(xoshiro_below(&generator, 1), 0);
+  }
+}
+END_TEST
+
+Suite *ts_randomizer(void) {
+  Suite *s1 = suite_create("ts_randomizer");
+  TCase *t1 = tcase_create("tc_randomizer");
+
+  suite_add_tcase(s1, t1);
+  tcase_add_test(t1, t_randomizer_golden_sequences);
+  tcase_add_test(t1, t_randomizer_bag_permutations);
+  tcase_add_test(t1, t_randomizer_history_first_figure);
+  tcase_add_test(t1, t_randomizer_below_bounds);
+
+  return s1;
+}
@@ -0,0 +1,203 @@
+#include <stdlib.h>
+
+#include "../replay.h"
+#include "../replay_player.h"
+#include "tests.h"
+
+/// @brief play a game with random presses on a manual clock
+/// @param context the context, in the START state
+/// @param seed game and presses seed
+void play_random_game(tetris_context_t *context, uint64_t seed) {
+  const UserAction_t actions[] = {Left, Right, Up, Action, Down, Pause};
+  xoshiro256_t presses;
+  xoshiro_seed(&presses, seed);
+  const tetris_setup_t setup = {seed, RANDOMIZER_BAG, BOARD_STANDARD};
+  tetris_context_configure(context, &setup);
+  tetris_context_user_input(context, Start, true);
+  tetris_context_update_current_state(context);
+  for (int i = 0; i != 200000 && context->core.state != GAMEOVER; ++i) {
+    tetris_context_advance_clock_ms(context, 20);
+    const uint32_t press = xoshiro_below(&presses, 16);
+    if (press < 6) tetris_context_user_input(context, actions[press], true);
+    // a pause is always released right away
+    if (press == 5) tetris_context_user_input(context, Pause, true);
+    tetris_context_update_current_state(context);
+  }
+}
+
+/// @brief read the whole file
+/// @param file the file
+/// @param size where to save the size
+/// @return the data, to be freed
+unsigned char *read_whole_file(FILE *file, size_t *size) {
+  fseek(file, 0, SEEK_END);
+  *size = (size_t)ftell(file);
+  rewind(file);
+  unsigned char *data = malloc(*size);
+  ck_assert_ptr_nonnull(data);
+  ck_assert_uint_eq(fread(data, 1, *size, file), *size);
+  return data;
+}
+
+START_TEST(t_replay_varint) {
+  const uint64_t values[] = {0, 1, 127, 128, 300, 1ull << 32, UINT64_MAX};
+  for (size_t i = 0; i != sizeof(values) / sizeof(values[0]); ++i) {
+    unsigned char buffer[16] = {0};
+    const size_t size = replay_put_varint(buffer, values[i]);
+    uint64_t value = 0;
+    ck_assert_uint_eq(replay_get_varint(buffer, size, &value), size);
+    ck_assert_uint_eq(value, values[i]);
+    ck_assert_uint_eq(replay_get_varint(buffer, size - 1, &value), 0);
+  }
+  unsigned char buffer[16] = {0};
+  ck_assert_uint_eq(replay_put_varint(buffer, 127), 1);
+  ck_assert_uint_eq(replay_put_varint(buffer, 128), 2);
+}
+END_TEST
+
+START_TEST(t_replay_record_play) {
+  FILE *file = tmpfile();
+  ck_assert_ptr_nonnull(file);
+  replay_writer_t *writer = replay_writer_create(file);
+  ck_assert_ptr_nonnull(writer);
+  tetris_context_t *live = tetris_context_create();
+  ck_assert_ptr_nonnull(live);
+  game_clock_t clock = {0};
+  game_clock_init(&clock, GAME_CLOCK_MANUAL, 1);
+  tetris_context_set_clock(live, &clock);
+  tetris_context_set_recorder(live, writer);
+  int scores[3] = {0};
+  for (int game = 0; game != 3; ++game) {
+    play_random_game(live, 7 + game);
+    ck_assert_int_eq(live->core.state, GAMEOVER);
+    scores[game] = live->core.game.game.score;
+  }
+  tetris_context_destroy(live);
+  ck_assert_int_eq(replay_writer_destroy(writer), false);
+
+  size_t size = 0;
+  unsigned char *data = read_whole_file(file, &size);
+  fclose(file);
+  replay_reader_t reader;
+  ck_assert_int_eq(replay_reader_init(&reader, data, size), false);
+  ck_assert_uint_eq(reader.engine_version, TETRIS_ENGINE_VERSION);
+  tetris_context_t *replayed = tetris_context_create();
+  ck_assert_ptr_nonnull(replayed);
+  for (int game = 0; game != 3; ++game) {
+    replay_game_result_t result;
+    ck_assert_int_eq(replay_play_game(&reader, replayed, &result), false);
+    ck_assert_int_eq(result.recorded_score, scores[game]);
+    ck_assert_int_eq(result.score, scores[game]);
+    ck_assert_int_eq(replay_game_result_get_matches(&result), true);
+  }
+  ck_assert_uint_eq(reader.position, size);
+  tetris_context_destroy(replayed);
+  free(data);
+}
+END_TEST
+
+START_TEST(t_replay_corrupted) {
+  FILE *file = tmpfile();
+  ck_assert_ptr_nonnull(file);
+  replay_writer_t *writer = replay_writer_create(file);
+  ck_assert_ptr_nonnull(writer);
+  tetris_context_t *live = tetris_context_create();
+  ck_assert_ptr_nonnull(live);
+  game_clock_t clock = {0};
+  game_clock_init(&clock, GAME_CLOCK_MANUAL, 1);
+  tetris_context_set_clock(live, &clock);
+  tetris_context_set_recorder(live, writer);
+  play_random_game(live, 1);
+  tetris_context_destroy(live);
+  ck_assert_int_eq(replay_writer_destroy(writer), false);
+  size_t size = 0;
+  unsigned char *data = read_whole_file(file, &size);
+  fclose(file);
+
+  replay_reader_t reader;
+  tetris_context_t *replayed = tetris_context_create();
+  ck_assert_ptr_nonnull(replayed);
+  replay_game_result_t result;
+  // the game is cut before its end record
+  ck_assert_int_eq(replay_reader_init(&reader, data, size - 3), false);
+  ck_assert_int_eq(replay_play_game(&reader, replayed, &result), true);
+  ck_assert_int_eq(reader.error, true);
+  data[0] = 'X';
+  ck_assert_int_eq(replay_reader_init(&reader, data, size), true);
+  tetris_context_destroy(replayed);
+  free(data);
+}
+END_TEST
+
+START_TEST(t_replay_setup_versions) {
+  FILE *file = tmpfile();
+  ck_assert_ptr_nonnull(file);
+  replay_writer_t *writer = replay_writer_create(file);
+  ck_assert_ptr_nonnull(writer);
+  tetris_context_t *live = tetris_context_create();
+  ck_assert_ptr_nonnull(live);
+  game_clock_t clock = {0};
+  game_clock_init(&clock, GAME_CLOCK_MANUAL, 1);
+  tetris_context_set_clock(live, &clock);
+  tetris_context_set_recorder(live, writer);
+  play_random_game(live, 5);
+  tetris_context_destroy(live);
+  ck_assert_int_eq(replay_writer_destroy(writer), false);
+  size_t size = 0;
+  unsigned char *data = read_whole_file(file, &size);
+  fclose(file);
+
+  // the setup byte follows the head, the record type and the seed
+  replay_reader_t reader;
+  ck_assert_int_eq(replay_reader_init(&reader, data, size), false);
+  ck_assert_int_eq(reader.format_version, REPLAY_FORMAT_VERSION);
+  uint64_t head = 0;
+  const size_t setup_offset =
+      reader.position +
+      replay_get_varint(data + reader.position, size - reader.position,
+                        &head) +
+      1 + 8;
+  ck_assert_uint_eq(data[setup_offset], RANDOMIZER_BAG);
+  replay_event_t event;
+  // a version 1 game is played on the standard board
+  data[REPLAY_MAGIC_SIZE] = REPLAY_FORMAT_VERSION_STANDARD_BOARD;
+  ck_assert_int_eq(replay_reader_init(&reader, data, size), false);
+  ck_assert_int_eq(replay_reader_next(&reader, &event), true);
+  ck_assert_int_eq(event.setup.randomizer, RANDOMIZER_BAG);
+  ck_assert_int_eq(event.setup.board, BOARD_STANDARD);
+  // a board of a later version is not a randomizer of version 1
+  data[setup_offset] = RANDOMIZER_BAG | BOARD_MINI << 4;
+  ck_assert_int_eq(replay_reader_init(&reader, data, size), false);
+  ck_assert_int_eq(replay_reader_next(&reader, &event), false);
+  ck_assert_int_eq(reader.error, true);
+  data[REPLAY_MAGIC_SIZE] = REPLAY_FORMAT_VERSION;
+  ck_assert_int_eq(replay_reader_init(&reader, data, size), false);
+  ck_assert_int_eq(replay_reader_next(&reader, &event), true);
+  ck_assert_int_eq(event.setup.board, BOARD_MINI);
+  // unknown kinds are rejected
+  const unsigned char unknown[] = {RANDOMIZER_HISTORY + 1,
+                                   BOARD_KINDS_COUNT << 4};
+  for (size_t i = 0; i != sizeof(unknown); ++i) {
+    data[setup_offset] = unknown[i];
+    ck_assert_int_eq(replay_reader_init(&reader, data, size), false);
+    ck_assert_int_eq(replay_reader_next(&reader, &event), false);
+    ck_assert_int_eq(reader.error, true);
+  }
+  data[REPLAY_MAGIC_SIZE] = REPLAY_FORMAT_VERSION + 1;
+  ck_assert_int_eq(replay_reader_init(&reader, data, size), true);
+  free(data);
+}
+END_TEST
+
+Suite *ts_replay(void) {
+  Suite *s1 = suite_create("ts_replay");
+  TCase *t1 = tcase_create("tc_replay");
+
+  suite_add_tcase(s1, t1);
+  tcase_add_test(t1, t_replay_varint);
+  tcase_add_test(t1, t_replay_record_play);
+  tcase_add_test(t1, t_replay_corrupted);
+  tcase_add_test(t1, t_replay_setup_versions);
+
+  return s1;
+}
@@ -0,0 +1,139 @@
+#include <string.h>
+
+#include "../search.h"
+#include "tests.h"
+
+START_TEST(t_search_hash) {
+  search_t *search = search_create(NULL);
+  ck_assert_ptr_nonnull(search);
+  xoshiro256_t random;
+  xoshiro_seed(&random, 3);
+  row_mask_t board[FIELD_TOTAL_HEIGHT] = {0};
+  ck_assert_uint_eq(search_hash_board(search, board), 0);
+  uint64_t hash = 0;
+  static figure_t placements[PLACEMENTS_MAX];
+  int cuts = 0;
+  for (int i = 0; i != 400; ++i) {
+    figure_t spawned;
+    backend_get_spawned_figure(xoshiro_below(&random, 7), &spawned);
+    const int count = placement_generate(board, &spawned, placements);
+    // one of the lowest placements, so that the rows get filled
+    const figure_t *placement = NULL;
+    const int first = count ? (int)xoshiro_below(&random, count) : 0;
+    for (int k = 0; k != count; ++k) {
+      const figure_t *next = &placements[(first + k) % count];
+      if (!placement || next->position.r > placement->position.r) {
+        placement = next;
+      }
+    }
+    row_mask_t after[FIELD_TOTAL_HEIGHT];
+    memcpy(after, board, sizeof(after));
+    int cut_rows = 0;
+    // a new board after the game is over
+    if (!placement || placement_lock(after, placement, &cut_rows)) {
+      memset(board, 0, sizeof(board));
+      hash = 0;
+      continue;
+    }
+    hash = search_hash_lock(search, hash, board, after, placement, cut_rows);
+    memcpy(board, after, sizeof(board));
+    ck_assert_uint_eq(hash, search_hash_board(search, board));
+    cuts += cut_rows;
+  }
+  ck_assert_int_gt(cuts, 0);
+  search_destroy(search);
+}
+END_TEST
+
+START_TEST(t_search_transpositions) {
+  search_config_t config;
+  search_config_init(&config);
+  config.beam_width = 64;
+  search_t *search = search_create(&config);
+  ck_assert_ptr_nonnull(search);
+  // two O figures put side by side in either order give the same board
+  const row_mask_t board[FIELD_TOTAL_HEIGHT] = {0};
+  figure_t figure;
+  backend_get_spawned_figure(3, &figure);
+  const int preview = 3;
+  figure_t choice;
+  ck_assert_int_eq(search_choose(search, board, &figure, &preview, 1,
+                                 autoplay_evaluate_heuristic, NULL, &choice),
+                   false);
+  ck_assert_int_eq(choice.id, 3);
+  ck_assert_int_eq(search->stats.searches, 1);
+  ck_assert_int_gt(search->stats.duplicates, 0);
+  // 9 placements, then 9 more on each of them, less the repeated boards
+  ck_assert_int_eq(search->stats.nodes + search->stats.duplicates, 9 + 81);
+  // the next search does not see the boards of this one
+  ck_assert_int_eq(search_choose(search, board, &figure, NULL, 0,
+                                 autoplay_evaluate_heuristic, NULL, &choice),
+                   false);
+  ck_assert_int_eq(search->stats.nodes + search->stats.duplicates, 99);
+  search_destroy(search);
+}
+END_TEST
+
+START_TEST(t_search_budget) {
+  search_config_t config;
+  search_config_init(&config);
+  config.node_budget = 12;
+  search_t *search = search_create(&config);
+  ck_assert_ptr_nonnull(search);
+  const row_mask_t board[FIELD_TOTAL_HEIGHT] = {0};
+  figure_t figure;
+  backend_get_spawned_figure(5, &figure);
+  const int preview = 0;
+  figure_t choice;
+  ck_assert_int_eq(search_choose(search, board, &figure, &preview, 1,
+                                 autoplay_evaluate_heuristic, NULL, &choice),
+                   false);
+  ck_assert_int_eq(choice.id, 5);
+  ck_assert_int_eq(search->stats.nodes, 12);
+  ck_assert_int_eq(search->stats.budget_cuts, 1);
+  search_destroy(search);
+  config.node_budget = 0;
+  ck_assert_ptr_null(search_create(&config));
+}
+END_TEST
+
+START_TEST(t_search_game) {
+  tetris_context_t *context = tetris_context_create();
+  ck_assert_ptr_nonnull(context);
+  const tetris_setup_t setup = {9, RANDOMIZER_UNIFORM, BOARD_STANDARD};
+  tetris_context_configure(context, &setup);
+  search_t *search = search_create(NULL);
+  ck_assert_ptr_nonnull(search);
+  static autoplay_t autoplay;
+  autoplay_init(&autoplay, NULL, NULL);
+  autoplay_set_search(&autoplay, search);
+  tetris_context_apply_signal(context, START_BTN);
+  int pieces = 0;
+  while (context->core.state != GAMEOVER && pieces != 500) {
+    fsm_input_t signal = NO_INPUT;
+    if (context->core.state == SPAWNING) ++pieces;
+    if (context->core.state == IDLE) {
+      signal = autoplay_get_signal(&autoplay, &context->core.game);
+    }
+    tetris_context_apply_signal(context, signal);
+  }
+  ck_assert_int_eq(pieces, 500);
+  ck_assert_int_ge(search->stats.searches, 500 - 1);
+  ck_assert_int_gt(search->stats.nodes, search->stats.searches);
+  search_destroy(search);
+  tetris_context_destroy(context);
+}
+END_TEST
+
+Suite *ts_search(void) {
+  Suite *s1 = suite_create("ts_search");
+  TCase *t1 = tcase_create("tc_search");
+
+  suite_add_tcase(s1, t1);
+  tcase_add_test(t1, t_search_hash);
+  tcase_add_test(t1, t_search_transpositions);
+  tcase_add_test(t1, t_search_budget);
+  tcase_add_test(t1, t_search_game);
+
+  return s1;
+}
@@ -0,0 +1,250 @@
+#define _POSIX_C_SOURCE 200809L
+// relying on the POSIX pipe(), socketpair() and the Unix domain sockets
+#include <fcntl.h>
+#include <signal.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "../context.h"
+#include "../spectator.h"
+#include "tests.h"
+
+#define TEST_MOVES 40
+#define TEST_FLOOD_FRAMES 20000
+
+/// @brief read what the spectator has got and decode it, a partly read frame
+/// is kept for the next call
+/// @param fd the non-blocking read end of the spectator
+/// @param decoder the decoder
+/// @return number of the bytes read, -1 if the stream is malformed
+long read_spectator_stream(const int fd, spectator_decoder_t *decoder) {
+  static uint8_t buffer[1 << 17];
+  static size_t size = 0;
+  long total = 0;
+  ssize_t read_size = 0;
+  while ((read_size = read(fd, buffer + size, sizeof(buffer) - size)) > 0) {
+    size += (size_t)read_size;
+    total += read_size;
+    size_t offset = 0;
+    int frame_size = 0;
+    while ((frame_size = spectator_decode(decoder, buffer + offset,
+                                          size - offset)) > 0) {
+      offset += (size_t)frame_size;
+    }
+    if (frame_size < 0) return -1;
+    size -= offset;
+    memmove(buffer, buffer + offset, size);
+  }
+  return total;
+}
+
+/// @brief check that the spectator sees the game as it is
+/// @param decoder the decoder of the spectator
+/// @param context the context
+void check_spectator_frame(const spectator_decoder_t *decoder,
+                           const tetris_context_t *context) {
+  spectator_frame_t frame;
+  spectator_frame_fill(&frame, &context->core.game, context->core.state);
+  ck_assert_int_eq(decoder->synced, true);
+  ck_assert_int_eq(memcmp(&decoder->frame, &frame, sizeof(frame)), 0);
+}
+
+START_TEST(t_spectator_roundtrip) {
+  tetris_context_t *context = tetris_context_create();
+  spectator_hub_t *hub = spectator_hub_create();
+  ck_assert_ptr_nonnull(context);
+  ck_assert_ptr_nonnull(hub);
+  int pipe_fds[2];
+  ck_assert_int_eq(pipe(pipe_fds), 0);
+  fcntl(pipe_fds[0], F_SETFL, O_NONBLOCK);
+  ck_assert_int_eq(spectator_hub_add(hub, pipe_fds[1]), false);
+  const tetris_setup_t setup = {7, RANDOMIZER_BAG, BOARD_STANDARD};
+  tetris_context_configure(context, &setup);
+  tetris_context_set_spectators(context, hub);
+  static spectator_decoder_t decoder;
+  tetris_context_user_input(context, Start, true);
+  tetris_context_update_current_state(context);
+  ck_assert_int_gt(read_spectator_stream(pipe_fds[0], &decoder), 0);
+  check_spectator_frame(&decoder, context);
+  const UserAction_t moves[] = {Left, Action, Right, Down, Right, Down};
+  long bytes = 0;
+  for (int i = 0; i < TEST_MOVES; ++i) {
+    tetris_context_user_input(context, moves[i % 6], true);
+    tetris_context_update_current_state(context);
+    const long size = read_spectator_stream(pipe_fds[0], &decoder);
+    ck_assert_int_ge(size, 0);
+    bytes += size;
+    check_spectator_frame(&decoder, context);
+  }
+  // the deltas are a small fraction of the full frames
+  ck_assert_int_eq(decoder.skipped, 0);
+  ck_assert_int_eq(hub->stats.frames, decoder.frames);
+  ck_assert_int_lt(bytes * 10,
+                   (long)decoder.frames * SPECTATOR_FULL_FRAME_SIZE);
+  // an unchanged game sends nothing
+  tetris_context_publish(context);
+  ck_assert_int_eq(read_spectator_stream(pipe_fds[0], &decoder), 0);
+  tetris_context_destroy(context);
+  spectator_hub_destroy(hub);
+  close(pipe_fds[0]);
+}
+END_TEST
+
+START_TEST(t_spectator_resync) {
+  tetris_context_t *context = tetris_context_create();
+  spectator_hub_t *hub = spectator_hub_create();
+  ck_assert_ptr_nonnull(context);
+  ck_assert_ptr_nonnull(hub);
+  int pipe_fds[2];
+  ck_assert_int_eq(pipe(pipe_fds), 0);
+  fcntl(pipe_fds[0], F_SETFL, O_NONBLOCK);
+  ck_assert_int_eq(spectator_hub_add(hub, pipe_fds[1]), false);
+  tetris_context_set_spectators(context, hub);
+  tetris_context_user_input(context, Start, true);
+  tetris_context_update_current_state(context);
+  // a spectator that does not read fills the pipe and misses frames
+  for (int i = 0; i < TEST_FLOOD_FRAMES; ++i) {
+    context->core.game.game.score += 10;
+    tetris_context_publish(context);
+  }
+  ck_assert_int_gt(hub->stats.missed, 0);
+  ck_assert_int_eq(hub->stats.dropped, 0);
+  static spectator_decoder_t decoder;
+  ck_assert_int_gt(read_spectator_stream(pipe_fds[0], &decoder), 0);
+  // once it reads, the next frame is a keyframe of the current game
+  const long keyframes = hub->stats.keyframes;
+  context->core.game.game.score += 10;
+  tetris_context_publish(context);
+  ck_assert_int_eq(hub->stats.keyframes, keyframes + 1);
+  ck_assert_int_gt(read_spectator_stream(pipe_fds[0], &decoder), 0);
+  check_spectator_frame(&decoder, context);
+  tetris_context_destroy(context);
+  spectator_hub_destroy(hub);
+  close(pipe_fds[0]);
+}
+END_TEST
+
+START_TEST(t_spectator_late_decoder) {
+  spectator_frame_t first = {0};
+  spectator_frame_t second = first;
+  second.field[FIELD_TOTAL_HEIGHT - 1][3] = 5;
+  second.score = 100;
+  spectator_frame_t third = second;
+  third.next[1][2] = 7;
+  third.state = 3;
+  uint8_t buffer[SPECTATOR_MAX_FRAME_SIZE];
+  static spectator_decoder_t decoder;
+  // a delta without the keyframe before it is skipped
+  size_t size = spectator_encode(&first, &second, 2, buffer);
+  ck_assert_int_eq(spectator_decode(&decoder, buffer, size), (int)size);
+  ck_assert_int_eq(decoder.synced, false);
+  ck_assert_int_eq(decoder.skipped, 1);
+  // a row and the score: the size, the type, the number, the mask, one row,
+  // the flags and the score
+  ck_assert_int_eq((int)size, 1 + 1 + 1 + 4 + SPECTATOR_ROW_SIZE + 1 + 1);
+  size = spectator_encode(NULL, &second, 2, buffer);
+  ck_assert_int_eq(spectator_decode(&decoder, buffer, size - 1), 0);
+  ck_assert_int_eq(spectator_decode(&decoder, buffer, size), (int)size);
+  ck_assert_int_eq(decoder.synced, true);
+  size = spectator_encode(&second, &third, 3, buffer);
+  ck_assert_int_eq(spectator_decode(&decoder, buffer, size), (int)size);
+  ck_assert_int_eq(memcmp(&decoder.frame, &third, sizeof(third)), 0);
+  // a gap in the numbers waits for a keyframe
+  size = spectator_encode(&third, &second, 5, buffer);
+  ck_assert_int_eq(spectator_decode(&decoder, buffer, size), (int)size);
+  ck_assert_int_eq(decoder.synced, false);
+  ck_assert_int_eq(memcmp(&decoder.frame, &third, sizeof(third)), 0);
+  // a malformed frame
+  size = spectator_encode(NULL, &second, 6, buffer);
+  buffer[2] = 0;
+  ck_assert_int_eq(spectator_decode(&decoder, buffer, size), -1);
+  const uint8_t garbage[] = {0xFF, 0xFF, 0xFF, 0x01};
+  ck_assert_int_eq(spectator_decode(&decoder, garbage, sizeof(garbage)), -1);
+}
+END_TEST
+
+START_TEST(t_spectator_socket_drop) {
+  char path[108];
+  snprintf(path, sizeof(path), "/tmp/.tetris_spectate_test.%ld",
+           (long)getpid());
+  tetris_context_t *context = tetris_context_create();
+  spectator_hub_t *hub = spectator_hub_create();
+  ck_assert_ptr_nonnull(context);
+  ck_assert_ptr_nonnull(hub);
+  ck_assert_int_eq(spectator_hub_listen(hub, path), false);
+  ck_assert_int_eq(spectator_hub_listen(hub, path), true);
+  struct sockaddr_un address;
+  memset(&address, 0, sizeof(address));
+  address.sun_family = AF_UNIX;
+  strcpy(address.sun_path, path);
+  const int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+  ck_assert_int_eq(
+      connect(fd, (struct sockaddr *)&address, sizeof(address)), 0);
+  fcntl(fd, F_SETFL, O_NONBLOCK);
+  ck_assert_int_eq(spectator_hub_wait(hub, 1000), false);
+  int pair[2];
+  ck_assert_int_eq(socketpair(AF_UNIX, SOCK_STREAM, 0, pair), 0);
+  ck_assert_int_eq(spectator_hub_add(hub, pair[1]), false);
+  ck_assert_int_eq(hub->count, 2);
+  tetris_context_set_spectators(context, hub);
+  tetris_context_user_input(context, Start, true);
+  tetris_context_update_current_state(context);
+  static spectator_decoder_t decoder;
+  ck_assert_int_gt(read_spectator_stream(fd, &decoder), 0);
+  check_spectator_frame(&decoder, context);
+  // a spectator that is gone is dropped, the others keep watching
+  close(pair[0]);
+  tetris_context_user_input(context, Left, true);
+  tetris_context_update_current_state(context);
+  ck_assert_int_eq(hub->stats.dropped, 1);
+  ck_assert_int_eq(hub->count, 1);
+  ck_assert_int_gt(read_spectator_stream(fd, &decoder), 0);
+  check_spectator_frame(&decoder, context);
+  ck_assert_int_eq(spectator_hub_add(hub, -1), true);
+  tetris_context_destroy(context);
+  spectator_hub_destroy(hub);
+  ck_assert_int_eq(access(path, F_OK), -1);
+  close(fd);
+}
+END_TEST
+
+START_TEST(t_spectator_pipe_drop) {
+  tetris_context_t *context = tetris_context_create();
+  spectator_hub_t *hub = spectator_hub_create();
+  ck_assert_ptr_nonnull(context);
+  ck_assert_ptr_nonnull(hub);
+  int pipe_fds[2];
+  ck_assert_int_eq(pipe(pipe_fds), 0);
+  ck_assert_int_eq(spectator_hub_add(hub, pipe_fds[1]), false);
+  tetris_context_set_spectators(context, hub);
+  // a pipe whose reader has exited neither kills the game with SIGPIPE nor
+  // leaves one pending, the spectator is dropped
+  close(pipe_fds[0]);
+  tetris_context_user_input(context, Start, true);
+  tetris_context_update_current_state(context);
+  ck_assert_int_eq(hub->stats.dropped, 1);
+  ck_assert_int_eq(hub->count, 0);
+  sigset_t pending;
+  sigpending(&pending);
+  ck_assert_int_eq(sigismember(&pending, SIGPIPE), 0);
+  tetris_context_destroy(context);
+  spectator_hub_destroy(hub);
+}
+END_TEST
+
+Suite *ts_spectator(void) {
+  Suite *s1 = suite_create("ts_spectator");
+  TCase *t1 = tcase_create("tc_spectator");
+
+  suite_add_tcase(s1, t1);
+  tcase_add_test(t1, t_spectator_roundtrip);
+  tcase_add_test(t1, t_spectator_resync);
+  tcase_add_test(t1, t_spectator_late_decoder);
+  tcase_add_test(t1, t_spectator_socket_drop);
+  tcase_add_test(t1, t_spectator_pipe_drop);
+
+  return s1;
+}
@@ -0,0 +1,124 @@
+#include "../stats.h"
+#include "tests.h"
+
+START_TEST(t_stats_buckets) {
+  ck_assert_int_eq(stats_histogram_get_bucket(0), 0);
+  ck_assert_int_eq(stats_histogram_get_bucket(3), 3);
+  int previous = 3;
+  for (uint64_t ns = 4; ns != 1 << 20; ++ns) {
+    const int bucket = stats_histogram_get_bucket(ns);
+    // the buckets go in order and none is wider than a quarter of its values
+    ck_assert_int_ge(bucket, previous);
+    ck_assert_int_le(bucket, previous + 1);
+    ck_assert_uint_ge(stats_histogram_get_bucket_max(bucket), ns);
+    ck_assert_uint_lt(stats_histogram_get_bucket_max(bucket - 1), ns);
+    ck_assert_uint_le(stats_histogram_get_bucket_max(bucket) - ns,
+                      ns / STATS_SUB_BUCKETS);
+    previous = bucket;
+  }
+  ck_assert_int_eq(stats_histogram_get_bucket(UINT64_MAX),
+                   STATS_HISTOGRAM_BUCKETS - 1);
+  ck_assert_int_eq(stats_histogram_get_bucket(7ull << 38),
+                   STATS_HISTOGRAM_BUCKETS - 1);
+  ck_assert_int_eq(stats_histogram_get_bucket((7ull << 38) - 1),
+                   STATS_HISTOGRAM_BUCKETS - 2);
+}
+END_TEST
+
+START_TEST(t_stats_percentiles) {
+  stats_histogram_t histogram = {0};
+  ck_assert_uint_eq(stats_histogram_get_percentile(&histogram, 50), 0);
+  for (uint64_t ns = 1; ns <= 1000; ++ns) {
+    stats_histogram_record(&histogram, ns);
+  }
+  ck_assert_uint_eq(histogram.count, 1000);
+  ck_assert_uint_eq(histogram.max_ns, 1000);
+  ck_assert_uint_eq(histogram.total_ns, 500500);
+  const uint64_t p50 = stats_histogram_get_percentile(&histogram, 50);
+  ck_assert_uint_ge(p50, 500);
+  ck_assert_uint_le(p50, 500 + 500 / STATS_SUB_BUCKETS);
+  ck_assert_uint_eq(stats_histogram_get_percentile(&histogram, 100), 1000);
+}
+END_TEST
+
+START_TEST(t_stats_fsm) {
+#ifndef TETRIS_NO_STATS
+  static fsm_stats_t stats;
+  fsm_stats_reset(&stats);
+  ck_assert_ptr_null(fsm_stats_bind(&stats));
+  tetris_game_t g = {0};
+  tetris_state_t state = PRESTART;
+  fsm_apply_input(NO_INPUT, &state, &g);
+  fsm_apply_input(START_BTN, &state, &g);
+  fsm_apply_input(MOVE_LEFT, &state, &g);
+  fsm_apply_input(AUTOSHIFT_SIG, &state, &g);
+  fsm_apply_input(NO_INPUT, &state, &g);
+  fsm_apply_input(EXIT_BTN, &state, &g);
+  fsm_apply_input(NO_INPUT, &state, &g);
+  ck_assert_int_eq(state, EXIT);
+  ck_assert_ptr_eq(fsm_stats_bind(NULL), &stats);
+  fsm_apply_input(NO_INPUT, &state, &g);
+  ck_assert_uint_eq(stats.transitions[PRESTART], 1);
+  ck_assert_uint_eq(stats.transitions[START], 1);
+  ck_assert_uint_eq(stats.transitions[SPAWNING], 1);
+  ck_assert_uint_eq(stats.transitions[IDLE], 3);
+  ck_assert_uint_eq(stats.transitions[MOVING], 1);
+  ck_assert_uint_eq(stats.transitions[AUTOSHIFTING], 1);
+  ck_assert_uint_eq(stats.transitions[PREEXIT], 1);
+  ck_assert_uint_eq(stats.transitions[EXIT], 0);
+  const stats_call_t calls[] = {STATS_INIT_GAME, STATS_SETUP_NEW_GAME,
+                                STATS_SPAWN,     STATS_MOVE_LEFT,
+                                STATS_DROP,      STATS_DESTROY_GAME};
+  for (int i = 0; i != 6; ++i) {
+    ck_assert_uint_eq(stats.calls[calls[i]].count, 1);
+  }
+  ck_assert_uint_eq(stats.calls[STATS_ROTATE].count, 0);
+  ck_assert_uint_eq(stats.calls[STATS_CUT].count, 0);
+#endif
+}
+END_TEST
+
+START_TEST(t_stats_context_merge) {
+#ifndef TETRIS_NO_STATS
+  static fsm_stats_t stats[2];
+  static fsm_stats_t merged;
+  tetris_context_t *contexts[2];
+  for (int i = 0; i != 2; ++i) {
+    contexts[i] = tetris_context_create();
+    ck_assert_ptr_nonnull(contexts[i]);
+    fsm_stats_reset(&stats[i]);
+    tetris_context_set_stats(contexts[i], &stats[i]);
+    tetris_context_apply_signal(contexts[i], START_BTN);
+    for (int k = 0; k <= i; ++k) {
+      tetris_context_apply_signal(contexts[i], ROTATE_BTN);
+    }
+  }
+  // the contexts do not leave their statistics bound
+  ck_assert_ptr_null(fsm_stats_bind(NULL));
+  ck_assert_uint_eq(stats[0].calls[STATS_ROTATE].count, 1);
+  ck_assert_uint_eq(stats[1].calls[STATS_ROTATE].count, 2);
+  fsm_stats_reset(&merged);
+  fsm_stats_merge(&merged, &stats[0]);
+  fsm_stats_merge(&merged, &stats[1]);
+  ck_assert_uint_eq(merged.calls[STATS_ROTATE].count, 3);
+  ck_assert_uint_eq(merged.calls[STATS_SPAWN].count, 2);
+  ck_assert_uint_eq(merged.transitions[START], 2);
+  ck_assert_uint_ge(merged.calls[STATS_ROTATE].max_ns,
+                    stats[1].calls[STATS_ROTATE].max_ns);
+  for (int i = 0; i != 2; ++i) tetris_context_destroy(contexts[i]);
+#endif
+}
+END_TEST
+
+Suite *ts_stats(void) {
+  Suite *s1 = suite_create("ts_stats");
+  TCase *t1 = tcase_create("tc_stats");
+
+  suite_add_tcase(s1, t1);
+  tcase_add_test(t1, t_stats_buckets);
+  tcase_add_test(t1, t_stats_percentiles);
+  tcase_add_test(t1, t_stats_fsm);
+  tcase_add_test(t1, t_stats_context_merge);
+
+  return s1;
+}
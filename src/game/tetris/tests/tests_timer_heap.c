@@ -0,0 +1,117 @@
+#include "../../../server/protocol.h"
+#include "../../../server/timer_heap.h"
+#include "tests.h"
+
+#define TEST_SESSIONS 64
+
+/// @brief check that every deadline is not earlier than its parent and the
+/// positions point to the deadlines of their sessions
+/// @param heap the heap
+/// @param count number of the deadlines expected
+void check_timer_heap(const timer_heap_t *heap, const int count) {
+  ck_assert_int_eq(heap->count, count);
+  int placed = 0;
+  for (int id = 0; id != heap->capacity; ++id) {
+    const int i = heap->positions[id];
+    if (i < 0) continue;
+    ++placed;
+    ck_assert_int_lt(i, heap->count);
+    ck_assert_int_eq(heap->entries[i].id, id);
+  }
+  ck_assert_int_eq(placed, count);
+  for (int i = 1; i < heap->count; ++i) {
+    ck_assert_uint_ge(heap->entries[i].deadline_ms,
+                      heap->entries[(i - 1) / 2].deadline_ms);
+  }
+}
+
+START_TEST(t_timer_heap_set_remove) {
+  timer_heap_t heap = {0};
+  ck_assert_int_eq(timer_heap_init(&heap, TEST_SESSIONS), false);
+  ck_assert_int_eq(timer_heap_get_ms_to_first(&heap, 0), -1);
+  ck_assert_int_eq(timer_heap_pop_due(&heap, UINT64_MAX), -1);
+  for (int id = 0; id != TEST_SESSIONS; ++id) {
+    timer_heap_set(&heap, id, 1000 + (uint64_t)((id * 37) % TEST_SESSIONS));
+    check_timer_heap(&heap, id + 1);
+  }
+  ck_assert_int_eq(timer_heap_get_ms_to_first(&heap, 900), 100);
+  ck_assert_int_eq(timer_heap_get_ms_to_first(&heap, 2000), 0);
+  // a deadline moved earlier or later keeps its session
+  timer_heap_set(&heap, 5, 10);
+  check_timer_heap(&heap, TEST_SESSIONS);
+  ck_assert_int_eq(heap.entries[0].id, 5);
+  timer_heap_set(&heap, 5, 5000);
+  timer_heap_set(&heap, 9, 1);
+  check_timer_heap(&heap, TEST_SESSIONS);
+  ck_assert_int_eq(heap.entries[0].id, 9);
+  // removed from the root, a leaf and the middle, then once more
+  timer_heap_remove(&heap, 9);
+  timer_heap_remove(&heap, heap.entries[heap.count - 1].id);
+  timer_heap_remove(&heap, heap.entries[heap.count / 2].id);
+  timer_heap_remove(&heap, 9);
+  check_timer_heap(&heap, TEST_SESSIONS - 3);
+  ck_assert_int_eq(heap.positions[9], -1);
+  timer_heap_destroy(&heap);
+}
+END_TEST
+
+START_TEST(t_timer_heap_pop_due) {
+  timer_heap_t heap = {0};
+  ck_assert_int_eq(timer_heap_init(&heap, TEST_SESSIONS), false);
+  for (int id = 0; id != TEST_SESSIONS; ++id) {
+    timer_heap_set(&heap, id, (uint64_t)((id * 23) % 17) * 10);
+  }
+  // only the passed deadlines are taken, the earliest first
+  int count = TEST_SESSIONS;
+  uint64_t previous_ms = 0;
+  for (uint64_t now_ms = 0; now_ms != 200; now_ms += 10) {
+    int id = -1;
+    while ((id = timer_heap_pop_due(&heap, now_ms)) >= 0) {
+      const uint64_t deadline_ms = (uint64_t)((id * 23) % 17) * 10;
+      ck_assert_uint_le(deadline_ms, now_ms);
+      ck_assert_uint_ge(deadline_ms, previous_ms);
+      previous_ms = deadline_ms;
+      ck_assert_int_eq(heap.positions[id], -1);
+      check_timer_heap(&heap, --count);
+    }
+    if (count) ck_assert_int_gt(timer_heap_get_ms_to_first(&heap, now_ms), 0);
+  }
+  ck_assert_int_eq(count, 0);
+  ck_assert_int_eq(timer_heap_get_ms_to_first(&heap, 0), -1);
+  timer_heap_destroy(&heap);
+  ck_assert_ptr_null(heap.entries);
+}
+END_TEST
+
+START_TEST(t_server_request_valid) {
+  server_request_t request = {SERVER_REQUEST_OPEN, Start, 1, BOARD_MINI, 1, 7};
+  ck_assert_int_eq(server_request_get_is_valid(&request), true);
+  request.kind = SERVER_REQUEST_INPUT;
+  request.action = Action;
+  ck_assert_int_eq(server_request_get_is_valid(&request), true);
+  request.kind = SERVER_REQUEST_CLOSE;
+  ck_assert_int_eq(server_request_get_is_valid(&request), true);
+  request.kind = 0;
+  ck_assert_int_eq(server_request_get_is_valid(&request), false);
+  request.kind = SERVER_REQUEST_CLOSE + 1;
+  ck_assert_int_eq(server_request_get_is_valid(&request), false);
+  request.kind = SERVER_REQUEST_INPUT;
+  request.action = USERACTIONS_COUNT;
+  ck_assert_int_eq(server_request_get_is_valid(&request), false);
+  request.action = Left;
+  request.board = BOARD_KINDS_COUNT;
+  ck_assert_int_eq(server_request_get_is_valid(&request), false);
+}
+END_TEST
+
+Suite *ts_timer_heap(void) {
+  Suite *s1 = suite_create("ts_timer_heap");
+  TCase *t1 = tcase_create("tc_timer_heap");
+
+  suite_add_tcase(s1, t1);
+  tcase_add_test(t1, t_timer_heap_set_remove);
+  tcase_add_test(t1, t_timer_heap_pop_due);
+  tcase_add_test(t1, t_server_request_valid);
+
+  return s1;
+}
@@ -1,15 +1,10 @@
 #include "front.h"
 
-#define _POSIX_C_SOURCE 200809L
-// relying on the POSIX nanosleep()
-// man 2 nanosleep
 #include <ncurses.h>
 #include <stdlib.h>
-#include <time.h>
 
 #include "../../game/lib.h"
 #include "../../game/tetris/defines.h"
-#include "../../common/time_utils.h"
 
 void f_init_colours(void) {
   start_color();
@@ -24,22 +19,26 @@ void f_init_colours(void) {
   init_pair(9, COLOR_BLACK, COLOR_BLACK);
 }
 
+void draw_help(void);
+
 void init_cli() {
   initscr();
   cbreak();
   noecho();
-  nodelay(stdscr, TRUE);
+  // the keys are read by the input thread, see input.h
   keypad(stdscr, TRUE);
   if (has_colors()) {
     f_init_colours();
   }
+}
+
+void draw_help(void) {
   const int screen_center_row = getmaxy(stdscr) / 2;
   const int screen_center_column = getmaxx(stdscr) / 2;
   mvprintw(screen_center_row, screen_center_column, "s - start/restart");
   mvprintw(screen_center_row + 1, screen_center_column, "p - pause");
   mvprintw(screen_center_row + 2, screen_center_column, "space - rotate");
   mvprintw(screen_center_row + 3, screen_center_column, "q - exit");
-  refresh();
 }
 
 void free_cli(void) {
@@ -51,40 +50,121 @@ void free_cli(void) {
 
 #define IFACE_HSTRETCH_COEFF 2
 #define IFACE_GAMEFIELD_WIDTH (FIELD_WIDTH * IFACE_HSTRETCH_COEFF)
-void draw_game_field(const GameInfo_t *const game, const int screen_center_row);
-void draw_next_figure(const GameInfo_t *const game,
-                      const int screen_center_row);
-void draw_game_stats(const GameInfo_t *const game, const int screen_center_row);
+void draw_game_field(const GameInfo_t *const game, const int screen_center_row,
+                     const bool full, const unsigned long dirty_rows);
+void draw_next_figure(const GameInfo_t *const game, const int screen_center_row,
+                      const bool full);
+void draw_game_stats(const GameInfo_t *const game, const int screen_center_row,
+                     const bool full);
 void draw_game_over(const int screen_center_row, const bool over);
 void draw_pause(const int screen_center_row, const bool pause);
 
+// what is on the screen, the scene is redrawn only where it differs
+typedef struct {
+  bool drawn;
+  int screen_rows;
+  int screen_columns;
+  unsigned long generation;
+  bool game_over;
+  bool pause;
+  int score;
+  int level;
+  int high_score;
+  int next[MAX_FIGURE_SIZE][MAX_FIGURE_SIZE];
+} scene_cache_t;
+
+static scene_cache_t scene_cache;
+
+bool get_next_figure_changed(const GameInfo_t *const game) {
+  bool changed = false;
+  for (int r = 0; !changed && r < MAX_FIGURE_SIZE; ++r) {
+    for (int c = 0; !changed && c < MAX_FIGURE_SIZE; ++c) {
+      changed = game->next[r][c] != scene_cache.next[r][c];
+    }
+  }
+  return changed;
+}
+
+bool get_game_stats_changed(const GameInfo_t *const game) {
+  return game->score != scene_cache.score ||
+         game->level != scene_cache.level ||
+         game->high_score != scene_cache.high_score;
+}
+
+void save_scene_cache(const GameInfo_t *const game) {
+  scene_cache.score = game->score;
+  scene_cache.level = game->level;
+  scene_cache.high_score = game->high_score;
+  for (int r = 0; r < MAX_FIGURE_SIZE; ++r) {
+    for (int c = 0; c < MAX_FIGURE_SIZE; ++c) {
+      scene_cache.next[r][c] = game->next[r][c];
+    }
+  }
+}
+
 void frontend_draw_game_scene(const GameInfo_t *const game, bool game_over,
-                              bool pause) {
-  const int screen_center_row = getmaxy(stdscr) / 2;
-  draw_game_field(game, screen_center_row);
-  draw_next_figure(game, screen_center_row);
-  draw_game_stats(game, screen_center_row);
-  draw_game_over(screen_center_row, game_over);
-  draw_pause(screen_center_row, pause);
+                              bool pause, unsigned long generation,
+                              unsigned long dirty_rows) {
+  if (!game || !game->field || !game->next) return;
+  const int screen_rows = getmaxy(stdscr);
+  const int screen_columns = getmaxx(stdscr);
+  const bool full = !scene_cache.drawn ||
+                    screen_rows != scene_cache.screen_rows ||
+                    screen_columns != scene_cache.screen_columns;
+  if (!full && generation == scene_cache.generation &&
+      game_over == scene_cache.game_over && pause == scene_cache.pause) {
+    return;
+  }
+  const int screen_center_row = screen_rows / 2;
+  if (full) {
+    clear();
+    draw_help();
+  }
+  draw_game_field(game, screen_center_row, full, dirty_rows);
+  if (full || get_next_figure_changed(game)) {
+    draw_next_figure(game, screen_center_row, full);
+  }
+  if (full || get_game_stats_changed(game)) {
+    draw_game_stats(game, screen_center_row, full);
+  }
+  if (full || game_over != scene_cache.game_over) {
+    draw_game_over(screen_center_row, game_over);
+  }
+  if (full || pause != scene_cache.pause) {
+    draw_pause(screen_center_row, pause);
+  }
+  save_scene_cache(game);
+  scene_cache.drawn = true;
+  scene_cache.screen_rows = screen_rows;
+  scene_cache.screen_columns = screen_columns;
+  scene_cache.generation = generation;
+  scene_cache.game_over = game_over;
+  scene_cache.pause = pause;
   move(0, 0);
   refresh();
 }
 
-void draw_game_field(const GameInfo_t *const game,
-                     const int screen_center_row) {
+void draw_game_field(const GameInfo_t *const game, const int screen_center_row,
+                     const bool full, const unsigned long dirty_rows) {
   if (!game) return;
   if (screen_center_row < FIELD_VISIBLE_HEIGHT / 2) return;
   const int start_row = screen_center_row - FIELD_VISIBLE_HEIGHT / 2 - 1;
-  move(start_row, 2);
-  hline(ACS_HLINE, IFACE_GAMEFIELD_WIDTH);
-  move(start_row + 1, 1);
-  vline(ACS_VLINE, FIELD_VISIBLE_HEIGHT);
-  move(start_row + FIELD_VISIBLE_HEIGHT + 1, 2);
-  hline(ACS_HLINE, IFACE_GAMEFIELD_WIDTH);
-  move(start_row + 1, IFACE_GAMEFIELD_WIDTH + 2);
-  vline(ACS_VLINE, FIELD_VISIBLE_HEIGHT);
+  if (full) {
+    move(start_row, 2);
+    hline(ACS_HLINE, IFACE_GAMEFIELD_WIDTH);
+    move(start_row + 1, 1);
+    vline(ACS_VLINE, FIELD_VISIBLE_HEIGHT);
+    move(start_row + FIELD_VISIBLE_HEIGHT + 1, 2);
+    hline(ACS_HLINE, IFACE_GAMEFIELD_WIDTH);
+    move(start_row + 1, IFACE_GAMEFIELD_WIDTH + 2);
+    vline(ACS_VLINE, FIELD_VISIBLE_HEIGHT);
+  }
   int interface_r = start_row + 1;
   for (int r = FIELD_UPPER_MARGIN; r < FIELD_TOTAL_HEIGHT; ++r) {
+    if (!full && !((dirty_rows >> r) & 1ul)) {
+      ++interface_r;
+      continue;
+    }
     move(interface_r++, 2);
     for (int c = 0; c < FIELD_WIDTH; ++c) {
       const int field_value = game->field[r][c];
@@ -103,20 +183,22 @@ void draw_game_field(const GameInfo_t *const game,
   }
 }
 
-void draw_next_figure(const GameInfo_t *const game,
-                      const int screen_center_row) {
+void draw_next_figure(const GameInfo_t *const game, const int screen_center_row,
+                      const bool full) {
   if (!game) return;
   if (screen_center_row < FIELD_VISIBLE_HEIGHT / 2) return;
   const int start_row = screen_center_row - FIELD_VISIBLE_HEIGHT / 2 - 1;
-  move(start_row, IFACE_GAMEFIELD_WIDTH + 4);
-  hline(ACS_HLINE, MAX_FIGURE_SIZE * IFACE_HSTRETCH_COEFF);
-  move(start_row + 1, IFACE_GAMEFIELD_WIDTH + 3);
-  vline(ACS_VLINE, MAX_FIGURE_SIZE);
-  move(start_row + MAX_FIGURE_SIZE + 1, IFACE_GAMEFIELD_WIDTH + 4);
-  hline(ACS_HLINE, MAX_FIGURE_SIZE * IFACE_HSTRETCH_COEFF);
-  move(start_row + 1,
-       IFACE_GAMEFIELD_WIDTH + 4 + MAX_FIGURE_SIZE * IFACE_HSTRETCH_COEFF);
-  vline(ACS_VLINE, MAX_FIGURE_SIZE);
+  if (full) {
+    move(start_row, IFACE_GAMEFIELD_WIDTH + 4);
+    hline(ACS_HLINE, MAX_FIGURE_SIZE * IFACE_HSTRETCH_COEFF);
+    move(start_row + 1, IFACE_GAMEFIELD_WIDTH + 3);
+    vline(ACS_VLINE, MAX_FIGURE_SIZE);
+    move(start_row + MAX_FIGURE_SIZE + 1, IFACE_GAMEFIELD_WIDTH + 4);
+    hline(ACS_HLINE, MAX_FIGURE_SIZE * IFACE_HSTRETCH_COEFF);
+    move(start_row + 1,
+         IFACE_GAMEFIELD_WIDTH + 4 + MAX_FIGURE_SIZE * IFACE_HSTRETCH_COEFF);
+    vline(ACS_VLINE, MAX_FIGURE_SIZE);
+  }
   int interface_r = start_row + 1;
   const int interface_c = IFACE_GAMEFIELD_WIDTH + 4;
   for (int r = 0; r < MAX_FIGURE_SIZE; ++r) {
@@ -138,20 +220,22 @@ void draw_next_figure(const GameInfo_t *const game,
   }
 }
 
-void draw_game_stats(const GameInfo_t *const game,
-                     const int screen_center_row) {
+void draw_game_stats(const GameInfo_t *const game, const int screen_center_row,
+                     const bool full) {
   if (!game) return;
   if (screen_center_row < FIELD_VISIBLE_HEIGHT / 2) return;
   const int start_row = screen_center_row - FIELD_VISIBLE_HEIGHT / 2 + 6;
-  move(start_row, IFACE_GAMEFIELD_WIDTH + 4);
-  hline(ACS_HLINE, MAX_FIGURE_SIZE * IFACE_HSTRETCH_COEFF);
-  move(start_row + 1, IFACE_GAMEFIELD_WIDTH + 3);
-  vline(ACS_VLINE, 6);
-  move(start_row + 6 + 1, IFACE_GAMEFIELD_WIDTH + 4);
-  hline(ACS_HLINE, MAX_FIGURE_SIZE * IFACE_HSTRETCH_COEFF);
-  move(start_row + 1,
-       IFACE_GAMEFIELD_WIDTH + 4 + MAX_FIGURE_SIZE * IFACE_HSTRETCH_COEFF);
-  vline(ACS_VLINE, 6);
+  if (full) {
+    move(start_row, IFACE_GAMEFIELD_WIDTH + 4);
+    hline(ACS_HLINE, MAX_FIGURE_SIZE * IFACE_HSTRETCH_COEFF);
+    move(start_row + 1, IFACE_GAMEFIELD_WIDTH + 3);
+    vline(ACS_VLINE, 6);
+    move(start_row + 6 + 1, IFACE_GAMEFIELD_WIDTH + 4);
+    hline(ACS_HLINE, MAX_FIGURE_SIZE * IFACE_HSTRETCH_COEFF);
+    move(start_row + 1,
+         IFACE_GAMEFIELD_WIDTH + 4 + MAX_FIGURE_SIZE * IFACE_HSTRETCH_COEFF);
+    vline(ACS_VLINE, 6);
+  }
   int interface_r = start_row + 1;
   const int interface_c = IFACE_GAMEFIELD_WIDTH + 4;
   move(interface_r++, interface_c);
@@ -199,56 +283,3 @@ void draw_pause(const int screen_center_row, const bool paused) {
     attroff(COLOR_PAIR(5));
   }
 }
-
-bool get_user_input(UserAction_t *const input) {
-  // static clock_t prev_update;
-  static struct timespec prev_update;
-  bool any_input = false;
-  if (get_is_time_to_operate_ms_diff(&prev_update, USERINPUT_COOLDOWN_MS)) {
-    const int ch = getch();
-    switch (ch) {
-      case KEY_UP:
-        *input = Up;
-        any_input = true;
-        break;
-      case KEY_DOWN:
-        *input = Down;
-        any_input = true;
-        break;
-      case KEY_LEFT:
-        *input = Left;
-        any_input = true;
-        break;
-      case KEY_RIGHT:
-        *input = Right;
-        any_input = true;
-        break;
-      case 's':
-        *input = Start;
-        any_input = true;
-        break;
-      case 'p':
-        *input = Pause;
-        any_input = true;
-        break;
-      case 'q':
-        *input = Terminate;
-        any_input = true;
-        break;
-      case ' ':
-        *input = Action;
-        any_input = true;
-        break;
-      default:
-        break;
-    }
-  }
-  return any_input;
-}
-
-void frontend_interframe_delay(void) {
-  struct timespec ts1 = {0};
-  ts1.tv_nsec = 800000;
-  struct timespec trem = {0};
-  nanosleep(&ts1, &trem);
-}
@@ -0,0 +1,247 @@
+#include "input.h"
+
+/// @file input.c
+/// @brief Implementation of the input thread. ncurses is not thread safe, so
+/// the thread reads the terminal fd directly and decodes the arrow keys
+/// itself, the main thread keeps ncurses for the output only. After every
+/// read the thread writes the read time to the notify pipe, the main loop
+/// sleeps on it
+
+#define _POSIX_C_SOURCE 200809L
+// relying on the POSIX poll(), pipe() and read()
+#include <limits.h>
+#include <poll.h>
+#include <pthread.h>
+#include <unistd.h>
+
+#include "../../common/time_utils.h"
+#include "../../game/lib.h"
+
+#define INPUT_READ_SIZE 32
+#define LATENCY_BUCKETS 32
+
+typedef enum {
+  KEY_STATE_PLAIN = 0,
+  KEY_STATE_ESCAPE,
+  KEY_STATE_SEQUENCE
+} key_state_t;
+
+// latency histogram, the bucket b counts the wakes of [2^b - 1, 2^(b+1) - 1)
+// microseconds late
+typedef struct {
+  unsigned long count;
+  unsigned long sum_us;
+  unsigned long max_us;
+  unsigned long buckets[LATENCY_BUCKETS];
+} wake_latency_t;
+
+static pthread_t input_thread;
+static int stop_pipe[2] = {-1, -1};
+static int notify_pipe[2] = {-1, -1};
+static wake_latency_t input_latency;
+static wake_latency_t timer_latency;
+
+bool decode_input_char(const char ch, key_state_t *state,
+                       UserAction_t *action);
+void *input_thread_routine(void *arg);
+void wake_latency_add(wake_latency_t *latency, unsigned long us);
+void wake_latency_print(FILE *stream, const char *name,
+                        const wake_latency_t *latency);
+
+/// @brief translate a character of the terminal input to the user action.
+/// Arrow keys come as ESC [ A or ESC O A, the decoder state is kept between
+/// the calls, so a sequence may be split between the reads
+/// @param ch the character
+/// @param state decoder state
+/// @param action where to save the action
+/// @return true if the character completes a key press
+bool decode_input_char(const char ch, key_state_t *state,
+                       UserAction_t *action) {
+  bool any_input = true;
+  if (*state == KEY_STATE_SEQUENCE) {
+    *state = KEY_STATE_PLAIN;
+    switch (ch) {
+      case 'A':
+        *action = Up;
+        break;
+      case 'B':
+        *action = Down;
+        break;
+      case 'C':
+        *action = Right;
+        break;
+      case 'D':
+        *action = Left;
+        break;
+      default:
+        any_input = false;
+        break;
+    }
+  } else if (*state == KEY_STATE_ESCAPE && (ch == '[' || ch == 'O')) {
+    *state = KEY_STATE_SEQUENCE;
+    any_input = false;
+  } else {
+    // a lone escape is dropped, the character after it is a plain one
+    *state = KEY_STATE_PLAIN;
+    switch (ch) {
+      case '\033':
+        *state = KEY_STATE_ESCAPE;
+        any_input = false;
+        break;
+      case 's':
+        *action = Start;
+        break;
+      case 'p':
+        *action = Pause;
+        break;
+      case 'q':
+        *action = Terminate;
+        break;
+      case ' ':
+        *action = Action;
+        break;
+      default:
+        any_input = false;
+        break;
+    }
+  }
+  return any_input;
+}
+
+/// @brief block on the terminal and the stop pipe, push the key presses to
+/// the game until the stop pipe is written to
+/// @param arg unused
+/// @return NULL
+void *input_thread_routine(void *arg) {
+  (void)arg;
+  key_state_t state = KEY_STATE_PLAIN;
+  bool running = true;
+  while (running) {
+    struct pollfd fds[2] = {{STDIN_FILENO, POLLIN, 0},
+                            {stop_pipe[0], POLLIN, 0}};
+    if (poll(fds, 2, -1) < 0) continue;
+    if (fds[1].revents) {
+      running = false;
+    } else if (fds[0].revents & (POLLHUP | POLLERR)) {
+      running = false;
+    } else if (fds[0].revents & POLLIN) {
+      char buffer[INPUT_READ_SIZE];
+      const ssize_t count = read(STDIN_FILENO, buffer, INPUT_READ_SIZE);
+      const unsigned long read_us = get_monotonic_us();
+      bool any_input = false;
+      for (ssize_t i = 0; i < count; ++i) {
+        UserAction_t action = Start;
+        if (decode_input_char(buffer[i], &state, &action)) {
+          userInput(action, true);
+          any_input = true;
+        }
+      }
+      if (any_input &&
+          write(notify_pipe[1], &read_us, sizeof(read_us)) < 0) {
+        running = false;
+      }
+      if (count == 0) running = false;
+    }
+  }
+  return NULL;
+}
+
+/// @brief start the input thread
+/// @return true on error
+bool frontend_start_input(void) {
+  bool error = pipe(stop_pipe) != 0;
+  if (!error && pipe(notify_pipe)) {
+    close(stop_pipe[0]);
+    close(stop_pipe[1]);
+    error = true;
+  }
+  if (!error &&
+      pthread_create(&input_thread, NULL, input_thread_routine, NULL)) {
+    close(stop_pipe[0]);
+    close(stop_pipe[1]);
+    close(notify_pipe[0]);
+    close(notify_pipe[1]);
+    error = true;
+  }
+  return error;
+}
+
+/// @brief wake the input thread up and wait for it to finish
+void frontend_stop_input(void) {
+  const char stop = 0;
+  if (write(stop_pipe[1], &stop, 1) == 1) {
+    pthread_join(input_thread, NULL);
+  }
+  close(stop_pipe[0]);
+  close(stop_pipe[1]);
+  close(notify_pipe[0]);
+  close(notify_pipe[1]);
+}
+
+/// @brief sleep until the input thread pushes input or the timeout expires.
+/// The delay between the key read and the wake, and between the timeout and
+/// the wake, is accounted in the latency statistics
+/// @param timeout_ms milliseconds to sleep, 0 to not sleep, -1 to sleep until
+/// the input
+void frontend_wait_for_input(const long timeout_ms) {
+  struct pollfd fd = {notify_pipe[0], POLLIN, 0};
+  const unsigned long deadline_us =
+      get_monotonic_us() + (timeout_ms > 0 ? timeout_ms : 0) * 1000ul;
+  const int ready =
+      poll(&fd, 1, timeout_ms > INT_MAX ? INT_MAX : (int)timeout_ms);
+  const unsigned long wake_us = get_monotonic_us();
+  if (ready > 0) {
+    unsigned long read_us[INPUT_READ_SIZE];
+    const ssize_t size = read(notify_pipe[0], read_us, sizeof(read_us));
+    for (ssize_t i = 0; i < size / (ssize_t)sizeof(unsigned long); ++i) {
+      wake_latency_add(&input_latency,
+                       wake_us > read_us[i] ? wake_us - read_us[i] : 0);
+    }
+  } else if (ready == 0 && timeout_ms > 0) {
+    wake_latency_add(&timer_latency,
+                     wake_us > deadline_us ? wake_us - deadline_us : 0);
+  }
+}
+
+/// @brief account a wake
+/// @param latency the statistics
+/// @param us microseconds between the event and the wake
+void wake_latency_add(wake_latency_t *latency, unsigned long us) {
+  int bucket = 0;
+  while (bucket < LATENCY_BUCKETS - 1 && (us + 1) >> (bucket + 1)) {
+    ++bucket;
+  }
+  ++latency->buckets[bucket];
+  ++latency->count;
+  latency->sum_us += us;
+  if (us > latency->max_us) latency->max_us = us;
+}
+
+/// @brief print the count, the mean, the 99th percentile upper bound and the
+/// maximum of the wake latency
+/// @param stream where to print
+/// @param name what woke the loop up
+/// @param latency the statistics
+void wake_latency_print(FILE *stream, const char *name,
+                        const wake_latency_t *latency) {
+  unsigned long p99_us = 0;
+  unsigned long accounted = 0;
+  for (int b = 0; latency->count && b < LATENCY_BUCKETS; ++b) {
+    accounted += latency->buckets[b];
+    if (!p99_us && accounted * 100 >= latency->count * 99) {
+      p99_us = (2ul << b) - 1;
+    }
+  }
+  fprintf(stream, "%s wakes: %lu, mean %lu us, p99 < %lu us, max %lu us\n",
+          name, latency->count,
+          latency->count ? latency->sum_us / latency->count : 0, p99_us,
+          latency->max_us);
+}
+
+/// @brief print the wake latency of the main loop, on the input and on the
+/// autoshift timer
+/// @param stream where to print
+void frontend_print_wake_latency(FILE *stream) {
+  wake_latency_print(stream, "input", &input_latency);
+  wake_latency_print(stream, "timer", &timer_latency);
+}
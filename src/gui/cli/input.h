@@ -0,0 +1,17 @@
+#ifndef GAME_FRONTEND_INPUT
+#define GAME_FRONTEND_INPUT
+
+/// @file input.h
+/// @brief Declaration of the input thread. The thread blocks on the terminal
+/// and pushes every key press to the game as soon as it is read, the main
+/// loop sleeps until it does or until the next autoshift
+
+#include <stdbool.h>
+#include <stdio.h>
+
+bool frontend_start_input(void);
+void frontend_stop_input(void);
+void frontend_wait_for_input(const long timeout_ms);
+void frontend_print_wake_latency(FILE *stream);
+
+#endif
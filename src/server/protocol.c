@@ -0,0 +1,39 @@
+#include "protocol.h"
+
+/// @file protocol.c
+/// @brief Implementation of the messages of the game server
+
+/// @brief make the state message of the game of a context
+/// @param state where to save the message
+/// @param context the context
+/// @param sequence sequence of the last request applied
+void server_state_fill(server_state_t *state, const tetris_context_t *context,
+                       const uint32_t sequence) {
+  const tetris_game_t *game = &context->core.game;
+  state->state = (uint8_t)context->core.state;
+  state->next_figure_id = (uint8_t)game->next_figure_id;
+  state->pause = (uint8_t)game->game.pause;
+  state->board = (uint8_t)game->board;
+  state->sequence = sequence;
+  state->score = game->game.score;
+  state->high_score = game->game.high_score;
+  state->level = game->game.level;
+  state->lines = game->game.lines;
+  state->generation = game->generation;
+  for (int r = 0; r < FIELD_VISIBLE_HEIGHT; ++r) {
+    for (int c = 0; c < FIELD_WIDTH; ++c) {
+      state->field[r][c] = (uint8_t)game->game.field[FIELD_UPPER_MARGIN + r][c];
+    }
+  }
+}
+
+/// @brief check the request before it is applied
+/// @param request the request
+/// @return true if the kind, the action and the board are known
+bool server_request_get_is_valid(const server_request_t *request) {
+  return (request->kind == SERVER_REQUEST_OPEN ||
+          request->kind == SERVER_REQUEST_INPUT ||
+          request->kind == SERVER_REQUEST_CLOSE) &&
+         request->action < USERACTIONS_COUNT &&
+         request->board < BOARD_KINDS_COUNT;
+}
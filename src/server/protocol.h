@@ -0,0 +1,65 @@
+#ifndef TETRIS_SERVER_PROTOCOL
+#define TETRIS_SERVER_PROTOCOL
+
+/// @file protocol.h
+/// @brief Declaration of the messages of the game server. A connection is a
+/// session: the client opens a game with a seed, sends the user input and
+/// receives the state of the game. Every request is answered with the state
+/// after it, the server also pushes the state whenever the game changes on its
+/// own. The messages are fixed size in the host byte order, the server and
+/// its clients share the host over a Unix domain socket
+
+#include <stdint.h>
+
+#include "../game/tetris/context.h"
+
+#define SERVER_DEFAULT_SOCKET_PATH "/tmp/.tetris_server.sock"
+
+typedef enum {
+  SERVER_REQUEST_OPEN = 1,
+  SERVER_REQUEST_INPUT,
+  SERVER_REQUEST_CLOSE
+} server_request_kind_t;
+
+/// @brief kind is a server_request_kind_t, action and hold are the user input
+/// of an input request, seed and board set up the games of an open request,
+/// seed 0 for the current time, board is a board_kind_t. sequence is echoed in
+/// the state that answers the request
+typedef struct {
+  uint8_t kind;
+  uint8_t action;
+  uint8_t hold;
+  uint8_t board;
+  uint32_t sequence;
+  uint64_t seed;
+} server_request_t;
+
+/// @brief state is a tetris_state_t, sequence is the one of the last request
+/// applied, field holds the colours of the visible rows with the current
+/// figure, next_figure_id is UINT8_MAX before the first game, board is the
+/// board_kind_t of the game, a smaller board takes the bottom left corner of
+/// the field. A state with an unchanged generation may be skipped
+typedef struct {
+  uint8_t state;
+  uint8_t next_figure_id;
+  uint8_t pause;
+  uint8_t board;
+  uint32_t sequence;
+  int32_t score;
+  int32_t high_score;
+  int32_t level;
+  int32_t lines;
+  uint64_t generation;
+  uint8_t field[FIELD_VISIBLE_HEIGHT][FIELD_WIDTH];
+} server_state_t;
+
+_Static_assert(sizeof(server_request_t) == 16, "the request has padding");
+_Static_assert(sizeof(server_state_t) ==
+                   32 + FIELD_VISIBLE_HEIGHT * FIELD_WIDTH,
+               "the state has padding");
+
+void server_state_fill(server_state_t *, const tetris_context_t *,
+                       const uint32_t sequence);
+bool server_request_get_is_valid(const server_request_t *);
+
+#endif
@@ -0,0 +1,521 @@
+#define _POSIX_C_SOURCE 200809L
+// relying on the Linux epoll, the POSIX sockets, threads, pipe() and
+// setrlimit()
+#include "server.h"
+
+/// @file server.c
+/// @brief Implementation of the game server
+
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "../common/time_utils.h"
+#include "timer_heap.h"
+
+#define SERVER_LISTEN_TOKEN UINT64_MAX
+#define SERVER_STOP_TOKEN (UINT64_MAX - 1)
+#define SERVER_ACCEPT_BATCH 64
+// the intermediate FSM states a session passes without input
+#define SERVER_MAX_UPDATES 16
+
+/// @brief A connection and its game. tag tells the session from the previous
+/// ones of the same id in the epoll events, input holds a partly read
+/// request, out[0] is the state being written and out[1] the next one
+typedef struct {
+  int fd;
+  uint32_t tag;
+  tetris_context_t *context;
+  uint32_t sequence;
+  unsigned long sent_generation;
+  bool answer;
+  bool closing;
+  bool broken;
+  bool writing;
+  size_t input_size;
+  uint8_t input[sizeof(server_request_t)];
+  int out_count;
+  size_t out_sent;
+  server_state_t out[2];
+} server_session_t;
+
+/// @brief The sessions of a worker thread, sessions[id] is NULL for the ids
+/// in free_ids. The stats are written by the worker only
+typedef struct {
+  _Alignas(SERVER_CACHE_LINE) server_stats_t stats;
+  const server_config_t *config;
+  int listen_fd;
+  int epoll_fd;
+  uint32_t tag;
+  server_session_t **sessions;
+  int *free_ids;
+  int free_count;
+  timer_heap_t timers;
+  bool error;
+} server_worker_t;
+
+// the workers wait for the read end, server_stop() writes to the other one
+static int stop_pipe[2] = {-1, -1};
+static atomic_int stop_fd = -1;
+
+int server_listen(const char *path);
+bool server_worker_init(server_worker_t *worker,
+                        const server_config_t *config, const int listen_fd);
+void server_worker_destroy(server_worker_t *worker);
+void *server_worker_routine(void *arg);
+void server_worker_accept(server_worker_t *worker);
+void server_worker_handle(server_worker_t *worker, const uint64_t token,
+                          const uint32_t events);
+void server_worker_expire(server_worker_t *worker);
+void server_worker_settle(server_worker_t *worker, const int id);
+int server_session_read(server_worker_t *worker, server_session_t *session);
+bool server_session_apply(server_worker_t *worker, server_session_t *session,
+                          const server_request_t *request);
+void server_session_update(server_worker_t *worker, server_session_t *session,
+                           const int id);
+void server_session_queue(server_worker_t *worker, server_session_t *session);
+void server_session_flush(server_worker_t *worker, server_session_t *session,
+                          const uint64_t token);
+
+/// @brief serve the games on config->threads threads until server_stop()
+/// @param config the server config
+/// @param result where to save the merged stats of the workers
+/// @return true if the socket could not be listened on or on malloc error
+bool server_run(const server_config_t *config, server_stats_t *result) {
+  if (!config || !result || !config->socket_path || config->threads < 1 ||
+      config->max_sessions < 1) {
+    return true;
+  }
+  const int threads = config->threads;
+  const int listen_fd = server_listen(config->socket_path);
+  bool error = listen_fd < 0 || pipe(stop_pipe) != 0;
+  if (!error) atomic_store(&stop_fd, stop_pipe[1]);
+  server_worker_t *workers =
+      aligned_alloc(SERVER_CACHE_LINE, sizeof(server_worker_t) * threads);
+  pthread_t *handles = calloc(threads, sizeof(pthread_t));
+  error = error || !workers || !handles;
+  int ready = 0;
+  while (!error && ready != threads) {
+    error = server_worker_init(&workers[ready], config, listen_fd);
+    if (!error) ++ready;
+  }
+  // the first worker runs on the calling thread
+  int started = 1;
+  while (!error && started != threads) {
+    error = pthread_create(&handles[started], NULL, server_worker_routine,
+                           &workers[started]) != 0;
+    if (!error) ++started;
+  }
+  if (error) {
+    server_stop();
+  } else {
+    server_worker_routine(&workers[0]);
+  }
+  for (int i = 1; i < started; ++i) {
+    pthread_join(handles[i], NULL);
+  }
+  if (!error) memset(result, 0, sizeof(server_stats_t));
+  for (int i = 0; i < ready; ++i) {
+    error = error || workers[i].error;
+    if (!error) {
+      const server_stats_t *stats = &workers[i].stats;
+      result->sessions += stats->sessions;
+      result->rejected += stats->rejected;
+      result->requests += stats->requests;
+      result->states += stats->states;
+      result->coalesced += stats->coalesced;
+      result->dropped += stats->dropped;
+      stats_histogram_merge(&result->latency, &stats->latency);
+    }
+    server_worker_destroy(&workers[i]);
+  }
+  atomic_store(&stop_fd, -1);
+  for (int i = 0; i < 2; ++i) {
+    if (stop_pipe[i] >= 0) close(stop_pipe[i]);
+    stop_pipe[i] = -1;
+  }
+  if (listen_fd >= 0) {
+    close(listen_fd);
+    unlink(config->socket_path);
+  }
+  free(handles);
+  free(workers);
+  return error;
+}
+
+/// @brief make the workers finish, async-signal-safe
+void server_stop(void) {
+  const int fd = atomic_load(&stop_fd);
+  if (fd >= 0 && write(fd, "", 1) < 0) {
+    // the pipe is full, the workers are stopping anyway
+  }
+}
+
+/// @brief raise the limit of the open files to the hard one, every session
+/// takes a file
+/// @return the limit
+long server_raise_file_limit(void) {
+  struct rlimit limit;
+  long files = -1;
+  if (!getrlimit(RLIMIT_NOFILE, &limit)) {
+    limit.rlim_cur = limit.rlim_max;
+    setrlimit(RLIMIT_NOFILE, &limit);
+    getrlimit(RLIMIT_NOFILE, &limit);
+    files = (long)limit.rlim_cur;
+  }
+  return files;
+}
+
+/// @brief print the stats of a run
+/// @param out where to print
+/// @param stats the stats
+void server_stats_print(FILE *out, const server_stats_t *stats) {
+  fprintf(out, "sessions:   %ld accepted, %ld rejected, %ld dropped\n",
+          stats->sessions, stats->rejected, stats->dropped);
+  fprintf(out, "requests:   %ld\n", stats->requests);
+  fprintf(out, "states:     %ld written, %ld coalesced\n", stats->states,
+          stats->coalesced);
+  fprintf(out, "latency:    p50 %.1f us, p99 %.1f us, p99.9 %.1f us, ",
+          stats_histogram_get_percentile(&stats->latency, 50) / 1e3,
+          stats_histogram_get_percentile(&stats->latency, 99) / 1e3,
+          stats_histogram_get_percentile(&stats->latency, 99.9) / 1e3);
+  fprintf(out, "max %.1f us\n", stats->latency.max_ns / 1e3);
+}
+
+/// @brief listen on the Unix domain socket, replacing the file of a previous
+/// server
+/// @param path the socket file
+/// @return the non-blocking socket, -1 on error
+int server_listen(const char *path) {
+  struct sockaddr_un address;
+  memset(&address, 0, sizeof(address));
+  address.sun_family = AF_UNIX;
+  if (strlen(path) >= sizeof(address.sun_path)) return -1;
+  strcpy(address.sun_path, path);
+  int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (fd >= 0) {
+    unlink(path);
+    if (bind(fd, (struct sockaddr *)&address, sizeof(address)) != 0 ||
+        listen(fd, SERVER_BACKLOG) != 0 ||
+        fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK) != 0) {
+      close(fd);
+      fd = -1;
+    }
+  }
+  return fd;
+}
+
+/// @brief prepare a worker without sessions. The listening socket wakes one
+/// worker per connection
+/// @param worker where to save the worker
+/// @param config the server config
+/// @param listen_fd the listening socket
+/// @return true on error, the worker holds nothing then
+bool server_worker_init(server_worker_t *worker,
+                        const server_config_t *config, const int listen_fd) {
+  memset(worker, 0, sizeof(server_worker_t));
+  worker->config = config;
+  worker->listen_fd = listen_fd;
+  worker->epoll_fd = epoll_create1(0);
+  const int capacity = config->max_sessions;
+  worker->sessions = calloc(capacity, sizeof(server_session_t *));
+  worker->free_ids = malloc(sizeof(int) * capacity);
+  bool error = worker->epoll_fd < 0 || !worker->sessions ||
+               !worker->free_ids || timer_heap_init(&worker->timers, capacity);
+  for (int i = 0; !error && i != capacity; ++i) {
+    worker->free_ids[worker->free_count++] = capacity - 1 - i;
+  }
+  struct epoll_event event = {EPOLLIN | EPOLLEXCLUSIVE,
+                              {.u64 = SERVER_LISTEN_TOKEN}};
+  error = error || epoll_ctl(worker->epoll_fd, EPOLL_CTL_ADD, listen_fd,
+                             &event) != 0;
+  event.events = EPOLLIN;
+  event.data.u64 = SERVER_STOP_TOKEN;
+  error = error || epoll_ctl(worker->epoll_fd, EPOLL_CTL_ADD, stop_pipe[0],
+                             &event) != 0;
+  if (error) server_worker_destroy(worker);
+  return error;
+}
+
+/// @brief close the sessions of the worker and free it
+/// @param worker the worker
+void server_worker_destroy(server_worker_t *worker) {
+  for (int id = 0; worker->sessions && id != worker->config->max_sessions;
+       ++id) {
+    if (worker->sessions[id]) {
+      worker->sessions[id]->broken = true;
+      server_worker_settle(worker, id);
+    }
+  }
+  if (worker->epoll_fd >= 0) close(worker->epoll_fd);
+  worker->epoll_fd = -1;
+  free(worker->sessions);
+  free(worker->free_ids);
+  worker->sessions = NULL;
+  worker->free_ids = NULL;
+  if (worker->timers.entries) timer_heap_destroy(&worker->timers);
+}
+
+/// @brief serve the sessions of the worker until the server stops
+/// @param arg the worker
+/// @return NULL
+void *server_worker_routine(void *arg) {
+  server_worker_t *worker = arg;
+  struct epoll_event events[SERVER_MAX_EVENTS];
+  bool stopped = false;
+  while (!stopped && !worker->error) {
+    const long timeout_ms =
+        timer_heap_get_ms_to_first(&worker->timers, get_monotonic_ms());
+    const int count = epoll_wait(worker->epoll_fd, events, SERVER_MAX_EVENTS,
+                                 (int)timeout_ms);
+    worker->error = count < 0 && errno != EINTR;
+    for (int i = 0; i < count; ++i) {
+      const uint64_t token = events[i].data.u64;
+      if (token == SERVER_STOP_TOKEN) {
+        stopped = true;
+      } else if (token == SERVER_LISTEN_TOKEN) {
+        server_worker_accept(worker);
+      } else {
+        server_worker_handle(worker, token, events[i].events);
+      }
+    }
+    server_worker_expire(worker);
+  }
+  return NULL;
+}
+
+/// @brief accept the waiting connections as new sessions, those over the
+/// limit are closed
+/// @param worker the worker
+void server_worker_accept(server_worker_t *worker) {
+  for (int i = 0; i != SERVER_ACCEPT_BATCH; ++i) {
+    const int fd = accept(worker->listen_fd, NULL, NULL);
+    if (fd < 0) break;
+    server_session_t *session =
+        worker->free_count ? calloc(1, sizeof(server_session_t)) : NULL;
+    const int id = session ? worker->free_ids[worker->free_count - 1] : -1;
+    struct epoll_event event = {EPOLLIN, {0}};
+    if (session) {
+      session->fd = fd;
+      session->tag = ++worker->tag;
+      event.data.u64 = (uint64_t)session->tag << 32 | (uint32_t)id;
+    }
+    if (!session || fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK) ||
+        epoll_ctl(worker->epoll_fd, EPOLL_CTL_ADD, fd, &event)) {
+      free(session);
+      close(fd);
+      ++worker->stats.rejected;
+    } else {
+      --worker->free_count;
+      worker->sessions[id] = session;
+      ++worker->stats.sessions;
+    }
+  }
+}
+
+/// @brief handle the epoll events of a session
+/// @param worker the worker
+/// @param token the session id and its tag
+/// @param events the events
+void server_worker_handle(server_worker_t *worker, const uint64_t token,
+                          const uint32_t events) {
+  const int id = (int)(uint32_t)token;
+  server_session_t *session = worker->sessions[id];
+  // the session of the event has been closed by a previous event
+  if (!session || session->tag != (uint32_t)(token >> 32)) return;
+  if (events & (EPOLLIN | EPOLLHUP | EPOLLERR)) {
+    const uint64_t start_ns = get_monotonic_ns();
+    const int requests = server_session_read(worker, session);
+    if (!session->broken) server_session_update(worker, session, id);
+    if (requests) {
+      stats_histogram_record(&worker->stats.latency,
+                             get_monotonic_ns() - start_ns);
+    }
+  }
+  if (!session->broken && (events & EPOLLOUT)) {
+    server_session_flush(worker, session, token);
+  }
+  server_worker_settle(worker, id);
+}
+
+/// @brief update the sessions which deadlines have passed
+/// @param worker the worker
+void server_worker_expire(server_worker_t *worker) {
+  const uint64_t now_ms = get_monotonic_ms();
+  int id = -1;
+  while ((id = timer_heap_pop_due(&worker->timers, now_ms)) >= 0) {
+    server_session_update(worker, worker->sessions[id], id);
+    server_worker_settle(worker, id);
+  }
+}
+
+/// @brief close the session if it is broken or is closing and has nothing to
+/// write
+/// @param worker the worker
+/// @param id the session
+void server_worker_settle(server_worker_t *worker, const int id) {
+  server_session_t *session = worker->sessions[id];
+  if (!session->broken && !(session->closing && !session->out_count)) return;
+  timer_heap_remove(&worker->timers, id);
+  close(session->fd);
+  tetris_context_destroy(session->context);
+  free(session);
+  worker->sessions[id] = NULL;
+  worker->free_ids[worker->free_count++] = id;
+}
+
+/// @brief read a batch of requests and apply them. A session with a
+/// malformed request is broken
+/// @param worker the worker
+/// @param session the session
+/// @return number of the requests applied
+int server_session_read(server_worker_t *worker, server_session_t *session) {
+  uint8_t buffer[SERVER_READ_BATCH * sizeof(server_request_t)];
+  memcpy(buffer, session->input, session->input_size);
+  const ssize_t size = read(session->fd, buffer + session->input_size,
+                            sizeof(buffer) - session->input_size);
+  if (size <= 0) {
+    session->broken = size == 0 || (errno != EAGAIN && errno != EINTR);
+    return 0;
+  }
+  const size_t total = session->input_size + (size_t)size;
+  const size_t count = total / sizeof(server_request_t);
+  bool valid = true;
+  for (size_t i = 0; valid && i != count; ++i) {
+    server_request_t request;
+    memcpy(&request, buffer + i * sizeof(server_request_t),
+           sizeof(server_request_t));
+    valid = server_session_apply(worker, session, &request);
+  }
+  session->input_size = total - count * sizeof(server_request_t);
+  memcpy(session->input, buffer + count * sizeof(server_request_t),
+         session->input_size);
+  if (!valid) {
+    session->broken = true;
+    ++worker->stats.dropped;
+  }
+  session->answer = valid && count;
+  return valid ? (int)count : 0;
+}
+
+/// @brief apply a request to the session, the input is applied on the next
+/// update
+/// @param worker the worker
+/// @param session the session
+/// @param request the request
+/// @return true if the request is valid
+bool server_session_apply(server_worker_t *worker, server_session_t *session,
+                          const server_request_t *request) {
+  bool valid = server_request_get_is_valid(request);
+  if (valid && request->kind == SERVER_REQUEST_OPEN && !session->context) {
+    session->context = tetris_context_create();
+    tetris_context_set_leaderboard(session->context,
+                                   worker->config->leaderboard);
+    valid = session->context != NULL;
+  }
+  if (valid && request->kind == SERVER_REQUEST_OPEN) {
+    const tetris_setup_t setup = {
+        request->seed ? request->seed : (uint64_t)time(NULL),
+        RANDOMIZER_UNIFORM, (board_kind_t)request->board};
+    tetris_context_configure(session->context, &setup);
+  } else if (valid && request->kind == SERVER_REQUEST_INPUT) {
+    valid = session->context != NULL;
+    tetris_context_user_input(session->context, (UserAction_t)request->action,
+                              request->hold);
+  } else if (valid && request->kind == SERVER_REQUEST_CLOSE) {
+    session->closing = true;
+  }
+  session->sequence = request->sequence;
+  ++worker->stats.requests;
+  return valid;
+}
+
+/// @brief update the game of the session through the intermediate states,
+/// queue the state if it has changed or a request waits for it and set the
+/// next deadline of the session
+/// @param worker the worker
+/// @param session the session
+/// @param id id of the session
+void server_session_update(server_worker_t *worker, server_session_t *session,
+                           const int id) {
+  tetris_context_t *context = session->context;
+  long ms = -1;
+  if (context) {
+    int updates = 0;
+    do {
+      tetris_context_update_current_state(context);
+      ms = tetris_context_get_ms_to_next_update(context);
+    } while (!ms && ++updates != SERVER_MAX_UPDATES);
+    if (tetris_context_get_game_has_finished(context)) session->closing = true;
+  }
+  if (session->answer ||
+      (context && context->core.game.generation != session->sent_generation)) {
+    server_session_queue(worker, session);
+  }
+  if (ms < 0 || session->closing) {
+    timer_heap_remove(&worker->timers, id);
+  } else {
+    timer_heap_set(&worker->timers, id, get_monotonic_ms() + (ms ? ms : 1));
+  }
+  const uint64_t token = (uint64_t)session->tag << 32 | (uint32_t)id;
+  server_session_flush(worker, session, token);
+}
+
+/// @brief put the state of the session to its output, in place of the next
+/// state if there is one
+/// @param worker the worker
+/// @param session the session
+void server_session_queue(server_worker_t *worker, server_session_t *session) {
+  if (session->out_count == 2) ++worker->stats.coalesced;
+  const int slot = session->out_count == 2 ? 1 : session->out_count++;
+  server_state_t *state = &session->out[slot];
+  if (session->context) {
+    server_state_fill(state, session->context, session->sequence);
+    session->sent_generation = session->context->core.game.generation;
+  } else {
+    memset(state, 0, sizeof(server_state_t));
+    state->next_figure_id = UINT8_MAX;
+    state->sequence = session->sequence;
+  }
+  session->answer = false;
+}
+
+/// @brief write the output of the session until the socket is full, then
+/// wait for it to be writable
+/// @param worker the worker
+/// @param session the session
+/// @param token the epoll token of the session
+void server_session_flush(server_worker_t *worker, server_session_t *session,
+                          const uint64_t token) {
+  bool full = false;
+  while (!session->broken && !full && session->out_count) {
+    const ssize_t size =
+        send(session->fd, (uint8_t *)&session->out[0] + session->out_sent,
+             sizeof(server_state_t) - session->out_sent, MSG_NOSIGNAL);
+    full = size < 0 && (errno == EAGAIN || errno == EINTR);
+    session->broken = size < 0 && !full;
+    if (size > 0) session->out_sent += (size_t)size;
+    if (session->out_sent == sizeof(server_state_t)) {
+      session->out[0] = session->out[1];
+      --session->out_count;
+      session->out_sent = 0;
+      ++worker->stats.states;
+    }
+  }
+  if (!session->broken && full != session->writing) {
+    struct epoll_event event = {EPOLLIN | (full ? EPOLLOUT : 0),
+                                {.u64 = token}};
+    session->broken =
+        epoll_ctl(worker->epoll_fd, EPOLL_CTL_MOD, session->fd, &event) != 0;
+    session->writing = full;
+  }
+}
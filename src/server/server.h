@@ -0,0 +1,57 @@
+#ifndef TETRIS_SERVER
+#define TETRIS_SERVER
+
+/// @file server.h
+/// @brief Declaration of the game server. Every worker thread runs its own
+/// epoll loop over its own sessions, a session is a connection with its own
+/// game context, so the workers share nothing but the listening socket that
+/// wakes one worker per connection. A session is updated when its requests
+/// come and when its autoshift deadline passes, the deadlines of a worker are
+/// kept in a heap, so an idle session costs nothing. A worker reads a bounded
+/// batch of requests from a session per wake up, applies them at once and
+/// answers with one state, so a busy session does not delay the others. The
+/// output of a session holds the state being written and the next one, a
+/// newer state replaces the next one, so a slow client takes no more memory
+/// and gets the latest state
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "../game/tetris/stats.h"
+#include "protocol.h"
+
+#define SERVER_CACHE_LINE 64
+#define SERVER_DEFAULT_MAX_SESSIONS 65536
+#define SERVER_READ_BATCH 32
+#define SERVER_MAX_EVENTS 256
+#define SERVER_BACKLOG 4096
+
+/// @brief max_sessions is the limit of the sessions of a worker, the finished
+/// games of all the sessions are submitted to the leaderboard if there is one
+typedef struct {
+  const char *socket_path;
+  int threads;
+  int max_sessions;
+  leaderboard_t *leaderboard;
+} server_config_t;
+
+/// @brief sessions counts the accepted connections, rejected the ones over
+/// max_sessions, coalesced the states replaced before they were written and
+/// dropped the sessions closed on a malformed request. latency is the time
+/// from the read of a batch of requests to the write of its state
+typedef struct {
+  long sessions;
+  long rejected;
+  long requests;
+  long states;
+  long coalesced;
+  long dropped;
+  stats_histogram_t latency;
+} server_stats_t;
+
+bool server_run(const server_config_t *, server_stats_t *);
+void server_stop(void);
+void server_stats_print(FILE *, const server_stats_t *);
+long server_raise_file_limit(void);
+
+#endif
@@ -0,0 +1,151 @@
+#include "timer_heap.h"
+
+/// @file timer_heap.c
+/// @brief Implementation of the deadlines of many sessions
+
+#include <stdlib.h>
+
+void timer_heap_swap(timer_heap_t *heap, const int i, const int j);
+void timer_heap_sift_up(timer_heap_t *heap, int i);
+void timer_heap_sift_down(timer_heap_t *heap, int i);
+
+/// @brief allocate an empty heap
+/// @param heap where to save the heap
+/// @param capacity the session ids are below it
+/// @return true on malloc error
+bool timer_heap_init(timer_heap_t *heap, const int capacity) {
+  heap->entries = malloc(sizeof(timer_heap_entry_t) * capacity);
+  heap->positions = malloc(sizeof(int) * capacity);
+  heap->count = 0;
+  heap->capacity = capacity;
+  const bool error = !heap->entries || !heap->positions;
+  if (error) {
+    timer_heap_destroy(heap);
+  } else {
+    for (int id = 0; id < capacity; ++id) heap->positions[id] = -1;
+  }
+  return error;
+}
+
+/// @brief free the heap
+/// @param heap the heap
+void timer_heap_destroy(timer_heap_t *heap) {
+  free(heap->entries);
+  free(heap->positions);
+  heap->entries = NULL;
+  heap->positions = NULL;
+  heap->count = 0;
+}
+
+/// @brief set the deadline of a session, replacing the one it has
+/// @param heap the heap
+/// @param id the session
+/// @param deadline_ms the deadline
+void timer_heap_set(timer_heap_t *heap, const int id,
+                    const uint64_t deadline_ms) {
+  int i = heap->positions[id];
+  if (i < 0) {
+    i = heap->count++;
+    heap->entries[i].id = id;
+    heap->positions[id] = i;
+  }
+  const uint64_t previous_ms = heap->entries[i].deadline_ms;
+  heap->entries[i].deadline_ms = deadline_ms;
+  if (i == heap->count - 1 || deadline_ms < previous_ms) {
+    timer_heap_sift_up(heap, i);
+  } else {
+    timer_heap_sift_down(heap, i);
+  }
+}
+
+/// @brief remove the deadline of a session if it has one
+/// @param heap the heap
+/// @param id the session
+void timer_heap_remove(timer_heap_t *heap, const int id) {
+  const int i = heap->positions[id];
+  if (i < 0) return;
+  const int last = --heap->count;
+  if (i != last) {
+    timer_heap_swap(heap, i, last);
+    const int moved_id = heap->entries[i].id;
+    timer_heap_sift_up(heap, i);
+    timer_heap_sift_down(heap, heap->positions[moved_id]);
+  }
+  heap->positions[id] = -1;
+}
+
+/// @brief get how long to wait for the first deadline
+/// @param heap the heap
+/// @param now_ms the current time
+/// @return milliseconds to the first deadline, 0 if it has passed, -1 if
+/// there are no deadlines
+long timer_heap_get_ms_to_first(const timer_heap_t *heap,
+                                const uint64_t now_ms) {
+  long ms = -1;
+  if (heap->count) {
+    const uint64_t deadline_ms = heap->entries[0].deadline_ms;
+    ms = deadline_ms > now_ms ? (long)(deadline_ms - now_ms) : 0;
+  }
+  return ms;
+}
+
+/// @brief take the first deadline if it has passed
+/// @param heap the heap
+/// @param now_ms the current time
+/// @return the session of the deadline, -1 if no deadline has passed
+int timer_heap_pop_due(timer_heap_t *heap, const uint64_t now_ms) {
+  int id = -1;
+  if (heap->count && heap->entries[0].deadline_ms <= now_ms) {
+    id = heap->entries[0].id;
+    timer_heap_remove(heap, id);
+  }
+  return id;
+}
+
+/// @brief swap two deadlines and their positions
+/// @param heap the heap
+/// @param i index of the first deadline
+/// @param j index of the second deadline
+void timer_heap_swap(timer_heap_t *heap, const int i, const int j) {
+  const timer_heap_entry_t swapped = heap->entries[i];
+  heap->entries[i] = heap->entries[j];
+  heap->entries[j] = swapped;
+  heap->positions[heap->entries[i].id] = i;
+  heap->positions[heap->entries[j].id] = j;
+}
+
+/// @brief move the deadline up while it is earlier than its parent
+/// @param heap the heap
+/// @param i index of the deadline
+void timer_heap_sift_up(timer_heap_t *heap, int i) {
+  while (i > 0 && heap->entries[i].deadline_ms <
+                      heap->entries[(i - 1) / 2].deadline_ms) {
+    timer_heap_swap(heap, i, (i - 1) / 2);
+    i = (i - 1) / 2;
+  }
+}
+
+/// @brief move the deadline down while a child is earlier
+/// @param heap the heap
+/// @param i index of the deadline
+void timer_heap_sift_down(timer_heap_t *heap, int i) {
+  bool moved = true;
+  while (moved) {
+    int earliest = i;
+    const int left = 2 * i + 1;
+    const int right = left + 1;
+    if (left < heap->count && heap->entries[left].deadline_ms <
+                                  heap->entries[earliest].deadline_ms) {
+      earliest = left;
+    }
+    if (right < heap->count && heap->entries[right].deadline_ms <
+                                   heap->entries[earliest].deadline_ms) {
+      earliest = right;
+    }
+    moved = earliest != i;
+    if (moved) {
+      timer_heap_swap(heap, i, earliest);
+      i = earliest;
+    }
+  }
+}
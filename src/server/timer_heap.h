@@ -0,0 +1,34 @@
+#ifndef TETRIS_SERVER_TIMER_HEAP
+#define TETRIS_SERVER_TIMER_HEAP
+
+/// @file timer_heap.h
+/// @brief Declaration of the deadlines of many sessions. The deadlines are a
+/// binary min-heap indexed by the session id, so the next one is found in
+/// O(1) and a deadline is set, moved or removed in O(log n) without scanning
+/// the sessions
+
+#include <stdbool.h>
+#include <stdint.h>
+
+typedef struct {
+  uint64_t deadline_ms;
+  int id;
+} timer_heap_entry_t;
+
+/// @brief positions[id] is the index of the deadline of the session id in
+/// entries, -1 if it has none
+typedef struct {
+  timer_heap_entry_t *entries;
+  int *positions;
+  int count;
+  int capacity;
+} timer_heap_t;
+
+bool timer_heap_init(timer_heap_t *, const int capacity);
+void timer_heap_destroy(timer_heap_t *);
+void timer_heap_set(timer_heap_t *, const int id, const uint64_t deadline_ms);
+void timer_heap_remove(timer_heap_t *, const int id);
+long timer_heap_get_ms_to_first(const timer_heap_t *, const uint64_t now_ms);
+int timer_heap_pop_due(timer_heap_t *, const uint64_t now_ms);
+
+#endif
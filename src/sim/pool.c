@@ -0,0 +1,217 @@
+#define _POSIX_C_SOURCE 200809L
+// relying on the POSIX threads, sysconf() and clock_gettime()
+#include "pool.h"
+
+/// @file pool.c
+/// @brief Implementation of the simulation pool
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+/// @brief Part of the seed range owned by a worker. Chunks are claimed by
+/// advancing next, by the owner and the thieves alike
+typedef struct {
+  _Alignas(SIM_CACHE_LINE) atomic_long next;
+  long end;
+} sim_pool_range_t;
+
+/// @brief Result slot of a worker, written by the worker only
+typedef struct {
+  _Alignas(SIM_CACHE_LINE) sim_stats_t stats;
+  fsm_stats_t fsm_stats;
+  long stolen_chunks;
+  bool error;
+} sim_pool_slot_t;
+
+typedef struct {
+  const sim_pool_config_t *config;
+  sim_pool_range_t *ranges;
+  sim_pool_slot_t *slots;
+} sim_pool_t;
+
+typedef struct {
+  sim_pool_t *pool;
+  int id;
+} sim_pool_worker_t;
+
+/// @brief get the number of the online processors
+/// @return the number, at least 1
+int sim_pool_get_cpu_count(void) {
+  const long count = sysconf(_SC_NPROCESSORS_ONLN);
+  return count > 0 ? (int)count : 1;
+}
+
+/// @brief open the replay file of the worker and set it as the recorder of
+/// the context
+/// @param pool the pool
+/// @param id worker id
+/// @param context context of the worker
+/// @param file where to save the open file
+/// @return the writer, NULL on error
+replay_writer_t *sim_pool_open_replay(const sim_pool_t *pool, const int id,
+                                      tetris_context_t *context, FILE **file) {
+  char path[4096];
+  if (pool->config->threads == 1) {
+    snprintf(path, sizeof(path), "%s", pool->config->replay_path);
+  } else {
+    snprintf(path, sizeof(path), "%s.%d", pool->config->replay_path, id);
+  }
+  *file = fopen(path, "wb");
+  replay_writer_t *writer = replay_writer_create(*file);
+  if (!writer && *file) {
+    fclose(*file);
+    *file = NULL;
+  }
+  tetris_context_set_recorder(context, writer);
+  return writer;
+}
+
+/// @brief play the chunks of the range until it is exhausted
+/// @param pool the pool
+/// @param context context to play in
+/// @param range the range to claim chunks from
+/// @param slot where to account the games
+/// @return number of the chunks played
+long sim_pool_drain_range(const sim_pool_t *pool, tetris_context_t *context,
+                          sim_pool_range_t *range, sim_pool_slot_t *slot) {
+  const sim_pool_config_t *config = pool->config;
+  long chunks = 0;
+  long first = 0;
+  while ((first = atomic_fetch_add_explicit(&range->next, config->chunk_size,
+                                            memory_order_relaxed)) <
+         range->end) {
+    long last = first + config->chunk_size;
+    if (last > range->end) last = range->end;
+    for (long game = first; game < last; ++game) {
+      const board_kind_t board =
+          config->mixed_boards ? (board_kind_t)(game % BOARD_KINDS_COUNT)
+                               : config->board;
+      const tetris_setup_t setup = {config->first_seed + game,
+                                    config->randomizer, board};
+      sim_game_result_t result = {0};
+      if (!sim_run_game(context, &setup, &config->policy, &result)) {
+        sim_stats_add(&slot->stats, &result);
+      }
+    }
+    ++chunks;
+  }
+  return chunks;
+}
+
+/// @brief worker thread routine: drain the own range, then the others
+/// @param arg sim_pool_worker_t of the worker
+/// @return NULL
+void *sim_pool_worker(void *arg) {
+  const sim_pool_worker_t *worker = arg;
+  sim_pool_t *pool = worker->pool;
+  sim_pool_slot_t *slot = &pool->slots[worker->id];
+  tetris_context_t *context = tetris_context_create();
+  if (!context) {
+    slot->error = true;
+    return NULL;
+  }
+  if (pool->config->fsm_stats) {
+    tetris_context_set_stats(context, &slot->fsm_stats);
+  }
+  tetris_context_set_leaderboard(context, pool->config->leaderboard);
+  if (!worker->id) {
+    tetris_context_set_spectators(context, pool->config->spectators);
+  }
+  FILE *replay_file = NULL;
+  replay_writer_t *writer = NULL;
+  if (pool->config->replay_path) {
+    writer = sim_pool_open_replay(pool, worker->id, context, &replay_file);
+    slot->error = !writer;
+  }
+  const int threads = pool->config->threads;
+  for (int i = 0; !slot->error && i != threads; ++i) {
+    const int victim = (worker->id + i) % threads;
+    const long chunks =
+        sim_pool_drain_range(pool, context, &pool->ranges[victim], slot);
+    if (victim != worker->id) slot->stolen_chunks += chunks;
+  }
+  if (writer) {
+    slot->error = replay_writer_destroy(writer) || slot->error;
+    slot->error = fclose(replay_file) != 0 || slot->error;
+  }
+  tetris_context_destroy(context);
+  return NULL;
+}
+
+/// @brief split the games between the workers evenly
+/// @param pool the pool
+void sim_pool_split_ranges(sim_pool_t *pool) {
+  const sim_pool_config_t *config = pool->config;
+  const long share = config->games / config->threads;
+  const long rest = config->games % config->threads;
+  long begin = 0;
+  for (int i = 0; i != config->threads; ++i) {
+    const long end = begin + share + (i < rest ? 1 : 0);
+    atomic_init(&pool->ranges[i].next, begin);
+    pool->ranges[i].end = end;
+    begin = end;
+  }
+}
+
+/// @brief play the games of the config on config->threads threads
+/// @param config the pool config
+/// @param result where to save the merged result
+/// @return true on error, the result is not valid then
+bool sim_pool_run(const sim_pool_config_t *config, sim_pool_result_t *result) {
+  if (!config || !result || config->threads < 1 || config->games < 0 ||
+      config->chunk_size < 1)
+    return true;
+  const int threads = config->threads;
+  sim_pool_t pool = {config, NULL, NULL};
+  pool.ranges =
+      aligned_alloc(SIM_CACHE_LINE, sizeof(sim_pool_range_t) * threads);
+  pool.slots = aligned_alloc(SIM_CACHE_LINE, sizeof(sim_pool_slot_t) * threads);
+  sim_pool_worker_t *workers = calloc(threads, sizeof(sim_pool_worker_t));
+  pthread_t *handles = calloc(threads, sizeof(pthread_t));
+  bool error = !pool.ranges || !pool.slots || !workers || !handles;
+  int started = 0;
+  struct timespec start = {0};
+  struct timespec finish = {0};
+  if (!error) {
+    sim_pool_split_ranges(&pool);
+    for (int i = 0; i != threads; ++i) {
+      memset(&pool.slots[i], 0, sizeof(sim_pool_slot_t));
+      sim_stats_init(&pool.slots[i].stats);
+      workers[i].pool = &pool;
+      workers[i].id = i;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (; !error && started != threads; ++started) {
+      error = pthread_create(&handles[started], NULL, sim_pool_worker,
+                             &workers[started]) != 0;
+    }
+    if (error) --started;
+  }
+  for (int i = 0; i < started; ++i) {
+    pthread_join(handles[i], NULL);
+  }
+  clock_gettime(CLOCK_MONOTONIC, &finish);
+  if (!error) {
+    sim_stats_init(&result->stats);
+    fsm_stats_reset(&result->fsm_stats);
+    result->stolen_chunks = 0;
+    for (int i = 0; i != threads; ++i) {
+      error = error || pool.slots[i].error;
+      sim_stats_merge(&result->stats, &pool.slots[i].stats);
+      fsm_stats_merge(&result->fsm_stats, &pool.slots[i].fsm_stats);
+      result->stolen_chunks += pool.slots[i].stolen_chunks;
+    }
+    result->seconds = (finish.tv_sec - start.tv_sec) +
+                      (finish.tv_nsec - start.tv_nsec) / 1e9;
+  }
+  free(handles);
+  free(workers);
+  free(pool.slots);
+  free(pool.ranges);
+  return error;
+}
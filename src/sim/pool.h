@@ -0,0 +1,48 @@
+#ifndef TETRIS_SIM_POOL
+#define TETRIS_SIM_POOL
+
+/// @file pool.h
+/// @brief Declaration of the simulation pool. The seed range is split between
+/// worker threads, every worker plays its part with its own game context and
+/// steals the chunks of the others when it is done. With a replay_path every
+/// worker records its games, to replay_path itself with one worker and to
+/// replay_path.<worker> with more. With fsm_stats every worker accounts the
+/// FSM of its context to its own statistics, merged into the result. With a
+/// leaderboard every finished game is submitted to it. With spectators the
+/// games of the first worker are published to them. With mixed_boards game i
+/// is played on the board kind i % BOARD_KINDS_COUNT
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "sim.h"
+
+#define SIM_CACHE_LINE 64
+#define SIM_POOL_DEFAULT_CHUNK 64
+
+typedef struct {
+  int threads;
+  uint64_t first_seed;
+  long games;
+  long chunk_size;
+  randomizer_kind_t randomizer;
+  board_kind_t board;
+  bool mixed_boards;
+  sim_policy_t policy;
+  const char *replay_path;
+  bool fsm_stats;
+  leaderboard_t *leaderboard;
+  spectator_hub_t *spectators;
+} sim_pool_config_t;
+
+typedef struct {
+  sim_stats_t stats;
+  double seconds;
+  long stolen_chunks;
+  fsm_stats_t fsm_stats;
+} sim_pool_result_t;
+
+bool sim_pool_run(const sim_pool_config_t *, sim_pool_result_t *);
+int sim_pool_get_cpu_count(void);
+
+#endif
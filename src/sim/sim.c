@@ -0,0 +1,230 @@
+#include "sim.h"
+
+/// @file sim.c
+/// @brief Implementation of the headless game runner
+
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+
+/// @brief translate a script character to the fsm signal
+/// @param move the character
+/// @return fsm signal, NO_INPUT for unknown characters
+fsm_input_t sim_get_script_signal(const char move) {
+  fsm_input_t signal = NO_INPUT;
+  switch (move) {
+    case 'L':
+      signal = MOVE_LEFT;
+      break;
+    case 'R':
+      signal = MOVE_RIGHT;
+      break;
+    case 'A':
+      signal = ROTATE_BTN;
+      break;
+    case 'D':
+      signal = MOVE_DOWN;
+      break;
+    case 'G':
+      signal = AUTOSHIFT_SIG;
+      break;
+    default:
+      break;
+  }
+  return signal;
+}
+
+/// @brief check that a script is made of the known moves and has an
+/// autoshift, the only move that locks the figures
+/// @param script the script
+/// @return true if the script can finish a game
+bool sim_script_get_is_valid(const char *script) {
+  bool valid = script && strchr(script, 'G');
+  for (const char *move = script; valid && *move; ++move) {
+    valid = sim_get_script_signal(*move) != NO_INPUT;
+  }
+  return valid;
+}
+
+/// @brief choose the next move of the policy
+/// @param policy the policy
+/// @param random policy generator
+/// @param step number of the move in the game
+/// @return fsm signal to apply
+fsm_input_t sim_get_policy_signal(const sim_policy_t *policy,
+                                  xoshiro256_t *random, const long step) {
+  const fsm_input_t moves[] = {MOVE_LEFT, MOVE_RIGHT, ROTATE_BTN, MOVE_DOWN};
+  fsm_input_t signal = AUTOSHIFT_SIG;
+  if (policy->kind == SIM_POLICY_SCRIPTED && policy->script &&
+      policy->script[0]) {
+    const size_t length = strlen(policy->script);
+    signal = sim_get_script_signal(policy->script[step % length]);
+  } else {
+    const uint64_t value = xoshiro_next(random);
+    const int chance = policy->gravity_chance > 0 ? policy->gravity_chance : 1;
+    if (value % chance) {
+      signal = moves[(value >> 32) % 4];
+    }
+  }
+  return signal;
+}
+
+/// @brief play a complete game. The context must be in the START or GAMEOVER
+/// state, it is left in the GAMEOVER state
+/// @param context the context to play in
+/// @param setup game seed and randomizer
+/// @param policy the policy to choose moves with
+/// @param result where to save the game result
+/// @return true if the game could not be started
+bool sim_run_game(tetris_context_t *context, const tetris_setup_t *setup,
+                  const sim_policy_t *policy, sim_game_result_t *result) {
+  if (!context || !setup || !policy || !result) return true;
+  if (context->core.state != START && context->core.state != GAMEOVER) {
+    return true;
+  }
+  // the policy generator must not repeat the figures one
+  xoshiro256_t random;
+  xoshiro_seed(&random, ~setup->seed);
+  tetris_context_configure(context, setup);
+  game_clock_t clock = {0};
+  game_clock_init(&clock, GAME_CLOCK_MANUAL, 1);
+  tetris_context_set_clock(context, &clock);
+  const int max_pieces = policy->max_pieces > 0 ? policy->max_pieces : INT_MAX;
+  autoplay_t autoplay;
+  autoplay_init(&autoplay, autoplay_evaluate_heuristic, policy->weights);
+  search_t *search = NULL;
+  if (policy->kind == SIM_POLICY_AUTOPLAY && policy->search) {
+    search = search_create(policy->search);
+    if (!search) return true;
+    autoplay_set_search(&autoplay, search);
+  }
+  int pieces = 0;
+  long step = 0;
+  long piece_steps = 0;
+  tetris_context_apply_signal(context, START_BTN);
+  while (context->core.state != GAMEOVER) {
+    fsm_input_t signal = NO_INPUT;
+    if (context->core.state == SPAWNING) {
+      if (pieces == max_pieces) break;
+      ++pieces;
+      piece_steps = 0;
+    } else if (context->core.state == IDLE &&
+               ++piece_steps > SIM_MAX_STEPS_PER_PIECE) {
+      // a policy that never locks the figure still finishes the game
+      signal = AUTOSHIFT_SIG;
+    } else if (context->core.state == IDLE) {
+      if (policy->frame_ms > 0) {
+        tetris_context_advance_clock_ms(context, policy->frame_ms);
+      }
+      if (policy->frame_ms > 0 &&
+          tetris_context_get_is_time_to_autoshift(context)) {
+        signal = AUTOSHIFT_SIG;
+      } else if (policy->kind == SIM_POLICY_AUTOPLAY) {
+        signal = autoplay_get_signal(&autoplay, &context->core.game);
+        // a figure without placements is locked where it is
+        if (signal == NO_INPUT) signal = AUTOSHIFT_SIG;
+      } else {
+        signal = sim_get_policy_signal(policy, &random, step++);
+      }
+    }
+    tetris_context_apply_signal(context, signal);
+    if (fsm_is_waiting_for_input(context->core.state)) {
+      tetris_context_publish(context);
+    }
+  }
+  // a game stopped at max_pieces is finished as if it was over
+  if (context->core.state != GAMEOVER) {
+    replay_writer_record_state(context->recorder,
+                               game_clock_get_ms(&context->core.clock),
+                               GAMEOVER, &context->core.game);
+    tetris_context_submit_score(context);
+  }
+  context->core.state = GAMEOVER;
+  result->score = context->core.game.game.score;
+  result->pieces = pieces;
+  result->nodes = search ? search->stats.nodes : 0;
+  search_destroy(search);
+  return false;
+}
+
+/// @brief prepare empty statistics
+/// @param stats the statistics
+void sim_stats_init(sim_stats_t *stats) {
+  memset(stats, 0, sizeof(sim_stats_t));
+  stats->score_min = INT_MAX;
+  stats->score_max = INT_MIN;
+}
+
+/// @brief account a game in the statistics
+/// @param stats the statistics
+/// @param result the game result
+void sim_stats_add(sim_stats_t *stats, const sim_game_result_t *result) {
+  ++stats->games;
+  stats->pieces += result->pieces;
+  stats->nodes += result->nodes;
+  stats->score_sum += result->score;
+  if (result->score < stats->score_min) stats->score_min = result->score;
+  if (result->score > stats->score_max) stats->score_max = result->score;
+  int bucket = result->score / SIM_SCORE_BUCKET_WIDTH;
+  if (bucket < 0) bucket = 0;
+  if (bucket >= SIM_SCORE_BUCKETS) bucket = SIM_SCORE_BUCKETS - 1;
+  ++stats->score_histogram[bucket];
+}
+
+/// @brief add the statistics of other games
+/// @param stats the statistics to add to
+/// @param other the statistics to add
+void sim_stats_merge(sim_stats_t *stats, const sim_stats_t *other) {
+  stats->games += other->games;
+  stats->pieces += other->pieces;
+  stats->nodes += other->nodes;
+  stats->score_sum += other->score_sum;
+  if (other->score_min < stats->score_min) stats->score_min = other->score_min;
+  if (other->score_max > stats->score_max) stats->score_max = other->score_max;
+  for (int i = 0; i != SIM_SCORE_BUCKETS; ++i) {
+    stats->score_histogram[i] += other->score_histogram[i];
+  }
+}
+
+/// @brief get the score below which the given percent of the games are. The
+/// value is accurate up to SIM_SCORE_BUCKET_WIDTH
+/// @param stats the statistics
+/// @param percent the percent, 0 to 100
+/// @return lower bound of the score bucket
+int sim_stats_get_score_percentile(const sim_stats_t *stats,
+                                   const double percent) {
+  if (!stats->games) return 0;
+  long rank = (long)(stats->games * percent / 100.0);
+  if (rank >= stats->games) rank = stats->games - 1;
+  int bucket = 0;
+  long seen = stats->score_histogram[0];
+  while (seen <= rank && bucket < SIM_SCORE_BUCKETS - 1) {
+    seen += stats->score_histogram[++bucket];
+  }
+  return bucket * SIM_SCORE_BUCKET_WIDTH;
+}
+
+/// @brief print the throughput and the score distribution
+/// @param out where to print
+/// @param stats the statistics
+/// @param seconds wall time the games took
+void sim_stats_print(FILE *out, const sim_stats_t *stats,
+                     const double seconds) {
+  const double safe_seconds = seconds > 0 ? seconds : 1e-9;
+  fprintf(out, "games:      %ld\n", stats->games);
+  fprintf(out, "pieces:     %ld\n", stats->pieces);
+  fprintf(out, "time:       %.3f s\n", seconds);
+  fprintf(out, "games/sec:  %.1f\n", stats->games / safe_seconds);
+  fprintf(out, "pieces/sec: %.1f\n", stats->pieces / safe_seconds);
+  if (stats->nodes) {
+    fprintf(out, "nodes/sec:  %.1f\n", stats->nodes / safe_seconds);
+  }
+  if (!stats->games) return;
+  fprintf(out, "score:      min %d, mean %.1f, max %d\n", stats->score_min,
+          (double)stats->score_sum / stats->games, stats->score_max);
+  fprintf(out, "score:      p50 %d, p90 %d, p99 %d, p99.9 %d\n",
+          sim_stats_get_score_percentile(stats, 50),
+          sim_stats_get_score_percentile(stats, 90),
+          sim_stats_get_score_percentile(stats, 99),
+          sim_stats_get_score_percentile(stats, 99.9));
+}
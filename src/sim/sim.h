@@ -0,0 +1,74 @@
+#ifndef TETRIS_SIM
+#define TETRIS_SIM
+
+/// @file sim.h
+/// @brief Declaration of the headless game runner. Games are driven through
+/// the FSM directly, the autoshift is one of the policy moves or comes from
+/// the level timer on a virtual clock, so no wall clock is involved
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "../game/tetris/context.h"
+#include "../game/tetris/search.h"
+
+#define SIM_SCORE_BUCKETS 1024
+#define SIM_SCORE_BUCKET_WIDTH 100
+// a figure moved this many times without locking is pulled down by force
+#define SIM_MAX_STEPS_PER_PIECE 1000
+
+typedef enum {
+  SIM_POLICY_RANDOM = 0,
+  SIM_POLICY_SCRIPTED,
+  SIM_POLICY_AUTOPLAY
+} sim_policy_kind_t;
+
+/// @brief How the moves are chosen. The random policy makes an autoshift one
+/// move in gravity_chance, the scripted one cycles through the script:
+/// L - left, R - right, A - rotate, D - down, G - autoshift. The autoplay
+/// policy plays with the heuristic evaluator and the weights, the default ones
+/// if weights is NULL, and locks every figure as soon as it is in place. With
+/// a search config it chooses the placements by the beam search. With a
+/// positive frame_ms every move takes frame_ms of virtual time and the
+/// autoshift also happens on the level timer, as in the real time game. Any
+/// policy gets only autoshifts once a figure has taken SIM_MAX_STEPS_PER_PIECE
+/// moves
+typedef struct {
+  sim_policy_kind_t kind;
+  const char *script;
+  int gravity_chance;
+  int max_pieces;
+  int frame_ms;
+  const autoplay_weights_t *weights;
+  const search_config_t *search;
+} sim_policy_t;
+
+typedef struct {
+  int score;
+  int pieces;
+  long nodes;
+} sim_game_result_t;
+
+/// @brief Mergeable statistics of a set of games
+typedef struct {
+  long games;
+  long pieces;
+  long nodes;
+  long long score_sum;
+  int score_min;
+  int score_max;
+  long score_histogram[SIM_SCORE_BUCKETS];
+} sim_stats_t;
+
+bool sim_script_get_is_valid(const char *script);
+bool sim_run_game(tetris_context_t *, const tetris_setup_t *,
+                  const sim_policy_t *, sim_game_result_t *);
+
+void sim_stats_init(sim_stats_t *);
+void sim_stats_add(sim_stats_t *, const sim_game_result_t *);
+void sim_stats_merge(sim_stats_t *, const sim_stats_t *);
+int sim_stats_get_score_percentile(const sim_stats_t *, const double percent);
+void sim_stats_print(FILE *, const sim_stats_t *, const double seconds);
+
+#endif
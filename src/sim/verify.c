@@ -0,0 +1,235 @@
+#define _POSIX_C_SOURCE 200809L
+// relying on the POSIX mmap(), posix_madvise(), open(), fstat() and
+// clock_gettime()
+#include "verify.h"
+
+/// @file verify.c
+/// @brief Implementation of the parallel replay verifier
+
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+typedef struct {
+  const verify_file_t *files;
+  verify_game_t *games;
+  long games_count;
+  atomic_long next;
+  atomic_bool error;
+} verify_pool_t;
+
+/// @brief map the replay file to memory and check its header
+/// @param file where to save the mapping
+/// @param path the replay file
+/// @return true if the file can not be mapped or is not a replay
+bool verify_map_file(verify_file_t *file, const char *path) {
+  file->path = path;
+  file->data = NULL;
+  file->size = 0;
+  file->corrupted = false;
+  file->corrupted_at = 0;
+  const int fd = open(path, O_RDONLY);
+  struct stat status = {0};
+  bool error = fd < 0 || fstat(fd, &status) || status.st_size == 0;
+  if (!error) {
+    void *data =
+        mmap(NULL, (size_t)status.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    error = data == MAP_FAILED;
+    if (!error) {
+      file->data = data;
+      file->size = (size_t)status.st_size;
+      posix_madvise(data, file->size, POSIX_MADV_WILLNEED);
+    }
+  }
+  if (fd >= 0) close(fd);
+  replay_reader_t reader;
+  if (!error) {
+    error = replay_reader_init(&reader, file->data, file->size);
+    file->engine_version = reader.engine_version;
+  }
+  if (error) verify_unmap_file(file);
+  return error;
+}
+
+/// @brief unmap the replay file
+/// @param file the mapping
+void verify_unmap_file(verify_file_t *file) {
+  if (file->data) munmap((void *)file->data, file->size);
+  file->data = NULL;
+  file->size = 0;
+}
+
+/// @brief find the start records of all the games of the files. The games of
+/// a file are indexed up to its first corrupted entry, if any
+/// @param files the mapped files, the corrupted ones are marked
+/// @param files_count number of the files
+/// @param games where to save the allocated games array
+/// @param games_count where to save the number of the games
+/// @return true on malloc error
+bool verify_index_games(verify_file_t *files, int files_count,
+                        verify_game_t **games, long *games_count) {
+  long capacity = 1024;
+  long count = 0;
+  verify_game_t *found = malloc(sizeof(verify_game_t) * capacity);
+  bool error = !found;
+  for (int f = 0; !error && f != files_count; ++f) {
+    replay_reader_t reader;
+    replay_reader_init(&reader, files[f].data, files[f].size);
+    size_t position = reader.position;
+    replay_event_t event;
+    while (!error && replay_reader_next(&reader, &event)) {
+      if (event.kind == REPLAY_EVENT_GAME_START) {
+        if (count == capacity) {
+          capacity *= 2;
+          verify_game_t *grown =
+              realloc(found, sizeof(verify_game_t) * capacity);
+          error = !grown;
+          if (grown) found = grown;
+        }
+        if (!error) {
+          found[count++] = (verify_game_t){f, position, VERIFY_GAME_PENDING,
+                                           {0}};
+        }
+      }
+      position = reader.position;
+    }
+    files[f].corrupted = reader.error;
+    files[f].corrupted_at = position;
+  }
+  if (error) {
+    free(found);
+    found = NULL;
+    count = 0;
+  }
+  *games = found;
+  *games_count = count;
+  return error;
+}
+
+/// @brief worker thread routine: claim chunks of games and play them
+/// @param arg the verify_pool_t
+/// @return NULL
+void *verify_worker(void *arg) {
+  verify_pool_t *pool = arg;
+  tetris_context_t *context = tetris_context_create();
+  if (!context) {
+    atomic_store(&pool->error, true);
+    return NULL;
+  }
+  long first = 0;
+  while ((first = atomic_fetch_add_explicit(&pool->next, VERIFY_CHUNK,
+                                            memory_order_relaxed)) <
+         pool->games_count) {
+    long last = first + VERIFY_CHUNK;
+    if (last > pool->games_count) last = pool->games_count;
+    for (long i = first; i < last; ++i) {
+      verify_game_t *game = &pool->games[i];
+      const verify_file_t *file = &pool->files[game->file];
+      replay_reader_t reader;
+      replay_reader_init(&reader, file->data, file->size);
+      reader.position = game->offset;
+      if (context->core.state == EXIT) {
+        // a game that ended with the exit leaves the context unusable
+        tetris_context_destroy(context);
+        context = tetris_context_create();
+        if (!context) {
+          atomic_store(&pool->error, true);
+          return NULL;
+        }
+      }
+      if (replay_play_game(&reader, context, &game->result)) {
+        game->status = VERIFY_GAME_CORRUPTED;
+        context->core.state = GAMEOVER;
+      } else if (replay_game_result_get_matches(&game->result)) {
+        game->status = VERIFY_GAME_MATCHES;
+      } else {
+        game->status = VERIFY_GAME_DIFFERS;
+      }
+    }
+  }
+  tetris_context_destroy(context);
+  return NULL;
+}
+
+/// @brief play the indexed games again on the threads
+/// @param files the mapped files
+/// @param games the indexed games, their status and result are filled
+/// @param games_count number of the games
+/// @param threads number of the worker threads
+/// @param result where to save the totals
+/// @return true if a thread or a context could not be created
+bool verify_run(const verify_file_t *files, verify_game_t *games,
+                long games_count, int threads, verify_result_t *result) {
+  if (!files || (!games && games_count) || threads < 1 || !result) return true;
+  verify_pool_t pool = {files, games, games_count, 0, false};
+  pthread_t *handles = calloc(threads, sizeof(pthread_t));
+  bool error = !handles;
+  int started = 0;
+  struct timespec start = {0};
+  struct timespec finish = {0};
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  for (; !error && started != threads; ++started) {
+    error = pthread_create(&handles[started], NULL, verify_worker, &pool) != 0;
+  }
+  if (error && started) --started;
+  for (int i = 0; i < started; ++i) {
+    pthread_join(handles[i], NULL);
+  }
+  clock_gettime(CLOCK_MONOTONIC, &finish);
+  free(handles);
+  error = error || atomic_load(&pool.error);
+  memset(result, 0, sizeof(verify_result_t));
+  for (long i = 0; !error && i != games_count; ++i) {
+    ++result->games;
+    result->pieces += games[i].result.pieces;
+    result->differs += games[i].status == VERIFY_GAME_DIFFERS;
+    result->corrupted += games[i].status == VERIFY_GAME_CORRUPTED;
+  }
+  result->seconds =
+      (finish.tv_sec - start.tv_sec) + (finish.tv_nsec - start.tv_nsec) / 1e9;
+  return error;
+}
+
+/// @brief print the games that did not end as recorded
+/// @param stream where to print
+/// @param files the mapped files
+/// @param games the verified games
+/// @param games_count number of the games
+void verify_print_differences(FILE *stream, const verify_file_t *files,
+                              const verify_game_t *games, long games_count) {
+  for (long i = 0; i != games_count; ++i) {
+    const verify_game_t *game = &games[i];
+    if (game->status == VERIFY_GAME_CORRUPTED) {
+      fprintf(stream, "%s: game at %zu: corrupted\n", files[game->file].path,
+              game->offset);
+    } else if (game->status == VERIFY_GAME_DIFFERS) {
+      fprintf(stream,
+              "%s: game at %zu: score %d, recorded %d, board %016llx, "
+              "recorded %016llx\n",
+              files[game->file].path, game->offset, game->result.score,
+              game->result.recorded_score,
+              (unsigned long long)game->result.board_hash,
+              (unsigned long long)game->result.recorded_board_hash);
+    }
+  }
+}
+
+/// @brief print the totals and the throughput
+/// @param stream where to print
+/// @param result the totals
+void verify_result_print(FILE *stream, const verify_result_t *result) {
+  const double seconds = result->seconds > 0 ? result->seconds : 1e-9;
+  fprintf(stream, "games:        %ld\n", result->games);
+  fprintf(stream, "pieces:       %ld\n", result->pieces);
+  fprintf(stream, "differ:       %ld\n", result->differs);
+  fprintf(stream, "corrupted:    %ld\n", result->corrupted);
+  fprintf(stream, "time:         %.3f s\n", result->seconds);
+  fprintf(stream, "replays/sec:  %.1f\n", result->games / seconds);
+  fprintf(stream, "pieces/sec:   %.1f\n", result->pieces / seconds);
+}
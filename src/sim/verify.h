@@ -0,0 +1,59 @@
+#ifndef TETRIS_SIM_VERIFY
+#define TETRIS_SIM_VERIFY
+
+/// @file verify.h
+/// @brief Declaration of the parallel replay verifier. Replay files are
+/// mapped to memory and indexed by games, worker threads claim the games and
+/// play them again through the FSM and the backend as fast as they can,
+/// checking the score and the board against the recorded ones
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+
+#include "../game/tetris/replay_player.h"
+
+#define VERIFY_CHUNK 16
+
+typedef struct {
+  const char *path;
+  const unsigned char *data;
+  size_t size;
+  unsigned long engine_version;
+  bool corrupted;
+  size_t corrupted_at;
+} verify_file_t;
+
+typedef enum {
+  VERIFY_GAME_PENDING = 0,
+  VERIFY_GAME_MATCHES,
+  VERIFY_GAME_DIFFERS,
+  VERIFY_GAME_CORRUPTED
+} verify_status_t;
+
+typedef struct {
+  int file;
+  size_t offset;
+  verify_status_t status;
+  replay_game_result_t result;
+} verify_game_t;
+
+typedef struct {
+  long games;
+  long pieces;
+  long differs;
+  long corrupted;
+  double seconds;
+} verify_result_t;
+
+bool verify_map_file(verify_file_t *, const char *path);
+void verify_unmap_file(verify_file_t *);
+bool verify_index_games(verify_file_t *files, int files_count,
+                        verify_game_t **games, long *games_count);
+bool verify_run(const verify_file_t *files, verify_game_t *games,
+                long games_count, int threads, verify_result_t *result);
+void verify_print_differences(FILE *, const verify_file_t *files,
+                              const verify_game_t *games, long games_count);
+void verify_result_print(FILE *, const verify_result_t *);
+
+#endif
@@ -1,25 +1,100 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
 #include "game/tetris/lib.h"
 #include "gui/cli/front.h"
+#include "gui/cli/input.h"
+
+#define LEADERBOARD_TOP_COUNT 10
 
 void game_loop(void);
 
-int main(void) {
+int main(int argc, char **argv) {
+  bool print_latency = false;
+  bool print_stats = false;
+  const char *replay_path = NULL;
+  const char *leaderboard_path = NULL;
+  const char *spectate_path = NULL;
+  long autoplay_move_ms = -1;
+  const char *autoplay_weights = NULL;
+  int beam_width = 0;
+  for (int i = 1; i < argc; ++i) {
+    if (!strcmp(argv[i], "-l")) {
+      print_latency = true;
+    } else if (!strcmp(argv[i], "-s")) {
+      print_stats = true;
+    } else if (!strcmp(argv[i], "-r") && i + 1 < argc) {
+      replay_path = argv[++i];
+    } else if (!strcmp(argv[i], "-L") && i + 1 < argc) {
+      leaderboard_path = argv[++i];
+    } else if (!strcmp(argv[i], "-W") && i + 1 < argc) {
+      spectate_path = argv[++i];
+    } else if (!strcmp(argv[i], "-a") && i + 1 < argc) {
+      autoplay_move_ms = strtol(argv[++i], NULL, 10);
+    } else if (!strcmp(argv[i], "-w") && i + 1 < argc) {
+      autoplay_weights = argv[++i];
+    } else if (!strcmp(argv[i], "-b") && i + 1 < argc) {
+      beam_width = (int)strtol(argv[++i], NULL, 10);
+    } else {
+      fprintf(stderr,
+              "usage: %s [-l] [-s] [-r replay_file] [-L leaderboard] "
+              "[-W spectate_socket] [-a move_ms] [-w weights] "
+              "[-b beam_width]\n",
+              argv[0]);
+      return 1;
+    }
+  }
+  if (autoplay_move_ms >= 0 &&
+      startAutoplay((unsigned long)autoplay_move_ms, autoplay_weights,
+                    beam_width)) {
+    fprintf(stderr,
+            "failed to start the autoplay, the weights are "
+            "height,holes,bumpiness,wells,lines\n");
+    return 1;
+  }
+  if (replay_path && startRecording(replay_path)) {
+    fprintf(stderr, "failed to record to %s\n", replay_path);
+    return 1;
+  }
+  if (leaderboard_path && openLeaderboard(leaderboard_path)) {
+    fprintf(stderr, "failed to open the leaderboard %s\n", leaderboard_path);
+    return 1;
+  }
+  if (spectate_path && startSpectating(spectate_path)) {
+    fprintf(stderr, "failed to listen for the spectators on %s\n",
+            spectate_path);
+    return 1;
+  }
+  if (print_stats) startFsmStats();
   game_loop();
+  if (spectate_path) stopSpectating();
+  if (replay_path && stopRecording()) {
+    fprintf(stderr, "failed to write %s\n", replay_path);
+  }
+  if (print_latency) frontend_print_wake_latency(stderr);
+  if (print_stats) printFsmStats(stderr);
+  if (leaderboard_path) {
+    printLeaderboard(stderr, LEADERBOARD_TOP_COUNT);
+    closeLeaderboard();
+  }
   return 0;
 }
 
 void game_loop(void) {
   init_cli();
   initGame();
+  if (frontend_start_input()) {
+    free_cli();
+    return;
+  }
   GameInfo_t frame = updateCurrentState();
   while (!getGameHasFinished()) {
-    frontend_draw_game_scene(&frame, getGameOver(), getPause());
-    UserAction_t user_input = 0;
-    if (get_user_input(&user_input)) {
-      userInput(user_input, true);
-    }
-    frontend_interframe_delay();
+    frontend_draw_game_scene(&frame, getGameOver(), getPause(), getGeneration(),
+                             takeDirtyRows());
+    frontend_wait_for_input(getMsToNextUpdate());
     frame = updateCurrentState();
   }
+  frontend_stop_input();
   free_cli();
 }
@@ -0,0 +1,330 @@
+#define _POSIX_C_SOURCE 200809L
+// relying on the POSIX getopt()
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "bench/bench.h"
+#include "game/tetris/backend.h"
+#include "game/tetris/figures.h"
+#include "game/tetris/fsm.h"
+#include "game/tetris/matrix.h"
+
+#define DEFAULT_THRESHOLD_PERCENT 10.0
+#define BOARDS_COUNT 5
+
+/// @brief A board of the corpus, rows are listed from the bottom one
+typedef struct {
+  const char *name;
+  int rows_count;
+  row_mask_t rows[FIELD_VISIBLE_HEIGHT];
+} bench_board_t;
+
+/// @brief The games of a board, one per current figure id, and the games the
+/// operations of a batch change
+typedef struct {
+  tetris_game_t corpus[ALLOWED_FIGURES_COUNT];
+  tetris_game_t games[BENCH_BATCH];
+  tetris_state_t states[BENCH_BATCH];
+} backend_bench_t;
+
+typedef struct {
+  int **corpus;
+  int **matrices[BENCH_BATCH];
+  int filled_rows;
+} matrix_bench_t;
+
+void print_usage(const char *name);
+void build_backend_bench(const bench_board_t *board, backend_bench_t *bench);
+bool build_matrix_bench(const bench_board_t *board, matrix_bench_t *bench);
+void free_matrix_bench(matrix_bench_t *bench);
+void prepare_game(void *data, int i);
+void run_drop(void *data, int i);
+void run_rotate(void *data, int i);
+void run_move_left(void *data, int i);
+void run_move_right(void *data, int i);
+void run_cut_filled_rows(void *data, int i);
+void run_spawn_new_figure(void *data, int i);
+void run_fsm_apply_input(void *data, int i);
+void prepare_matrix(void *data, int i);
+void run_fill_matrix(void *data, int i);
+void run_get_is_a_filled_row(void *data, int i);
+void run_shift_down_rows(void *data, int i);
+
+static const bench_board_t boards[BOARDS_COUNT] = {
+    {"empty", 0, {0}},
+    {"ragged", 6, {0x1FF, 0x3FE, 0x37B, 0x3F3, 0x1E3, 0x0C0}},
+    {"tall",
+     14,
+     {0x3FE, 0x3FD, 0x3FB, 0x3F7, 0x3EF, 0x3DF, 0x3BF, 0x37F, 0x2FF, 0x1FF,
+      0x3FE, 0x3FD, 0x3FB, 0x3F7}},
+    {"cut1", 3, {0x3FF, 0x1FE, 0x0F0}},
+    {"cut4", 6, {0x3FF, 0x3FF, 0x3FF, 0x3FF, 0x3DF, 0x18C}}};
+// the moves are timed on the boards without filled rows, the cuts on the
+// others
+static const int move_boards[] = {0, 1, 2};
+static const int cut_boards[] = {3, 4};
+static const int matrix_boards[] = {1, 4};
+
+int main(int argc, char **argv) {
+  int samples = BENCH_DEFAULT_SAMPLES;
+  double threshold = DEFAULT_THRESHOLD_PERCENT;
+  const char *save_path = NULL;
+  const char *compare_path = NULL;
+  int opt = 0;
+  bool error = false;
+  while (!error && (opt = getopt(argc, argv, "n:s:c:t:h")) != -1) {
+    if (opt == 'n') {
+      samples = (int)strtol(optarg, NULL, 10);
+    } else if (opt == 's') {
+      save_path = optarg;
+    } else if (opt == 'c') {
+      compare_path = optarg;
+    } else if (opt == 't') {
+      threshold = strtod(optarg, NULL);
+    } else {
+      error = true;
+    }
+  }
+  if (error || optind != argc || samples < 1) {
+    print_usage(argv[0]);
+    return 1;
+  }
+  static bench_result_t baseline[BENCH_CASES_MAX];
+  int baseline_count = 0;
+  if (compare_path) {
+    baseline_count = bench_load_baseline(compare_path, baseline,
+                                         BENCH_CASES_MAX);
+    if (baseline_count < 0) {
+      fprintf(stderr, "failed to read %s\n", compare_path);
+      return 1;
+    }
+  }
+  static backend_bench_t backend_benches[BOARDS_COUNT];
+  static matrix_bench_t matrix_benches[BOARDS_COUNT];
+  static bench_case_t cases[BENCH_CASES_MAX];
+  static char names[BENCH_CASES_MAX][BENCH_NAME_MAX];
+  int count = 0;
+  for (int b = 0; b != BOARDS_COUNT; ++b) {
+    build_backend_bench(&boards[b], &backend_benches[b]);
+    if (build_matrix_bench(&boards[b], &matrix_benches[b])) {
+      fprintf(stderr, "failed to allocate the matrices\n");
+      return 1;
+    }
+  }
+  const struct {
+    const char *name;
+    bench_op_t run;
+    bool cut;
+  } backend_ops[] = {{"drop", run_drop, false},
+                     {"rotate", run_rotate, false},
+                     {"move_left", run_move_left, false},
+                     {"move_right", run_move_right, false},
+                     {"fsm_apply_input", run_fsm_apply_input, false},
+                     {"spawn_new_figure", run_spawn_new_figure, false},
+                     {"cut_filled_rows", run_cut_filled_rows, true}};
+  for (size_t o = 0; o != sizeof(backend_ops) / sizeof(backend_ops[0]); ++o) {
+    const int *board_ids = backend_ops[o].cut ? cut_boards : move_boards;
+    const int boards_count = backend_ops[o].cut ? 2 : 3;
+    for (int b = 0; b != boards_count; ++b) {
+      snprintf(names[count], BENCH_NAME_MAX, "%s/%s", backend_ops[o].name,
+               boards[board_ids[b]].name);
+      cases[count] = (bench_case_t){names[count], prepare_game,
+                                    backend_ops[o].run,
+                                    &backend_benches[board_ids[b]]};
+      ++count;
+    }
+  }
+  const struct {
+    const char *name;
+    bench_op_t run;
+  } matrix_ops[] = {{"matrix_fill", run_fill_matrix},
+                    {"matrix_filled_row", run_get_is_a_filled_row},
+                    {"matrix_shift_down_rows", run_shift_down_rows}};
+  for (size_t o = 0; o != sizeof(matrix_ops) / sizeof(matrix_ops[0]); ++o) {
+    for (int b = 0; b != 2; ++b) {
+      const int board_id = matrix_boards[b];
+      snprintf(names[count], BENCH_NAME_MAX, "%s/%s", matrix_ops[o].name,
+               boards[board_id].name);
+      cases[count] = (bench_case_t){names[count], prepare_matrix,
+                                    matrix_ops[o].run,
+                                    &matrix_benches[board_id]};
+      ++count;
+    }
+  }
+  static bench_result_t results[BENCH_CASES_MAX];
+  int regressions = 0;
+  printf("%-28s %10s %10s %10s %10s%s\n", "ns/op", "p50", "p90", "p99", "min",
+         compare_path ? "   vs p50" : "");
+  for (int i = 0; !error && i != count; ++i) {
+    error = bench_run_case(&cases[i], samples, &results[i]);
+    if (!error) {
+      const bench_result_t *base =
+          bench_find_result(baseline, baseline_count, results[i].name);
+      regressions += bench_print_result(stdout, &results[i], base, threshold);
+    }
+  }
+  for (int b = 0; b != BOARDS_COUNT; ++b) free_matrix_bench(&matrix_benches[b]);
+  if (!error && save_path) {
+    error = bench_save_baseline(save_path, results, count);
+  }
+  if (error) {
+    fprintf(stderr, "the benchmark failed\n");
+    return 1;
+  }
+  if (regressions) {
+    printf("%d cases are more than %.1f%% slower than the baseline\n",
+           regressions, threshold);
+  }
+  return regressions ? 2 : 0;
+}
+
+/// @brief set up the games of the board, one per figure id with the figure
+/// at its spawn position. The high score is out of reach, so a cut does not
+/// write the high score file
+/// @param board the board
+/// @param bench where to save the games
+void build_backend_bench(const bench_board_t *board, backend_bench_t *bench) {
+  for (int id = 0; id != ALLOWED_FIGURES_COUNT; ++id) {
+    tetris_game_t *game = &bench->corpus[id];
+    backend_init_game(game);
+    const tetris_setup_t setup = {(uint64_t)id + 1, RANDOMIZER_BAG,
+                                  BOARD_STANDARD};
+    backend_configure_game(game, &setup);
+    backend_setup_new_game(game);
+    game->game.high_score = INT_MAX;
+    for (int i = 0; i != board->rows_count; ++i) {
+      const int r = FIELD_TOTAL_HEIGHT - 1 - i;
+      for (int c = 0; c != FIELD_WIDTH; ++c) {
+        game->game.field[r][c] = (board->rows[i] >> c) & 1u;
+      }
+    }
+    backend_sync_occupancy(game);
+    game->current_figure.id = NO_FIGURE;
+    game->next_figure_id = id;
+    backend_spawn_new_figure(game);
+  }
+}
+
+/// @brief allocate the matrices of the board, filled with the board cells
+/// @param board the board
+/// @param bench where to save the matrices
+/// @return true on malloc error
+bool build_matrix_bench(const bench_board_t *board, matrix_bench_t *bench) {
+  bool error = !(bench->corpus = calloc_matrix(FIELD_TOTAL_HEIGHT,
+                                               FIELD_WIDTH));
+  for (int i = 0; !error && i != BENCH_BATCH; ++i) {
+    error = !(bench->matrices[i] =
+                  calloc_matrix(FIELD_TOTAL_HEIGHT, FIELD_WIDTH));
+  }
+  for (int i = 0; !error && i != board->rows_count; ++i) {
+    const int r = FIELD_TOTAL_HEIGHT - 1 - i;
+    for (int c = 0; c != FIELD_WIDTH; ++c) {
+      bench->corpus[r][c] = (board->rows[i] >> c) & 1u;
+    }
+  }
+  bench->filled_rows = 0;
+  return error;
+}
+
+/// @brief free the matrices of the board
+/// @param bench the matrices
+void free_matrix_bench(matrix_bench_t *bench) {
+  free_matrix(bench->corpus);
+  for (int i = 0; i != BENCH_BATCH; ++i) free_matrix(bench->matrices[i]);
+}
+
+/// @brief copy a game of the corpus for the operation, the figures take turns
+/// @param data the backend_bench_t
+/// @param i index in the batch
+void prepare_game(void *data, int i) {
+  backend_bench_t *bench = data;
+  bench->games[i] = bench->corpus[i % ALLOWED_FIGURES_COUNT];
+  bench->states[i] = IDLE;
+}
+
+void run_drop(void *data, int i) {
+  backend_drop_current_figure(&((backend_bench_t *)data)->games[i]);
+}
+
+void run_rotate(void *data, int i) {
+  backend_rotate_current_figure(&((backend_bench_t *)data)->games[i]);
+}
+
+void run_move_left(void *data, int i) {
+  backend_move_left_current_figure(&((backend_bench_t *)data)->games[i]);
+}
+
+void run_move_right(void *data, int i) {
+  backend_move_right_current_figure(&((backend_bench_t *)data)->games[i]);
+}
+
+void run_cut_filled_rows(void *data, int i) {
+  backend_cut_filled_rows(&((backend_bench_t *)data)->games[i]);
+}
+
+void run_spawn_new_figure(void *data, int i) {
+  backend_spawn_new_figure(&((backend_bench_t *)data)->games[i]);
+}
+
+/// @brief apply one of the IDLE state inputs, the autoshift included
+/// @param data the backend_bench_t
+/// @param i index in the batch
+void run_fsm_apply_input(void *data, int i) {
+  const fsm_input_t inputs[] = {MOVE_LEFT, MOVE_RIGHT, ROTATE_BTN, MOVE_DOWN,
+                                AUTOSHIFT_SIG};
+  backend_bench_t *bench = data;
+  fsm_apply_input(inputs[i % 5], &bench->states[i], &bench->games[i]);
+}
+
+/// @brief copy the matrix of the corpus for the operation
+/// @param data the matrix_bench_t
+/// @param i index in the batch
+void prepare_matrix(void *data, int i) {
+  matrix_bench_t *bench = data;
+  for (int r = 0; r != FIELD_TOTAL_HEIGHT; ++r) {
+    memcpy(bench->matrices[i][r], bench->corpus[r],
+           sizeof(int) * FIELD_WIDTH);
+  }
+}
+
+void run_fill_matrix(void *data, int i) {
+  fill_matrix(((matrix_bench_t *)data)->matrices[i], FIELD_TOTAL_HEIGHT,
+              FIELD_WIDTH, i & 7);
+}
+
+/// @brief check every row of the field, as the cut does
+/// @param data the matrix_bench_t
+/// @param i index in the batch
+void run_get_is_a_filled_row(void *data, int i) {
+  matrix_bench_t *bench = data;
+  for (int r = 0; r != FIELD_TOTAL_HEIGHT; ++r) {
+    bench->filled_rows +=
+        get_is_a_filled_row((const int **)bench->matrices[i], r, FIELD_WIDTH);
+  }
+}
+
+void run_shift_down_rows(void *data, int i) {
+  shift_down_rows(((matrix_bench_t *)data)->matrices[i],
+                  FIELD_TOTAL_HEIGHT - 1, 1 + i % 4, FIELD_WIDTH);
+}
+
+/// @brief print the options
+/// @param name executable name
+void print_usage(const char *name) {
+  fprintf(stderr,
+          "usage: %s [-n samples] [-s baseline] [-c baseline] "
+          "[-t threshold]\n"
+          "  times the backend, FSM and matrix primitives on fixed boards, "
+          "%d operations per sample,\n"
+          "  and reports ns/op percentiles\n"
+          "  -n  number of samples per case, %d by default\n"
+          "  -s  save the results as the baseline file\n"
+          "  -c  compare the medians with the baseline file, exit with 2\n"
+          "      if any is more than threshold percent slower\n"
+          "  -t  the threshold, %.0f%% by default\n",
+          name, BENCH_BATCH, BENCH_DEFAULT_SAMPLES,
+          DEFAULT_THRESHOLD_PERCENT);
+}
@@ -0,0 +1,291 @@
+#define _POSIX_C_SOURCE 200809L
+#define _XOPEN_SOURCE 700
+// relying on the XSI pseudo-terminals, POSIX fork(), poll() and getopt()
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "common/time_utils.h"
+#include "game/tetris/stats.h"
+
+#define DEFAULT_KEYS 200
+#define DEFAULT_QUIET_MS 30
+#define DEFAULT_TIMEOUT_MS 200
+#define STARTUP_QUIET_MS 300
+#define STARTUP_TIMEOUT_MS 5000
+#define EXIT_TIMEOUT_MS 1000
+#define TERMINAL_ROWS 40
+#define TERMINAL_COLUMNS 100
+#define OUTPUT_READ_SIZE 4096
+#define GAME_OVER_UNCHANGED_KEYS 5
+
+/// @brief State of the terminal output parser: plain text, an escape, a
+/// control sequence ESC [ ... or a string ESC ] ... / ESC P ...
+typedef enum {
+  TERM_PLAIN = 0,
+  TERM_ESCAPE,
+  TERM_CSI,
+  TERM_STRING
+} term_state_t;
+
+typedef struct {
+  int master;
+  pid_t pid;
+  term_state_t state;
+} pty_game_t;
+
+void print_usage(const char *name);
+bool spawn_game(char **argv, pty_game_t *game);
+int count_visible_chars(const char *buffer, const ssize_t size,
+                        term_state_t *state);
+int read_output(pty_game_t *game, const long timeout_ms);
+bool wait_for_quiet(pty_game_t *game, const long quiet_ms,
+                    const long timeout_ms);
+bool wait_for_change(pty_game_t *game, const long timeout_ms,
+                     unsigned long long *change_ns);
+void stop_game(pty_game_t *game);
+
+int main(int argc, char **argv) {
+  long keys = DEFAULT_KEYS;
+  long quiet_ms = DEFAULT_QUIET_MS;
+  long timeout_ms = DEFAULT_TIMEOUT_MS;
+  int opt = 0;
+  bool error = false;
+  while (!error && (opt = getopt(argc, argv, "+n:q:t:h")) != -1) {
+    if (opt == 'n') {
+      keys = strtol(optarg, NULL, 10);
+    } else if (opt == 'q') {
+      quiet_ms = strtol(optarg, NULL, 10);
+    } else if (opt == 't') {
+      timeout_ms = strtol(optarg, NULL, 10);
+    } else {
+      error = true;
+    }
+  }
+  if (error || keys < 1 || quiet_ms < 1 || timeout_ms < 1) {
+    print_usage(argv[0]);
+    return 1;
+  }
+  char *default_command[] = {"./tetris", NULL};
+  pty_game_t game = {-1, -1, TERM_PLAIN};
+  if (spawn_game(optind < argc ? argv + optind : default_command, &game)) {
+    fprintf(stderr, "failed to run the game under a pseudo-terminal\n");
+    return 1;
+  }
+  // the keys move the figure left and right and back, so it stays in the
+  // middle of the field and every move is visible
+  const char *key_codes[] = {"\033[D", "\033[C", " ", "\033[C", "\033[D"};
+  static stats_histogram_t latency;
+  long unchanged = 0;
+  int unchanged_in_row = 0;
+  error = wait_for_quiet(&game, STARTUP_QUIET_MS, STARTUP_TIMEOUT_MS) ||
+          write(game.master, "s", 1) != 1 ||
+          wait_for_quiet(&game, quiet_ms, STARTUP_TIMEOUT_MS);
+  for (long i = 0; !error && i != keys; ++i) {
+    const char *key = key_codes[i % 5];
+    const unsigned long long press_ns = get_monotonic_ns();
+    unsigned long long change_ns = 0;
+    error = write(game.master, key, strlen(key)) != (ssize_t)strlen(key);
+    if (!error && wait_for_change(&game, timeout_ms, &change_ns)) {
+      stats_histogram_record(&latency, change_ns - press_ns);
+      unchanged_in_row = 0;
+    } else if (!error) {
+      // a figure above the visible rows or against a wall does not change
+      // the screen, many keys in a row do not change it after the game over
+      ++unchanged;
+      if (++unchanged_in_row == GAME_OVER_UNCHANGED_KEYS) {
+        unchanged_in_row = 0;
+        error = write(game.master, "s", 1) != 1;
+      }
+    }
+    error = error || wait_for_quiet(&game, quiet_ms, STARTUP_TIMEOUT_MS);
+  }
+  stop_game(&game);
+  if (error) {
+    fprintf(stderr, "the game has stopped responding\n");
+    return 1;
+  }
+  printf("keys:      %ld, %ld without a visible change\n", keys, unchanged);
+  printf("latency:   p50 %.1f us, p90 %.1f us, p99 %.1f us, max %.1f us\n",
+         stats_histogram_get_percentile(&latency, 50) / 1e3,
+         stats_histogram_get_percentile(&latency, 90) / 1e3,
+         stats_histogram_get_percentile(&latency, 99) / 1e3,
+         latency.max_ns / 1e3);
+  printf("mean:      %.1f us\n",
+         latency.count ? (double)latency.total_ns / latency.count / 1e3 : 0);
+  return 0;
+}
+
+/// @brief run the game with a new pseudo-terminal as its controlling terminal
+/// @param argv the game command and its arguments
+/// @param game where to save the master side and the game pid
+/// @return true on error
+bool spawn_game(char **argv, pty_game_t *game) {
+  game->master = posix_openpt(O_RDWR | O_NOCTTY);
+  bool error = game->master < 0 || grantpt(game->master) ||
+               unlockpt(game->master);
+  const char *slave_name = error ? NULL : ptsname(game->master);
+  const struct winsize size = {TERMINAL_ROWS, TERMINAL_COLUMNS, 0, 0};
+  error = error || !slave_name || ioctl(game->master, TIOCSWINSZ, &size) < 0;
+  if (!error) game->pid = fork();
+  if (!error && game->pid == 0) {
+    const int slave = setsid() < 0 ? -1 : open(slave_name, O_RDWR);
+    if (slave < 0 || dup2(slave, STDIN_FILENO) < 0 ||
+        dup2(slave, STDOUT_FILENO) < 0 || dup2(slave, STDERR_FILENO) < 0) {
+      _exit(127);
+    }
+    close(slave);
+    close(game->master);
+    if (!getenv("TERM")) setenv("TERM", "xterm", 1);
+    execvp(argv[0], argv);
+    _exit(127);
+  }
+  error = error || game->pid < 0;
+  if (error && game->master >= 0) close(game->master);
+  return error;
+}
+
+/// @brief count the characters the terminal draws, the control characters
+/// and the escape sequences do not change the screen by themselves
+/// @param buffer the terminal output
+/// @param size size of the output
+/// @param state parser state, kept between the calls
+/// @return number of the drawn characters
+int count_visible_chars(const char *buffer, const ssize_t size,
+                        term_state_t *state) {
+  int visible = 0;
+  for (ssize_t i = 0; i < size; ++i) {
+    const unsigned char ch = (unsigned char)buffer[i];
+    if (*state == TERM_PLAIN) {
+      if (ch == '\033') {
+        *state = TERM_ESCAPE;
+      } else if (ch >= ' ' && ch != 0x7F) {
+        ++visible;
+      }
+    } else if (*state == TERM_ESCAPE) {
+      if (ch == '[') {
+        *state = TERM_CSI;
+      } else if (ch == ']' || ch == 'P') {
+        *state = TERM_STRING;
+      } else if (ch < 0x20 || ch > 0x2F) {
+        // the intermediate bytes 0x20 - 0x2F keep the escape going
+        *state = TERM_PLAIN;
+      }
+    } else if (*state == TERM_CSI) {
+      if (ch >= 0x40 && ch <= 0x7E) *state = TERM_PLAIN;
+    } else if (ch == '\a') {
+      *state = TERM_PLAIN;
+    } else if (ch == '\033') {
+      // ESC \ ends the string, the backslash is dropped by TERM_ESCAPE
+      *state = TERM_ESCAPE;
+    }
+  }
+  return visible;
+}
+
+/// @brief wait for the game output and read it
+/// @param game the game
+/// @param timeout_ms how long to wait
+/// @return number of the drawn characters, 0 on timeout, -1 if the game
+/// has closed the terminal
+int read_output(pty_game_t *game, const long timeout_ms) {
+  struct pollfd fd = {game->master, POLLIN, 0};
+  const int ready = poll(&fd, 1, (int)timeout_ms);
+  int visible = 0;
+  if (ready > 0) {
+    char buffer[OUTPUT_READ_SIZE];
+    const ssize_t size = read(game->master, buffer, sizeof(buffer));
+    visible = size > 0 ? count_visible_chars(buffer, size, &game->state) : -1;
+  } else if (ready < 0) {
+    visible = -1;
+  }
+  return visible;
+}
+
+/// @brief read the game output until there is none for quiet_ms
+/// @param game the game
+/// @param quiet_ms how long the output must stay quiet
+/// @param timeout_ms how long to wait for the quiet at most
+/// @return true if the game has closed the terminal or does not stop drawing
+bool wait_for_quiet(pty_game_t *game, const long quiet_ms,
+                    const long timeout_ms) {
+  const unsigned long long deadline_ns =
+      get_monotonic_ns() + timeout_ms * 1000000ull;
+  bool quiet = false;
+  bool error = false;
+  while (!quiet && !error) {
+    const int visible = read_output(game, quiet_ms);
+    quiet = visible == 0 && game->state == TERM_PLAIN;
+    error = visible < 0 || get_monotonic_ns() > deadline_ns;
+  }
+  return error;
+}
+
+/// @brief read the game output until a character is drawn
+/// @param game the game
+/// @param timeout_ms how long to wait for the change
+/// @param change_ns where to save the time the change was read
+/// @return true if the screen has changed
+bool wait_for_change(pty_game_t *game, const long timeout_ms,
+                     unsigned long long *change_ns) {
+  const unsigned long long deadline_ns =
+      get_monotonic_ns() + timeout_ms * 1000000ull;
+  bool changed = false;
+  bool expired = false;
+  while (!changed && !expired) {
+    const unsigned long long now_ns = get_monotonic_ns();
+    expired = now_ns >= deadline_ns;
+    const long left_ms = expired ? 0 : (long)((deadline_ns - now_ns) / 1000000);
+    const int visible = expired ? 0 : read_output(game, left_ms + 1);
+    if (visible > 0) {
+      changed = true;
+      *change_ns = get_monotonic_ns();
+    }
+    expired = expired || visible < 0;
+  }
+  return changed;
+}
+
+/// @brief quit the game, kill it if it does not exit in time
+/// @param game the game
+void stop_game(pty_game_t *game) {
+  if (write(game->master, "q", 1) == 1) {
+    wait_for_quiet(game, DEFAULT_QUIET_MS, EXIT_TIMEOUT_MS);
+  }
+  int status = 0;
+  const unsigned long long deadline_ns =
+      get_monotonic_ns() + EXIT_TIMEOUT_MS * 1000000ull;
+  while (waitpid(game->pid, &status, WNOHANG) == 0) {
+    if (get_monotonic_ns() > deadline_ns) {
+      kill(game->pid, SIGKILL);
+      waitpid(game->pid, &status, 0);
+    } else {
+      read_output(game, 10);
+    }
+  }
+  close(game->master);
+}
+
+/// @brief print the options
+/// @param name executable name
+void print_usage(const char *name) {
+  fprintf(stderr,
+          "usage: %s [-n keys] [-q quiet_ms] [-t timeout_ms] "
+          "[game [args]]\n"
+          "  runs the game, ./tetris by default, under a pseudo-terminal,\n"
+          "  presses the arrow keys and the rotation one by one and reports\n"
+          "  the time from a key press to the first character drawn\n"
+          "  -n  number of the key presses, %d by default\n"
+          "  -q  the next key is pressed after quiet_ms without output,\n"
+          "      %d by default\n"
+          "  -t  a key without a change in timeout_ms is not accounted, %d\n"
+          "      of them in a row restart the game, %d ms by default\n",
+          name, DEFAULT_KEYS, DEFAULT_QUIET_MS, GAME_OVER_UNCHANGED_KEYS,
+          DEFAULT_TIMEOUT_MS);
+}
@@ -0,0 +1,315 @@
+#define _POSIX_C_SOURCE 200809L
+// relying on the Linux epoll, the POSIX sockets, fork() and getopt()
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "common/game_clock.h"
+#include "common/time_utils.h"
+#include "server/server.h"
+#include "server/timer_heap.h"
+
+#define DEFAULT_SESSIONS 1000
+#define DEFAULT_SECONDS 5
+#define DEFAULT_INTERVAL_MS 100
+#define CONNECT_TIMEOUT_MS 5000
+#define CONNECT_RETRY_MS 10
+#define READ_STATES 8
+#define MAX_EVENTS 256
+#define ACTIONS_COUNT 5
+
+/// @brief A session of the client. sent_ns is the send time of the request
+/// waiting for its answer, input holds a partly read state
+typedef struct {
+  int fd;
+  uint32_t sequence;
+  bool waiting;
+  bool game_over;
+  unsigned long long sent_ns;
+  size_t input_size;
+  uint8_t input[sizeof(server_state_t)];
+} load_session_t;
+
+/// @brief the requests sent before begin_ns, while the sessions connect, are
+/// not timed
+typedef struct {
+  unsigned long long begin_ns;
+  long connected;
+  long errors;
+  long requests;
+  long answers;
+  long pushes;
+  long games;
+  stats_histogram_t latency;
+} load_stats_t;
+
+void print_usage(const char *name);
+pid_t spawn_server(char **argv);
+int connect_session(const char *path, const long timeout_ms);
+bool send_request(load_session_t *session, const uint8_t kind,
+                  const UserAction_t action, const uint64_t seed,
+                  const board_kind_t board, load_stats_t *stats);
+bool read_states(load_session_t *session, load_stats_t *stats);
+void print_stats(const load_stats_t *stats, const long sessions,
+                 const double seconds);
+
+int main(int argc, char **argv) {
+  const char *socket_path = SERVER_DEFAULT_SOCKET_PATH;
+  long sessions_count = DEFAULT_SESSIONS;
+  long seconds = DEFAULT_SECONDS;
+  long interval_ms = DEFAULT_INTERVAL_MS;
+  uint64_t first_seed = 1;
+  board_kind_t board = BOARD_STANDARD;
+  bool mixed_boards = false;
+  int opt = 0;
+  bool error = false;
+  while (!error && (opt = getopt(argc, argv, "+S:n:d:i:s:b:h")) != -1) {
+    if (opt == 'S') {
+      socket_path = optarg;
+    } else if (opt == 'n') {
+      sessions_count = strtol(optarg, NULL, 10);
+    } else if (opt == 'd') {
+      seconds = strtol(optarg, NULL, 10);
+    } else if (opt == 'i') {
+      interval_ms = strtol(optarg, NULL, 10);
+    } else if (opt == 's') {
+      first_seed = strtoull(optarg, NULL, 10);
+    } else if (opt == 'b') {
+      mixed_boards = !strcmp(optarg, "mixed");
+      error = !mixed_boards && board_parse_kind(optarg, &board);
+    } else {
+      error = true;
+    }
+  }
+  if (error || sessions_count < 1 || sessions_count > INT32_MAX ||
+      seconds < 1 || interval_ms < 1) {
+    print_usage(argv[0]);
+    return 1;
+  }
+  server_raise_file_limit();
+  const pid_t server = optind < argc ? spawn_server(argv + optind) : 0;
+  load_session_t *sessions = calloc(sessions_count, sizeof(load_session_t));
+  timer_heap_t sends = {0};
+  const int epoll_fd = epoll_create1(0);
+  error = server < 0 || !sessions || epoll_fd < 0 ||
+          timer_heap_init(&sends, (int)sessions_count);
+  static load_stats_t stats;
+  for (long i = 0; !error && i != sessions_count; ++i) {
+    load_session_t *session = &sessions[i];
+    session->fd = connect_session(socket_path, CONNECT_TIMEOUT_MS);
+    struct epoll_event event = {EPOLLIN, {.u64 = (uint64_t)i}};
+    error = session->fd < 0 ||
+            fcntl(session->fd, F_SETFL,
+                  fcntl(session->fd, F_GETFL) | O_NONBLOCK) != 0 ||
+            epoll_ctl(epoll_fd, EPOLL_CTL_ADD, session->fd, &event) != 0 ||
+            send_request(session, SERVER_REQUEST_OPEN, Start, first_seed + i,
+                         mixed_boards ? (board_kind_t)(i % BOARD_KINDS_COUNT)
+                                      : board,
+                         &stats) ||
+            send_request(session, SERVER_REQUEST_INPUT, Start, 0,
+                         BOARD_STANDARD, &stats);
+    stats.connected += !error;
+  }
+  // the moves of the sessions are spread over the interval
+  const uint64_t begin_ms = get_monotonic_ms();
+  stats.begin_ns = get_monotonic_ns();
+  for (long i = 0; !error && i != sessions_count; ++i) {
+    timer_heap_set(&sends, (int)i,
+                   begin_ms + interval_ms * i / sessions_count);
+  }
+  const UserAction_t actions[ACTIONS_COUNT] = {Left, Action, Right, Left,
+                                               Down};
+  const uint64_t end_ms = begin_ms + seconds * 1000;
+  struct epoll_event events[MAX_EVENTS];
+  uint64_t now_ms = begin_ms;
+  while (!error && now_ms < end_ms) {
+    long timeout_ms = timer_heap_get_ms_to_first(&sends, now_ms);
+    if (timeout_ms < 0 || timeout_ms > (long)(end_ms - now_ms)) {
+      timeout_ms = (long)(end_ms - now_ms);
+    }
+    const int count =
+        epoll_wait(epoll_fd, events, MAX_EVENTS, (int)timeout_ms);
+    error = count < 0 && errno != EINTR;
+    for (int i = 0; i < count; ++i) {
+      load_session_t *session = &sessions[events[i].data.u64];
+      stats.errors += read_states(session, &stats);
+    }
+    now_ms = get_monotonic_ms();
+    int id = -1;
+    while ((id = timer_heap_pop_due(&sends, now_ms)) >= 0) {
+      load_session_t *session = &sessions[id];
+      // a session sends when the previous request has been answered
+      if (!session->waiting) {
+        const UserAction_t action =
+            session->game_over ? Start
+                               : actions[session->sequence % ACTIONS_COUNT];
+        stats.errors += send_request(session, SERVER_REQUEST_INPUT, action,
+                                     0, BOARD_STANDARD, &stats);
+      }
+      timer_heap_set(&sends, id, now_ms + interval_ms);
+    }
+  }
+  const double elapsed = (get_monotonic_ms() - begin_ms) / 1e3;
+  for (long i = 0; sessions && i != sessions_count; ++i) {
+    if (sessions[i].fd > 0) close(sessions[i].fd);
+  }
+  if (server > 0) {
+    int status = 0;
+    kill(server, SIGINT);
+    waitpid(server, &status, 0);
+  }
+  if (epoll_fd >= 0) close(epoll_fd);
+  timer_heap_destroy(&sends);
+  free(sessions);
+  if (error) {
+    fprintf(stderr, "failed to run %ld sessions, %ld connected\n",
+            sessions_count, stats.connected);
+    return 1;
+  }
+  print_stats(&stats, sessions_count, elapsed);
+  return stats.errors || !stats.answers;
+}
+
+/// @brief run the server and let it listen
+/// @param argv the server command and its arguments
+/// @return the server pid, -1 on error
+pid_t spawn_server(char **argv) {
+  const pid_t pid = fork();
+  if (!pid) {
+    execvp(argv[0], argv);
+    _exit(127);
+  }
+  return pid;
+}
+
+/// @brief connect to the server, waiting for it to listen
+/// @param path the socket file
+/// @param timeout_ms how long to wait
+/// @return the socket, -1 on error
+int connect_session(const char *path, const long timeout_ms) {
+  struct sockaddr_un address;
+  memset(&address, 0, sizeof(address));
+  address.sun_family = AF_UNIX;
+  if (strlen(path) >= sizeof(address.sun_path)) return -1;
+  strcpy(address.sun_path, path);
+  int fd = -1;
+  const struct timespec retry = {0, CONNECT_RETRY_MS * 1000000L};
+  for (long waited_ms = 0; fd < 0 && waited_ms <= timeout_ms;
+       waited_ms += CONNECT_RETRY_MS) {
+    fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd >= 0 &&
+        connect(fd, (struct sockaddr *)&address, sizeof(address)) != 0) {
+      close(fd);
+      fd = -1;
+      nanosleep(&retry, NULL);
+    }
+  }
+  return fd;
+}
+
+/// @brief send a request and wait for its answer
+/// @param session the session
+/// @param kind the server_request_kind_t
+/// @param action the user input of an input request
+/// @param seed the seed of an open request
+/// @param board the board of an open request
+/// @param stats the stats
+/// @return true if the request could not be sent
+bool send_request(load_session_t *session, const uint8_t kind,
+                  const UserAction_t action, const uint64_t seed,
+                  const board_kind_t board, load_stats_t *stats) {
+  const server_request_t request = {kind, (uint8_t)action, 1, (uint8_t)board,
+                                    ++session->sequence, seed};
+  session->sent_ns = get_monotonic_ns();
+  session->waiting = true;
+  ++stats->requests;
+  return send(session->fd, &request, sizeof(request), MSG_NOSIGNAL) !=
+         (ssize_t)sizeof(request);
+}
+
+/// @brief read the states of the session, the one answering the last request
+/// is timed
+/// @param session the session
+/// @param stats the stats
+/// @return true if the session is closed or on error
+bool read_states(load_session_t *session, load_stats_t *stats) {
+  uint8_t buffer[READ_STATES * sizeof(server_state_t)];
+  memcpy(buffer, session->input, session->input_size);
+  const ssize_t size = read(session->fd, buffer + session->input_size,
+                            sizeof(buffer) - session->input_size);
+  if (size <= 0) return size == 0 || (errno != EAGAIN && errno != EINTR);
+  const unsigned long long now_ns = get_monotonic_ns();
+  const size_t total = session->input_size + (size_t)size;
+  const size_t count = total / sizeof(server_state_t);
+  for (size_t i = 0; i != count; ++i) {
+    server_state_t state;
+    memcpy(&state, buffer + i * sizeof(server_state_t),
+           sizeof(server_state_t));
+    if (session->waiting && state.sequence == session->sequence) {
+      session->waiting = false;
+      if (session->sent_ns >= stats->begin_ns) {
+        stats_histogram_record(&stats->latency, now_ns - session->sent_ns);
+      }
+      ++stats->answers;
+    } else {
+      ++stats->pushes;
+    }
+    const bool game_over = state.state == GAMEOVER;
+    stats->games += game_over && !session->game_over;
+    session->game_over = game_over;
+  }
+  session->input_size = total - count * sizeof(server_state_t);
+  memcpy(session->input, buffer + count * sizeof(server_state_t),
+         session->input_size);
+  return false;
+}
+
+/// @brief print the throughput and the latency of the answers
+/// @param stats the stats
+/// @param sessions number of the sessions
+/// @param seconds duration of the run
+void print_stats(const load_stats_t *stats, const long sessions,
+                 const double seconds) {
+  printf("sessions:   %ld connected of %ld, %ld errors\n", stats->connected,
+         sessions, stats->errors);
+  printf("requests:   %ld, %.0f/s\n", stats->requests,
+         seconds > 0 ? stats->requests / seconds : 0);
+  printf("states:     %ld answers, %ld pushed, %ld games over\n",
+         stats->answers, stats->pushes, stats->games);
+  printf("latency:    p50 %.1f us, p90 %.1f us, p99 %.1f us, p99.9 %.1f us, "
+         "max %.1f us\n",
+         stats_histogram_get_percentile(&stats->latency, 50) / 1e3,
+         stats_histogram_get_percentile(&stats->latency, 90) / 1e3,
+         stats_histogram_get_percentile(&stats->latency, 99) / 1e3,
+         stats_histogram_get_percentile(&stats->latency, 99.9) / 1e3,
+         stats->latency.max_ns / 1e3);
+}
+
+/// @brief print the options
+/// @param name executable name
+void print_usage(const char *name) {
+  fprintf(stderr,
+          "usage: %s [-S socket] [-n sessions] [-d seconds] [-i interval_ms] "
+          "[-s seed] [-b board] [server [args]]\n"
+          "  opens the sessions on the game server and plays them, a session\n"
+          "  sends a move every interval_ms once the previous one has been\n"
+          "  answered, and reports the time from a request to its answer.\n"
+          "  With a server command the server is run and stopped by SIGINT\n"
+          "  -S  the socket file, %s by default\n"
+          "  -n  number of the sessions, %d by default\n"
+          "  -d  duration of the run, %d s by default\n"
+          "  -i  interval between the moves of a session, %d ms by default\n"
+          "  -s  seed of the first session, session i plays seed + i\n"
+          "  -b  board of the sessions: standard (default), mini, training\n"
+          "      or mixed, session i on the board i %% 3\n",
+          name, SERVER_DEFAULT_SOCKET_PATH, DEFAULT_SESSIONS, DEFAULT_SECONDS,
+          DEFAULT_INTERVAL_MS);
+}
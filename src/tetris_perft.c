@@ -0,0 +1,97 @@
+#define _POSIX_C_SOURCE 200809L
+// relying on the POSIX getopt()
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "common/time_utils.h"
+#include "game/tetris/placement.h"
+
+#define PERFT_MAX_DEPTH 8
+#define PERFT_GENERATE_ROUNDS 200000
+
+typedef struct {
+  const char *name;
+  row_mask_t rows[FIELD_TOTAL_HEIGHT];
+} perft_board_t;
+
+void print_usage(const char *name);
+void build_boards(perft_board_t *boards);
+void run_board(const perft_board_t *board, const int *ids, const int depth);
+
+int main(int argc, char **argv) {
+  int depth = 3;
+  int opt = 0;
+  bool error = false;
+  while (!error && (opt = getopt(argc, argv, "d:h")) != -1) {
+    if (opt == 'd') {
+      depth = (int)strtol(optarg, NULL, 10);
+    } else {
+      error = true;
+    }
+  }
+  if (error || optind != argc || depth < 1 || depth > PERFT_MAX_DEPTH) {
+    print_usage(argv[0]);
+    return 1;
+  }
+  // T, I, S, O, L, Z, J, T
+  const int ids[PERFT_MAX_DEPTH] = {5, 0, 4, 3, 2, 6, 1, 5};
+  perft_board_t boards[3];
+  build_boards(boards);
+  for (int i = 0; i != 3; ++i) run_board(&boards[i], ids, depth);
+  return 0;
+}
+
+/// @brief build the fixed boards: an empty one, a ragged stack with holes
+/// and a T-spin slot under an overhang
+/// @param boards where to save the 3 boards
+void build_boards(perft_board_t *boards) {
+  const int bottom = FIELD_TOTAL_HEIGHT - 1;
+  for (int i = 0; i != 3; ++i) {
+    for (int r = 0; r != FIELD_TOTAL_HEIGHT; ++r) boards[i].rows[r] = 0;
+  }
+  boards[0].name = "empty";
+  boards[1].name = "ragged";
+  const row_mask_t ragged[] = {0x0C0, 0x1E3, 0x3F3, 0x37B, 0x3FE, 0x1FF};
+  for (int i = 0; i != 6; ++i) boards[1].rows[bottom - 5 + i] = ragged[i];
+  boards[2].name = "tspin";
+  boards[2].rows[bottom] = FULL_ROW_MASK & ~(1u << 4);
+  boards[2].rows[bottom - 1] = FULL_ROW_MASK & ~(0x7u << 3);
+  boards[2].rows[bottom - 2] = 0xF;
+}
+
+/// @brief print the perft count of the board and the placement generation
+/// speed
+/// @param board the board
+/// @param ids figure ids, depth of them
+/// @param depth perft depth
+void run_board(const perft_board_t *board, const int *ids, const int depth) {
+  unsigned long start_us = get_monotonic_us();
+  const unsigned long sequences = placement_perft(board->rows, ids, depth);
+  const double perft_s = (get_monotonic_us() - start_us) / 1e6;
+  static figure_t placements[PLACEMENTS_MAX];
+  figure_t spawned;
+  backend_get_spawned_figure(ids[0], &spawned);
+  long placements_count = 0;
+  start_us = get_monotonic_us();
+  for (int i = 0; i != PERFT_GENERATE_ROUNDS; ++i) {
+    placements_count += placement_generate(board->rows, &spawned, placements);
+  }
+  const double generate_s = (get_monotonic_us() - start_us) / 1e6;
+  printf("%-8s depth %d: %lu sequences in %.3f s (%.1f M/s), ", board->name,
+         depth, sequences, perft_s,
+         perft_s > 0 ? sequences / perft_s / 1e6 : 0.0);
+  printf("%ld placements, %.0f ns per board\n",
+         placements_count / PERFT_GENERATE_ROUNDS,
+         generate_s * 1e9 / PERFT_GENERATE_ROUNDS);
+}
+
+/// @brief print the options
+/// @param name executable name
+void print_usage(const char *name) {
+  fprintf(stderr,
+          "usage: %s [-d depth]\n"
+          "  counts the sequences of placements of the figures T I S O L Z J "
+          "T on fixed boards, depth 1 to %d, 3 by default\n",
+          name, PERFT_MAX_DEPTH);
+}
@@ -0,0 +1,87 @@
+#define _POSIX_C_SOURCE 200809L
+// relying on the POSIX getopt(), sigaction() and setrlimit()
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "server/server.h"
+
+void print_usage(const char *name);
+void handle_stop_signal(int signal);
+
+int main(int argc, char **argv) {
+  server_config_t config = {SERVER_DEFAULT_SOCKET_PATH, 1,
+                            SERVER_DEFAULT_MAX_SESSIONS, NULL};
+  const char *leaderboard_path = NULL;
+  int opt = 0;
+  bool error = false;
+  while (!error && (opt = getopt(argc, argv, "S:t:c:L:h")) != -1) {
+    if (opt == 'S') {
+      config.socket_path = optarg;
+    } else if (opt == 't') {
+      config.threads = (int)strtol(optarg, NULL, 10);
+    } else if (opt == 'c') {
+      config.max_sessions = (int)strtol(optarg, NULL, 10);
+    } else if (opt == 'L') {
+      leaderboard_path = optarg;
+    } else {
+      error = true;
+    }
+  }
+  if (!config.threads) config.threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+  if (error || optind != argc || config.threads < 1 ||
+      config.max_sessions < 1) {
+    print_usage(argv[0]);
+    return 1;
+  }
+  if (leaderboard_path) {
+    config.leaderboard =
+        leaderboard_open(leaderboard_path, LEADERBOARD_DEFAULT_CAPACITY);
+    if (!config.leaderboard) {
+      fprintf(stderr, "failed to open the leaderboard %s\n",
+              leaderboard_path);
+      return 1;
+    }
+  }
+  server_raise_file_limit();
+  struct sigaction action;
+  memset(&action, 0, sizeof(action));
+  action.sa_handler = handle_stop_signal;
+  sigemptyset(&action.sa_mask);
+  sigaction(SIGINT, &action, NULL);
+  sigaction(SIGTERM, &action, NULL);
+  server_stats_t stats;
+  const bool error_run = server_run(&config, &stats);
+  if (error_run) {
+    fprintf(stderr, "failed to serve on %s\n", config.socket_path);
+  } else {
+    server_stats_print(stdout, &stats);
+  }
+  leaderboard_close(config.leaderboard);
+  return error_run;
+}
+
+/// @brief stop the server on SIGINT and SIGTERM
+/// @param signal the signal
+void handle_stop_signal(int signal) {
+  (void)signal;
+  server_stop();
+}
+
+/// @brief print the options
+/// @param name executable name
+void print_usage(const char *name) {
+  fprintf(stderr,
+          "usage: %s [-S socket] [-t threads] [-c max_sessions] "
+          "[-L leaderboard]\n"
+          "  serves the games over a Unix domain socket until SIGINT or\n"
+          "  SIGTERM, then prints the stats\n"
+          "  -S  the socket file, %s by default\n"
+          "  -t  number of worker threads, 0 for one per processor, 1 by\n"
+          "      default\n"
+          "  -c  sessions a worker serves at most, %d by default\n"
+          "  -L  submit the finished games to the leaderboard file\n",
+          name, SERVER_DEFAULT_SOCKET_PATH, SERVER_DEFAULT_MAX_SESSIONS);
+}
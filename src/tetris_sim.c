@@ -0,0 +1,256 @@
+#define _POSIX_C_SOURCE 200809L
+// relying on the POSIX getopt()
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "sim/pool.h"
+#include "sim/sim.h"
+
+#define DEFAULT_GAMES 1000
+#define DEFAULT_GRAVITY_CHANCE 4
+#define DEFAULT_MAX_PIECES 100000
+#define LEADERBOARD_TOP_COUNT 10
+#define SPECTATOR_WAIT_MS 10000
+
+void print_usage(const char *name);
+bool parse_randomizer(const char *name, randomizer_kind_t *kind);
+int run_scaling(sim_pool_config_t config);
+
+int main(int argc, char **argv) {
+  sim_pool_config_t config = {1,
+                              1,
+                              DEFAULT_GAMES,
+                              SIM_POOL_DEFAULT_CHUNK,
+                              RANDOMIZER_UNIFORM,
+                              BOARD_STANDARD,
+                              false,
+                              {SIM_POLICY_RANDOM, NULL, DEFAULT_GRAVITY_CHANCE,
+                               DEFAULT_MAX_PIECES, 0, NULL, NULL},
+                              NULL,
+                              false,
+                              NULL,
+                              NULL};
+  const char *leaderboard_path = NULL;
+  const char *spectate_path = NULL;
+  autoplay_weights_t weights = autoplay_default_weights;
+  search_config_t search;
+  search_config_init(&search);
+  bool scaling = false;
+  int opt = 0;
+  bool error = false;
+  const char *options = "n:s:r:d:g:m:f:S:Aw:b:B:t:c:R:L:W:PTh";
+  while (!error && (opt = getopt(argc, argv, options)) != -1) {
+    switch (opt) {
+      case 'n':
+        config.games = strtol(optarg, NULL, 10);
+        break;
+      case 's':
+        config.first_seed = strtoull(optarg, NULL, 10);
+        break;
+      case 'r':
+        error = parse_randomizer(optarg, &config.randomizer);
+        break;
+      case 'd':
+        config.mixed_boards = !strcmp(optarg, "mixed");
+        error = !config.mixed_boards && board_parse_kind(optarg, &config.board);
+        break;
+      case 'g':
+        config.policy.gravity_chance = (int)strtol(optarg, NULL, 10);
+        break;
+      case 'm':
+        config.policy.max_pieces = (int)strtol(optarg, NULL, 10);
+        break;
+      case 'f':
+        config.policy.frame_ms = (int)strtol(optarg, NULL, 10);
+        break;
+      case 'S':
+        config.policy.kind = SIM_POLICY_SCRIPTED;
+        config.policy.script = optarg;
+        error = !sim_script_get_is_valid(optarg);
+        break;
+      case 'A':
+        config.policy.kind = SIM_POLICY_AUTOPLAY;
+        break;
+      case 'w':
+        error = autoplay_parse_weights(optarg, &weights);
+        config.policy.weights = &weights;
+        break;
+      case 'b':
+        search.beam_width = (int)strtol(optarg, NULL, 10);
+        config.policy.kind = SIM_POLICY_AUTOPLAY;
+        config.policy.search = &search;
+        break;
+      case 'B':
+        search.node_budget = strtol(optarg, NULL, 10);
+        config.policy.kind = SIM_POLICY_AUTOPLAY;
+        config.policy.search = &search;
+        break;
+      case 't':
+        config.threads = (int)strtol(optarg, NULL, 10);
+        break;
+      case 'c':
+        config.chunk_size = strtol(optarg, NULL, 10);
+        break;
+      case 'R':
+        config.replay_path = optarg;
+        break;
+      case 'L':
+        leaderboard_path = optarg;
+        break;
+      case 'W':
+        spectate_path = optarg;
+        break;
+      case 'P':
+        config.fsm_stats = true;
+        break;
+      case 'T':
+        scaling = true;
+        break;
+      default:
+        error = true;
+        break;
+    }
+  }
+  if (!config.threads) config.threads = sim_pool_get_cpu_count();
+  if (error || config.games < 0 || config.threads < 0 ||
+      config.chunk_size < 1 || search.beam_width < 1 ||
+      search.node_budget < 1 ||
+      (config.policy.kind == SIM_POLICY_AUTOPLAY &&
+       (config.mixed_boards || config.board != BOARD_STANDARD))) {
+    print_usage(argv[0]);
+    return 1;
+  }
+  if (scaling) return run_scaling(config);
+  if (leaderboard_path) {
+    config.leaderboard =
+        leaderboard_open(leaderboard_path, LEADERBOARD_DEFAULT_CAPACITY);
+    if (!config.leaderboard) {
+      fprintf(stderr, "failed to open the leaderboard %s\n",
+              leaderboard_path);
+      return 1;
+    }
+  }
+  if (spectate_path) {
+    config.spectators = spectator_hub_create();
+    if (spectator_hub_listen(config.spectators, spectate_path) ||
+        spectator_hub_wait(config.spectators, SPECTATOR_WAIT_MS)) {
+      fprintf(stderr, "no spectator connected to %s\n", spectate_path);
+      spectator_hub_destroy(config.spectators);
+      leaderboard_close(config.leaderboard);
+      return 1;
+    }
+  }
+  sim_pool_result_t result = {0};
+  const bool error_run = sim_pool_run(&config, &result);
+  if (error_run) {
+    fprintf(stderr, "failed to run the games\n");
+  } else {
+    printf("threads:    %d\n", config.threads);
+    sim_stats_print(stdout, &result.stats, result.seconds);
+    if (config.fsm_stats) fsm_stats_print(stdout, &result.fsm_stats);
+    if (config.leaderboard) {
+      leaderboard_print(stdout, config.leaderboard, LEADERBOARD_TOP_COUNT);
+    }
+    if (config.spectators) {
+      const spectator_hub_stats_t *stats = &config.spectators->stats;
+      printf("spectators: %ld frames, %ld keyframes, %ld deltas, %ld bytes, "
+             "%ld missed, %ld dropped\n",
+             stats->frames, stats->keyframes, stats->deltas, stats->bytes,
+             stats->missed, stats->dropped);
+    }
+  }
+  spectator_hub_destroy(config.spectators);
+  leaderboard_close(config.leaderboard);
+  return error_run;
+}
+
+/// @brief play the same games with 1, 2, 4 ... config.threads threads and
+/// report the throughput and the scaling efficiency of every thread count
+/// @param config the pool config
+/// @return exit code
+int run_scaling(sim_pool_config_t config) {
+  const int max_threads = config.threads;
+  double single_rate = 0;
+  printf("%8s %12s %14s %8s %10s %8s\n", "threads", "games/sec", "pieces/sec",
+         "speedup", "efficiency", "stolen");
+  for (int threads = 1; threads <= max_threads;
+       threads = threads * 2 > max_threads && threads != max_threads
+                     ? max_threads
+                     : threads * 2) {
+    config.threads = threads;
+    sim_pool_result_t result = {0};
+    if (sim_pool_run(&config, &result)) {
+      fprintf(stderr, "failed to run the games\n");
+      return 1;
+    }
+    const double seconds = result.seconds > 0 ? result.seconds : 1e-9;
+    const double rate = result.stats.games / seconds;
+    if (threads == 1) single_rate = rate;
+    const double speedup = single_rate > 0 ? rate / single_rate : 0;
+    printf("%8d %12.1f %14.1f %8.2f %9.1f%% %8ld\n", threads, rate,
+           result.stats.pieces / seconds, speedup, 100.0 * speedup / threads,
+           result.stolen_chunks);
+  }
+  return 0;
+}
+
+/// @brief translate a randomizer name
+/// @param name uniform, bag or history
+/// @param kind where to save the randomizer
+/// @return true if the name is unknown
+bool parse_randomizer(const char *name, randomizer_kind_t *kind) {
+  bool error = false;
+  if (!strcmp(name, "uniform")) {
+    *kind = RANDOMIZER_UNIFORM;
+  } else if (!strcmp(name, "bag")) {
+    *kind = RANDOMIZER_BAG;
+  } else if (!strcmp(name, "history")) {
+    *kind = RANDOMIZER_HISTORY;
+  } else {
+    error = true;
+  }
+  return error;
+}
+
+void print_usage(const char *name) {
+  fprintf(stderr,
+          "usage: %s [-n games] [-s seed] [-r randomizer] [-d board] "
+          "[-g gravity_chance] [-m max_pieces] [-f frame_ms] [-S script] "
+          "[-A] [-w weights] [-b beam_width] [-B node_budget] "
+          "[-t threads] [-c chunk] [-R replay_file] [-L leaderboard] "
+          "[-W spectate_socket] [-P] [-T]\n"
+          "  -n  number of games to play, %d by default\n"
+          "  -s  seed of the first game, game i is played with seed + i\n"
+          "  -r  figures randomizer: uniform (default), bag or history\n"
+          "  -d  board: standard (default, 10x20), mini (6x12), training\n"
+          "      (4x16) or mixed, game i on the board i %% 3. The autoplay\n"
+          "      plays the standard board only\n"
+          "  -g  random policy: one move in gravity_chance is an autoshift\n"
+          "  -m  a game is stopped after max_pieces pieces\n"
+          "  -f  every move takes frame_ms of virtual time, the autoshift\n"
+          "      also comes from the level timer, 0 (default) disables it\n"
+          "  -S  scripted policy, the script is cycled through:\n"
+          "      L - left, R - right, A - rotate, D - down, G - autoshift,\n"
+          "      at least one G\n"
+          "  -A  autoplay policy, the heuristic evaluator places the figures\n"
+          "  -w  autoplay weights: height,holes,bumpiness,wells,lines\n"
+          "  -b  autoplay with the beam search over the current and the\n"
+          "      preview figure, beam_width boards per ply, %d by default\n"
+          "  -B  the beam search evaluates up to node_budget boards per\n"
+          "      figure, %d by default\n"
+          "  -t  number of worker threads, 0 for one per processor\n"
+          "  -c  number of games a worker claims at once, %d by default\n"
+          "  -R  record the games, to replay_file.<worker> with many workers\n"
+          "  -L  submit the games to the leaderboard file, shared with the\n"
+          "      other processes, and print its top %d\n"
+          "  -W  publish the games of the first worker to the spectators of\n"
+          "      the socket, the games start once a spectator connects\n"
+          "  -P  report the FSM transitions per state and the backend calls\n"
+          "      latency percentiles\n"
+          "  -T  report the scaling for 1, 2, 4 ... threads\n",
+          name, DEFAULT_GAMES, SEARCH_DEFAULT_BEAM_WIDTH,
+          SEARCH_DEFAULT_NODE_BUDGET, SIM_POOL_DEFAULT_CHUNK,
+          LEADERBOARD_TOP_COUNT);
+}
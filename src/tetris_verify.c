@@ -0,0 +1,78 @@
+#define _POSIX_C_SOURCE 200809L
+// relying on the POSIX getopt()
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "sim/pool.h"
+#include "sim/verify.h"
+
+void print_usage(const char *name);
+
+int main(int argc, char **argv) {
+  int threads = 0;
+  int opt = 0;
+  bool error = false;
+  while (!error && (opt = getopt(argc, argv, "t:h")) != -1) {
+    if (opt == 't') {
+      threads = (int)strtol(optarg, NULL, 10);
+    } else {
+      error = true;
+    }
+  }
+  if (!threads) threads = sim_pool_get_cpu_count();
+  const int files_count = argc - optind;
+  if (error || threads < 0 || files_count < 1) {
+    print_usage(argv[0]);
+    return 1;
+  }
+  verify_file_t *files = calloc(files_count, sizeof(verify_file_t));
+  if (!files) return 1;
+  for (int i = 0; !error && i != files_count; ++i) {
+    error = verify_map_file(&files[i], argv[optind + i]);
+    if (error) {
+      fprintf(stderr, "%s: not a replay file\n", argv[optind + i]);
+    } else if (files[i].engine_version != TETRIS_ENGINE_VERSION) {
+      fprintf(stderr, "%s: recorded by the engine version %lu, this is %d\n",
+              files[i].path, files[i].engine_version, TETRIS_ENGINE_VERSION);
+    }
+  }
+  verify_game_t *games = NULL;
+  long games_count = 0;
+  verify_result_t result = {0};
+  if (!error) {
+    error = verify_index_games(files, files_count, &games, &games_count);
+  }
+  if (!error) error = verify_run(files, games, games_count, threads, &result);
+  bool any_corrupted = false;
+  for (int i = 0; !error && i != files_count; ++i) {
+    if (files[i].corrupted) {
+      fprintf(stderr, "%s: corrupted at %zu, the rest of the file is skipped\n",
+              files[i].path, files[i].corrupted_at);
+      any_corrupted = true;
+    }
+  }
+  if (!error) {
+    verify_print_differences(stdout, files, games, games_count);
+    printf("threads:      %d\n", threads);
+    printf("files:        %d\n", files_count);
+    verify_result_print(stdout, &result);
+  } else {
+    fprintf(stderr, "failed to verify the replays\n");
+  }
+  free(games);
+  for (int i = 0; i != files_count; ++i) {
+    verify_unmap_file(&files[i]);
+  }
+  free(files);
+  return error || any_corrupted || result.differs || result.corrupted;
+}
+
+void print_usage(const char *name) {
+  fprintf(stderr,
+          "usage: %s [-t threads] replay_file...\n"
+          "  -t  number of worker threads, 0 (default) for one per processor\n"
+          "  every game of the files is played again and its score and board\n"
+          "  are checked against the recorded ones\n",
+          name);
+}
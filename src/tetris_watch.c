@@ -0,0 +1,206 @@
+#define _POSIX_C_SOURCE 200809L
+// relying on the POSIX sockets, fork() and getopt()
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "game/tetris/spectator.h"
+
+#define CONNECT_TIMEOUT_MS 10000
+#define CONNECT_RETRY_MS 10
+#define READ_BUFFER_SIZE 65536
+
+void print_usage(const char *name);
+pid_t spawn_game(char **argv);
+int connect_spectator(const char *path, const long timeout_ms);
+bool watch_stream(const int fd, const bool quiet, const long max_frames,
+                  spectator_decoder_t *decoder, long *bytes);
+void draw_frame(const spectator_frame_t *frame);
+void print_stats(const spectator_decoder_t *decoder, const long bytes);
+
+int main(int argc, char **argv) {
+  const char *socket_path = SPECTATOR_DEFAULT_SOCKET_PATH;
+  bool quiet = false;
+  long max_frames = 0;
+  int opt = 0;
+  bool error = false;
+  while (!error && (opt = getopt(argc, argv, "+S:n:qh")) != -1) {
+    if (opt == 'S') {
+      socket_path = optarg;
+    } else if (opt == 'n') {
+      max_frames = strtol(optarg, NULL, 10);
+    } else if (opt == 'q') {
+      quiet = true;
+    } else {
+      error = true;
+    }
+  }
+  if (error || max_frames < 0) {
+    print_usage(argv[0]);
+    return 1;
+  }
+  const pid_t game = optind < argc ? spawn_game(argv + optind) : 0;
+  const int fd = game < 0 ? -1
+                 : strcmp(socket_path, "-")
+                     ? connect_spectator(socket_path, CONNECT_TIMEOUT_MS)
+                     : STDIN_FILENO;
+  static spectator_decoder_t decoder;
+  long bytes = 0;
+  error = fd < 0 || watch_stream(fd, quiet, max_frames, &decoder, &bytes);
+  if (fd > STDIN_FILENO) close(fd);
+  if (game > 0) {
+    int status = 0;
+    waitpid(game, &status, 0);
+    error = error || !WIFEXITED(status) || WEXITSTATUS(status);
+  }
+  if (fd < 0) {
+    fprintf(stderr, "failed to connect to %s\n", socket_path);
+  } else {
+    print_stats(&decoder, bytes);
+  }
+  return error || !decoder.frames;
+}
+
+/// @brief run the game that publishes to the spectators
+/// @param argv the game command and its arguments
+/// @return the game pid, -1 on error
+pid_t spawn_game(char **argv) {
+  const pid_t pid = fork();
+  if (!pid) {
+    execvp(argv[0], argv);
+    _exit(127);
+  }
+  return pid;
+}
+
+/// @brief connect to the spectators socket, waiting for the game to listen
+/// @param path the socket file
+/// @param timeout_ms how long to wait
+/// @return the socket, -1 on error
+int connect_spectator(const char *path, const long timeout_ms) {
+  struct sockaddr_un address;
+  memset(&address, 0, sizeof(address));
+  address.sun_family = AF_UNIX;
+  if (strlen(path) >= sizeof(address.sun_path)) return -1;
+  strcpy(address.sun_path, path);
+  int fd = -1;
+  const struct timespec retry = {0, CONNECT_RETRY_MS * 1000000L};
+  for (long waited_ms = 0; fd < 0 && waited_ms <= timeout_ms;
+       waited_ms += CONNECT_RETRY_MS) {
+    fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd >= 0 &&
+        connect(fd, (struct sockaddr *)&address, sizeof(address)) != 0) {
+      close(fd);
+      fd = -1;
+      nanosleep(&retry, NULL);
+    }
+  }
+  return fd;
+}
+
+/// @brief decode the stream until it ends, drawing the game after every read
+/// @param fd the stream
+/// @param quiet whether to draw the game
+/// @param max_frames number of the frames to stop after, 0 for no limit
+/// @param decoder the decoder
+/// @param bytes where to count the bytes read
+/// @return true if the stream is malformed or on read error
+bool watch_stream(const int fd, const bool quiet, const long max_frames,
+                  spectator_decoder_t *decoder, long *bytes) {
+  static uint8_t buffer[READ_BUFFER_SIZE];
+  size_t size = 0;
+  bool error = false;
+  bool done = false;
+  if (!quiet) printf("\033[2J");
+  while (!error && !done) {
+    const ssize_t read_size = read(fd, buffer + size, sizeof(buffer) - size);
+    if (read_size < 0 && errno == EINTR) continue;
+    error = read_size < 0;
+    done = read_size <= 0;
+    size += read_size > 0 ? (size_t)read_size : 0;
+    *bytes += read_size > 0 ? read_size : 0;
+    size_t offset = 0;
+    int frame_size = 0;
+    while (!error && !done &&
+           (frame_size = spectator_decode(decoder, buffer + offset,
+                                          size - offset)) > 0) {
+      offset += (size_t)frame_size;
+      done = max_frames && decoder->frames >= max_frames;
+    }
+    error = error || frame_size < 0;
+    size -= offset;
+    memmove(buffer, buffer + offset, size);
+    if (!quiet && decoder->synced) draw_frame(&decoder->frame);
+  }
+  return error;
+}
+
+/// @brief draw the visible field, the next figure and the numbers with the
+/// terminal escapes
+/// @param frame the frame
+void draw_frame(const spectator_frame_t *frame) {
+  printf("\033[H");
+  for (int r = FIELD_UPPER_MARGIN; r != FIELD_TOTAL_HEIGHT; ++r) {
+    putchar('|');
+    for (int c = 0; c != FIELD_WIDTH; ++c) {
+      fputs(frame->field[r][c] ? "[]" : " .", stdout);
+    }
+    putchar('|');
+    const int row = r - FIELD_UPPER_MARGIN;
+    if (row < MAX_FIGURE_SIZE) {
+      fputs("  ", stdout);
+      for (int c = 0; c != MAX_FIGURE_SIZE; ++c) {
+        fputs(frame->next[row][c] ? "[]" : "  ", stdout);
+      }
+    } else if (row == MAX_FIGURE_SIZE + 1) {
+      printf("  score %d", frame->score);
+    } else if (row == MAX_FIGURE_SIZE + 2) {
+      printf("  high score %d", frame->high_score);
+    } else if (row == MAX_FIGURE_SIZE + 3) {
+      printf("  level %d", frame->level);
+    } else if (row == MAX_FIGURE_SIZE + 4) {
+      printf("  lines %d", frame->lines);
+    } else if (row == MAX_FIGURE_SIZE + 5 && frame->pause) {
+      fputs("  paused", stdout);
+    }
+    fputs("\033[K\n", stdout);
+  }
+  fflush(stdout);
+}
+
+/// @brief print the frames decoded and the bandwidth against dumping every
+/// frame whole
+/// @param decoder the decoder
+/// @param bytes number of the bytes read
+void print_stats(const spectator_decoder_t *decoder, const long bytes) {
+  const long frames = decoder->frames + decoder->skipped;
+  printf("frames:     %ld applied, %ld keyframes, %ld skipped\n",
+         decoder->frames, decoder->keyframes, decoder->skipped);
+  printf("bytes:      %ld, %.1f per frame, %.1f%% of the %d byte full "
+         "frames\n",
+         bytes, frames ? (double)bytes / frames : 0,
+         frames ? 100.0 * bytes / ((double)frames * SPECTATOR_FULL_FRAME_SIZE)
+                : 0,
+         SPECTATOR_FULL_FRAME_SIZE);
+}
+
+/// @brief print the options
+/// @param name executable name
+void print_usage(const char *name) {
+  fprintf(stderr,
+          "usage: %s [-S socket] [-n frames] [-q] [game [args]]\n"
+          "  watches the game published to the spectators and reports the\n"
+          "  bandwidth of the stream. With a game command the game is run\n"
+          "  and the stream is watched until the game ends\n"
+          "  -S  the socket file, %s by default, - for the\n"
+          "      standard input\n"
+          "  -n  stop after the frames\n"
+          "  -q  do not draw the game\n",
+          name, SPECTATOR_DEFAULT_SOCKET_PATH);
+}